@@ -0,0 +1,153 @@
+#' Append Rows to an HDF5 Dataset
+#'
+#' Adds new rows to the end of a dataset, creating it on the first call. Only
+#' the new rows are written, so a table can be built up batch by batch without
+#' rewriting what is already on disk.
+#'
+#' @param data The R object to append: a vector, matrix, array, or data.frame.
+#' @param file The path to the HDF5 file. It will be created if it does not exist.
+#' @param name The full path of the dataset to append to (e.g., `"/data/log"`).
+#' @param as The target HDF5 data type, used only when the dataset is created.
+#'   See [h5_write()] for the available options.
+#' @param compress A compression configuration, used only when the dataset is
+#'   created. See [h5_write()] and [h5_compression()].
+#'
+#' @details
+#' Rows are added along the first dimension: elements of a vector, rows of a
+#' matrix or data.frame, or the first dimension of an array. All other
+#' dimensions of `data` must match the existing dataset.
+#'
+#' **Creating the dataset**
+#'
+#' The first call creates a chunked dataset with an unlimited first dimension.
+#' Since later batches may hold larger values or longer strings, the `"auto"`
+#' type selection is less aggressive than in [h5_write()]: doubles are stored
+#' as `float64`, integers as `int32`, logicals as `uint8`, and strings as
+#' variable-length `utf8`. Integer and logical data containing `NA` are stored
+#' as `float64`. Set `as` to override these choices.
+#'
+#' **Appending to an existing dataset**
+#'
+#' New rows are converted to the dataset's existing HDF5 type, and an error is
+#' raised if they do not fit (for instance, `NA` values in an integer dataset).
+#' For data.frames, the column names must match the dataset's members. Only
+#' datasets created by `h5_append()` can be extended; datasets written by
+#' [h5_write()] have a fixed size.
+#'
+#' Names, row names, dimnames, and other R attributes of `data` are not stored.
+#'
+#' @return Invisibly returns `file`. This function is called for its side effects.
+#' @seealso [h5_write()], [h5_apply()]
+#' @export
+#' @examples
+#' file <- tempfile(fileext = ".h5")
+#'
+#' # Build a data.frame on disk, one batch at a time
+#' for (i in 1:3) {
+#'   batch <- data.frame(batch = i, value = rnorm(5))
+#'   h5_append(batch, file, "records")
+#' }
+#' h5_dim(file, "records")
+#'
+#' # Matrices grow by rows
+#' h5_append(matrix(1:6, ncol = 3), file, "mtx")
+#' h5_append(matrix(7:9, ncol = 3), file, "mtx")
+#' h5_read(file, "mtx")
+#'
+#' unlink(file)
+h5_append <- function(data, file, name, as = "auto", compress = "gzip") {
+
+  file   <- validate_strings(file, name)
+  obj_as <- validate_as(as)
+
+  if (is.null(data) || is_list_group(data))
+    stop("`data` must be a vector, matrix, array, or data.frame.", call. = FALSE)
+
+  compress <- h5_compression(compress)
+
+  h5_create_group(file, name = "/")
+  write_data(data, file, name, attr = NULL, obj_as, "auto", compress, dry = TRUE, append = TRUE)
+  write_data(data, file, name, attr = NULL, obj_as, "auto", compress, dry = FALSE, append = TRUE)
+
+  invisible(file)
+}
+
+
+#' Resolves the HDF5 type for appended data
+#' @noRd
+#' @keywords internal
+#' @return New datasets get wide types that later batches can still fit into.
+#'   Existing datasets dictate their own types, which `data` is checked against.
+resolve_append_type <- function(data, file, name, map_key, as_map) {
+
+  if (h5_exists(file, name)) {
+
+    if (!h5_is_dataset(file, name))
+      stop("Cannot append to '", name, "': object is not a dataset.", call. = FALSE)
+
+    if (.Call("C_h5_exists", file, name, dict_attr, PACKAGE = "h5lite"))
+      stop("Cannot append to dictionary-encoded dataset '", name, "'.", call. = FALSE)
+
+    members <- .Call("C_h5_member_types", file, name, PACKAGE = "h5lite")
+
+    if (is.data.frame(data)) {
+      if (is.null(members))
+        stop("Cannot append a data.frame to non-compound dataset '", name, "'.", call. = FALSE)
+      if (!setequal(names(data), names(members)))
+        stop(
+          "Cannot append to '", name, "': columns must match the dataset's members (",
+          paste(names(members), collapse = ", "), ").", call. = FALSE )
+      for (col in names(data)) check_append_kind(data[[col]], members[[col]], name)
+      return (resolve_h5_type(data, map_key, members))
+    }
+
+    if (!is.null(members))
+      stop("Cannot append to compound dataset '", name, "': `data` must be a data.frame.", call. = FALSE)
+
+    h5_type <- h5_typeof(file, name)
+    check_append_kind(data, h5_type, name)
+    return (resolve_h5_type(data, map_key, h5_type))
+  }
+
+  if (is.data.frame(data)) {
+    if (ncol(data) == 0)
+      stop("Cannot write a data.frame with zero columns: ", map_key, call. = FALSE)
+    return (vapply(
+      X         = names(data),
+      FUN       = function (col) resolve_append_type(data[[col]], file, name, col, as_map),
+      FUN.VALUE = character(1),
+      USE.NAMES = FALSE ))
+  }
+
+  h5_type <- lookup_as(data, map_key, as_map)
+
+  if (h5_type == "auto" && !inherits(data, c("factor", "integer64"))) {
+    if      (is.character(data)) { h5_type <- "utf8" }
+    else if (is.double(data))    { h5_type <- "float64" }
+    else if (is.integer(data))   { h5_type <- if (anyNA(data)) "float64" else "int32" }
+    else if (is.logical(data))   { h5_type <- if (anyNA(data)) "float64" else "uint8" }
+  }
+
+  resolve_h5_type(data, map_key, h5_type)
+}
+
+
+#' Checks that `data` can be converted to an existing HDF5 type
+#' @noRd
+#' @keywords internal
+check_append_kind <- function(data, h5_type, name) {
+
+  ok <- switch(
+    EXPR    = sub("\\[.*$", "", h5_type),
+    utf8    = ,
+    ascii   = is.character(data),
+    enum    = is.factor(data),
+    opaque  = is.raw(data),
+    complex = is.complex(data),
+    is.numeric(data) || is.logical(data) )
+
+  if (!ok)
+    stop(
+      "Cannot append ", class(data)[[1]], " data to '", name,
+      "', which has type '", h5_type, "'.", call. = FALSE )
+}
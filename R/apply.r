@@ -0,0 +1,81 @@
+#' Apply a Function to Blocks of a Dataset
+#'
+#' Streams a dataset through R one block at a time, calling `FUN` on each
+#' block. Only one block is held in memory at once, so datasets much larger
+#' than the available RAM can be summarized or reduced.
+#'
+#' @param file The path to the HDF5 file.
+#' @param name The full path of the dataset to read (e.g., `"/data/matrix"`).
+#' @param FUN The function to apply to each block. It is called as
+#'   `FUN(x, ...)`, where `x` is the block read from the dataset.
+#' @param ... Additional arguments passed on to `FUN`.
+#' @param block The number of units (see Details) to read per block.
+#'   If `NULL` (default), the block size is chosen so that each block is
+#'   roughly `getOption("h5lite.block_size")` bytes and covers whole chunks
+#'   of the on-disk layout.
+#' @param as The target R data type. See [h5_read()] for details.
+#'
+#' @details
+#' Blocks are taken along the same dimension that a single-value `start`
+#' targets in [h5_read()]:
+#'
+#' * **1D Vector:** blocks of **elements**.
+#' * **2D Matrix / Data Frame:** blocks of **rows**.
+#' * **3D Array:** blocks of **2D matrices** (the last dimension).
+#'
+#' Each block is equivalent to `h5_read(file, name, start = i, count = block)`,
+#' so dimensions are always preserved and the final block may be shorter than
+#' the others. The dataset is kept open between blocks, and HDF5 attributes are
+#' not attached to the blocks.
+#'
+#' @return A list with one element per block, holding the results of `FUN`.
+#'
+#' @seealso [h5_read()]
+#' @export
+#' @examples
+#' file <- tempfile(fileext = ".h5")
+#'
+#' m <- matrix(rnorm(10000), nrow = 1000, ncol = 10)
+#' h5_write(m, file, "matrix_data")
+#'
+#' # Column sums, computed 250 rows at a time
+#' sums <- h5_apply(file, "matrix_data", colSums, block = 250)
+#' Reduce(`+`, sums)
+#'
+#' # A running total with the default, chunk-aligned block size
+#' total <- 0
+#' invisible(h5_apply(file, "matrix_data", function (x) total <<- total + sum(x)))
+#' total
+#'
+#' unlink(file)
+h5_apply <- function(file, name, FUN, ..., block = NULL, as = "auto") {
+
+  file <- validate_strings(file, name, must_exist = TRUE)
+  FUN  <- match.fun(FUN)
+
+  assert_scalar_integer(block, .null_ok = TRUE)
+  if (!is.null(block) && block < 1)
+    stop("Argument `block` must be positive.", call. = FALSE)
+
+  if (!h5_is_dataset(file, name))
+    stop("Object '", name, "' is not a dataset.", call. = FALSE)
+
+  obj_as <- match_read_as(validate_as(as))
+  if (!is.null(block)) block <- as.numeric(block)
+
+  cursor <- .Call("C_h5_cursor_open", file, name, block, PACKAGE = "h5lite")
+  on.exit(.Call("C_h5_cursor_close", cursor$ptr, PACKAGE = "h5lite"), add = TRUE)
+
+  starts <- if (cursor$n == 0) numeric(0) else seq(1, cursor$n, by = cursor$block)
+  res    <- vector("list", length(starts))
+
+  for (i in seq_along(starts)) {
+    count <- min(cursor$block, cursor$n - starts[[i]] + 1)
+    x     <- .Call(
+      "C_h5_cursor_read", cursor$ptr, obj_as, basename(name),
+      starts[[i]], count, PACKAGE = "h5lite" )
+    res[i] <- list(FUN(x, ...))
+  }
+
+  return(res)
+}
@@ -48,7 +48,7 @@ validate_strings <- function (file, name = "/", attr = NULL, must_exist = FALSE)
   if (must_exist) {
 
     # Check File Existence
-    if (!file.exists(file)) stop("File '", file, "' does not exist.", call. = FALSE)
+    if (!file_exists(file)) stop("File '", file, "' does not exist.", call. = FALSE)
     
     # Check Object/Attribute Existence
     if (!.Call("C_h5_exists", file, name, attr, PACKAGE = "h5lite")) {
@@ -61,6 +61,14 @@ validate_strings <- function (file, name = "/", attr = NULL, must_exist = FALSE)
 }
 
 
+#' Whether a file exists on disk, or is held open in memory by h5_open()
+#' @noRd
+#' @keywords internal
+file_exists <- function (file) {
+  file.exists(file) || .Call("C_h5_is_memory", file, PACKAGE = "h5lite")
+}
+
+
 #' Sanity check integer arguments for start and count
 #' @noRd
 #' @keywords internal
@@ -142,3 +150,90 @@ validate_as <- function (as) {
 
   return (as)
 }
+
+
+#' Sanity check the `index` argument to h5_read()
+#' @noRd
+#' @keywords internal
+#' @return Assigns a list with one element per dimension, each `NULL` or a
+#'   double vector of 1-based indices, to `index` in the calling frame.
+validate_index <- function (file, name, attr, index, start) {
+  
+  if (is.null(index)) return (invisible())
+  
+  if (!is.null(start)) stop('`index` cannot be combined with `start` and `count`.', call. = FALSE)
+  if (!is.null(attr))  stop('`index` cannot be used on attributes.', call. = FALSE)
+  if (!h5_is_dataset(file, name) && !is_columnar(file, name))
+    stop('`index` can only be used on datasets.', call. = FALSE)
+  
+  # Data frames are indexed by row only
+  shape <- h5_dim(file, name)
+  if (h5_class(file, name) == "data.frame") shape <- shape[1]
+  N     <- length(shape)
+  
+  if (N == 0) stop('`index` cannot be used on scalar datasets.', call. = FALSE)
+  
+  if (!is.list(index)) {
+    if (N != 1) stop('`index` must be a list with one element per dimension.', call. = FALSE)
+    index <- list(index)
+  }
+  if (length(index) != N)
+    stop('`index` has ', length(index), ' elements, but the dataset has ', N, ' dimensions.', call. = FALSE)
+  
+  for (i in seq_len(N)) {
+    
+    idx <- index[[i]]
+    if (is.null(idx)) next
+    
+    if (is.logical(idx)) {
+      if (length(idx) != shape[[i]] || anyNA(idx))
+        stop('Logical `index` vectors must match the dimension length and cannot contain NA.', call. = FALSE)
+      idx <- which(idx)
+    }
+    
+    if (!is.numeric(idx))                     stop('`index` elements must be numeric, logical, or NULL.', call. = FALSE)
+    if (anyNA(idx) || !all(idx %% 1 == 0))    stop('`index` values must be whole numbers.', call. = FALSE)
+    if (!all(idx >= 1 & idx <= shape[[i]]))   stop('`index` is out of bounds', call. = FALSE)
+    
+    index[i] <- list(as.numeric(idx))
+  }
+  
+  assign('index', index, pos = parent.frame())
+  
+  return (invisible())
+}
+
+
+#' Sanity check the `cols` argument to h5_read()
+#' @noRd
+#' @keywords internal
+validate_cols <- function (file, name, attr, cols) {
+  
+  if (is.null(cols)) return (invisible())
+  
+  if (!is.character(cols) || length(cols) == 0 || anyNA(cols))
+    stop('`cols` must be a character vector of column names.', call. = FALSE)
+  if (anyDuplicated(cols))
+    stop('`cols` cannot contain duplicate names.', call. = FALSE)
+  if (!is.null(attr))
+    stop('`cols` cannot be used on attributes.', call. = FALSE)
+  
+  if (is_columnar(file, name)) {
+    members <- columnar_names(file, name)
+  }
+  else {
+    if (!h5_is_dataset(file, name))
+      stop('`cols` can only be used on datasets.', call. = FALSE)
+    
+    members <- names(.Call("C_h5_member_types", file, name, PACKAGE = "h5lite"))
+    
+    if (is.null(members))
+      stop('`cols` can only be used on data.frame (compound) datasets.', call. = FALSE)
+  }
+  
+  missing <- setdiff(cols, members)
+  if (length(missing) > 0)
+    stop('Columns not found in "', name, '": ', paste(missing, collapse = ', '), call. = FALSE)
+  
+  return (invisible())
+}
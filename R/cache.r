@@ -0,0 +1,115 @@
+#' Define HDF5 Cache Settings
+#'
+#' Constructs the cache and buffer settings used when h5lite opens a file. Pass
+#' the result to [h5_open()] to tune a single handle, or set it globally with
+#' `options(h5lite.cache = h5_cache(...))`.
+#'
+#' @param chunk_bytes Size, in bytes, of the raw data chunk cache kept for each
+#'   open dataset. Chunks that fit in the cache are decompressed once and then
+#'   reused by later reads of the same dataset.
+#'   * `"auto"` (Default): Sized per dataset to hold one chunk along every
+#'     dimension except the one being read in blocks, so that row slabs of a
+#'     read - or blocks of [h5_apply()] - that end inside a chunk do not
+#'     decompress it again. The size is capped at
+#'     `getOption("h5lite.block_size")`, but always holds at least one chunk,
+#'     and is never smaller than HDF5's 1 MiB default.
+#'   * Numeric: A fixed size for every dataset in the file.
+#' @param chunk_slots The number of hash table slots in the chunk cache. HDF5
+#'   recommends a prime number around 100 times the number of chunks that fit in
+#'   the cache. Default is `NULL`, which picks such a value for `"auto"` caches
+#'   and uses HDF5's default of 521 otherwise.
+#' @param preempt A number between `0` and `1` controlling which chunks are
+#'   evicted first. `0` evicts the least recently used chunk; `1` prefers chunks
+#'   that have been read completely. Default is `NULL` (HDF5's `0.75`).
+#' @param meta_bytes Initial size, in bytes, of the file's metadata cache, which
+#'   holds object headers, B-tree nodes and other file structure. Must be
+#'   between 1 KiB and 128 MiB. Default is `NULL` (HDF5's adaptive default,
+#'   starting at 2 MiB).
+#' @param sieve_bytes Size, in bytes, of the sieve buffer used to combine small
+#'   reads of contiguous (unchunked) datasets. Default is `NULL` (HDF5's 64 KiB).
+#'
+#' @details
+#' The chunk cache belongs to an open dataset and is discarded when the dataset
+#' is closed. It pays off whenever a single call reads the same chunks more than
+#' once - [h5_apply()] blocks, the row slabs that [h5_read()] uses for large
+#' matrices, and data.frame columns - and matters most for compressed data,
+#' where every cache miss means decompressing the whole chunk again.
+#' Chunks larger than the cache are never cached at all.
+#'
+#' The metadata cache and sieve buffer belong to the open file. They persist
+#' across calls only while the file is held open by an [h5_open()] handle.
+#'
+#' Settings passed to [h5_open()] apply to every call that goes through the
+#' handle's file, including plain `h5_*()` calls on the same path. Other calls
+#' use `getOption("h5lite.cache")`.
+#'
+#' @return An S3 object of class `cache` containing the settings.
+#' @seealso [h5_open()], [h5_compression()]
+#' @export
+#' @examples
+#' # A fixed 64 MiB chunk cache with a larger metadata cache
+#' h5_cache(chunk_bytes = 64 * 1024^2, meta_bytes = 8 * 1024^2)
+#'
+#' file <- tempfile(fileext = ".h5")
+#' h5_write(matrix(rnorm(1e5), ncol = 100), file, "mtx")
+#'
+#' # Tune a single handle
+#' h5 <- h5_open(file, cache = h5_cache(chunk_bytes = 4 * 1024^2))
+#' x  <- h5$read("mtx")
+#' h5$close()
+#'
+#' # Or every call in the session
+#' old <- options(h5lite.cache = h5_cache(sieve_bytes = 1024^2))
+#' x   <- h5_read(file, "mtx")
+#' options(old)
+#'
+#' unlink(file)
+h5_cache <- function(
+    chunk_bytes = "auto", chunk_slots = NULL, preempt = NULL,
+    meta_bytes = NULL, sieve_bytes = NULL ) {
+
+  if (inherits(chunk_bytes, 'cache')) return(chunk_bytes)
+
+  if (identical(chunk_bytes, "auto")) chunk_bytes <- NULL
+  assert_scalar_integer(chunk_bytes, chunk_slots, meta_bytes, sieve_bytes, .null_ok = TRUE)
+
+  for (var in c('chunk_bytes', 'chunk_slots', 'sieve_bytes'))
+    if (!is.null(get(var)) && get(var) < 1)
+      stop("`", var, "` must be a positive integer.", call. = FALSE)
+
+  if (!is.null(meta_bytes) && (meta_bytes < 1024 || meta_bytes > 128 * 1024^2))
+    stop("`meta_bytes` must be between 1 KiB and 128 MiB.", call. = FALSE)
+
+  if (!is.null(preempt) && !(is.numeric(preempt) && length(preempt) == 1 &&
+                             isTRUE(preempt >= 0 && preempt <= 1)))
+    stop("`preempt` must be a number between 0 and 1.", call. = FALSE)
+
+  na <- function (x) if (is.null(x)) NA_real_ else as.double(x)
+
+  structure(
+    .Data = list(
+      chunk_bytes = na(chunk_bytes),
+      chunk_slots = na(chunk_slots),
+      preempt     = na(preempt),
+      meta_bytes  = na(meta_bytes),
+      sieve_bytes = na(sieve_bytes) ),
+    class = 'cache' )
+}
+
+#' @keywords internal
+#' @export
+print.cache <- function(x, ...) {
+
+  dflt <- function (val, str) if (is.na(val)) str else fmt_bytes(val)
+
+  cat("<HDF5 Cache Configuration>\n")
+  cat(sprintf("  %-16s %s\n", "Chunk Cache:",  dflt(x$chunk_bytes, "Auto (per dataset)")))
+  if (!is.na(x$chunk_slots))
+    cat(sprintf("  %-16s %s\n", "Chunk Slots:", format(x$chunk_slots, scientific = FALSE)))
+  if (!is.na(x$preempt))
+    cat(sprintf("  %-16s %s\n", "Preemption:",  x$preempt))
+  cat(sprintf("  %-16s %s\n", "Metadata Cache:", dflt(x$meta_bytes,  "HDF5 Default")))
+  cat(sprintf("  %-16s %s\n", "Sieve Buffer:",   dflt(x$sieve_bytes, "HDF5 Default")))
+
+  invisible(x)
+}
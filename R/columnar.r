@@ -0,0 +1,112 @@
+# Columnar data.frame layout
+#
+# h5_write(layout = "columnar") stores a data.frame as a group with one 1D
+# dataset per column. The group's "h5lite_columns" attribute records the
+# column order and marks the group as a data.frame; string row names are kept
+# in a "_rownames" dimension scale shared by every column.
+
+columnar_attr <- "h5lite_columns"
+
+
+#' Tests whether an object is a columnar data.frame group
+#' @noRd
+#' @keywords internal
+is_columnar <- function (file, name) {
+  h5_is_group(file, name) &&
+    .Call("C_h5_exists", file, name, columnar_attr, PACKAGE = "h5lite")
+}
+
+
+#' Column names of a columnar data.frame group, in their stored order
+#' @noRd
+#' @keywords internal
+columnar_names <- function (file, name) {
+  .Call("C_h5_read_attribute", file, name, columnar_attr, "auto", PACKAGE = "h5lite")
+}
+
+
+#' Writes a data.frame as a group of column datasets
+#' @noRd
+#' @keywords internal
+#' @param h5_type The resolved HDF5 type of each column.
+#' @param batch `NULL`, or a batch from new_batch() to queue the writes on.
+write_columns <- function (data, file, name, h5_type, compress, dry = FALSE, batch = NULL) {
+  
+  cols <- names(data)
+  
+  if (anyNA(cols) || !all(nzchar(cols)) || anyDuplicated(cols))
+    stop("Columnar data.frames need unique, non-empty column names: ", name, call. = FALSE)
+  if (any(grepl("/", cols, fixed = TRUE)) || any(cols %in% c(".", "_rownames")))
+    stop(
+      "Columnar data.frame column names cannot contain '/' or be '.' or '_rownames': ", 
+      name, call. = FALSE )
+  
+  if (dry) return (invisible())
+  
+  write_call(batch, "group", file, name)
+  
+  for (i in seq_along(data)) {
+    col <- data[[i]]
+    names(col) <- NULL
+    write_call(
+      batch, "C_h5_write_dataset", file, paste(name, cols[[i]], sep = "/"), col, h5_type[[i]], 
+      length(col), column_compress(h5_type[[i]], compress, col) )
+  }
+  
+  if (.row_names_info(data) > 0)
+    write_call(batch, "C_h5_write_rownames", file, name, cols, rownames(data))
+  
+  write_call(batch, "C_h5_write_attribute", file, name, columnar_attr, cols, "utf8", length(cols))
+  
+  invisible()
+}
+
+
+#' Picks the compression for one column of a columnar data.frame
+#' @noRd
+#' @keywords internal
+#' @param col The column's data, for `compress = "auto"` trials.
+#' @return `compress` itself, unless it is `"auto"` (see auto_compression()) or
+#'   the implicit default, in which case the codec from type_codec().
+column_compress <- function (h5_type, compress, col = NULL) {
+  
+  if (!is.null(attr(compress, "auto")))  return (auto_compression(col, h5_type, length(col), compress))
+  if (!isTRUE(attr(compress, "by_type"))) return (compress)
+  
+  res <- h5_compression(type_codec(h5_type))
+  attr(res, "threads") <- attr(compress, "threads")
+  res
+}
+
+
+#' A codec suited to an HDF5 type
+#' @noRd
+#' @keywords internal
+#' @return Bitshuffle + Zstd for integers and dictionary codes, lossless
+#'   (reversible) ZFP for 32/64-bit floats, and Zstd otherwise - including
+#'   compound types.
+type_codec <- function (h5_type) {
+  if      (length(h5_type) != 1)                  "zstd"
+  else if (grepl("^(u?int|bit64|dict)", h5_type)) "bshuf-zstd"
+  else if (h5_type %in% c("float32", "float64"))  "zfp-rev"
+  else                                            "zstd"
+}
+
+
+#' Reads a columnar data.frame group
+#' @noRd
+#' @keywords internal
+read_columns <- function (file, name, obj_as, start, count, index, cols) {
+  
+  if (is.null(cols)) cols <- columnar_names(file, name)
+  
+  res <- .Call(
+    "C_h5_read_columns", file, name, cols, obj_as, 
+    start[1], count, index, PACKAGE = "h5lite" )
+  
+  # Columns skipped with `as = "null"`
+  keep <- !vapply(res, is.null, logical(1))
+  if (!all(keep)) res <- res[keep]
+  
+  res
+}
@@ -8,7 +8,8 @@
 #' @param compress A string specifying the compression algorithm and optional level 
 #'   (e.g., `"none"`, `"gzip"`, `"zstd-7"`, `"lz4"`, `"blosc1-lz4-9"`, 
 #'   `"blosc2-gzip-3"`, `"blosc2-zstd"`). See the **Valid Compression Strings** 
-#'   section below for an exhaustive list of supported formats. Default is `"gzip"`.
+#'   section below for an exhaustive list of supported formats, and the
+#'   **Automatic Codec Selection** section for `"auto"`. Default is `"gzip"`.
 #' @param chunk_size An integer specifying the target chunk size in bytes. 
 #'   Default is `1048576` (1 MB).
 #' @param checksum A logical value indicating whether to apply the Fletcher32 
@@ -30,6 +31,21 @@
 #' @param blosc2_truncate An integer. If provided and a `blosc2` compressor is selected, 
 #'   applies the Blosc2 Truncate Precision pre-filter to floating-point data, preserving 
 #'   exactly the specified number of uncompressed bits. Default is `NULL`.
+#' @param access How the dataset will usually be read, used to shape its chunks.
+#'   * `"balanced"` (Default): Chunks are cut evenly across all dimensions.
+#'   * `"row"`: Each chunk holds whole rows, so reading a few rows (e.g.
+#'     `h5_read(start = i, count = n)` on a matrix) decompresses only those rows.
+#'   * `"column"`: Each chunk holds whole columns (all of the first dimension),
+#'     for reading a few columns or samples at a time.
+#'   * Numeric vector (e.g., `c(1000, 1)`): Explicit chunk dimensions, in the
+#'     same order as `dim(data)`. Datasets of a different rank use `"balanced"`.
+#'   
+#'   Hints other than `"balanced"` are recorded in an `h5lite_access` attribute,
+#'   which [h5_read()] and [h5_apply()] use to pick matching block sizes.
+#' @param threads The number of threads used to compress chunks when writing.
+#'   Only `"gzip"` datasets are compressed in parallel; other codecs always run
+#'   on a single thread. Default is `NULL`, which uses
+#'   `getOption("h5lite.threads", 1)`.
 #' 
 #' @section Valid Compression Strings:
 #' The `compress` argument accepts a highly specific string syntax to define both 
@@ -37,7 +53,8 @@
 #' 
 #' ### Native / Core Codecs
 #' 
-#' * `"none"`: No compression.
+#' * `"none"`: No compression. The dataset is stored contiguously rather than in
+#'   chunks, unless a checksum, packing, rounding or `access` is also requested.
 #' * `"gzip-[level]"`: Levels `1` to `9`. Default is `5`. (e.g., `"gzip"` or `"gzip-9"`).
 #' * `"zstd-[level]"`: Levels `1` to `22`. Default is `3`. (e.g., `"zstd"` or `"zstd-7"`).
 #' * `"lz4-[level]"`: Levels `0` to `12`. Default is `0`. Level `0` is standard LZ4. Levels `1+` trigger LZ4-HC.
@@ -68,6 +85,32 @@
 #' * `"bzip2-[level]"`: Levels `1` to `9`. Default is `9`. (e.g., `"bzip2-4"`).
 #' * `"lzf"`, `"snappy"`: Fast, unconfigurable legacy compressors.
 #' 
+#' @section Automatic Codec Selection:
+#' 
+#' With `compress = "auto"`, the codec is chosen separately for each dataset
+#' by trying a set of candidates on its data: a sample of about three chunks
+#' (taken from the start, middle, and end of the data) is compressed with each
+#' candidate in memory and read back, and the winner is used for the full
+#' write. A target can be appended to the string:
+#' 
+#' * `"auto-balanced"` (same as `"auto"`): The fastest candidate whose
+#'   compression ratio is within 10% of the best one.
+#' * `"auto-speed"`: The fastest candidate that shrinks the data by at least
+#'   10%.
+#' * `"auto-ratio"`: The candidate with the best compression ratio.
+#' 
+#' Speed counts both compressing and decompressing the sample. Data that no
+#' candidate shrinks by 10% is stored uncompressed. The candidates are
+#' `"lz4"`, `"zstd"`, `"gzip"`, `"bshuf-lz4"`, `"bshuf-zstd"`, `"blosc2-lz4"`,
+#' and `"blosc2-zstd"`, plus lossless `"zfp-rev"` for floating-point data;
+#' every other setting (`chunk_size`, `checksum`, `access`, packing, ...)
+#' applies to each of them. Strings, data.frames stored as compound
+#' datasets, and other data that cannot be sampled use the codec that
+#' `layout = "columnar"` picks for their type (see [h5_write()]).
+#' 
+#' The chosen pipeline is recorded in an `h5lite_compress` attribute on the
+#' dataset (e.g. `"bshuf-zstd"`), which [h5_read()] does not return.
+#' 
 #' @section Automatic Shuffling:
 #' 
 #' To maximize compression ratios without requiring users to manually manage 
@@ -118,6 +161,9 @@
 #' # 4. Lossy ZFP compression (Tolerance of 0.05)
 #' h5_compression("zfp-acc-0.05")
 #' 
+#' # 5. Let h5_write() try candidate codecs on the data
+#' h5_compression("auto-speed")
+#' 
 #' # Pass the compress object directly to h5_write
 #' file <- tempfile(fileext = ".h5")
 #' cmp  <- h5_compression("gzip-9", checksum = TRUE)
@@ -133,7 +179,7 @@
 h5_compression <- function(
     compress = "gzip", chunk_size = 1024 * 1024, checksum = FALSE, 
     int_packing = FALSE, float_rounding = NULL,
-    blosc2_delta = FALSE, blosc2_truncate = NULL ) {
+    blosc2_delta = FALSE, blosc2_truncate = NULL, access = "balanced", threads = NULL ) {
   
   if (inherits(compress, 'compress'))           return(compress)
   if (is.numeric(compress) && compress %in% 1:9) compress <- paste0("gzip-", compress)
@@ -149,7 +195,18 @@ h5_compression <- function(
   assert_scalar_character(compress)
   assert_scalar_logical(checksum, blosc2_delta)
   assert_scalar_integer(chunk_size)
-  assert_scalar_integer(float_rounding, blosc2_truncate, .null_ok = TRUE)
+  assert_scalar_integer(float_rounding, blosc2_truncate, threads, .null_ok = TRUE)
+  if (!is.null(threads) && threads < 1)
+    stop("`threads` must be a positive integer.", call. = FALSE)
+  
+  if (is.numeric(access)) {
+    if (length(access) == 0 || anyNA(access) || any(access < 1) || any(access %% 1 != 0))
+      stop("Numeric `access` must be a vector of positive integer chunk dimensions.", call. = FALSE)
+    access <- as.double(access)
+  } else {
+    assert_scalar_character(access)
+    access <- match.arg(access, c("balanced", "row", "column"))
+  }
 
   # Check string format against known valid patterns
   if (!any(
@@ -157,7 +214,8 @@ h5_compression <- function(
       grepl('^(none|zfp-rev|bshuf-lz4|szip-ec|szip-nn|lzf|snappy)$',       compress),
       grepl('^blosc1(\\-(snappy|(lz4|gzip|zstd)(\\-[0-9]+)?))?$',          compress),
       grepl('^blosc2(\\-(ndlz|(lz4|gzip|zstd)(\\-[0-9]+)?))?$',            compress),
-      grepl('^(blosc2\\-)?zfp\\-((prec|rate)\\-[0-9]+|acc\\-[0-9\\.]+)$',  compress) )) {
+      grepl('^(blosc2\\-)?zfp\\-((prec|rate)\\-[0-9]+|acc\\-[0-9\\.]+)$',  compress),
+      grepl('^auto(\\-(speed|ratio|balanced))?$',                         compress) )) {
     stop("Invalid `compress` string: '", compress, "'.", call. = FALSE)
   }
   
@@ -167,7 +225,7 @@ h5_compression <- function(
   codecs <- c(
     'gzip', 'none', 'bshuf-lz4', 'bshuf-zstd', 'lz4', 'zstd', 
     'bzip2', 'lzf', 'zfp-rev', 'zfp-prec', 'zfp-acc', 'zfp-rate', 
-    'szip-ec', 'szip-nn', 'snappy', 'ndlz', 'blosclz')
+    'szip-ec', 'szip-nn', 'snappy', 'ndlz', 'blosclz', 'auto')
   for (codec in codecs)
     if (isTRUE(grepl(codec, compress, fixed = TRUE))) break
   
@@ -189,6 +247,7 @@ h5_compression <- function(
 
   if (is.null(float_rounding))  float_rounding  <- NA
   if (is.null(blosc2_truncate)) blosc2_truncate <- NA
+  if (is.null(threads))         threads         <- NA
 
   for (var in c('int_packing', 'float_rounding'))
     if (!is.na(get(var))) {
@@ -208,7 +267,10 @@ h5_compression <- function(
     chunk_size     = as.integer(chunk_size), 
     checksum       = as.logical(checksum),
     b2_delta       = as.logical(blosc2_delta), 
-    b2_trunc       = as.integer(blosc2_truncate)
+    b2_trunc       = as.integer(blosc2_truncate),
+    access         = access,
+    threads        = as.integer(threads),
+    auto           = if (codec == 'auto') { if (compress == 'auto') 'balanced' else sub('^auto-', '', compress) }
   )
 }
 
@@ -227,14 +289,21 @@ print.compress <- function(x, ...) {
   if (blosc > 0) codec_str <- paste0("blosc", blosc, "-", codec_str)
   if (grepl('(gzip|zstd|lz4|bzip2|zfp)', codec)) codec_str <- paste0(codec_str, "-", lvl)
   codec_str <- sub('lz4-0', 'lz4', codec_str)
+  if (codec == "auto") codec_str <- sprintf("Auto (%s, chosen per dataset)", attr(x, "auto"))
   
   size_str     <- fmt_bytes(attr(x, "chunk_size"))
   checksum_str <- if (attr(x, "checksum")) "Fletcher32" else "None"
   
+  access    <- attr(x, "access")
+  shape_str <- NULL
+  if      (is.numeric(access))                          { shape_str <- paste(access, collapse = " x ") }
+  else if (!is.null(access) && access != "balanced")    { shape_str <- paste0("Whole ", access, "s")   }
+  
   # Determine Shuffle Filter Logic
   is_scaled <- !is.na(ip) || !is.na(fr)
   
   if      (codec == "none")        { shuffle_str <- "None"                            }
+  else if (codec == "auto")        { shuffle_str <- "Per codec"                       }
   else if (is_scaled)              { shuffle_str <- "None (Disabled by Scale-Offset)" }
   else if (grepl("^szip",  codec)) { shuffle_str <- "None (Incompatible with szip)"   }
   else if (grepl("^zfp",   codec)) { shuffle_str <- "None (Incompatible with zfp)"    }
@@ -247,6 +316,8 @@ print.compress <- function(x, ...) {
   cat(sprintf("  %-16s %s\n", "Codec:",      codec_str))
   cat(sprintf("  %-16s %s\n", "Shuffle:",    shuffle_str))
   cat(sprintf("  %-16s %s\n", "Chunk Size:", size_str))
+  if (!is.null(shape_str))
+    cat(sprintf("  %-16s %s\n", "Chunk Shape:", shape_str))
   cat(sprintf("  %-16s %s\n", "Checksum:",   checksum_str))
   
   # Optional: Scale-Offset Modifiers
@@ -267,5 +338,86 @@ print.compress <- function(x, ...) {
     if (!is.na(b2_t)) cat(sprintf("  %-16s %s bits\n", "Blosc2 Trunc:", b2_t))
   }
   
+  # Optional: Parallel Compression
+  threads <- attr(x, "threads")
+  if (!is.null(threads) && !is.na(threads))
+    cat(sprintf("  %-16s %s\n", "Threads:", threads))
+  
   invisible(x)
 }
+
+
+#' Settles `compress = "auto"` for one dataset
+#' @noRd
+#' @keywords internal
+#' @param data,h5_type,dims The dataset, as passed to C_h5_write_dataset().
+#' @return `compress` itself, unless it is an `"auto"` object. Then the winning
+#'   pipeline, with the other settings of `compress` and an `auto` attribute
+#'   naming the target, which has the C writer record the choice.
+auto_compression <- function (data, h5_type, dims, compress) {
+  
+  target <- attr(compress, "auto")
+  if (is.null(target)) return (compress)
+  
+  # Scale-Offset packing rules out the bitshuffle and zfp candidates
+  scaled <- !is.na(attr(compress, "int_packing")) || !is.na(attr(compress, "float_rounding"))
+  
+  sampled <- length(h5_type) == 1 && grepl("^(u?int|float)[0-9]+$", h5_type) &&
+    typeof(data) %in% c("double", "integer", "logical", "raw") &&
+    length(dims) > 0 && length(data) > 0
+  
+  if (sampled) {
+    codecs <- c("lz4", "zstd", "gzip", "bshuf-lz4", "bshuf-zstd", "blosc2-lz4", "blosc2-zstd")
+    if (h5_type %in% c("float32", "float64")) codecs <- c(codecs, "zfp-rev")
+    if (scaled) codecs <- codecs[!grepl("^(bshuf|zfp)", codecs)]
+    
+    trial <- .Call(
+      "C_h5_compress_trial", data, h5_type, dims, 
+      lapply(codecs, with_settings, compress), 3 * attr(compress, "chunk_size"), 
+      PACKAGE = "h5lite" )
+    
+    choice <- pick_codec(codecs, trial, target)
+  }
+  else {
+    choice <- type_codec(h5_type)
+    if (scaled && grepl("^(bshuf|zfp)", choice)) choice <- "zstd"
+  }
+  
+  res <- with_settings(choice, compress)
+  attr(res, "auto") <- target
+  res
+}
+
+
+#' Picks the winner of C_h5_compress_trial() for a target
+#' @noRd
+#' @keywords internal
+#' @return One of `codecs`, or `"none"` when no candidate saves 10%.
+pick_codec <- function (codecs, trial, target) {
+  
+  ratio <- trial$bytes / trial$stored
+  speed <- trial$bytes / pmax(trial$write + trial$read, 1e-6)
+  ratio[!is.finite(ratio)] <- NA
+  
+  if (all(is.na(ratio))) return ("gzip") # nocov
+  
+  best <- max(ratio, na.rm = TRUE)
+  keep <- switch(target,
+    ratio    = which(ratio == best),
+    speed    = which(ratio >= 1.1),
+    balanced = which(ratio >= max(1.1, 0.9 * best)) )
+  
+  if (length(keep) == 0) return ("none")
+  codecs[keep][[which.max(speed[keep])]]
+}
+
+
+#' An h5_compression() object for `codec`, with the other settings of `compress`
+#' @noRd
+#' @keywords internal
+with_settings <- function (codec, compress) {
+  res <- h5_compression(codec)
+  for (a in c("int_packing", "float_rounding", "chunk_size", "checksum", "b2_delta", "b2_trunc", "access", "threads"))
+    attr(res, a) <- attr(compress, a)
+  res
+}
@@ -0,0 +1,142 @@
+#' Define HDF5 File Format Settings
+#'
+#' Constructs the file format and file-space settings used when h5lite creates
+#' or opens a file. Pass the result to [h5_open()] or [h5_create_file()], or
+#' set it globally with `options(h5lite.format = h5_format(...))`.
+#'
+#' @param libver The oldest version of the HDF5 file format that objects may
+#'   be written in.
+#'   * `"earliest"` (Default): HDF5's default - every object in the oldest
+#'     format that can represent it, readable by any HDF5 library.
+#'   * `"v18"`, `"v110"`: The formats of HDF5 1.8 and 1.10.
+#'   * `"latest"`: The newest format of the HDF5 library h5lite is built with.
+#'     Groups with many members and objects with many attributes are indexed
+#'     rather than searched, and headers are checksummed. Older HDF5 versions
+#'     may not be able to read the file.
+#' @param strategy How space in the file is allocated.
+#'   * `"default"` (Default): HDF5's default. Small metadata and raw data
+#'     allocations are aggregated into larger blocks, and space freed while the
+#'     file is open is reused.
+#'   * `"paged"`: Space is allocated in fixed-size pages of `page_size` bytes,
+#'     which keeps metadata together and allows a page buffer.
+#'   * `"aggregate"`: Aggregation only; freed space is never reused.
+#'   * `"none"`: Every allocation goes at the end of the file.
+#' @param persist If `TRUE`, free space is tracked in the file itself, so that
+#'   space freed by deleting or overwriting an object is reused by later calls
+#'   instead of being lost when the file is closed. Requires `strategy =
+#'   "default"` or `"paged"`. Default: `FALSE`
+#' @param threshold The smallest free-space section, in bytes, that is tracked
+#'   for reuse. Default is `NULL` (HDF5's `1`).
+#' @param page_size With `strategy = "paged"`, the size of a page in bytes. At
+#'   least 512. Default is `NULL` (HDF5's 4 KiB).
+#' @param page_buffer With `strategy = "paged"`, the size in bytes of a buffer
+#'   that keeps recently used pages in memory while the file is open. At least
+#'   one page. Default is `NULL` (no page buffer).
+#' @param meta_block The size, in bytes, of the blocks that small metadata
+#'   allocations are aggregated into. Default is `NULL` (HDF5's 2 KiB).
+#'
+#' @details
+#' `strategy`, `persist`, `threshold` and `page_size` are stored in the file
+#' when it is created, and cannot be changed afterwards. Files that already
+#' exist keep the settings they were created with.
+#'
+#' `libver`, `page_buffer` and `meta_block` apply whenever h5lite opens a file
+#' with these settings - through an [h5_open()] handle given them, or any call
+#' while `options(h5lite.format)` is set - and only affect objects written
+#' while it is open. A page buffer is skipped for files that were not created
+#' with `strategy = "paged"`.
+#'
+#' Files whose objects are deleted or overwritten often, such as a file
+#' rewritten by repeated [h5_write()] calls, grow with every rewrite under the
+#' default settings. With `persist = TRUE` they stay close to the size of
+#' their contents. Any `strategy` other than `"default"`, and `persist`,
+#' write the file's superblock in the 1.10 format whatever `libver` is, so the
+#' file can only be read by HDF5 1.10 or later.
+#'
+#' @return An S3 object of class `format` containing the settings.
+#' @seealso [h5_open()], [h5_create_file()], [h5_cache()]
+#' @export
+#' @examples
+#' # The latest file format, with free-space tracking
+#' h5_format("latest", persist = TRUE)
+#'
+#' file <- tempfile(fileext = ".h5")
+#'
+#' # Paged allocation with a 1 MiB page buffer
+#' fmt <- h5_format(strategy = "paged", page_size = 64 * 1024, page_buffer = 1024^2)
+#' h5_create_file(file, format = fmt)
+#'
+#' h5 <- h5_open(file, format = fmt)
+#' h5$write(matrix(rnorm(1e4), 100), "mtx")
+#' h5$close()
+#'
+#' # Or every file that h5lite creates in the session
+#' file2 <- tempfile(fileext = ".h5")
+#' old   <- options(h5lite.format = h5_format(persist = TRUE))
+#' h5_write(1:10, file2, "x")
+#' options(old)
+#'
+#' unlink(c(file, file2))
+h5_format <- function(
+    libver = "earliest", strategy = "default", persist = FALSE, threshold = NULL,
+    page_size = NULL, page_buffer = NULL, meta_block = NULL ) {
+
+  if (inherits(libver, 'format')) return(libver)
+
+  assert_scalar_character(libver, strategy)
+  assert_scalar_logical(persist)
+  assert_scalar_integer(threshold, page_size, page_buffer, meta_block, .null_ok = TRUE)
+
+  libver   <- match.arg(tolower(libver),   c("earliest", "v18", "v110", "latest"))
+  strategy <- match.arg(tolower(strategy), c("default", "paged", "aggregate", "none"))
+
+  for (var in c('threshold', 'page_buffer', 'meta_block'))
+    if (!is.null(get(var)) && get(var) < 1)
+      stop("`", var, "` must be a positive integer.", call. = FALSE)
+
+  if (strategy != "paged" && !(is.null(page_size) && is.null(page_buffer)))
+    stop('`page_size` and `page_buffer` require `strategy = "paged"`.', call. = FALSE)
+
+  if (!is.null(page_size) && page_size < 512)
+    stop("`page_size` must be at least 512 bytes.", call. = FALSE)
+
+  if (!is.null(page_buffer) && page_buffer < (if (is.null(page_size)) 4096 else page_size))
+    stop("`page_buffer` must hold at least one page.", call. = FALSE)
+
+  if (strategy %in% c("aggregate", "none") && (persist || !is.null(threshold)))
+    stop('`persist` and `threshold` require `strategy = "default"` or "paged".', call. = FALSE)
+
+  na <- function (x) if (is.null(x)) NA_real_ else as.double(x)
+
+  structure(
+    .Data = list(
+      libver      = libver,
+      strategy    = strategy,
+      persist     = persist,
+      threshold   = na(threshold),
+      page_size   = na(page_size),
+      page_buffer = na(page_buffer),
+      meta_block  = na(meta_block) ),
+    class = 'format' )
+}
+
+#' @keywords internal
+#' @export
+print.format <- function(x, ...) {
+
+  dflt <- function (val, str) if (is.na(val)) str else fmt_bytes(val)
+
+  cat("<HDF5 File Format>\n")
+  cat(sprintf("  %-16s %s\n", "Format Version:", x$libver))
+  cat(sprintf("  %-16s %s\n", "Space Strategy:", x$strategy))
+  if (x$strategy == "paged") {
+    cat(sprintf("  %-16s %s\n", "Page Size:",   dflt(x$page_size,   "HDF5 Default")))
+    cat(sprintf("  %-16s %s\n", "Page Buffer:", dflt(x$page_buffer, "None")))
+  }
+  cat(sprintf("  %-16s %s\n", "Track Free:", if (x$persist) "Yes" else "No"))
+  if (!is.na(x$threshold))
+    cat(sprintf("  %-16s %s\n", "Threshold:", fmt_bytes(x$threshold)))
+  cat(sprintf("  %-16s %s\n", "Meta Block:", dflt(x$meta_block, "HDF5 Default")))
+
+  invisible(x)
+}
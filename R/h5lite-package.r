@@ -15,6 +15,29 @@
 #'   \item **Easy Installation:** The required HDF5 library is bundled with the package.
 #' }
 #'
+#' @section Package Options:
+#' \describe{
+#'   \item{`h5lite.block_size`}{Target size, in bytes, of the scratch buffer
+#'     used when a multi-dimensional dataset is read or written in blocks of
+#'     rows.
+#'     Defaults to 16 MiB. Larger values trade memory for fewer HDF5 calls.}
+#'   \item{`h5lite.threads`}{Number of threads used to decompress chunks when
+#'     reading, and to compress them when writing, `gzip` datasets. Defaults
+#'     to 1. Other codecs always run on a single thread inside HDF5. See also
+#'     the `threads` argument of [h5_compression()].}
+#'   \item{`h5lite.cache`}{Chunk cache, metadata cache and sieve buffer
+#'     settings, created with [h5_cache()], for files not opened with their
+#'     own `cache` by [h5_open()]. Defaults to HDF5's sizes, with chunk caches
+#'     sized automatically from each dataset's chunk layout.}
+#'   \item{`h5lite.profile`}{If `TRUE`, the stages of every read and write
+#'     are timed and counted. Retrieve the totals with [h5_profile()].
+#'     Defaults to `FALSE`.}
+#'   \item{`h5lite.format`}{File format and file-space settings, created
+#'     with [h5_format()], for files not opened with their own `format` by
+#'     [h5_open()]. Defaults to HDF5's: the earliest format, without
+#'     free-space tracking.}
+#' }
+#'
 #' @seealso
 #' Useful links:
 #' * <https://cmmr.github.io/h5lite/>
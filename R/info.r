@@ -15,6 +15,7 @@
 #'   \item **Enum** \eqn{\rightarrow} `"factor"`
 #'   \item **Opaque** \eqn{\rightarrow} `"raw"`
 #'   \item **Compound** \eqn{\rightarrow} `"data.frame"`
+#'   \item **Columnar Data Frame Group** \eqn{\rightarrow} `"data.frame"`
 #'   \item **Null** \eqn{\rightarrow} `"NULL"`
 #' }
 #'
@@ -46,9 +47,15 @@
 #' unlink(file)
 h5_class <- function (file, name, attr = NULL) {
 
+  if (is.null(attr) && is_columnar(file, name))
+    return("data.frame")
+
   if (h5_is_group(file, name, attr))
     return("list")
 
+  if (is.null(attr) && .Call("C_h5_exists", file, name, dict_attr, PACKAGE = "h5lite"))
+    return("character")
+
   hdf5_type <- h5_typeof(file, name, attr)
 
   if (!is.character(hdf5_type)) return(NA_character_) # nocov
@@ -136,6 +143,12 @@ h5_typeof <- function (file, name, attr = NULL) {
 h5_dim <- function (file, name, attr = NULL) {
 
   file <- validate_strings(file, name, attr, must_exist = TRUE)
+  
+  if (is.null(attr) && is_columnar(file, name)) {
+    cols <- columnar_names(file, name)
+    rows <- .Call("C_h5_dim", file, paste(name, cols[[1]], sep = "/"), PACKAGE = "h5lite")
+    return (c(rows[[1]], length(cols)))
+  }
 
   if (is.null(attr)) { .Call("C_h5_dim",      file, name,       PACKAGE = "h5lite") } 
   else               { .Call("C_h5_dim_attr", file, name, attr, PACKAGE = "h5lite") }
@@ -309,6 +322,9 @@ h5_names <- function (file, name = "/", attr = NULL) {
   if (h5_is_dataset(file, name, attr)) {
     res <- .Call("C_h5_names", file, name, attr, PACKAGE = "h5lite")
   }
+  else if (is.null(attr) && is_columnar(file, name)) {
+    res <- columnar_names(file, name)
+  }
   else {
     res <- h5_ls(file, name, recursive = FALSE, full.names = FALSE)
   }
@@ -6,10 +6,32 @@
 #'
 #' @param file The path to the HDF5 file.
 #' @param name The full path of the dataset to inspect.
+#' @param chunks If `TRUE`, also describe every chunk of a chunked dataset.
+#'   Default: `FALSE`
 #' @return An object of class `inspect` (a named list) containing:
 #'   \item{layout}{A string indicating storage layout (e.g., "chunked", "contiguous").}
 #'   \item{chunk_dims}{A numeric vector of chunk dimensions, or `NULL` if not chunked.}
 #'   \item{filters}{A list describing each filter applied.}
+#'   
+#'   With `chunks = TRUE`, chunked datasets also have:
+#'   \item{n_chunks}{The number of chunks the dataset's extent spans.
+#'     Chunks that have never been written are not allocated in the file, and
+#'     read back as the fill value.}
+#'   \item{chunks}{A data.frame with one row per allocated chunk, in the order
+#'     HDF5 indexes them: `start_1`, `start_2`, ... (the chunk's first element
+#'     along each of `chunk_dims`, counting from 1), `address` (its byte
+#'     offset in the file), `size` (its stored size in bytes), `ratio` (its
+#'     uncompressed size over `size`), and `filter_mask` (a bit set for each
+#'     filter that was skipped for this chunk).}
+#'
+#' @details
+#' Chunk statistics are gathered from the chunk index alone, without reading
+#' or decompressing any data, in a single pass even for datasets with millions
+#' of chunks. [print()] summarizes them: the share of unallocated chunks, the
+#' spread of chunk sizes and ratios, and how scattered the chunks are in the
+#' file - the bytes between the first and last chunk over the bytes they
+#' occupy, which is `1.00x` when they are stored back to back.
+#'
 #' @export
 #' @examples
 #' file <- tempfile(fileext = ".h5")
@@ -26,15 +48,21 @@
 #' # Print the raw cd_values for blosc2
 #' dput(res$filters[[1]]$cd_values)
 #' 
+#' # Per-chunk statistics
+#' res <- h5_inspect(file, "float_mtx", chunks = TRUE)
+#' print(res)
+#' head(res$chunks)
+#' 
 #' unlink(file)
-h5_inspect <- function(file, name) {
+h5_inspect <- function(file, name, chunks = FALSE) {
   file <- validate_strings(file, name, must_exist = TRUE)
+  assert_scalar_logical(chunks)
   
   if (!h5_is_dataset(file, name)) {
     stop("Target must be a dataset to inspect its DCPL.")
   }
   
-  res <- .Call("C_h5_inspect", file, name, PACKAGE = "h5lite")
+  res <- .Call("C_h5_inspect", file, name, chunks, PACKAGE = "h5lite")
   
   # Append the 'inspect' class while keeping 'list' for standard subsetting
   class(res) <- c("inspect", "list")
@@ -52,6 +80,14 @@ fmt_bytes <- function(b) {
 }
 
 
+# Minimum, median and maximum of the non-NA values in x
+min_med_max <- function(x) {
+  x <- sort(x[!is.na(x)])
+  n <- length(x)
+  if (n == 0) return(c(NA, NA, NA))
+  c(x[1], (x[ceiling(n / 2)] + x[floor(n / 2) + 1]) / 2, x[n])
+}
+
 
 #' Print method for HDF5 inspect objects
 #'
@@ -169,5 +205,29 @@ print.inspect <- function(x, ...) {
     cat(paste(filter_names, collapse = " -> "), "\n")
   }
   
+  # --- Chunk Statistics (chunks = TRUE) ---
+  if (!is.null(x$chunks)) {
+    
+    chk <- x$chunks
+    n   <- nrow(chk)
+    
+    unalloc <- if (x$n_chunks > 0) sprintf(" (%.1f%% unallocated)", 100 * (1 - n / x$n_chunks)) else ""
+    cat(sprintf("  %-10s %s of %s chunks%s\n", "Allocated:",
+                format(n, big.mark = ","), format(x$n_chunks, big.mark = ","), unalloc))
+    
+    if (n > 0) {
+      q <- min_med_max(chk$size)
+      cat(sprintf("  %-10s %s / %s / %s (min / median / max)\n", "Sizes:",
+                  fmt_bytes(q[1]), fmt_bytes(q[2]), fmt_bytes(q[3])))
+      
+      q <- min_med_max(chk$ratio)
+      cat(sprintf("  %-10s %.2fx / %.2fx / %.2fx\n", "Ratios:", q[1], q[2], q[3]))
+      
+      span <- max(chk$address + chk$size) - min(chk$address)
+      if (sum(chk$size) > 0)
+        cat(sprintf("  %-10s %.2fx\n", "Spread:", span / sum(chk$size)))
+    }
+  }
+  
   invisible(x)
 }
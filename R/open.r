@@ -41,9 +41,10 @@
 #'   For example, `h5$write(data, "dset")` is equivalent to
 #'   `h5_write(data, file, "dset")`.
 #'
-#'   The available methods are: `attr_names`, `cd`, `class`, `close`, 
-#'   `create_group`, `delete`, `dim`, `exists`, `is_dataset`, `is_group`, 
-#'   `length`, `ls`, `move`, `names`, `pwd`, `read`, `str`, `typeof`, `write`.
+#'   The available methods are: `append`, `apply`, `attr_names`, `cd`, `class`, `close`, 
+#'   `create_group`, `delete`, `dim`, `exists`, `flush`, `inspect`,
+#'   `is_dataset`, `is_group`, `length`, `ls`, `move`, `names`, `pwd`, `read`,
+#'   `repack`, `serialize`, `str`, `typeof`, `write`.
 #' }
 #'
 #' \subsection{Navigation (`$cd()`, `$pwd()`)}{
@@ -64,17 +65,47 @@
 #' }
 #'
 #' \subsection{Closing the Handle (`$close()`)}{
-#' The `h5lite` package does not keep files persistently open. Each operation
-#' opens, modifies, and closes the file. Therefore, the `h5$close()` method
-#' does not perform any action on the HDF5 file itself.
+#' The handle keeps the HDF5 file open for as long as it exists. Every method
+#' call - and every plain `h5_*()` call on the same file path - reuses that
+#' open file instead of re-opening it, so the superblock, metadata cache and
+#' chunk cache stay warm between operations. The sizes of these caches can be
+#' tuned with the `cache` argument; see [h5_cache()].
 #'
-#' Its purpose is to invalidate the handle, preventing any further operations
-#' from being called. After `h5$close()` is called, any subsequent method
-#' call (e.g., `h5$ls()`) will throw an error.
+#' `h5$close()` releases the file and invalidates the handle. After it is
+#' called, any subsequent method call (e.g., `h5$ls()`) will throw an error.
+#' A handle that is never closed is released when it is garbage collected or
+#' when R exits.
+#'
+#' Changes made through an open handle are buffered by HDF5. Call
+#' `h5$flush()` to push them to disk without closing the handle, for instance
+#' before another process reads the file.
 #' }
 #'
+#' @section In-Memory Files:
+#' With `file = NULL`, the handle holds an HDF5 file in memory instead of on
+#' disk. It behaves like any other file - methods and plain `h5_*()` calls
+#' given the handle's name (`as.character(h5)`) work on it - but nothing is
+#' written to disk, and its contents are lost when the handle is closed.
+#'
+#' `h5$serialize()`, or [h5_serialize()], returns the file's bytes as a raw
+#' vector, which can be saved, sent over a connection, or stored in a
+#' database. Pass that vector as `raw` to open it again, in memory.
+#'
 #' @param file Path to the HDF5 file. The file will be created if it does not
-#'   exist.
+#'   exist. If `NULL`, an in-memory file is opened instead; see below.
+#' @param readonly If `TRUE`, open an existing file without write access.
+#'   Methods that modify the file will fail. Default is `FALSE`.
+#' @param cache Chunk cache, metadata cache and sieve buffer settings for the
+#'   file, created with [h5_cache()]. Default is `NULL`, which uses
+#'   `getOption("h5lite.cache")`, or HDF5's defaults with an automatically
+#'   sized chunk cache when that is unset.
+#' @param raw A raw vector holding a serialized HDF5 file, as returned by
+#'   [h5_serialize()], to open in memory. Requires `file = NULL`. Default is
+#'   `NULL`, which starts an empty in-memory file.
+#' @param format File format and file-space settings, created with
+#'   [h5_format()], for creating the file if it does not exist and for
+#'   opening it. Default is `NULL`, which uses `getOption("h5lite.format")`,
+#'   or HDF5's defaults when that is unset.
 #' @return An object of class `h5` with methods for interacting with the file.
 #' @export
 #' @examples
@@ -104,33 +135,77 @@
 #' # Close the handle
 #' h5$close()
 #' unlink(file)
-h5_open <- function (file) {
+#' 
+#' # An in-memory file, saved as a raw vector and reopened
+#' h5 <- h5_open()
+#' h5$write(mtcars, "mtcars")
+#' bytes <- h5$serialize()
+#' h5$close()
+#' 
+#' h5 <- h5_open(raw = bytes, readonly = TRUE)
+#' head(h5$read("mtcars"))
+#' h5$close()
+h5_open <- function (file = NULL, readonly = FALSE, cache = NULL, raw = NULL, format = NULL) {
   
-  h5_create_file(file)
+  assert_scalar_logical(readonly)
+  if (!is.null(cache))  cache  <- h5_cache(cache)
+  if (!is.null(format)) format <- h5_format(format)
   
-  env        <- new.env(parent = emptyenv())
-  env$.file  <- file
-  env$.wd    <- "/"
-  class(env) <- "h5"
+  if (is.null(file)) {
+    
+    if (!is.null(raw) && (!is.raw(raw) || length(raw) == 0))
+      stop("`raw` must be a non-empty raw vector.", call. = FALSE)
+    if (readonly && is.null(raw))
+      stop("An empty in-memory file cannot be opened read-only.", call. = FALSE)
+    
+    # A name no path on disk can collide with, by which h5_*() calls find it.
+    file  <- paste0("<memory:", basename(tempfile("")), ">")
+    path  <- file
+    image <- if (is.null(raw)) raw(0) else raw
+  }
+  else {
+    
+    if (!is.null(raw))
+      stop("`raw` can only be given with `file = NULL`.", call. = FALSE)
+    
+    if (readonly) { path <- validate_strings(file, must_exist = TRUE) }
+    else          { path <- validate_strings(file)                    }
+    image <- NULL
+  }
+  
+  env         <- new.env(parent = emptyenv())
+  env$.file   <- file
+  env$.wd     <- "/"
+  env$.ro     <- readonly
+  env$.handle <- .Call("C_h5_open", path, readonly, cache, format, image, PACKAGE = "h5lite")
+  class(env)  <- "h5"
   
-  env$read         = \(name = ".",       attr = NULL, as = "auto")                    { h5_run(env, h5_read)  }
-  env$write        = \(data, name = ".", attr = NULL, as = "auto", compress = "gzip") { h5_run(env, h5_write) }
-  env$ls           = \(name = ".", recursive = TRUE, full.names = FALSE)              { h5_run(env, h5_ls)    }
+  env$read         = \(name = ".",       attr = NULL, as = "auto", mmap = FALSE, lazy = FALSE)             { h5_run(env, h5_read)   }
+  env$write        = \(data, name = ".", attr = NULL, as = "auto", compress = "gzip", layout = "compound") { h5_run(env, h5_write,  modifies = TRUE) }
+  env$ls           = \(name = ".", recursive = TRUE, full.names = FALSE)                                   { h5_run(env, h5_ls)     }
+  env$append       = \(data, name, as = "auto", compress = "gzip")                                        { h5_run(env, h5_append, modifies = TRUE) }
   env$attr_names   = \(name = ".")                     { h5_run(env, h5_attr_names)   }
   env$class        = \(name, attr = NULL)              { h5_run(env, h5_class)        }
-  env$create_group = \(name)                           { h5_run(env, h5_create_group) }
-  env$delete       = \(name, attr = NULL, warn = TRUE) { h5_run(env, h5_delete)       }
+  env$create_group = \(name)                           { h5_run(env, h5_create_group, modifies = TRUE) }
+  env$delete       = \(name, attr = NULL, warn = TRUE) { h5_run(env, h5_delete,       modifies = TRUE) }
   env$dim          = \(name, attr = NULL)              { h5_run(env, h5_dim)          }
   env$exists       = \(name, attr = NULL)              { h5_run(env, h5_exists)       }
-  env$inspect      = \(name)                           { h5_run(env, h5_inspect)      }
+  env$inspect      = \(name, chunks = FALSE)          { h5_run(env, h5_inspect)      }
   env$is_dataset   = \(name)                           { h5_run(env, h5_is_dataset)   }
   env$is_group     = \(name)                           { h5_run(env, h5_is_group)     }
   env$length       = \(name = ".", attr = NULL)        { h5_run(env, h5_length)       }
-  env$move         = \(from, to)                       { h5_run(env, h5_move)         }
+  env$move         = \(from, to)                       { h5_run(env, h5_move,         modifies = TRUE) }
   env$names        = \(name = ".")                     { h5_run(env, h5_names)        }
+  env$repack       = \(name = ".", compress = "gzip")  { h5_run(env, h5_repack,       modifies = TRUE) }
   env$str          = \(name = ".", attrs = TRUE)       { h5_run(env, h5_str)          }
   env$typeof       = \(name, attr = NULL)              { h5_run(env, h5_typeof)       }
   
+  # Passes `...` through to FUN, which h5_run() cannot capture
+  env$apply = function (name, FUN, ..., block = NULL, as = "auto") {
+    check_open(env)
+    h5_apply(env$.file, normalize_path(env$.wd, name), FUN, ..., block = block, as = as)
+  }
+  
   # Navigation methods
   env$cd = function (group = "/") {
     check_open(env)
@@ -143,16 +218,69 @@ h5_open <- function (file) {
   }
   
   # Control methods
+  env$flush = function () {
+    check_open(env)
+    .Call("C_h5_flush", env$.handle, PACKAGE = "h5lite")
+    return(invisible(NULL))
+  }
+  env$serialize = function () {
+    check_open(env)
+    h5_serialize(env$.file)
+  }
   env$close = function () {
     check_open(env)
-    env$.file <- NULL
-    env$.wd   <- NULL
+    .Call("C_h5_close", env$.handle, PACKAGE = "h5lite")
+    env$.file   <- NULL
+    env$.wd     <- NULL
+    env$.handle <- NULL
     return(invisible(NULL))
   }
   
   return(env)
 }
 
+
+#' Serialize an HDF5 File to a Raw Vector
+#'
+#' Returns the complete contents of an HDF5 file - on disk or held in memory
+#' by [h5_open()] - as a raw vector.
+#'
+#' @details
+#' The bytes are a valid HDF5 file: [writeBin()] them to a `.h5` file, or
+#' pass them to `h5_open(raw = )` to open them again in memory, for instance
+#' after storing them in a database or receiving them over a connection.
+#'
+#' Changes made through an open handle are flushed first, so the result
+#' reflects everything written so far.
+#'
+#' @param file Path to the HDF5 file, or an `h5` handle from [h5_open()].
+#' @return A raw vector.
+#' @seealso [h5_open()]
+#' @export
+#' @examples
+#' h5 <- h5_open()
+#' h5$write(1:10, "x")
+#' bytes <- h5_serialize(h5)
+#' h5$close()
+#' length(bytes)
+#'
+#' # Write the bytes to disk as an ordinary HDF5 file
+#' file <- tempfile(fileext = ".h5")
+#' writeBin(bytes, file)
+#' h5_read(file, "x")
+#' unlink(file)
+h5_serialize <- function (file) {
+
+  if (inherits(file, "h5")) {
+    check_open(file)
+    file <- file$.file
+  }
+
+  file <- validate_strings(file, must_exist = TRUE)
+  .Call("C_h5_serialize", file, PACKAGE = "h5lite")
+}
+
+
 check_open <- function(env) {
   if (is.null(env$.file))
     stop("This h5 file handle has been closed.", call. = FALSE)
@@ -161,10 +289,14 @@ check_open <- function(env) {
 
 #' @noRd
 #' @keywords internal
-h5_run <- function(env, func) {
+h5_run <- function(env, func, modifies = FALSE) {
   
   check_open(env) # Ensure the handle is not closed
   
+  # Another handle may hold the same file open for writing
+  if (modifies && env$.ro)
+    stop("This h5 file handle is read-only.", call. = FALSE)
+  
   # Capture the arguments passed to the calling function (e.g., h5$read)
   args <- as.list(parent.frame())
   
@@ -215,11 +347,12 @@ print.h5 <- function(x, ...) {
   if (is.null(x$.file)) {
     cat("<h5 handle for a closed file>\n")
   } else {
-    size <- if (file.exists(x$.file)) file.size(x$.file) else NA
-    n_objects <- if (file.exists(x$.file)) length(h5_ls(x$.file, recursive = FALSE)) else NA
+    memory <- .Call("C_h5_is_memory", x$.file, PACKAGE = "h5lite")
+    size <- if (!memory && file.exists(x$.file)) file.size(x$.file) else NA
+    n_objects <- if (file_exists(x$.file)) length(h5_ls(x$.file, recursive = FALSE)) else NA
     
     cat("<h5 handle>\n")
-    cat("  File: ", x$.file, "\n")
+    cat("  File: ", x$.file, if (memory) "(in memory)", "\n")
     cat("  WD:   ", x$pwd(), "\n")
     if (!is.na(size)) {
       cat("  Size: ", format(structure(size, class = "object_size")), "\n")
@@ -29,8 +29,10 @@ h5_create_group <- function (file, name) {
 #' Explicitly creates a new, empty HDF5 file.
 #'
 #' @details
-#' This function is a simple wrapper around `h5_create_group(file, "/")`.
-#' Its main purpose is to allow for explicit file creation in code.
+#' Without `format`, this function is equivalent to
+#' `h5_create_group(file, "/")`. Its main purpose is to allow for explicit
+#' file creation in code, and to create files with non-default
+#' [h5_format()] settings.
 #'
 #' Note that calling this function is almost always **unnecessary**, as all
 #' `h5lite` writing functions (like [h5_write()] or
@@ -41,17 +43,21 @@ h5_create_group <- function (file, name) {
 #' a file before writing data to it.
 #'
 #' @param file Path to the HDF5 file to be created.
+#' @param format File format and file-space settings for the new file,
+#'   created with [h5_format()]. Default is `NULL`, which uses
+#'   `getOption("h5lite.format")`, or HDF5's defaults when that is unset.
 #'
 #' @section File Handling:
 #' - If `file` does not exist, it will be created as a new, empty HDF5 file.
 #' - If `file` already exists and is a valid HDF5 file, this function does
-#'   nothing and returns successfully.
+#'   nothing and returns successfully. The file keeps the format it was
+#'   created with.
 #' - If `file` exists but is **not** a valid HDF5 file (e.g., a text file),
 #'   an error will be thrown and the file will not be modified.
 #'
 #' @return Invisibly returns `NULL`. This function is called for its side
 #'   effects.
-#' @seealso [h5_create_group()], [h5_write()]
+#' @seealso [h5_create_group()], [h5_write()], [h5_format()]
 #' @export
 #' @examples
 #' file <- tempfile(fileext = ".h5")
@@ -64,9 +70,15 @@ h5_create_group <- function (file, name) {
 #' }
 #' 
 #' unlink(file)
-h5_create_file <- function (file) {
-  # Creating a file is equivalent to creating the root group '/'.
-  h5_create_group(file = file, name = "/")
+#' 
+#' # A file in the latest format that reuses freed space
+#' h5_create_file(file, format = h5_format("latest", persist = TRUE))
+#' unlink(file)
+h5_create_file <- function (file, format = NULL) {
+  file <- validate_strings(file)
+  if (!is.null(format)) format <- h5_format(format)
+  .Call("C_h5_create_file", file, format, PACKAGE = "h5lite")
+  invisible(NULL)
 }
 
 
@@ -92,7 +104,7 @@ h5_create_file <- function (file) {
 #' @return This function is called for its side-effect and returns `NULL`
 #'   invisibly.
 #'
-#' @seealso [h5_create_group()], [h5_delete()]
+#' @seealso [h5_copy()], [h5_create_group()], [h5_delete()]
 #' @export
 #' @examples
 #' file <- tempfile(fileext = ".h5")
@@ -125,6 +137,128 @@ h5_move <- function (file, from, to) {
 }
 
 
+
+#' Copy an HDF5 Object
+#'
+#' Copies an object (dataset, group, etc.) within an HDF5 file or into
+#' another one.
+#'
+#' @details
+#' This function wraps the HDF5 library's `H5Ocopy` function. The data is
+#' copied as it is stored - compressed chunks are not decompressed, and
+#' nothing is converted to or from R - so copying is much faster than reading
+#' and re-writing the object. Copying a group copies everything below it.
+#'
+#' The copy gets dimension scales (names, row names and dimnames) of its own,
+#' next to it, so it reads back exactly as the original does.
+#'
+#' The destination file is created if it does not exist, as are the
+#' destination's parent groups. The destination object must not already
+#' exist.
+#'
+#' @param from_file The path to the HDF5 file holding the object.
+#' @param from_name The path of the object to copy (e.g., `"/group/data"`).
+#' @param to_file The path to the HDF5 file to copy into. Defaults to
+#'   `from_file`.
+#' @param to_name The path of the copy. Defaults to `from_name`.
+#'
+#' @return This function is called for its side-effect and returns `NULL`
+#'   invisibly.
+#'
+#' @seealso [h5_move()], [h5_repack()]
+#' @export
+#' @examples
+#' file1 <- tempfile(fileext = ".h5")
+#' file2 <- tempfile(fileext = ".h5")
+#' h5_write(mtcars, file1, "group/mtcars")
+#'
+#' # Copy within the same file
+#' h5_copy(file1, "group/mtcars", to_name = "backup/mtcars")
+#' h5_str(file1)
+#'
+#' # Copy a whole group into another file
+#' h5_copy(file1, "group", file2)
+#' h5_str(file2)
+#'
+#' unlink(c(file1, file2))
+h5_copy <- function (from_file, from_name, to_file = from_file, to_name = from_name) {
+
+  from_file <- validate_strings(from_file, from_name, must_exist = TRUE)
+  to_file   <- validate_strings(to_file, to_name)
+  
+  if (normalizePath(from_file, mustWork = FALSE) == normalizePath(to_file, mustWork = FALSE))
+    to_file <- from_file
+  
+  if (file_exists(to_file) && h5_exists(to_file, to_name))
+    stop("Object '", to_name, "' already exists in file '", to_file, "'.", call. = FALSE)
+  
+  # Call the C function that wraps H5Ocopy.
+  .Call("C_h5_copy", from_file, from_name, to_file, to_name, PACKAGE = "h5lite")
+  invisible(NULL)
+}
+
+
+#' Rewrite a Dataset with New Compression Settings
+#'
+#' Rewrites a dataset - or every dataset in a group - with a new chunk layout
+#' and compression pipeline, without passing the data through R.
+#'
+#' @details
+#' The data is streamed from the old dataset to the new one in blocks of
+#' `getOption("h5lite.block_size")` bytes, aligned to whole chunks, so
+#' datasets larger than memory can be repacked. When the new settings give the
+#' same chunk dimensions and filters as the old ones, the compressed chunks are
+#' copied as they are, without being decompressed.
+#'
+#' Everything else about the dataset is kept: its type, attributes, names,
+#' row names and dimnames, and whether it can be appended to.
+#'
+#' Dimension scales and scalar datasets are left as they are. HDF5 reuses the
+#' space freed by the old dataset for later writes, but does not give it back,
+#' so the file itself does not shrink.
+#'
+#' @param file The path to the HDF5 file.
+#' @param name The path of the dataset or group to repack. Defaults to the
+#'   root group, i.e. the whole file.
+#' @param compress Compression settings for the new layout, as for
+#'   [h5_write()]: a compression string, number, or [h5_compression()] object.
+#'
+#' @return The paths of the datasets that were rewritten, invisibly.
+#'
+#' @seealso [h5_compression()], [h5_copy()], [h5_inspect()]
+#' @export
+#' @examples
+#' file <- tempfile(fileext = ".h5")
+#' h5_write(matrix(rnorm(1e4), 100), file, "mtx", compress = "none")
+#' h5_inspect(file, "mtx")
+#'
+#' h5_repack(file, "mtx", compress = "gzip-9")
+#' h5_inspect(file, "mtx")
+#'
+#' unlink(file)
+h5_repack <- function (file, name = "/", compress = "gzip") {
+
+  file     <- validate_strings(file, name, must_exist = TRUE)
+  compress <- h5_compression(compress)
+  
+  if (!is.null(attr(compress, "auto")))
+    stop('`compress = "auto"` is not supported by h5_repack().', call. = FALSE)
+  
+  if (h5_is_group(file, name)) {
+    names <- h5_ls(file, name, recursive = TRUE, full.names = TRUE)
+    names <- names[vapply(names, h5_is_dataset, logical(1), file = file)]
+  }
+  else {
+    names <- name
+  }
+  
+  done <- vapply(names, function (x) {
+    .Call("C_h5_repack", file, x, compress, PACKAGE = "h5lite")
+  }, logical(1), USE.NAMES = FALSE)
+  
+  invisible(names[done])
+}
+
 #' Delete an HDF5 Object or Attribute
 #'
 #' Deletes an object (dataset or group) or an attribute from an HDF5 file.
@@ -172,7 +306,7 @@ h5_delete <- function(file, name, attr = NULL, warn = TRUE) {
   assert_scalar_logical(warn)
   
   # Error if the file doesn't exist.
-  if (!file.exists(file)) stop("File '", file, "' does not exist.")
+  if (!file_exists(file)) stop("File '", file, "' does not exist.")
 
   # Warn but do not error if the target doesn't exist.
   if (h5_exists(file, name, attr)) {
@@ -0,0 +1,90 @@
+#' Profile HDF5 Reads and Writes
+#'
+#' Breaks down where the time of h5lite calls goes - opening files, decoding
+#' chunks, reordering arrays, creating strings - so that a slow [h5_read()] or
+#' [h5_write()] can be traced to the stage responsible.
+#'
+#' @param expr An expression to profile, typically one or more `h5_*()` calls.
+#'   If missing, the counters accumulated while
+#'   `options(h5lite.profile = TRUE)` is set are returned instead.
+#' @param reset Whether to clear the accumulated counters after returning
+#'   them. Has no effect on `expr`, which is always counted from zero.
+#'   Default: `FALSE`
+#'
+#' @details
+#' The stages are:
+#' * `open`: Opening or creating files. Files held open by an [h5_open()]
+#'   handle are only counted when the handle opens them.
+#' * `metadata`: Opening datasets: looking up their object headers and sizing
+#'   their chunk caches.
+#' * `read` / `write`: HDF5 moving data between the file and memory, which
+#'   includes decompression (or compression) and any type conversion done by
+#'   HDF5. `bytes` are counted in memory, after decompression.
+#' * `transpose`: Reordering arrays between HDF5's row-major and R's
+#'   column-major layout.
+#' * `coerce`: Converting numeric data to the R type requested by `as`, or
+#'   narrowing whole-number doubles to integers.
+#' * `strings`: Creating R strings from the data that HDF5 returned.
+#' * `dimscales`: Restoring `names` and `dimnames` from dimension scales.
+#'
+#' Times are measured on a monotonic clock and are inclusive: reading the
+#' dimension scales of a dataset, for instance, also counts towards `read`
+#' and `strings`. Time outside these stages - in R, or in HDF5 calls that
+#' move no data - is not counted, so the stages need not add up to the
+#' elapsed time of a call.
+#'
+#' Profiling costs nothing when it is off. With `options(h5lite.profile =
+#' TRUE)`, every call is counted until the option is unset, and `h5_profile()`
+#' returns the running totals.
+#'
+#' @return A data.frame with one row per stage and the columns `stage`,
+#'   `calls` (how many times the stage ran), `seconds`, `bytes` and
+#'   `elements`. When `expr` is given, its value is attached as the `"value"`
+#'   attribute.
+#'
+#' @seealso [h5_inspect()], [h5_cache()]
+#' @export
+#' @examples
+#' file <- tempfile(fileext = ".h5")
+#' h5_write(matrix(rnorm(1e5), ncol = 100), file, "mtx")
+#'
+#' # Counters for a single call
+#' p <- h5_profile(h5_read(file, "mtx"))
+#' p
+#' dim(attr(p, "value"))
+#'
+#' # Or running totals for everything in between
+#' old <- options(h5lite.profile = TRUE)
+#' x   <- h5_read(file, "mtx")
+#' x   <- h5_read(file, "mtx", start = 10, count = 5)
+#' options(old)
+#' h5_profile(reset = TRUE)
+#'
+#' unlink(file)
+h5_profile <- function(expr, reset = FALSE) {
+
+  assert_scalar_logical(reset)
+
+  if (missing(expr))
+    return(profile_frame(.Call("C_h5_profile_counters", reset, PACKAGE = "h5lite")))
+
+  # Profiling follows this option, which is read whenever a call opens its file.
+  old <- options(h5lite.profile = TRUE)
+  on.exit({ options(old); .Call("C_h5_profile_counters", FALSE, PACKAGE = "h5lite") })
+
+  before <- .Call("C_h5_profile_counters", FALSE, PACKAGE = "h5lite")
+  value  <- expr
+  after  <- .Call("C_h5_profile_counters", FALSE, PACKAGE = "h5lite")
+
+  for (i in c('calls', 'seconds', 'bytes', 'elements'))
+    after[[i]] <- after[[i]] - before[[i]]
+
+  res <- profile_frame(after)
+  attr(res, 'value') <- value
+  res
+}
+
+
+profile_frame <- function(counters) {
+  data.frame(counters, stringsAsFactors = FALSE)
+}
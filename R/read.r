@@ -10,7 +10,7 @@
 #'   * If `NULL` (default), the function reads the object specified by `name` (and attaches its attributes to the result).
 #'   * If provided (string), the function reads *only* the specified attribute from `name`.
 #' @param as The target R data type.
-#'   * **Global:** `"auto"` (default), `"integer"`, `"double"`, `"logical"`, `"bit64"`, `"null"`.
+#'   * **Global:** `"auto"` (default), `"integer"`, `"double"`, `"logical"`, `"bit64"`, `"factor"`, `"null"`.
 #'   * **Specific:** A named vector mapping names or type classes to R types (see Section "Type Conversion").
 #' @param start A numeric vector specifying the 1-based coordinate(s) for a partial read.
 #'   Most often, this is a **single value** targeting the most logical structural unit 
@@ -19,6 +19,21 @@
 #' @param count A single numeric value specifying the number of elements or units to read.
 #'   If `NULL` (default) and `start` is provided, `h5lite` reads exactly 1 unit and 
 #'   simplifies the resulting dimensions (see Section "Dimension Simplification").
+#' @param index A list with one element per dimension of the dataset, selecting
+#'   arbitrary (not necessarily contiguous) indices along each dimension. Each
+#'   element is a vector of 1-based indices, a logical vector, or `NULL` to keep
+#'   the whole dimension. A plain vector may be given for 1D datasets and data
+#'   frames. Cannot be combined with `start` and `count`. See Section
+#'   "Index Selections".
+#' @param cols A character vector of column names to read from a data.frame
+#'   (compound) dataset. If `NULL` (default), all columns are read. Only the
+#'   requested columns are converted and copied, in the order given. Can be
+#'   combined with `start`/`count` or `index` to read a block of a wide table.
+#' @param mmap If `TRUE`, map eligible datasets into memory instead of copying
+#'   them (see Section "Memory-Mapped Reads"). Default is `FALSE`.
+#' @param lazy If `TRUE`, return numeric datasets as vectors that are read from
+#'   the file only when their elements are used (see Section "Lazy Reads").
+#'   Default is `FALSE`.
 #'
 #' @section Partial Reading (Hyperslabs):
 #' You can read specific subsets of an n-dimensional dataset by utilizing the `start` 
@@ -60,6 +75,60 @@
 #'   `h5lite` assumes you are reading a range. The dataset's original structural geometry is 
 #'   **preserved**. (e.g., reading `start = 5, count = 1` on a matrix will return a 1xN matrix).
 #'
+#' @section Index Selections:
+#' The `index` argument reads scattered rows, columns, or elements in a single
+#' HDF5 read, rather than one `h5_read()` call per contiguous range. Unlike
+#' `start`, `index` refers to dimensions in their natural R order: for a
+#' matrix, `index = list(rows, cols)`.
+#' 
+#' The result is the same as subsetting the full dataset with `drop = FALSE`:
+#' `h5_read(file, name, index = list(i, NULL))` matches
+#' `h5_read(file, name)[i, , drop = FALSE]`, names and dimnames included, but
+#' only the selected elements are read from disk. Indices may be unsorted or
+#' repeated. Consecutive indices are merged into ranges, so selections made of
+#' a few long runs are as fast as a `start`/`count` read.
+#'
+#' @section Memory-Mapped Reads:
+#' With `mmap = TRUE`, a 1D `float64` dataset stored contiguously and without
+#' filters - for instance one written with `compress = "none"` - is not copied
+#' into R's memory. Instead, its bytes in the file are mapped read-only and
+#' returned as an ordinary-looking double vector. Pages are only read from disk
+#' when they are used, and several R processes reading the same file share a
+#' single copy through the operating system's page cache. `int32` datasets are
+#' mapped the same way when read with `as = "integer"`, unless they hold
+#' -2147483648, which R would take for `NA`.
+#' 
+#' Everything else - compressed, chunked or multi-dimensional datasets, other
+#' types, partial reads, in-memory files, and Windows - is read normally, so `mmap = TRUE` is
+#' always safe to request. Modifying a mapped vector in R transparently makes
+#' a private copy first. The mapping stays valid after the file is closed, but
+#' it is shared with the file: if the dataset is later rewritten in place, by
+#' h5lite or any other program, the vector's values change with it, and if the
+#' file is truncated, using the vector can crash R. Use `mmap = FALSE` for
+#' files that may change while the data is in use.
+#'
+#' @section Lazy Reads:
+#' With `lazy = TRUE`, numeric datasets are returned without reading their
+#' data. Their length, `dim`, names and dimnames come from the file's metadata,
+#' so reading a whole group of large arrays this way is almost instant. The
+#' values are read when they are used:
+#' 
+#' * Single elements and short runs of consecutive elements (e.g. `x[[i]]`,
+#'   `m[, j]`, or [sum()] and other functions that can stream through a
+#'   vector) are read through a small window of neighboring elements.
+#' * Subsets such as `x[idx]` read only the selected elements.
+#' * Everything else - most arithmetic, and any modification - reads the
+#'   whole dataset once, after which the vector behaves like any other.
+#' 
+#' Each read re-opens the file, so that it is not locked in the meantime; keep
+#' it open with [h5_open()] for many small reads. The file must not be changed
+#' while lazy vectors are in use.
+#' 
+#' Datasets whose R type depends on their values - integers of 32 bits or more
+#' read with `as = "auto"` - are read immediately, as are strings, factors,
+#' data.frames and partial reads. Give an explicit `as = "integer"` or
+#' `as = "double"` to read such integers lazily.
+#'
 #' @section Type Conversion (`as`):
 #' You can control how HDF5 data is converted to R types using the `as` argument.
 #'
@@ -92,7 +161,7 @@
 #' If you are reading a specific attribute directly (e.g., `h5_read(..., attr = "id")`), do **not** use
 #' the `@` prefix in the `as` argument.
 #' 
-#' Partial reading (`start`/`count`) is currently only supported for datasets, not attributes.
+#' Partial reading (`start`/`count` or `index`) is currently only supported for datasets, not attributes.
 #'
 #' @return An R object corresponding to the HDF5 object or attribute.
 #'   Returns `NULL` if the object is skipped via `as = "null"`.
@@ -146,25 +215,31 @@
 #' # 3D Array: Target matrix 2, row 1. (drops matrix and row dims, returns 1D vector of cols)
 #' h5_read(file, "array_data", start = c(2, 1))
 #' 
+#' # --- Partial Reading: Index Selections ---
+#' # Matrix: rows 2, 7, and 9, columns "c1" and "c5"
+#' h5_read(file, "matrix_data", index = list(c(2, 7, 9), c(1, 5)))
+#' 
+#' # Vector: any order, with repeats
+#' h5_read(file, "ints", index = c(5, 1, 1))
+#' 
+#' # --- Partial Reading: Data Frame Columns ---
+#' h5_write(mtcars, file, "mtcars")
+#' h5_read(file, "mtcars", cols = c("mpg", "wt"), start = 1, count = 5)
+#' 
 #' unlink(file)
-h5_read <- function(file, name = "/", attr = NULL, as = "auto", start = NULL, count = NULL) {
+h5_read <- function(
+    file, name = "/", attr = NULL, as = "auto", 
+    start = NULL, count = NULL, index = NULL, cols = NULL, mmap = FALSE, lazy = FALSE ) {
   
   file   <- validate_strings(file, name, attr, must_exist = TRUE)
   obj_as <- validate_as(as)
+  assert_scalar_logical(mmap, lazy)
   
+  validate_cols(file, name, attr, cols)
+  validate_index(file, name, attr, index, start)
   validate_start_count(file, name, attr, start, count)
   
-  # Validate choices
-  choices <- c("auto", "integer", "double", "logical", "bit64", "null")
-  if (!missing(choices))
-    for (i in seq_along(obj_as))
-      obj_as[i] <- tryCatch(
-        expr  = match.arg(tolower(obj_as[[i]]), choices),
-        error = function (e) { 
-          stop(
-            call. = FALSE,
-            "Invalid `as` argument: '", obj_as[[i]], "'\n", 
-            "Valid options are: '", paste(collapse = "', '", choices), "'.") })
+  obj_as <- match_read_as(obj_as)
   
   # Prepare the 'as' map for attributes
   # Example: obj_as  = c("@ready" = "logical", ".uint" = "integer", "@." = "null")
@@ -181,11 +256,32 @@ h5_read <- function(file, name = "/", attr = NULL, as = "auto", start = NULL, co
   }
   
   # --- Perform Read Operation ---
-  read_data(file, name, attr, obj_as, attr_as, start, count)
+  read_data(file, name, attr, obj_as, attr_as, start, count, index, cols, mmap, lazy)
 }
 
 
-read_data <- function (file, name, attr = NULL, obj_as, attr_as, start = NULL, count = NULL) {
+#' Validates the choices in a read `as` map
+#' @noRd
+#' @keywords internal
+match_read_as <- function (obj_as) {
+  
+  choices <- c("auto", "integer", "double", "logical", "bit64", "factor", "null")
+  for (i in seq_along(obj_as))
+    obj_as[i] <- tryCatch(
+      expr  = match.arg(tolower(obj_as[[i]]), choices),
+      error = function (e) { 
+        stop(
+          call. = FALSE,
+          "Invalid `as` argument: '", obj_as[[i]], "'\n", 
+          "Valid options are: '", paste(collapse = "', '", choices), "'.") })
+  
+  return (obj_as)
+}
+
+
+read_data <- function (
+    file, name, attr = NULL, obj_as, attr_as, 
+    start = NULL, count = NULL, index = NULL, cols = NULL, mmap = FALSE, lazy = FALSE ) {
   
   is_auto_count <- !is.null(start) && is.null(count)
   c_count       <- if (is_auto_count) 1 else count
@@ -195,16 +291,50 @@ read_data <- function (file, name, attr = NULL, obj_as, attr_as, start = NULL, c
     return(.Call("C_h5_read_attribute", file, name, attr, attr_as, PACKAGE = "h5lite"))
   }
   
-  # Case 2: Read Group (Recursive)
-  if (h5_is_group(file, name)) {
-    children <- sort(h5_ls(file, name, recursive = FALSE, full.names = TRUE))
-    res      <- lapply(children, read_data, file = file, obj_as = obj_as, attr_as = attr_as, start = start, count = count)
-    names(res) <- if (length(res) == 0) NULL else basename(children)
+  # HDF5 selections are sorted sets; reorder and repeat afterwards if needed
+  c_index <- if (is.null(index)) NULL else lapply(index, function (i) if (is.null(i)) NULL else sort(unique(i)))
+  
+  # Case 2: Read Columnar Data Frame
+  if (is_columnar(file, name)) {
+    res <- read_columns(file, name, obj_as, start, c_count, c_index, cols)
+    
+    if (!is.null(index) && !identical(index, c_index))
+      res <- remap_index(res, index, c_index)
+  }
+  
+  # Case 3: Read Group (Recursive)
+  else if (h5_is_group(file, name)) {
+    
+    # Whole members are read in C, in one pass with the file held open
+    if (is.null(start)) {
+      res <- .Call("C_h5_read_group", file, name, obj_as, attr_as, mmap, lazy, PACKAGE = "h5lite")
+    }
+    else {
+      children <- sort(h5_ls(file, name, recursive = FALSE, full.names = TRUE))
+      res      <- lapply(children, read_data, file = file, obj_as = obj_as, attr_as = attr_as, start = start, count = count, mmap = mmap, lazy = lazy)
+      names(res) <- if (length(res) == 0) NULL else basename(children)
+    }
   }
   
-  # Case 3: Read Dataset
+  # Case 4: Read Dataset
   else {
-    res <- .Call("C_h5_read_dataset", file, name, obj_as, basename(name), start, c_count, PACKAGE = "h5lite")
+    
+    # Whole datasets may be mapped or deferred instead; NULL when not eligible
+    res <- NULL
+    if (is.null(start) && is.null(index) && is.null(cols)) {
+      if (mmap)
+        res <- .Call("C_h5_read_mmap", file, name, obj_as, basename(name), PACKAGE = "h5lite")
+      if (lazy && is.null(res))
+        res <- .Call("C_h5_read_lazy", file, name, obj_as, basename(name), PACKAGE = "h5lite")
+    }
+    
+    if (is.null(res))
+      res <- .Call(
+        "C_h5_read_dataset", file, name, obj_as, basename(name), 
+        start, c_count, c_index, cols, PACKAGE = "h5lite" )
+    
+    if (!is.null(index) && !identical(index, c_index))
+      res <- remap_index(res, index, c_index)
     
     # Surgically drop fully specified dimensions
     if (!is.null(start) && !inherits(res, "data.frame")) {
@@ -267,11 +397,39 @@ read_data <- function (file, name, attr = NULL, obj_as, attr_as, start = NULL, c
   }
   
   # --- Attach Attributes ---
-  obj_attr_names <- h5_attr_names(file, name)
-  obj_attr_names <- setdiff(obj_attr_names, c("DIMENSION_LIST", "REFERENCE_LIST"))
-  for (attr in obj_attr_names)
-    if (!is.na(h5_class(file, name, attr)))
-      base::attr(res, attr) <- .Call("C_h5_read_attribute", file, name, attr, attr_as, PACKAGE = "h5lite")
+  # Read in one pass, without h5lite's own attributes or unreadable ones
+  obj_attrs <- .Call("C_h5_read_attributes", file, name, attr_as, PACKAGE = "h5lite")
+  for (attr in names(obj_attrs))
+    base::attr(res, attr) <- obj_attrs[[attr]]
   
   return(res)
 }
+
+
+#' Reorders and repeats the result of an index read
+#' @noRd
+#' @keywords internal
+#' @param res The object read with the sorted, distinct indices `c_index`.
+#' @param index The indices as requested.
+remap_index <- function (res, index, c_index) {
+  
+  pos <- mapply(
+    FUN      = function (i, ci) if (is.null(i)) NULL else match(i, ci),
+    i        = index, 
+    ci       = c_index, 
+    SIMPLIFY = FALSE )
+  
+  if (is.data.frame(res)) {
+    auto <- .row_names_info(res) < 0
+    res  <- res[pos[[1]], , drop = FALSE]
+    if (auto) rownames(res) <- NULL
+    return (res)
+  }
+  
+  if (is.null(dim(res))) return (res[pos[[1]]])
+  
+  for (i in seq_along(pos))
+    if (is.null(pos[[i]])) pos[[i]] <- seq_len(dim(res)[[i]])
+  
+  do.call(`[`, c(list(res), pos, drop = FALSE))
+}
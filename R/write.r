@@ -21,6 +21,9 @@
 #'   created by [h5_compression()] for advanced pipeline control (including scale-offset 
 #'   algorithms, Fletcher32 checksums, or Blosc2 pre-filters). See [h5_compression()] 
 #'   for the complete list of available codecs and options.
+#' @param layout How data.frames are stored. `"compound"` (default) writes each
+#'   data.frame as a single dataset of compound (row) records. `"columnar"`
+#'   writes a group with one dataset per column. See Section "Data Frame Layouts".
 #' 
 #' @section Writing Scalars:
 #' 
@@ -71,14 +74,26 @@
 #'     * `"utf8[]"` or `"ascii[]"` (length is set to the longest string)
 #'     * `"utf8[n]"` or `"ascii[n]"` (where `n` is the length in bytes)
 #' 
+#' * **Dictionary Encoded:** `"dict"` stores each distinct string once, and
+#'   the vector as unsigned integer codes into that dictionary. Best for long
+#'   vectors with few distinct values (labels, categories, sample IDs). Only
+#'   datasets and columns of `layout = "columnar"` data.frames can be
+#'   dictionary encoded; elsewhere `"dict"` falls back to `"utf8"`.
+#' 
 #' **NOTE:** Variable-length strings allow for `NA` values but cannot be 
 #' compressed on disk. Fixed-length strings allow for compression but do not 
-#' support `NA`.
+#' support `NA`. Dictionary-encoded strings allow both.
+#' 
+#' Factors can also be written with `as = "dict"`, which, unlike the default
+#' HDF5 enum type, allows `NA` values and any number of levels. Dictionary
+#' encoded datasets are read back as character vectors, or as factors with
+#' `h5_read(as = "factor")`.
 #' 
 #' #### Examples
 #' ```
 #' h5_write(letters[1:5],    file, "len10_strs", as = "utf8[10]")
 #' h5_write(c('X', 'Y', NA), file, "var_chars",  as = "ascii")
+#' h5_write(rep(c('ctrl', 'trt'), 1e4), file, "groups", as = "dict")
 #' ```
 #' 
 #' ### Lists, Data Frames, and Attributes
@@ -102,6 +117,25 @@
 #' h5_write(mtcars, file, 'my_df', as = c('hp' = "auto", 'wt' = "float32", '.' = "skip"))
 #' ```
 #' 
+#' @section Data Frame Layouts:
+#' 
+#' By default, a data.frame is written as a single compound dataset in which
+#' each row is one record. This is compact for narrow tables and is readable by
+#' any HDF5 tool as a table.
+#' 
+#' With `layout = "columnar"`, each column is written as its own chunked and
+#' separately compressed dataset inside a group named `name`. Columns of a
+#' single type compress much better than interleaved rows, and reading a few
+#' columns with `h5_read(cols = )` only touches those columns on disk. Row
+#' names are stored once, as a `_rownames` dimension scale shared by all
+#' columns. [h5_read()] reassembles the data.frame transparently, and
+#' [h5_class()] reports it as a `"data.frame"`.
+#' 
+#' When `compress` is not given, each column of a columnar data.frame gets a
+#' codec suited to its type: Bitshuffle + Zstd for integers, lossless ZFP for
+#' `float32`/`float64`, and Zstd for everything else. An explicit `compress`
+#' applies to every column.
+#' 
 #' @section Dimension Scales:
 #' `h5lite` automatically writes `names`, `row.names`, and `dimnames` as 
 #' HDF5 dimension scales. Named vectors will generate an `<name>_names` 
@@ -151,6 +185,9 @@
 #' )
 #' h5_write(df, file, "records/scores", as = c(grade = "ascii[1]"))
 #' 
+#' # Or one dataset per column, each compressed to suit its type
+#' h5_write(df, file, "records/columns", layout = "columnar")
+#' 
 #' # 6. Fixed-Length Strings
 #' h5_write(c("A", "B"), file, "fixed_str", as = "ascii[10]")
 #' 
@@ -159,9 +196,10 @@
 #' 
 #' # 8. Clean up
 #' unlink(file)
-h5_write <- function(data, file, name, attr = NULL, as = "auto", compress = "gzip") {
+h5_write <- function(data, file, name, attr = NULL, as = "auto", compress = "gzip", layout = "compound") {
   
-  file <- validate_strings(file, name, attr)
+  file   <- validate_strings(file, name, attr)
+  layout <- match.arg(layout, c("compound", "columnar"))
   
   if (!is.null(attr) && !h5_exists(file, name))
     stop("Cannot write attribute '", attr, "' to non-existent object '", name, "'.", call. = FALSE)
@@ -181,16 +219,19 @@ h5_write <- function(data, file, name, attr = NULL, as = "auto", compress = "gzi
     if (is.null(attr_as) || length(attr_as) == 0) attr_as <- "auto"
   }
 
+  by_type  <- missing(compress) && layout == "columnar"
   compress <- h5_compression(compress)
+  if (by_type) attr(compress, "by_type") <- TRUE
 
   # Write the data
   h5_create_group(file, name = "/")
   if (is_list_group(data)) {
-    write_group(data, file, name, obj_as, attr_as, compress, dry = TRUE)
-    write_group(data, file, name, obj_as, attr_as, compress, dry = FALSE)
+    batch <- new_batch()
+    write_group(data, file, name, obj_as, attr_as, compress, batch = batch, layout = layout)
+    run_batch(batch, file)
   } else {
-    write_data(data, file, name, attr, obj_as, attr_as, compress, dry = TRUE)
-    write_data(data, file, name, attr, obj_as, attr_as, compress, dry = FALSE)
+    write_data(data, file, name, attr, obj_as, attr_as, compress, dry = TRUE,  layout = layout)
+    write_data(data, file, name, attr, obj_as, attr_as, compress, dry = FALSE, layout = layout)
   }
   
   invisible(file)
@@ -201,29 +242,84 @@ h5_write <- function(data, file, name, attr = NULL, as = "auto", compress = "gzi
 #' Recursively write a list as a group
 #' @noRd
 #' @keywords internal
-write_group <- function(data, file, name, obj_as, attr_as, compress, dry = FALSE) {
+#' @param batch A batch from new_batch(). Nothing is written until the caller
+#'   runs it, so that the whole tree is validated first and then written in a
+#'   single file session.
+write_group <- function(data, file, name, obj_as, attr_as, compress, batch, layout = "compound") {
 
-  if (!dry) h5_delete(file, name, warn = FALSE)
-  if (!dry) h5_create_group(file, name)
+  write_call(batch, "group", file, name)
   
-  write_attributes(data, file, name, attr_as, dry = dry)
+  write_attributes(data, file, name, attr_as, batch = batch)
   
   # Recursively write children
   for (child_name in names(data)) {
     child_path <- paste(name, child_name, sep = "/")
     child_data <- data[[child_name]]
     if (is_list_group(child_data)) {
-      write_group(child_data, file, child_path, obj_as, attr_as, compress, dry = dry)
+      write_group(child_data, file, child_path, obj_as, attr_as, compress, batch = batch, layout = layout)
     } else {
-      write_data(child_data, file, child_path, attr = NULL, obj_as, attr_as, compress, dry = dry)
+      write_data(child_data, file, child_path, attr = NULL, obj_as, attr_as, compress, batch = batch, layout = layout)
+    }
+  }
+}
+
+
+#' Creates an empty queue of write operations
+#' @noRd
+#' @keywords internal
+new_batch <- function () {
+  batch     <- new.env(parent = emptyenv())
+  batch$ops <- vector("list", 64L)
+  batch$n   <- 0L
+  batch
+}
+
+
+#' Calls a C write routine now, or queues the call on a batch
+#' @noRd
+#' @keywords internal
+#' @param batch `NULL` to call `routine` right away, or a batch from new_batch().
+#' @param routine The C entry point, or `"group"` to replace `name` with an
+#'   empty group.
+write_call <- function (batch, routine, ...) {
+  
+  if (is.null(batch)) {
+    if (routine == "group") {
+      h5_delete(..1, ..2, warn = FALSE)
+      h5_create_group(..1, ..2)
+    }
+    else {
+      .Call(routine, ..., PACKAGE = "h5lite")
     }
+    return (invisible())
   }
+  
+  # Grow geometrically; appending one element at a time copies the queue
+  n <- batch$n + 1L
+  if (n > length(batch$ops)) length(batch$ops) <- 2L * n
+  batch$ops[[n]] <- list(routine, ...)
+  batch$n        <- n
+  
+  invisible()
+}
+
+
+#' Runs every queued operation against a single open file
+#' @noRd
+#' @keywords internal
+run_batch <- function (batch, file) {
+  .Call("C_h5_write_batch", file, batch$ops[seq_len(batch$n)], PACKAGE = "h5lite")
+  invisible()
 }
 
 #' Write a single dataset or attribute
 #' @noRd
 #' @keywords internal
-write_data <- function(data, file, name, attr, obj_as, attr_as, compress, dry = FALSE) {
+#' @param append If `TRUE`, rows are appended to `name` via h5_append().
+#' @param layout `"columnar"` writes data.frame datasets as groups of columns.
+write_data <- function(
+    data, file, name, attr, obj_as, attr_as, compress, 
+    dry = FALSE, append = FALSE, layout = "compound", batch = NULL ) {
   
   # Convert POSIXt vectors/columns to ISO 8601 character strings.
   if (inherits(data, "POSIXt")) {
@@ -236,7 +332,8 @@ write_data <- function(data, file, name, attr, obj_as, attr_as, compress, dry =
   }
 
   map_key <- if (is.null(attr)) basename(name) else attr
-  h5_type <- resolve_h5_type(data, map_key, obj_as)
+  h5_type <- if (append) resolve_append_type(data, file, name, map_key, obj_as)
+             else        resolve_h5_type(data, map_key, obj_as)
   
   if (all(h5_type == "skip")) return (NULL)
   
@@ -245,6 +342,29 @@ write_data <- function(data, file, name, attr, obj_as, attr_as, compress, dry =
     h5_type <- h5_type[h5_type != "skip"]
   }
   
+  # Dictionary encoding needs a dataset of its own for the codes
+  if (any(h5_type == "dict")) {
+    
+    if (append)
+      stop('`as = "dict"` is not supported by h5_append().', call. = FALSE)
+    
+    for (i in which(h5_type == "dict")) {
+      col <- if (is.data.frame(data)) data[[i]] else data
+      
+      if (is.null(attr) && (layout == "columnar" || !is.data.frame(data))) {
+        if (!dry) col <- dict_encode(col)
+      }
+      else {
+        # Attributes and compound members fall back to an enum or "utf8"
+        if (is.factor(col) && anyNA(col))
+          stop("Factors with NA values cannot be written to HDF5 Enum types. Convert to character vector first.", call. = FALSE)
+        h5_type[[i]] <- if (is.factor(col)) "factor" else "utf8"
+      }
+      
+      if (is.data.frame(data)) data[[i]] <- col else data <- col
+    }
+  }
+  
   for (i in which(startsWith(h5_type, "ascii"))) {
     
     # Converts from:      ÀÁÂÃÄÅÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖÙÚÛÜÝàáâãäåçèéêëìíîïðñòóôõöùúûüýÿ
@@ -262,36 +382,87 @@ write_data <- function(data, file, name, attr, obj_as, attr_as, compress, dry =
   }
   
   dims <- validate_dims(data)
+  
+  # Settle compress = "auto" on the data of each new dataset
+  if (!dry && is.null(attr) && !(layout == "columnar" && is.data.frame(data)))
+    if (!(append && file_exists(file) && h5_exists(file, name)))
+      compress <- auto_compression(data, h5_type, dims, compress)
 
-  if (is.null(attr)) {
+  if (append) {
     if (!dry)
-      .Call("C_h5_write_dataset", file, name, data, h5_type, dims, compress, PACKAGE = "h5lite")
+      .Call("C_h5_append_dataset", file, name, data, h5_type, dims, compress, PACKAGE = "h5lite")
+  }
+  else if (is.null(attr) && layout == "columnar" && is.data.frame(data)) {
+    write_columns(data, file, name, h5_type, compress, dry = dry, batch = batch)
+    write_attributes(data, file, name, attr_as, dry = dry, batch = batch)
+  }
+  else if (is.null(attr)) {
+    if (!dry) {
+      # Past HDF5's default of 8 compact attributes, index them from the start
+      if (length(stored_attr_names(data)) > 8L) attr(compress, "dense_attrs") <- TRUE
+      write_call(batch, "C_h5_write_dataset", file, name, data, h5_type, dims, compress)
+    }
     
-    write_attributes(data, file, name, attr_as, dry = dry)
+    write_attributes(data, file, name, attr_as, dry = dry, batch = batch)
   }
   else {
     
     if (!dry)
-      .Call("C_h5_write_attribute", file, name, attr, data, h5_type, dims, PACKAGE = "h5lite")
+      write_call(batch, "C_h5_write_attribute", file, name, attr, data, h5_type, dims)
   }
 }
 
 #' Write R attributes to HDF5
 #' @noRd
 #' @keywords internal
-write_attributes <- function(data, file, name, attr_as, dry = FALSE) {
+#' @details Each attribute is resolved by write_data() as usual, but the
+#'   resulting C_h5_write_attribute() calls are collected and made as a single
+#'   C_h5_write_attributes() call, which opens the object once for all of them.
+write_attributes <- function(data, file, name, attr_as, dry = FALSE, batch = NULL) {
 
-  attr_names <- names(attributes(data))
-  attr_names <- setdiff(attr_names, c("class", "dim", "dimnames", "names", "row.names", "levels"))
+  attr_names <- stored_attr_names(data)
+  if (length(attr_names) == 0) return (invisible())
 
+  queue <- new_batch()
   for (attr in attr_names) {
     attr_data <- base::attr(data, attr, exact = TRUE)
     if (is_list_group(attr_data)) next
-    write_data(attr_data, file, name, attr, attr_as, attr_as, list("none", NULL, NULL), dry = dry)
+    write_data(attr_data, file, name, attr, attr_as, attr_as, list("none", NULL, NULL), dry = dry, batch = queue)
   }
+  
+  # Each queued op is list(routine, file, name, attr, data, h5_type, dims)
+  if (!dry && queue$n > 0) {
+    attrs <- lapply(queue$ops[seq_len(queue$n)], `[`, 4:7)
+    write_call(batch, "C_h5_write_attributes", file, name, attrs)
+  }
+}
+
+
+#' Names of the R attributes that write_attributes() stores in HDF5
+#' @noRd
+#' @keywords internal
+stored_attr_names <- function(data) {
+  setdiff(names(attributes(data)), c("class", "dim", "dimnames", "names", "row.names", "levels"))
 }
 
 
+#' Dictionary-encodes a character vector or factor for `as = "dict"`
+#' @noRd
+#' @keywords internal
+#' @return A factor of `x`'s distinct values, keeping its other attributes
+#'   (names, dim, dimnames, ...). The C writer stores the codes, with `NA` as
+#'   0, and the levels in the `dict_attr` attribute.
+dict_encode <- function (x) {
+  res <- if (is.factor(x)) x else factor(x)
+  att <- attributes(x)
+  att <- att[setdiff(names(att), c("class", "levels"))]
+  attributes(res) <- c(att, list(levels = levels(res), class = "factor"))
+  res
+}
+
+dict_attr <- "h5lite_dict"
+
+
 # --- Type Resolution Logic ---
 
 #' Resolves the HDF5 type based on the 'as' map and data properties
@@ -326,6 +497,8 @@ resolve_h5_type <- function(data, name, as_map) {
       stop("Non-factors with factor class cannot be written to HDF5.", call. = FALSE) # nocov
     if (!is.character(levels(data)))
       stop("Factors with non-character levels cannot be written to HDF5.", call. = FALSE) # nocov
+    if (identical(lookup_as(data, name, as_map), "dict"))
+      return ("dict")
     if (anyNA(data))
       stop("Factors with NA values cannot be written to HDF5 Enum types. Convert to character vector first.", call. = FALSE)
     if (typeof(data) != "integer")
@@ -335,25 +508,7 @@ resolve_h5_type <- function(data, name, as_map) {
   }
   
   
-  if (is.null(names(as_map))) {
-    h5_type <- tolower(as_map)
-    
-  } else {
-  
-    # Generate type keys for lookup (e.g., .integer, .double)
-    mode <- paste0(".", storage.mode(data))
-    if (is.numeric(data)) { keys <- c(name, mode, ".numeric", ".") }
-    else                  { keys <- c(name, mode,             ".") }
-    
-    h5_type <- "auto"
-    for (key in keys) {
-      if (key %in% names(as_map)) {
-        h5_type <- tolower(as_map[[key]])
-        break
-      }
-    }
-    
-  }
+  h5_type <- lookup_as(data, name, as_map)
   
   
   if (is.character(data)) {
@@ -363,10 +518,11 @@ resolve_h5_type <- function(data, name, as_map) {
     
     h5_type <- tolower(h5_type)
     cset    <- tryCatch(
-      expr  = match.arg(sub('\\[.+$', '', h5_type), c("auto", "ascii", "skip", "utf8")), 
+      expr  = match.arg(sub('\\[.+$', '', h5_type), c("auto", "ascii", "dict", "skip", "utf8")), 
       error = function (e) { stop(arg_errmsg, call. = FALSE) })
     
     if (cset == "skip") return ("skip")
+    if (cset == "dict") return ("dict")
 
     # Auto-select: Always use UTF-8.
     # Choose fixed length when strings are short and consistent.
@@ -474,6 +630,26 @@ resolve_h5_type <- function(data, name, as_map) {
 }
 
 
+#' Finds the requested type for `data` in the 'as' map
+#' @noRd
+#' @keywords internal
+lookup_as <- function(data, name, as_map) {
+  
+  if (is.null(names(as_map))) return (tolower(as_map))
+  
+  # Generate type keys for lookup (e.g., .integer, .double)
+  mode <- paste0(".", storage.mode(data))
+  if (is.numeric(data)) { keys <- c(name, mode, ".numeric", ".") }
+  else                  { keys <- c(name, mode,             ".") }
+  
+  for (key in keys)
+    if (key %in% names(as_map))
+      return (tolower(as_map[[key]]))
+  
+  return ("auto")
+}
+
+
 #' @noRd
 #' @keywords internal
 validate_dims <- function (data) {
@@ -0,0 +1,121 @@
+# ==========================================
+# Benchmark case matrix for scripts/bench/run.r
+# ==========================================
+#
+# Each family crosses only the factors that matter to its code path, so the
+# matrix stays small enough to run before every release:
+#
+#   numeric    - dtype x rank x size x codec x read pattern
+#                (h5_transpose, block reads, compression filters)
+#   strings    - cardinality x size x codec
+#                (read_character, variable-length string writes)
+#   data.frame - width x size x codec x read pattern
+#                (write_dataframe, compound packing, cols = )
+#
+# Sizes are the in-memory size of the R object. "quick" is meant for a
+# laptop; "full" for a dedicated machine.
+
+bench_sizes <- list(
+  quick = c(small = 1, large = 32),
+  full  = c(small = 1, large = 256) )
+
+bench_codecs <- c("none", "gzip", "zstd", "lz4", "bshuf-lz4", "blosc2-zstd")
+
+
+# Builds the data for one case. `mb` is the target size in MiB.
+bench_numeric <- function(dtype, rank, mb) {
+  el   <- if (dtype == "double") 8 else 4
+  n    <- max(1, floor(mb * 2^20 / el))
+  vals <- switch(
+    dtype,
+    double  = round(cumsum(rnorm(n)), 3),
+    integer = as.integer(cumsum(sample(-3:3, n, replace = TRUE))),
+    logical = sample(c(TRUE, FALSE, NA), n, replace = TRUE, prob = c(.6, .38, .02)) )
+  if (rank == 1) return(vals)
+  cols <- if (rank == 2) 64 else 16
+  if (rank == 2) return(matrix(vals[seq_len(n %/% cols * cols)], ncol = cols))
+  slab <- cols * cols
+  array(vals[seq_len(n %/% slab * slab)], c(cols, cols, n %/% slab))
+}
+
+bench_strings <- function(cardinality, mb) {
+  # ~16 bytes per string in the file, more in R's CHARSXP cache
+  n    <- max(1, floor(mb * 2^20 / 16))
+  pool <- if (cardinality == "low") sprintf("level_%02d", 1:10) else NULL
+  if (is.null(pool)) sprintf("id_%012d", sample.int(.Machine$integer.max, n, replace = TRUE))
+  else               sample(pool, n, replace = TRUE)
+}
+
+bench_dataframe <- function(width, mb) {
+  n_rows <- max(1, floor(mb * 2^20 / (width * 8)))
+  cols   <- lapply(seq_len(width), function (i) {
+    switch(
+      i %% 4 + 1,
+      round(rnorm(n_rows), 2),
+      sample.int(1000L, n_rows, replace = TRUE),
+      factor(sample(c("a", "b", "c"), n_rows, replace = TRUE)),
+      sample(c(TRUE, FALSE), n_rows, replace = TRUE) )
+  })
+  names(cols) <- sprintf("col_%03d", seq_len(width))
+  as.data.frame(cols)
+}
+
+
+# Returns arguments for h5_read() that exercise one partial-read pattern.
+# `n` is the number of units h5_read(start = ) steps through: elements of a
+# vector, rows of a matrix or data.frame, slabs of a 3D array. Scattered
+# reads pick 1% of those units, along the same dimension.
+bench_read_args <- function(pattern, n, data) {
+  switch(
+    pattern,
+    full    = list(),
+    block   = list(start = max(1, n %/% 3), count = max(1, n %/% 10)),
+    scatter = {
+      rank <- max(1, length(dim(data)))
+      idx  <- rep(list(NULL), rank)
+      idx[[if (rank >= 3) rank else 1]] <- sort(sample.int(n, max(1, n %/% 100)))
+      list(index = idx)
+    },
+    cols    = list(cols = names(data)[seq(1, length(data), by = 4)]) )
+}
+
+
+# Expands the matrix into a data.frame with one row per case.
+bench_cases <- function(profile = "quick") {
+
+  sizes <- bench_sizes[[profile]]
+
+  numeric <- expand.grid(
+    family  = "numeric",
+    dtype   = c("double", "integer", "logical"),
+    rank    = 1:3,
+    size    = names(sizes),
+    codec   = bench_codecs,
+    pattern = c("full", "block", "scatter"),
+    stringsAsFactors = FALSE )
+
+  strings <- expand.grid(
+    family      = "strings",
+    cardinality = c("low", "high"),
+    size        = names(sizes),
+    codec       = c("none", "gzip", "zstd"),
+    pattern     = c("full", "block"),
+    stringsAsFactors = FALSE )
+
+  dataframe <- expand.grid(
+    family  = "data.frame",
+    width   = c(4L, 64L),
+    size    = names(sizes),
+    codec   = c("none", "gzip", "zstd"),
+    pattern = c("full", "block", "cols"),
+    stringsAsFactors = FALSE )
+
+  all <- c("family", "dtype", "rank", "cardinality", "width", "size", "codec", "pattern")
+  pad <- function (x) { x[setdiff(all, names(x))] <- NA; x[all] }
+
+  cases    <- rbind(pad(numeric), pad(strings), pad(dataframe))
+  cases$mb <- unname(sizes[cases$size])
+  cases$id <- apply(cases[all], 1, function (x) paste(x[!is.na(x)], collapse = "/"))
+  cases$id <- gsub(" ", "", cases$id)
+  cases
+}
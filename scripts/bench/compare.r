@@ -0,0 +1,49 @@
+# ==========================================
+# Compare two benchmark result files
+# ==========================================
+#
+# Usage:
+#
+#   Rscript scripts/bench/compare.r <baseline.csv> <candidate.csv> [--threshold 0.1]
+#
+# Matches results from scripts/bench/run.r by case and operation and prints
+# the change in throughput and peak memory. Cases whose throughput dropped,
+# or whose R heap peak grew, by more than the threshold (default 10%) are
+# listed as regressions, and the script exits with status 1 if there are any.
+
+args <- commandArgs(trailingOnly = TRUE)
+if (length(args) < 2) stop("Usage: compare.r <baseline.csv> <candidate.csv> [--threshold 0.1]")
+
+i         <- match("--threshold", args)
+threshold <- if (is.na(i)) 0.1 else as.numeric(args[[i + 1]])
+
+keep <- c("id", "op", "mb_per_s", "r_peak_mb", "rss_peak_mb", "h5lite")
+base <- read.csv(args[[1]], stringsAsFactors = FALSE)[keep]
+cand <- read.csv(args[[2]], stringsAsFactors = FALSE)[keep]
+both <- merge(base, cand, by = c("id", "op"), suffixes = c(".base", ".cand"))
+if (!nrow(both)) stop("The two files have no cases in common.")
+
+both$speed  <- both$mb_per_s.cand  / both$mb_per_s.base
+both$memory <- both$r_peak_mb.cand / pmax(both$r_peak_mb.base, 1e-3)
+
+cat(sprintf(
+  "h5lite %s -> %s: %d cases in common\n\n",
+  base$h5lite[[1]], cand$h5lite[[1]], nrow(both) ))
+
+both <- both[order(both$speed), ]
+cat(sprintf(
+  "%-56s %-12s %10s %10s %7s %8s\n",
+  "Case", "Operation", "Base MB/s", "New MB/s", "Speed", "Memory" ))
+for (j in seq_len(nrow(both)))
+  with(both[j, ], cat(sprintf(
+    "%-56s %-12s %10.1f %10.1f %6.2fx %7.2fx\n",
+    id, op, mb_per_s.base, mb_per_s.cand, speed, memory )))
+
+slow <- both$speed  < 1 - threshold
+big  <- both$memory > 1 + threshold & both$r_peak_mb.cand - both$r_peak_mb.base > 1
+n    <- sum(slow | big)
+
+cat(sprintf(
+  "\n%d regression(s) beyond %.0f%%: %d slower, %d using more memory.\n",
+  n, 100 * threshold, sum(slow), sum(big) ))
+if (n > 0) quit(status = 1)
@@ -0,0 +1,163 @@
+# ==========================================
+# h5lite read/write benchmarks
+# ==========================================
+#
+# Usage (from the repository root, against the installed h5lite):
+#
+#   Rscript scripts/bench/run.r [--profile quick|full] [--reps 3]
+#                               [--filter <regex>] [--out bench.csv]
+#
+# Runs the case matrix in scripts/bench/cases.r and writes one CSV row per
+# case and operation, with throughput (MB/s of the R object), the size on
+# disk, and memory use:
+#
+#   r_peak_mb   - Peak R heap during the operation (gc() "max used")
+#   rss_peak_mb - Peak resident set size of the process (Linux only), which
+#                 also counts HDF5's own buffers
+#   alloc_mb    - Total bytes allocated by R during one run (Rprofmem);
+#   n_alloc       NA when R was built without memory profiling
+#
+# Timings are the median of --reps runs. Compare two result files with
+# scripts/bench/compare.r.
+
+library(h5lite)
+
+args <- commandArgs(trailingOnly = TRUE)
+opt  <- function (flag, default) {
+  i <- match(flag, args)
+  if (is.na(i) || i == length(args)) default else args[[i + 1]]
+}
+
+profile <- opt("--profile", "quick")
+reps    <- as.integer(opt("--reps", "3"))
+pattern <- opt("--filter", "")
+out     <- opt("--out", sprintf("bench-%s-%s.csv", packageVersion("h5lite"), format(Sys.time(), "%Y%m%d-%H%M%S")))
+
+here <- sub("^--file=", "", grep("^--file=", commandArgs(), value = TRUE))
+here <- if (length(here)) dirname(here[[1]]) else file.path("scripts", "bench")
+source(file.path(here, "cases.r"))
+
+set.seed(1)
+cases <- bench_cases(profile)
+if (nzchar(pattern)) cases <- cases[grepl(pattern, cases$id), , drop = FALSE]
+if (!nrow(cases)) stop("No benchmark cases match --filter '", pattern, "'.")
+
+
+# ==========================================
+# MEASUREMENT
+# ==========================================
+
+rss_peak_mb <- function () {
+  status <- tryCatch(readLines("/proc/self/status"), error = function (e) character(0))
+  hwm    <- grep("^VmHWM:", status, value = TRUE)
+  if (!length(hwm)) return(NA_real_)
+  as.numeric(gsub("[^0-9]", "", hwm)) / 1024
+}
+
+# Linux lets a process reset its VmHWM by writing "5" to clear_refs.
+rss_reset <- function () {
+  invisible(tryCatch(writeLines("5", "/proc/self/clear_refs"), error = function (e) NULL, warning = function (w) NULL))
+}
+
+allocations <- function (fn) {
+  if (!capabilities("profmem")) return(c(alloc_mb = NA_real_, n_alloc = NA_real_))
+  log <- tempfile(fileext = ".txt")
+  on.exit(unlink(log))
+  Rprofmem(log, threshold = 0)
+  fn()
+  Rprofmem(NULL)
+  lines <- readLines(log)
+  bytes <- suppressWarnings(as.numeric(sub(" *:.*$", "", lines)))
+  bytes <- bytes[!is.na(bytes)]
+  c(alloc_mb = sum(bytes) / 2^20, n_alloc = length(bytes))
+}
+
+# Runs `fn` `reps` times. Returns the median elapsed time and the peak memory
+# over all runs, plus the allocations of one extra, untimed run.
+measure <- function (fn) {
+  secs <- r_peak <- rss <- numeric(reps)
+  for (i in seq_len(reps)) {
+    gc(); rss_reset(); base <- sum(gc(reset = TRUE)[, 2])
+    secs[i]   <- system.time(fn(), gcFirst = FALSE)[["elapsed"]]
+    r_peak[i] <- sum(gc()[, 6]) - base
+    rss[i]    <- rss_peak_mb()
+  }
+  c(seconds = median(secs), r_peak_mb = max(r_peak), rss_peak_mb = max(rss), allocations(fn))
+}
+
+
+# ==========================================
+# CASES
+# ==========================================
+
+make_data <- function (case) {
+  switch(
+    case$family,
+    numeric      = bench_numeric(case$dtype, case$rank, case$mb),
+    strings      = bench_strings(case$cardinality, case$mb),
+    "data.frame" = bench_dataframe(case$width, case$mb) )
+}
+
+# Units that h5_read(start = ) steps through.
+read_units <- function (data) {
+  if (is.data.frame(data))       nrow(data)
+  else if (is.null(dim(data)))   length(data)
+  else if (length(dim(data)) >= 3) dim(data)[[length(dim(data))]]
+  else                           nrow(data)
+}
+
+# Cases differing only in their read pattern share one written dataset.
+cases$group <- sub("/[^/]+$", "", cases$id)
+results     <- list()
+file        <- tempfile(fileext = ".h5")
+
+for (group in unique(cases$group)) {
+
+  batch <- cases[cases$group == group, , drop = FALSE]
+  case  <- batch[1, ]
+  data  <- make_data(case)
+  mb    <- as.numeric(object.size(data)) / 2^20
+
+  row <- function (op, id, m, stored, mb) {
+    data.frame(
+      case[setdiff(names(case), c("id", "group", "pattern"))],
+      id = id, op = op, object_mb = mb, as.list(m),
+      mb_per_s = mb / max(m[["seconds"]], 1e-6),
+      stored_mb = stored, row.names = NULL )
+  }
+
+  cat(sprintf("%-52s", group))
+
+  w <- tryCatch(
+    measure(function () { unlink(file); h5_write(data, file, "x", compress = case$codec) }),
+    error = function (e) { cat(" skipped:", conditionMessage(e), "\n"); NULL })
+  if (is.null(w)) next
+
+  stored <- h5_inspect(file, "x")$storage_size / 2^20
+  results[[length(results) + 1]] <- row("write", group, w, stored, mb)
+  cat(sprintf(" write %8.1f MB/s", results[[length(results)]]$mb_per_s))
+
+  # Partial reads are rated by the size of what they return.
+  for (i in seq_len(nrow(batch))) {
+    rargs <- bench_read_args(batch$pattern[[i]], read_units(data), data)
+    read  <- function () do.call(h5_read, c(list(file, "x"), rargs))
+    r_mb  <- as.numeric(object.size(read())) / 2^20
+    r     <- measure(read)
+    results[[length(results) + 1]] <- row(paste0("read:", batch$pattern[[i]]), batch$id[[i]], r, stored, r_mb)
+    cat(sprintf(" | %s %8.1f MB/s", batch$pattern[[i]], results[[length(results)]]$mb_per_s))
+  }
+  cat("\n")
+}
+
+unlink(file)
+results <- do.call(rbind, results)
+
+results$h5lite  <- as.character(packageVersion("h5lite"))
+results$r       <- paste(R.version$major, R.version$minor, sep = ".")
+results$os      <- R.version$os
+results$cpu     <- Sys.info()[["machine"]]
+results$date    <- format(Sys.time(), "%Y-%m-%dT%H:%M:%S")
+results$reps    <- reps
+
+write.csv(results, out, row.names = FALSE)
+cat("\nWrote", nrow(results), "results to", out, "\n")
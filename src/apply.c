@@ -0,0 +1,169 @@
+#include "h5lite.h"
+
+/*
+ * Block cursor behind h5_apply().
+ *
+ * The cursor keeps one dataset open for the whole iteration so that each
+ * block is a single hyperslab read, with no file or object re-opening in
+ * between. Blocks run along the same dimension that a single-value `start`
+ * targets in h5_read(): elements of a vector, rows of a matrix or
+ * data.frame, and the last dimension of higher-order arrays.
+ */
+typedef struct {
+  hid_t   file_id;
+  hid_t   dset_id;
+  hsize_t extent;   /* Length of the iterated dimension */
+  hsize_t block;    /* Units per block */
+} h5_cursor_t;
+
+
+static void cursor_finalizer(SEXP ptr) {
+  h5_cursor_t *cur = (h5_cursor_t *)R_ExternalPtrAddr(ptr);
+  if (cur == NULL) return;
+  H5Dclose(cur->dset_id);
+  H5Fclose(cur->file_id);
+  free(cur);
+  R_ClearExternalPtr(ptr);
+}
+
+static h5_cursor_t *get_cursor(SEXP ptr) {
+  h5_cursor_t *cur = (h5_cursor_t *)R_ExternalPtrAddr(ptr);
+  if (cur == NULL) error("This dataset cursor has been closed.");
+  return cur;
+}
+
+
+/*
+ * Picks a default block size: as many units as fit in h5_block_bytes(),
+ * rounded down to whole chunks along the iterated dimension so that no chunk
+ * is decompressed by more than one block (unless the "h5lite_access" hint
+ * says the chunks run the other way).
+ */
+static hsize_t default_block(hid_t dset_id, int ndims, hsize_t *dims, int axis) {
+
+  hid_t  type_id   = H5Dget_type(dset_id);
+  size_t unit_size = H5Tget_size(type_id);
+  H5Tclose(type_id);
+
+  for (int i = 0; i < ndims; i++)
+    if (i != axis) unit_size *= (size_t)dims[i];
+  if (unit_size == 0) unit_size = 1;
+
+  hsize_t block      = (hsize_t)(h5_block_bytes() / unit_size);
+  hsize_t chunk_rows = 1;
+
+  /* Chunks written with access = "column" span every row: aligning row
+   * blocks to them would put the whole dataset in one block. */
+  int align = !(axis == 0 && h5_access_hint(dset_id) == H5LITE_ACCESS_COLUMN);
+
+  hid_t dcpl_id = align ? H5Dget_create_plist(dset_id) : -1;
+  if (dcpl_id >= 0) {
+    if (H5Pget_layout(dcpl_id) == H5D_CHUNKED) {
+      hsize_t *chunk_dims = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+      if (H5Pget_chunk(dcpl_id, ndims, chunk_dims) == ndims) chunk_rows = chunk_dims[axis];
+    }
+    H5Pclose(dcpl_id);
+  }
+
+  if (chunk_rows > 1) block = (block / chunk_rows) * chunk_rows;
+  if (block < chunk_rows)  block = chunk_rows;
+  if (block > dims[axis])  block = dims[axis];
+  if (block < 1)           block = 1;
+
+  return block;
+}
+
+
+/*
+ * Opens a dataset for block-wise reading.
+ * Returns list(ptr = <externalptr>, n = <units>, block = <units per block>).
+ * A NULL `block` selects a chunk-aligned default.
+ */
+SEXP C_h5_cursor_open(SEXP filename, SEXP dataset_name, SEXP block) {
+
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename,     0));
+  const char *dname = Rf_translateCharUTF8(STRING_ELT(dataset_name, 0));
+
+  hid_t shared_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (shared_id < 0) error("Failed to open file: %s", fname);
+
+  /* The id may be an h5_open() handle's, which can be closed while the
+   * cursor is still in use. A private one keeps the file open until then. */
+  hid_t file_id = H5Freopen(shared_id);
+  h5_file_close(shared_id);
+  if (file_id < 0) error("Failed to open file: %s", fname); // # nocov
+
+  hid_t dset_id = h5_dataset_open(file_id, dname, -1);
+  if (dset_id < 0) { H5Fclose(file_id); error("Failed to open dataset: %s", dname); }
+
+  hid_t space_id = H5Dget_space(dset_id);
+  int   ndims    = H5Sget_simple_extent_ndims(space_id);
+
+  hsize_t extent = 1, units = 1;
+
+  if (H5Sget_simple_extent_type(space_id) == H5S_NULL) {
+    extent = 0;
+  }
+  else if (ndims > 0) {
+    hsize_t *dims = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+    H5Sget_simple_extent_dims(space_id, dims, NULL);
+
+    int axis = (ndims >= 3) ? ndims - 1 : 0;
+    extent   = dims[axis];
+    units    = (block == R_NilValue) ? default_block(dset_id, ndims, dims, axis) : (hsize_t)asReal(block);
+  }
+  H5Sclose(space_id);
+
+  if (units < 1) units = 1;
+
+  h5_cursor_t *cur = (h5_cursor_t *)malloc(sizeof(h5_cursor_t));
+  if (cur == NULL) { H5Dclose(dset_id); H5Fclose(file_id); error("Memory allocation failed"); } // # nocov
+
+  cur->file_id = file_id;
+  cur->dset_id = dset_id;
+  cur->extent  = extent;
+  cur->block   = units;
+
+  SEXP ptr = PROTECT(R_MakeExternalPtr(cur, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, cursor_finalizer, TRUE);
+
+  SEXP result = PROTECT(allocVector(VECSXP, 3));
+  SEXP names  = PROTECT(allocVector(STRSXP, 3));
+  SET_VECTOR_ELT(result, 0, ptr);                           SET_STRING_ELT(names, 0, mkChar("ptr"));
+  SET_VECTOR_ELT(result, 1, ScalarReal((double)extent));    SET_STRING_ELT(names, 1, mkChar("n"));
+  SET_VECTOR_ELT(result, 2, ScalarReal((double)units));     SET_STRING_ELT(names, 2, mkChar("block"));
+  setAttrib(result, R_NamesSymbol, names);
+
+  UNPROTECT(3);
+  return result;
+}
+
+
+/*
+ * Reads `count` units starting at the 1-based unit `start` from an open
+ * cursor. Dimensions are always preserved, as with h5_read(count = ).
+ */
+SEXP C_h5_cursor_read(SEXP ptr, SEXP rmap, SEXP element_name, SEXP start, SEXP count) {
+
+  h5_cursor_t *cur     = get_cursor(ptr);
+  const char  *el_name = Rf_translateCharUTF8(STRING_ELT(element_name, 0));
+
+  double s = asReal(start), n = asReal(count);
+  if (s < 1 || n < 1 || (hsize_t)(s - 1 + n) > cur->extent)
+    error("Block [%.0f, %.0f] is out of bounds.", s, s - 1 + n);
+
+  SEXP result = PROTECT(read_dataset(cur->dset_id, rmap, el_name, start, count, R_NilValue, R_NilValue, 1));
+
+  if (TYPEOF(result) == CHARSXP)
+    error("Error reading dataset block\n%s", CHAR(result)); // # nocov
+
+  UNPROTECT(1);
+  return result;
+}
+
+
+/* Releases the cursor's dataset. Safe to call more than once. */
+SEXP C_h5_cursor_close(SEXP ptr) {
+  cursor_finalizer(ptr);
+  return R_NilValue;
+}
@@ -0,0 +1,222 @@
+#include "h5lite.h"
+
+/*
+ * Cache and buffer tuning for files and datasets.
+ *
+ * Settings come from an h5_cache() object: the one given to h5_open() for
+ * files held open by a handle, and getOption("h5lite.cache") otherwise. The
+ * metadata cache, sieve buffer and any fixed chunk cache size go on the file
+ * access property list, which datasets inherit. An "auto" chunk cache is
+ * sized per dataset by h5_dataset_open(), from the dataset's chunk layout.
+ */
+
+
+/* Largest metadata cache HDF5 accepts (H5C__MAX_MAX_CACHE_SIZE). */
+#define H5LITE_MDC_MAX ((size_t)128 * 1024 * 1024)
+#define H5LITE_MDC_MIN ((size_t)1024)
+
+
+static double cache_field(SEXP x, const char *name) {
+  SEXP names = getAttrib(x, R_NamesSymbol);
+  if (names == R_NilValue) return NA_REAL;
+  for (R_xlen_t i = 0; i < XLENGTH(x); i++) {
+    if (strcmp(CHAR(STRING_ELT(names, i)), name) != 0) continue;
+    SEXP val = VECTOR_ELT(x, i);
+    if ((isReal(val) || isInteger(val)) && XLENGTH(val) == 1) return asReal(val);
+    return NA_REAL;
+  }
+  return NA_REAL;
+}
+
+
+/*
+ * Fills `out` from an h5_cache() object. Anything else - including NULL -
+ * leaves every field NA, meaning HDF5's default (or "auto" for chunk_bytes).
+ */
+void h5_cache_parse(SEXP x, h5_cache_t *out) {
+
+  out->chunk_bytes = out->chunk_slots = out->preempt = NA_REAL;
+  out->meta_bytes  = out->sieve_bytes = NA_REAL;
+
+  if (TYPEOF(x) != VECSXP) return;
+
+  out->chunk_bytes = cache_field(x, "chunk_bytes");
+  out->chunk_slots = cache_field(x, "chunk_slots");
+  out->preempt     = cache_field(x, "preempt");
+  out->meta_bytes  = cache_field(x, "meta_bytes");
+  out->sieve_bytes = cache_field(x, "sieve_bytes");
+}
+
+
+/* Settings that apply to loc_id's file: its h5_open() handle's, else the option. */
+static void cache_settings(hid_t loc_id, h5_cache_t *out) {
+  if (loc_id >= 0 && h5_handle_cache(loc_id, out)) return;
+  h5_cache_parse(GetOption1(install("h5lite.cache")), out);
+}
+
+
+/*
+ * Builds a file access property list from `cfg`, or from the h5lite.cache
+ * option when `cfg` is NULL. Returns H5P_DEFAULT when nothing differs from
+ * HDF5's defaults; otherwise the caller closes the returned list.
+ */
+hid_t h5_fapl(const h5_cache_t *cfg) {
+
+  h5_cache_t opt;
+  if (cfg == NULL) { cache_settings(-1, &opt); cfg = &opt; }
+
+  int chunk = !ISNAN(cfg->chunk_bytes) || !ISNAN(cfg->chunk_slots) || !ISNAN(cfg->preempt);
+  if (!chunk && ISNAN(cfg->meta_bytes) && ISNAN(cfg->sieve_bytes)) return H5P_DEFAULT;
+
+  hid_t fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+  if (fapl_id < 0) return H5P_DEFAULT; // # nocov
+
+  if (chunk) {
+    int    mdc_nelmts;
+    size_t nslots, nbytes;
+    double w0;
+    H5Pget_cache(fapl_id, &mdc_nelmts, &nslots, &nbytes, &w0);
+    if (!ISNAN(cfg->chunk_bytes)) nbytes = (size_t)cfg->chunk_bytes;
+    if (!ISNAN(cfg->chunk_slots)) nslots = (size_t)cfg->chunk_slots;
+    if (!ISNAN(cfg->preempt))     w0     = cfg->preempt;
+    H5Pset_cache(fapl_id, mdc_nelmts, nslots, nbytes, w0);
+  }
+
+  if (!ISNAN(cfg->meta_bytes)) {
+    size_t size = (size_t)cfg->meta_bytes;
+    if (size < H5LITE_MDC_MIN) size = H5LITE_MDC_MIN;
+    if (size > H5LITE_MDC_MAX) size = H5LITE_MDC_MAX;
+
+    H5AC_cache_config_t mdc;
+    mdc.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+    if (H5Pget_mdc_config(fapl_id, &mdc) >= 0) {
+      mdc.set_initial_size = 1;
+      mdc.initial_size     = size;
+      if (mdc.max_size < size) mdc.max_size = size;
+      if (mdc.min_size > size) mdc.min_size = size;
+      H5Pset_mdc_config(fapl_id, &mdc);
+    }
+  }
+
+  if (!ISNAN(cfg->sieve_bytes))
+    H5Pset_sieve_buf_size(fapl_id, (size_t)cfg->sieve_bytes);
+
+  return fapl_id;
+}
+
+
+/* Smallest prime >= n, for the chunk cache's hash table. */
+static size_t next_prime(size_t n) {
+  if (n <= 2) return 2;
+  if (n % 2 == 0) n++;
+  for (;; n += 2) {
+    int prime = 1;
+    for (size_t d = 3; d * d <= n; d += 2)
+      if (n % d == 0) { prime = 0; break; }
+    if (prime) return n;
+  }
+}
+
+
+/*
+ * Bytes needed to cache one chunk along every dimension but `axis`: the
+ * chunks that a block of rows (or of h5_apply() units) cuts through. Capped
+ * at h5_block_bytes() in whole chunks, but never below one chunk. Returns 0
+ * for datasets that are not chunked.
+ */
+static size_t auto_cache_bytes(hid_t dset_id, int axis, size_t *chunk_bytes) {
+
+  size_t result   = 0;
+  hid_t  dcpl_id  = H5Dget_create_plist(dset_id);
+  hid_t  space_id = H5Dget_space(dset_id);
+  hid_t  type_id  = H5Dget_type(dset_id);
+  int    ndims    = H5Sget_simple_extent_ndims(space_id);
+
+  if (dcpl_id >= 0 && ndims > 0 && H5Pget_layout(dcpl_id) == H5D_CHUNKED) {
+
+    hsize_t *dims  = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+    hsize_t *chunk = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+    H5Sget_simple_extent_dims(space_id, dims, NULL);
+
+    if (H5Pget_chunk(dcpl_id, ndims, chunk) == ndims) {
+
+      if (axis < 0 || axis >= ndims) axis = (ndims >= 3) ? ndims - 1 : 0;
+
+      double one = (double)H5Tget_size(type_id), n = 1;
+      for (int i = 0; i < ndims; i++) {
+        one *= (double)chunk[i];
+        if (i != axis && chunk[i] > 0) n *= (double)((dims[i] + chunk[i] - 1) / chunk[i]);
+      }
+
+      double cap  = (double)h5_block_bytes();
+      double want = one * n;
+      if (want > cap) want = one * floor(cap / one);
+      if (want < one) want = one;
+
+      *chunk_bytes = (size_t)one;
+      result       = (size_t)want;
+    }
+  }
+
+  H5Tclose(type_id); H5Sclose(space_id);
+  if (dcpl_id >= 0) H5Pclose(dcpl_id);
+  return result;
+}
+
+
+/*
+ * Drop-in replacement for H5Dopen2(loc_id, name, H5P_DEFAULT) for datasets
+ * whose chunks are read block by block along dimension `axis`. A negative
+ * `axis` is the dimension h5_apply() iterates: the last one of 3D+ arrays.
+ *
+ * With an "auto" chunk cache, a chunked dataset whose chunks would not fit in
+ * the inherited (by default 1 MiB) cache is reopened with one that does,
+ * sized by auto_cache_bytes(). Fixed sizes are inherited from the file as is.
+ */
+static hid_t dataset_open(hid_t loc_id, const char *name, int axis) {
+
+  hid_t dset_id = H5Dopen2(loc_id, name, H5P_DEFAULT);
+  if (dset_id < 0) return dset_id;
+
+  h5_cache_t cfg;
+  cache_settings(loc_id, &cfg);
+  if (!ISNAN(cfg.chunk_bytes)) return dset_id;
+
+  size_t chunk_bytes = 0;
+  size_t want        = auto_cache_bytes(dset_id, axis, &chunk_bytes);
+  if (want == 0) return dset_id;
+
+  size_t nslots, nbytes;
+  double w0;
+  hid_t  dapl_id = H5Dget_access_plist(dset_id);
+  H5Pget_chunk_cache(dapl_id, &nslots, &nbytes, &w0);
+
+  if (want <= nbytes) { H5Pclose(dapl_id); return dset_id; }
+
+  if (ISNAN(cfg.chunk_slots)) {
+    size_t n_chunks = want / (chunk_bytes > 0 ? chunk_bytes : 1);
+    nslots = next_prime(n_chunks > 10000 ? 1000000 : 100 * n_chunks);
+    if (nslots < 521) nslots = 521;
+  }
+  else {
+    nslots = (size_t)cfg.chunk_slots;
+  }
+  if (!ISNAN(cfg.preempt)) w0 = cfg.preempt;
+
+  /* HDF5 only applies a cache size when the dataset is not already open. */
+  H5Pset_chunk_cache(dapl_id, nslots, want, w0);
+  H5Dclose(dset_id);
+  dset_id = H5Dopen2(loc_id, name, dapl_id);
+  H5Pclose(dapl_id);
+
+  if (dset_id < 0) dset_id = H5Dopen2(loc_id, name, H5P_DEFAULT); // # nocov
+  return dset_id;
+}
+
+/* Timed as the "metadata" stage of h5_profile(). */
+hid_t h5_dataset_open(hid_t loc_id, const char *name, int axis) {
+  H5LITE_PROF_BEGIN(t0);
+  hid_t dset_id = dataset_open(loc_id, name, axis);
+  H5LITE_PROF_END(H5LITE_PROF_META, t0, 0, 0);
+  return dset_id;
+}
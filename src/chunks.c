@@ -0,0 +1,536 @@
+#include "h5lite.h"
+#include <zlib.h>
+
+/*
+ * Parallel chunk (de)compression for dataset reads and writes.
+ *
+ * H5Dread() and H5Dwrite() run the filter pipeline one chunk at a time on
+ * the calling thread, so compressed I/O is bound to a single core. With more
+ * than one thread, chunked datasets whose pipeline h5lite can run itself
+ * (shuffle and deflate, as set up by apply_compression() for "gzip") are
+ * instead moved as raw chunks with H5Dread_chunk() / H5Dwrite_chunk(), and
+ * the chunks are inflated or deflated by a pool of OpenMP threads. The bytes
+ * on disk are the same as those HDF5's own filters produce.
+ *
+ * HDF5 is not thread-safe: every HDF5 call (chunk lookups, raw reads and
+ * writes, type conversion) stays on the main thread, and the workers only
+ * touch plain memory. Selections, layouts, or filters the engine does not
+ * handle return H5LITE_CHUNKS_FALLBACK, and the caller uses H5Dread() or
+ * H5Dwrite() as usual.
+ */
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MAX_FILTERS 2 /* [shuffle,] deflate */
+
+typedef enum { STAGE_SHUFFLE, STAGE_DEFLATE } stage_t;
+
+typedef struct {
+  int      n_stages;
+  stage_t  stages[MAX_FILTERS];   /* In write order; decoded in reverse */
+  int      levels[MAX_FILTERS];   /* Deflate level of each deflate stage */
+  size_t   type_size;             /* Bytes per element on disk */
+  hsize_t  chunk_elems;
+  hsize_t  chunk_dims[H5S_MAX_RANK];
+} pipeline_t;
+
+typedef struct {
+  hsize_t   offset[H5S_MAX_RANK]; /* File coordinates of the chunk's corner */
+  hsize_t   raw_size;
+  uint32_t  filter_mask;          /* Bit i set: stage i was skipped on write */
+  unsigned char *raw;
+  unsigned char *data;            /* Decoded chunk (converted in place on read) */
+  int       status;
+} chunk_job_t;
+
+
+/*
+ * Fills `pipe` from the dataset's creation properties. Returns 0 if
+ * unsupported: only deflate, optionally preceded by shuffle - the pipeline
+ * apply_compression() builds for "gzip" - is run here, as the buffers are
+ * sized for exactly that order.
+ */
+static int plan_pipeline(hid_t dset_id, hid_t file_type_id, int ndims, pipeline_t *pipe) {
+
+  int ok = 0;
+  hid_t dcpl_id = H5Dget_create_plist(dset_id);
+  if (dcpl_id < 0) return 0; // # nocov
+
+  int n_filters = H5Pget_nfilters(dcpl_id);
+
+  if (H5Pget_layout(dcpl_id) == H5D_CHUNKED && n_filters > 0 && n_filters <= MAX_FILTERS &&
+      H5Pget_chunk(dcpl_id, ndims, pipe->chunk_dims) == ndims) {
+
+    ok = 1;
+    pipe->n_stages  = n_filters;
+    pipe->type_size = H5Tget_size(file_type_id);
+
+    for (int i = 0; i < n_filters && ok; i++) {
+      unsigned int flags, cd_values[8];
+      size_t       n_cd = 8;
+      H5Z_filter_t id   = H5Pget_filter2(dcpl_id, (unsigned)i, &flags, &n_cd, cd_values, 0, NULL, NULL);
+
+      pipe->levels[i] = (n_cd > 0) ? (int)cd_values[0] : Z_DEFAULT_COMPRESSION;
+
+      if      (id == H5Z_FILTER_SHUFFLE) pipe->stages[i] = STAGE_SHUFFLE;
+      else if (id == H5Z_FILTER_DEFLATE) pipe->stages[i] = STAGE_DEFLATE;
+      else                               ok = 0;
+    }
+
+    int last = n_filters - 1;
+    if (ok && (pipe->stages[last] != STAGE_DEFLATE || (last == 1 && pipe->stages[0] != STAGE_SHUFFLE)))
+      ok = 0;
+
+    pipe->chunk_elems = 1;
+    for (int i = 0; i < ndims; i++) pipe->chunk_elems *= pipe->chunk_dims[i];
+  }
+
+  H5Pclose(dcpl_id);
+  return ok && pipe->chunk_elems > 0;
+}
+
+
+/* Reverses H5Z_FILTER_SHUFFLE: byte planes back to interleaved elements. */
+static void unshuffle(const unsigned char *src, unsigned char *dst, size_t n_bytes, size_t type_size) {
+
+  size_t n_elems = n_bytes / type_size;
+
+  for (size_t b = 0; b < type_size; b++) {
+    const unsigned char *plane = src + b * n_elems;
+    for (size_t e = 0; e < n_elems; e++) dst[e * type_size + b] = plane[e];
+  }
+
+  /* Trailing bytes that did not fill an element are stored unshuffled. */
+  size_t tail = n_elems * type_size;
+  if (tail < n_bytes) memcpy(dst + tail, src + tail, n_bytes - tail);
+}
+
+
+/* Applies H5Z_FILTER_SHUFFLE: gathers byte b of every element into plane b. */
+static void shuffle(const unsigned char *src, unsigned char *dst, size_t n_bytes, size_t type_size) {
+
+  size_t n_elems = n_bytes / type_size;
+
+  for (size_t b = 0; b < type_size; b++) {
+    unsigned char *plane = dst + b * n_elems;
+    for (size_t e = 0; e < n_elems; e++) plane[e] = src[e * type_size + b];
+  }
+
+  size_t tail = n_elems * type_size;
+  if (tail < n_bytes) memcpy(dst + tail, src + tail, n_bytes - tail);
+}
+
+
+/*
+ * Decodes job->raw into job->data (chunk_bytes long). Runs on worker
+ * threads: no HDF5 or R API calls. `scratch` is at least chunk_bytes long.
+ */
+static int decode_chunk(const pipeline_t *pipe, chunk_job_t *job, size_t chunk_bytes, unsigned char *scratch) {
+
+  unsigned char *cur      = job->raw;
+  size_t         cur_size = (size_t)job->raw_size;
+  unsigned char *bufs[2]  = { job->data, scratch };
+  int            next     = 0;
+
+  for (int i = pipe->n_stages - 1; i >= 0; i--) {
+
+    if (job->filter_mask & (1u << i)) continue;
+
+    unsigned char *out = bufs[next];
+
+    if (pipe->stages[i] == STAGE_DEFLATE) {
+      uLongf out_size = (uLongf)chunk_bytes;
+      if (uncompress(out, &out_size, cur, (uLong)cur_size) != Z_OK) return -1;
+      cur_size = (size_t)out_size;
+    }
+    else if (pipe->type_size > 1) {
+      unshuffle(cur, out, cur_size, pipe->type_size);
+    }
+    else {
+      memcpy(out, cur, cur_size);
+    }
+
+    cur  = out;
+    next = 1 - next;
+  }
+
+  if (cur_size != chunk_bytes) return -1;
+  if (cur != job->data) memcpy(job->data, cur, chunk_bytes);
+  return 0;
+}
+
+
+/*
+ * Copies the part of a decoded chunk that falls inside the selection
+ * [origin, origin + dims) into dest, in R's column-major order.
+ */
+static void scatter_chunk(const unsigned char *chunk, const hsize_t *chunk_offset, const hsize_t *chunk_dims,
+                          unsigned char *dest, int ndims, const hsize_t *origin, const hsize_t *dims,
+                          size_t el_size) {
+
+  hsize_t lo[H5S_MAX_RANK], hi[H5S_MAX_RANK], c_stride[H5S_MAX_RANK], r_stride[H5S_MAX_RANK];
+
+  for (int k = 0; k < ndims; k++) {
+    hsize_t c_end = chunk_offset[k] + chunk_dims[k], s_end = origin[k] + dims[k];
+    lo[k] = (chunk_offset[k] > origin[k]) ? chunk_offset[k] : origin[k];
+    hi[k] = (c_end < s_end) ? c_end : s_end;
+    if (hi[k] <= lo[k]) return;
+  }
+
+  c_stride[ndims - 1] = 1;
+  for (int k = ndims - 2; k >= 0; k--) c_stride[k] = c_stride[k + 1] * chunk_dims[k + 1];
+  r_stride[0] = 1;
+  for (int k = 1; k < ndims; k++) r_stride[k] = r_stride[k - 1] * dims[k - 1];
+
+  int     last  = ndims - 1;
+  hsize_t run   = hi[last] - lo[last];
+  hsize_t r_inc = r_stride[last];
+  hsize_t pos[H5S_MAX_RANK];
+  for (int k = 0; k < ndims; k++) pos[k] = lo[k];
+
+  for (;;) {
+    hsize_t src = 0, dst = 0;
+    for (int k = 0; k < ndims; k++) {
+      src += (pos[k] - chunk_offset[k]) * c_stride[k];
+      dst += (pos[k] - origin[k])       * r_stride[k];
+    }
+
+    /* The last dimension is contiguous in the chunk, and strided in R. */
+    if (ndims == 1 || r_inc == 1) {
+      memcpy(dest + dst * el_size, chunk + src * el_size, run * el_size);
+    } else {
+      for (hsize_t j = 0; j < run; j++)
+        memcpy(dest + (dst + j * r_inc) * el_size, chunk + (src + j) * el_size, el_size);
+    }
+
+    /* Advance the odometer over all but the last dimension. */
+    int k = last - 1;
+    while (k >= 0 && ++pos[k] == hi[k]) { pos[k] = lo[k]; k--; }
+    if (k < 0) break;
+  }
+}
+
+
+/*
+ * Reads the selection of an open dataset into dest (column-major, converted
+ * to mem_type_id) with parallel chunk decompression. `dims` is the shape of
+ * the selection. Returns 0 on success, a negative value on a read error, or
+ * H5LITE_CHUNKS_FALLBACK when the dataset or selection is not eligible.
+ */
+herr_t h5_read_chunks(hid_t dset_id, hid_t mem_type_id, size_t el_size, void *dest,
+                      int ndims, hsize_t *dims, hid_t file_space_id) {
+
+  int n_threads = h5_threads();
+  if (n_threads < 2 || ndims < 1 || ndims > H5S_MAX_RANK) return H5LITE_CHUNKS_FALLBACK;
+
+  hsize_t total = 1;
+  for (int k = 0; k < ndims; k++) total *= dims[k];
+  if (total == 0) return H5LITE_CHUNKS_FALLBACK;
+
+  /* Only single-block selections. */
+  hsize_t origin[H5S_MAX_RANK], hi[H5S_MAX_RANK];
+  if (file_space_id == H5S_ALL) {
+    for (int k = 0; k < ndims; k++) origin[k] = 0;
+  } else {
+    if (H5Sget_select_type(file_space_id) != H5S_SEL_HYPERSLABS &&
+        H5Sget_select_type(file_space_id) != H5S_SEL_ALL) return H5LITE_CHUNKS_FALLBACK;
+    if (H5Sget_select_bounds(file_space_id, origin, hi) < 0) return H5LITE_CHUNKS_FALLBACK;
+    if ((hsize_t)H5Sget_select_npoints(file_space_id) != total) return H5LITE_CHUNKS_FALLBACK;
+    for (int k = 0; k < ndims; k++)
+      if (hi[k] - origin[k] + 1 != dims[k]) return H5LITE_CHUNKS_FALLBACK;
+  }
+
+  hid_t file_type_id = H5Dget_type(dset_id);
+  pipeline_t pipe;
+  if (!plan_pipeline(dset_id, file_type_id, ndims, &pipe)) {
+    H5Tclose(file_type_id);
+    return H5LITE_CHUNKS_FALLBACK;
+  }
+
+  /* The chunk grid covering the selection. */
+  hsize_t first[H5S_MAX_RANK], n_grid[H5S_MAX_RANK], n_chunks = 1;
+  for (int k = 0; k < ndims; k++) {
+    first[k]  = origin[k] / pipe.chunk_dims[k];
+    n_grid[k] = (origin[k] + dims[k] - 1) / pipe.chunk_dims[k] - first[k] + 1;
+    n_chunks *= n_grid[k];
+  }
+  if (n_chunks < 2) { H5Tclose(file_type_id); return H5LITE_CHUNKS_FALLBACK; }
+
+  H5LITE_PROF_BEGIN(t0);
+  size_t file_bytes  = (size_t)pipe.chunk_elems * pipe.type_size;
+  size_t mem_bytes   = (size_t)pipe.chunk_elems * (el_size > pipe.type_size ? el_size : pipe.type_size);
+  int    convert     = !H5Tequal(file_type_id, mem_type_id);
+
+  /* Chunks per batch: enough to keep every thread busy, within the block size. */
+  hsize_t batch = h5_block_bytes() / (mem_bytes + file_bytes);
+  if (batch < (hsize_t)n_threads) batch = (hsize_t)n_threads;
+  if (batch > n_chunks)           batch = n_chunks;
+
+  chunk_job_t   *jobs    = (chunk_job_t *)calloc((size_t)batch, sizeof(chunk_job_t));
+  unsigned char *scratch = (unsigned char *)malloc((size_t)n_threads * file_bytes);
+  if (!jobs || !scratch) { free(jobs); free(scratch); H5Tclose(file_type_id); return H5LITE_CHUNKS_FALLBACK; } // # nocov
+
+  herr_t  status = 0;
+  hsize_t idx[H5S_MAX_RANK];
+  for (int k = 0; k < ndims; k++) idx[k] = 0;
+
+  for (hsize_t done = 0; done < n_chunks && status == 0; ) {
+
+    hsize_t n_jobs = (n_chunks - done < batch) ? n_chunks - done : batch;
+
+    /* 1. Fetch raw chunks (main thread). */
+    for (hsize_t j = 0; j < n_jobs && status == 0; j++) {
+
+      chunk_job_t *job = &jobs[j];
+      for (int k = 0; k < ndims; k++) job->offset[k] = (first[k] + idx[k]) * pipe.chunk_dims[k];
+      for (int k = ndims - 1; k >= 0 && ++idx[k] == n_grid[k]; k--) idx[k] = 0;
+
+      /* Unallocated chunks hold fill values, which only H5Dread provides. */
+      if (H5Dget_chunk_storage_size(dset_id, job->offset, &job->raw_size) < 0 || job->raw_size == 0) {
+        status = H5LITE_CHUNKS_FALLBACK;
+        break;
+      }
+
+      job->raw  = (unsigned char *)malloc((size_t)job->raw_size);
+      job->data = (unsigned char *)malloc(mem_bytes);
+      if (!job->raw || !job->data) { status = -1; break; } // # nocov
+
+#if defined(H5Dread_chunk_vers) && H5Dread_chunk_vers >= 2
+      size_t buf_size = (size_t)job->raw_size;
+      if (H5Dread_chunk(dset_id, H5P_DEFAULT, job->offset, &job->filter_mask, job->raw, &buf_size) < 0) status = -1;
+#else
+      if (H5Dread_chunk(dset_id, H5P_DEFAULT, job->offset, &job->filter_mask, job->raw) < 0) status = -1;
+#endif
+    }
+
+    /* 2. Decompress (worker threads). */
+    if (status == 0) {
+      #pragma omp parallel for num_threads(n_threads) schedule(dynamic)
+      for (hsize_t j = 0; j < n_jobs; j++) {
+        int tid = 0;
+        #ifdef _OPENMP
+        tid = omp_get_thread_num();
+        #endif
+        jobs[j].status = decode_chunk(&pipe, &jobs[j], file_bytes, scratch + (size_t)tid * file_bytes);
+      }
+    }
+
+    /* 3. Convert and scatter into the R vector (main thread). */
+    for (hsize_t j = 0; j < n_jobs; j++) {
+      chunk_job_t *job = &jobs[j];
+      if (status == 0 && job->status < 0) status = -1;
+      if (status == 0 && convert &&
+          H5Tconvert(file_type_id, mem_type_id, (size_t)pipe.chunk_elems, job->data, NULL, H5P_DEFAULT) < 0)
+        status = -1; // # nocov
+      if (status == 0)
+        scatter_chunk(job->data, job->offset, pipe.chunk_dims, (unsigned char *)dest,
+                      ndims, origin, dims, el_size);
+      free(job->raw);  job->raw  = NULL;
+      free(job->data); job->data = NULL;
+    }
+
+    done += n_jobs;
+  }
+
+  /* Release anything left over from an aborted batch. */
+  for (hsize_t j = 0; j < batch; j++) { free(jobs[j].raw); free(jobs[j].data); }
+  free(jobs);
+  free(scratch);
+  H5Tclose(file_type_id);
+
+  if (status != H5LITE_CHUNKS_FALLBACK) H5LITE_PROF_END(H5LITE_PROF_READ, t0, total * el_size, total);
+  return status;
+}
+
+
+/*
+ * Encodes job->data (chunk_bytes long, file type, row-major) into job->raw,
+ * which must hold compressBound(chunk_bytes) bytes. Like HDF5's deflate
+ * filter, the compressed output is stored even when it is larger than its
+ * input, so job->filter_mask is always 0. Runs on worker threads.
+ */
+static int encode_chunk(const pipeline_t *pipe, chunk_job_t *job, size_t chunk_bytes, unsigned char *scratch) {
+
+  unsigned char *cur      = job->data;
+  size_t         cur_size = chunk_bytes;
+  int            next     = 0;
+  job->filter_mask        = 0;
+
+  for (int i = 0; i < pipe->n_stages; i++) {
+
+    unsigned char *out = next ? job->data : scratch;
+
+    if (pipe->stages[i] == STAGE_DEFLATE) {
+      uLongf out_size = (uLongf)compressBound((uLong)cur_size);
+      int    rc       = compress2(job->raw, &out_size, cur, (uLong)cur_size, pipe->levels[i]);
+      if (rc != Z_OK) return -1;
+      out      = job->raw;
+      cur_size = (size_t)out_size;
+    }
+    else if (pipe->type_size > 1) {
+      if (out == cur) out = job->raw;
+      shuffle(cur, out, cur_size, pipe->type_size);
+    }
+    else {
+      continue;
+    }
+
+    cur  = out;
+    next = (cur == scratch);
+  }
+
+  if (cur != job->raw) memcpy(job->raw, cur, cur_size);
+  job->raw_size = cur_size;
+  return 0;
+}
+
+
+/*
+ * Copies the part of the row-major `src` array (shape dims) that falls in the
+ * chunk at chunk_offset into `chunk`, zero-padding past the dataset's edge.
+ */
+static void gather_chunk(const unsigned char *src, int ndims, const hsize_t *dims,
+                         unsigned char *chunk, const hsize_t *chunk_offset, const hsize_t *chunk_dims,
+                         size_t chunk_elems, size_t el_size) {
+
+  hsize_t hi[H5S_MAX_RANK], c_stride[H5S_MAX_RANK], s_stride[H5S_MAX_RANK], pos[H5S_MAX_RANK];
+  int     partial = 0;
+
+  for (int k = 0; k < ndims; k++) {
+    hsize_t c_end = chunk_offset[k] + chunk_dims[k];
+    hi[k]  = (c_end < dims[k]) ? c_end : dims[k];
+    pos[k] = chunk_offset[k];
+    if (hi[k] < c_end) partial = 1;
+  }
+  if (partial) memset(chunk, 0, chunk_elems * el_size);
+
+  c_stride[ndims - 1] = s_stride[ndims - 1] = 1;
+  for (int k = ndims - 2; k >= 0; k--) {
+    c_stride[k] = c_stride[k + 1] * chunk_dims[k + 1];
+    s_stride[k] = s_stride[k + 1] * dims[k + 1];
+  }
+
+  int     last = ndims - 1;
+  hsize_t run  = hi[last] - chunk_offset[last];
+
+  for (;;) {
+    hsize_t from = 0, to = 0;
+    for (int k = 0; k < ndims; k++) {
+      from += pos[k] * s_stride[k];
+      to   += (pos[k] - chunk_offset[k]) * c_stride[k];
+    }
+    memcpy(chunk + to * el_size, src + from * el_size, run * el_size);
+
+    int k = last - 1;
+    while (k >= 0 && ++pos[k] == hi[k]) { pos[k] = chunk_offset[k]; k--; }
+    if (k < 0) break;
+  }
+}
+
+
+/*
+ * Writes the whole of a newly created dataset from `buf` (C order, in
+ * mem_type_id) with parallel chunk compression on n_threads threads.
+ * Returns 0 on success, a negative value on a write error, or
+ * H5LITE_CHUNKS_FALLBACK when the dataset is not eligible (no data has been
+ * written in that case).
+ */
+herr_t h5_write_chunks(hid_t dset_id, hid_t mem_type_id, int ndims, hsize_t *dims,
+                       const void *buf, int n_threads) {
+
+  if (n_threads < 2 || ndims < 1 || ndims > H5S_MAX_RANK) return H5LITE_CHUNKS_FALLBACK;
+  if (H5Iget_type(dset_id) != H5I_DATASET) return H5LITE_CHUNKS_FALLBACK;
+
+  hid_t file_type_id = H5Dget_type(dset_id);
+  pipeline_t pipe;
+  if (!plan_pipeline(dset_id, file_type_id, ndims, &pipe)) {
+    H5Tclose(file_type_id);
+    return H5LITE_CHUNKS_FALLBACK;
+  }
+
+  hsize_t n_grid[H5S_MAX_RANK], n_chunks = 1;
+  for (int k = 0; k < ndims; k++) {
+    n_grid[k] = (dims[k] + pipe.chunk_dims[k] - 1) / pipe.chunk_dims[k];
+    n_chunks *= n_grid[k];
+  }
+  if (n_chunks < 2) { H5Tclose(file_type_id); return H5LITE_CHUNKS_FALLBACK; }
+
+  H5LITE_PROF_BEGIN(t0);
+  size_t el_size    = H5Tget_size(mem_type_id);
+  size_t file_bytes = (size_t)pipe.chunk_elems * pipe.type_size;
+  size_t mem_bytes  = (size_t)pipe.chunk_elems * (el_size > pipe.type_size ? el_size : pipe.type_size);
+  size_t raw_bytes  = (size_t)compressBound((uLong)file_bytes);
+  int    convert    = !H5Tequal(file_type_id, mem_type_id);
+  if (raw_bytes < file_bytes) raw_bytes = file_bytes; // # nocov
+
+  hsize_t batch = h5_block_bytes() / (mem_bytes + raw_bytes);
+  if (batch < (hsize_t)n_threads) batch = (hsize_t)n_threads;
+  if (batch > n_chunks)           batch = n_chunks;
+
+  chunk_job_t   *jobs    = (chunk_job_t *)calloc((size_t)batch, sizeof(chunk_job_t));
+  unsigned char *scratch = (unsigned char *)malloc((size_t)n_threads * file_bytes);
+  int            ok      = (jobs != NULL && scratch != NULL);
+  for (hsize_t j = 0; ok && j < batch; j++) {
+    jobs[j].data = (unsigned char *)malloc(mem_bytes);
+    jobs[j].raw  = (unsigned char *)malloc(raw_bytes);
+    ok = (jobs[j].data != NULL && jobs[j].raw != NULL);
+  }
+
+  herr_t  status = ok ? 0 : H5LITE_CHUNKS_FALLBACK;
+  hsize_t idx[H5S_MAX_RANK];
+  for (int k = 0; k < ndims; k++) idx[k] = 0;
+
+  for (hsize_t done = 0; done < n_chunks && status == 0; ) {
+
+    hsize_t n_jobs = (n_chunks - done < batch) ? n_chunks - done : batch;
+
+    /* 1. Cut the chunks out of the buffer and convert them (main thread). */
+    for (hsize_t j = 0; j < n_jobs && status == 0; j++) {
+      chunk_job_t *job = &jobs[j];
+      for (int k = 0; k < ndims; k++) job->offset[k] = idx[k] * pipe.chunk_dims[k];
+      for (int k = ndims - 1; k >= 0 && ++idx[k] == n_grid[k]; k--) idx[k] = 0;
+
+      gather_chunk((const unsigned char *)buf, ndims, dims, job->data, job->offset,
+                   pipe.chunk_dims, (size_t)pipe.chunk_elems, el_size);
+
+      if (convert && H5Tconvert(mem_type_id, file_type_id, (size_t)pipe.chunk_elems, job->data, NULL, H5P_DEFAULT) < 0)
+        status = -1; // # nocov
+    }
+
+    /* 2. Compress (worker threads). */
+    if (status == 0) {
+      #pragma omp parallel for num_threads(n_threads) schedule(dynamic)
+      for (hsize_t j = 0; j < n_jobs; j++) {
+        int tid = 0;
+        #ifdef _OPENMP
+        tid = omp_get_thread_num();
+        #endif
+        jobs[j].status = encode_chunk(&pipe, &jobs[j], file_bytes, scratch + (size_t)tid * file_bytes);
+      }
+    }
+
+    /* 3. Commit the encoded chunks (main thread). */
+    for (hsize_t j = 0; j < n_jobs && status == 0; j++) {
+      chunk_job_t *job = &jobs[j];
+      if (job->status < 0 ||
+          H5Dwrite_chunk(dset_id, H5P_DEFAULT, job->filter_mask, job->offset, (size_t)job->raw_size, job->raw) < 0)
+        status = -1;
+    }
+
+    done += n_jobs;
+  }
+
+  for (hsize_t j = 0; jobs && j < batch; j++) { free(jobs[j].raw); free(jobs[j].data); }
+  free(jobs);
+  free(scratch);
+  H5Tclose(file_type_id);
+
+  if (status != H5LITE_CHUNKS_FALLBACK) {
+    hsize_t total = 1;
+    for (int k = 0; k < ndims; k++) total *= dims[k];
+    H5LITE_PROF_END(H5LITE_PROF_WRITE, t0, total * el_size, total);
+  }
+  return status;
+}
@@ -0,0 +1,200 @@
+#include "h5lite.h"
+#include <time.h>
+
+/*
+ * Compression trials behind h5_compression("auto").
+ *
+ * A sample of the data - a few chunks' worth of slices from its start, middle
+ * and end - is written with each candidate pipeline to a file held in memory
+ * by HDF5's core driver, then read back. The stored size and the time spent
+ * in each direction are returned to R, which picks the winner for its target.
+ *
+ * Slices are taken along the last dimension, the one that is contiguous in
+ * R's column-major memory, so the sample keeps every other dimension of the
+ * data intact: the rows of a vector, the columns of a matrix.
+ */
+
+
+/* Builds the sample: slices from three evenly spaced places in `data`. */
+static SEXP sample_slices(SEXP data, int rank, const hsize_t *h5_dims, size_t el_size,
+                          size_t sample_bytes, hsize_t *out_slices) {
+
+  hsize_t n_slices    = h5_dims[rank - 1];
+  hsize_t slice_elems = 1;
+  for (int i = 0; i < rank - 1; i++) slice_elems *= h5_dims[i];
+
+  size_t  slice_bytes = (size_t)slice_elems * el_size;
+  hsize_t per_slab    = (slice_bytes > 0) ? (hsize_t)(sample_bytes / 3 / slice_bytes) : n_slices;
+  if (per_slab < 1) per_slab = 1;
+
+  hsize_t starts[3] = { 0, 0, 0 };
+  int     n_slabs   = 1;
+
+  if (3 * per_slab >= n_slices) {
+    per_slab = n_slices;
+  }
+  else {
+    n_slabs   = 3;
+    starts[1] = (n_slices - per_slab) / 2;
+    starts[2] = n_slices - per_slab;
+  }
+
+  *out_slices = per_slab * (hsize_t)n_slabs;
+
+  SEXP   sample = PROTECT(allocVector(TYPEOF(data), (R_xlen_t)(*out_slices * slice_elems)));
+  char  *dst    = (char *)DATAPTR(sample);
+  const char *src = (const char *)DATAPTR_RO(data);
+
+  for (int s = 0; s < n_slabs; s++) {
+    size_t bytes = (size_t)per_slab * slice_bytes;
+    memcpy(dst, src + (size_t)starts[s] * slice_bytes, bytes);
+    dst += bytes;
+  }
+
+  UNPROTECT(1);
+  return sample;
+}
+
+
+static double elapsed(clock_t since) {
+  return (double)(clock() - since) / CLOCKS_PER_SEC;
+}
+
+
+/*
+ * Writes `sample` with one candidate pipeline to an in-memory file, reads it
+ * back, and stores the on-disk size and both timings in `out`. Returns 0 if
+ * the pipeline could not be used (e.g. a filter plugin is missing).
+ */
+static int run_trial(SEXP sample, const char *dtype_str, int rank, hsize_t *h5_dims,
+                     SEXP compress, double *out) {
+
+  int ok = 0;
+
+  hid_t fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_core(fapl_id, H5LITE_CORE_INCREMENT, 0);
+  hid_t file_id = H5Fcreate("h5lite_compress_trial", H5F_ACC_TRUNC, H5P_DEFAULT, fapl_id);
+  H5Pclose(fapl_id);
+  if (file_id < 0) return 0; // # nocov
+
+  hid_t space_id     = H5Screate_simple(rank, h5_dims, NULL);
+  hid_t file_type_id = create_h5_file_type(sample, dtype_str);
+
+  /* Laid out as C_h5_write_dataset() would lay out the real dataset. */
+  hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
+  if (!compress_is_plain(compress)) {
+    hsize_t *chunk_dims = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+    calculate_chunk_dims(rank, h5_dims, H5Tget_size(file_type_id), compress, chunk_dims);
+    apply_compression(dcpl_id, file_type_id, rank, chunk_dims, compress);
+  }
+
+  hid_t dset_id = H5Dcreate2(file_id, "trial", file_type_id, space_id, H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Pclose(dcpl_id);
+
+  if (dset_id >= 0) {
+
+    /* Chunks are compressed as they leave the chunk cache: flush them all. */
+    clock_t t0  = clock();
+    SEXP errmsg = write_atomic_selection(dset_id, sample, dtype_str, rank, h5_dims, H5S_ALL, 1);
+    herr_t status = (errmsg == R_NilValue) ? H5Dflush(dset_id) : -1;
+    out[1] = elapsed(t0);
+    out[0] = (double)H5Dget_storage_size(dset_id);
+    H5Dclose(dset_id);
+
+    /* Reopening starts with an empty chunk cache, so every chunk is decoded. */
+    hid_t  mem_type_id = H5Tget_native_type(file_type_id, H5T_DIR_DEFAULT);
+    size_t n_bytes     = (size_t)XLENGTH(sample) * H5Tget_size(mem_type_id);
+    void  *buffer      = (status >= 0) ? malloc(n_bytes > 0 ? n_bytes : 1) : NULL;
+
+    if (buffer != NULL) {
+      t0      = clock();
+      dset_id = H5Dopen2(file_id, "trial", H5P_DEFAULT);
+      status  = (dset_id >= 0) ? H5Dread(dset_id, mem_type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer) : -1;
+      out[2]  = elapsed(t0);
+      ok      = (status >= 0);
+      if (dset_id >= 0) H5Dclose(dset_id);
+      free(buffer);
+    }
+    H5Tclose(mem_type_id);
+  }
+
+  H5Tclose(file_type_id); H5Sclose(space_id);
+  H5Fclose(file_id);
+  return ok;
+}
+
+
+/*
+ * C implementation of the trials for h5_compression("auto").
+ * `candidates` is a list of h5_compression() objects. Returns
+ * list(bytes = <sample size uncompressed>, stored = , write = , read = ), the
+ * last three with one entry per candidate (NA where a candidate failed).
+ * Timings are in seconds of CPU time.
+ */
+SEXP C_h5_compress_trial(SEXP data, SEXP dtype, SEXP dims, SEXP candidates, SEXP sample_bytes) {
+
+  const char *dtype_str = CHAR(STRING_ELT(dtype, 0));
+  R_xlen_t    n_cand    = XLENGTH(candidates);
+
+  size_t el_size = 0;
+  switch (TYPEOF(data)) {
+    case REALSXP: el_size = sizeof(double); break;
+    case INTSXP:
+    case LGLSXP:  el_size = sizeof(int);    break;
+    case RAWSXP:  el_size = 1;              break;
+    default:      error("Compression trials need numeric, logical or raw data.");
+  }
+
+  int      rank    = 0;
+  hsize_t *h5_dims = NULL;
+  hid_t    space_id = create_dataspace(dims, data, &rank, &h5_dims);
+  if (space_id < 0 || rank == 0) {
+    if (space_id >= 0) H5Sclose(space_id);
+    error("Compression trials need a non-scalar dataset.");
+  }
+  H5Sclose(space_id);
+
+  hsize_t n_slices = 0;
+  SEXP sample = PROTECT(sample_slices(data, rank, h5_dims, el_size, (size_t)asReal(sample_bytes), &n_slices));
+
+  hsize_t *s_dims = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  memcpy(s_dims, h5_dims, rank * sizeof(hsize_t));
+  s_dims[rank - 1] = n_slices;
+
+  /* Ratios are against the data's size on disk when uncompressed. */
+  hid_t  file_type_id = create_h5_file_type(sample, dtype_str);
+  double bytes        = (double)XLENGTH(sample) * (double)H5Tget_size(file_type_id);
+  H5Tclose(file_type_id);
+
+  SEXP stored = PROTECT(allocVector(REALSXP, n_cand));
+  SEXP wtime  = PROTECT(allocVector(REALSXP, n_cand));
+  SEXP rtime  = PROTECT(allocVector(REALSXP, n_cand));
+
+  /* Candidates whose filters are not available fail quietly. */
+  herr_t (*old_func)(hid_t, void*);
+  void *old_client_data;
+  H5Eget_auto(H5E_DEFAULT, &old_func, &old_client_data);
+  H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+
+  for (R_xlen_t i = 0; i < n_cand; i++) {
+    double res[3] = { NA_REAL, NA_REAL, NA_REAL };
+    if (!run_trial(sample, dtype_str, rank, s_dims, VECTOR_ELT(candidates, i), res))
+      res[0] = res[1] = res[2] = NA_REAL;
+    REAL(stored)[i] = res[0];
+    REAL(wtime)[i]  = res[1];
+    REAL(rtime)[i]  = res[2];
+  }
+
+  H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
+
+  SEXP result = PROTECT(allocVector(VECSXP, 4));
+  SEXP names  = PROTECT(allocVector(STRSXP, 4));
+  SET_VECTOR_ELT(result, 0, ScalarReal(bytes));  SET_STRING_ELT(names, 0, mkChar("bytes"));
+  SET_VECTOR_ELT(result, 1, stored);             SET_STRING_ELT(names, 1, mkChar("stored"));
+  SET_VECTOR_ELT(result, 2, wtime);              SET_STRING_ELT(names, 2, mkChar("write"));
+  SET_VECTOR_ELT(result, 3, rtime);              SET_STRING_ELT(names, 3, mkChar("read"));
+  setAttrib(result, R_NamesSymbol, names);
+
+  UNPROTECT(6);
+  return result;
+}
@@ -3,9 +3,16 @@
 
 /* --- COMPOUND (DATA FRAME) READER --- */
 
+/*
+ * `cols` is NULL to read every member, or a character vector naming the
+ * members to read, in the order they should appear in the data.frame. Only
+ * those members go into the memory compound type, so HDF5 converts and copies
+ * nothing else.
+ */
 SEXP read_data_frame(
     hid_t obj_id, int is_dataset, hid_t file_type_id, hid_t space_id, SEXP rmap, 
-    hid_t mem_space_id, hid_t file_space_id, hsize_t *offset, hsize_t *mem_dims) {
+    hid_t mem_space_id, hid_t file_space_id, hsize_t *offset, hsize_t *mem_dims, hsize_t **coords, 
+    SEXP cols) {
   
   int ndims = H5Sget_simple_extent_ndims(space_id);
   hsize_t n_rows;
@@ -22,11 +29,21 @@ SEXP read_data_frame(
   int n_cols = H5Tget_nmembers(file_type_id);
   if (n_cols < 0) return mkChar("Failed to get number of compound members");
   
+  /* 0. Map output columns to file members */
+  if (cols != R_NilValue) n_cols = (int)XLENGTH(cols);
+  int *members = (int *)R_alloc(n_cols > 0 ? n_cols : 1, sizeof(int));
+  
+  for (int c = 0; c < n_cols; c++) {
+    if (cols == R_NilValue) { members[c] = c; continue; }
+    const char *col_name = Rf_translateCharUTF8(STRING_ELT(cols, c));
+    members[c] = H5Tget_member_index(file_type_id, col_name);
+    if (members[c] < 0) return errmsg_1("Column '%s' not found in compound dataset", col_name);
+  }
+  
   H5T_class_t *member_classes   = (H5T_class_t *)R_alloc(n_cols, sizeof(H5T_class_t));
   R_TYPE      *member_rtypes    = (R_TYPE *)     R_alloc(n_cols, sizeof(R_TYPE));
   hid_t       *mem_member_types = (hid_t *)      R_alloc(n_cols, sizeof(hid_t));
   size_t       total_mem_size   = 0;
-  size_t       max_fixed_width  = 0;
   
   SEXP result         = PROTECT(allocVector(VECSXP, n_cols));
   SEXP col_names_sexp = allocVector(STRSXP, n_cols);
@@ -34,11 +51,11 @@ SEXP read_data_frame(
   
   /* 1. Setup Types */
   for (int c = 0; c < n_cols; c++) {
-    char *member_name = H5Tget_member_name(file_type_id, c);
+    char *member_name = H5Tget_member_name(file_type_id, members[c]);
     if (member_name) { SET_STRING_ELT(col_names_sexp, c, mkCharCE(member_name, CE_UTF8)); }
     else             { SET_STRING_ELT(col_names_sexp, c, NA_STRING); } // # nocov
     
-    hid_t file_member_type = H5Tget_member_type(file_type_id, c);
+    hid_t file_member_type = H5Tget_member_type(file_type_id, members[c]);
     H5T_class_t file_class = H5Tget_class(file_member_type);
     member_classes[c] = file_class;
     
@@ -68,7 +85,6 @@ SEXP read_data_frame(
       } else {
         size_t fixed_width = H5Tget_size(file_member_type);
         H5Tset_size(mem_member_types[c], fixed_width);
-        if (max_fixed_width < fixed_width) max_fixed_width = fixed_width;
       }
       H5Tset_cset(mem_member_types[c], cset);
     }
@@ -88,13 +104,11 @@ SEXP read_data_frame(
     H5Tclose(file_member_type);
   }
   
-  char *fixed_width_buffer = (char *) R_alloc(max_fixed_width + 1, sizeof(char));
-  
   /* 2. Create Compound Memory Type */
   hid_t mem_type_id = H5Tcreate(H5T_COMPOUND, total_mem_size);
   size_t mem_offset = 0;
   for (int c = 0; c < n_cols; c++) {
-    char *member_name = H5Tget_member_name(file_type_id, c);
+    char *member_name = H5Tget_member_name(file_type_id, members[c]);
     H5Tinsert(mem_type_id, member_name, mem_offset, mem_member_types[c]);
     mem_offset += H5Tget_size(mem_member_types[c]);
     H5free_memory(member_name);
@@ -108,9 +122,11 @@ SEXP read_data_frame(
     return mkChar("Memory allocation failed"); 
   } // # nocov end
   
+  H5LITE_PROF_BEGIN(t0);
   herr_t status;
   if (is_dataset) { status = H5Dread(obj_id, mem_type_id, mem_space_id, file_space_id, H5P_DEFAULT, buffer); }
   else            { status = H5Aread(obj_id, mem_type_id, buffer); }
+  h5_prof_io(H5LITE_PROF_READ, t0, obj_id, mem_type_id, is_dataset ? mem_space_id : H5S_ALL);
   
   if (status < 0) {  // # nocov start
     free(buffer); H5Tclose(mem_type_id); UNPROTECT(1);
@@ -133,7 +149,7 @@ SEXP read_data_frame(
       }
       R_TYPE rtype = member_rtypes[c];
       if (rtype != R_TYPE_DOUBLE) {
-        hid_t file_member_type = H5Tget_member_type(file_type_id, c);
+        hid_t file_member_type = H5Tget_member_type(file_type_id, members[c]);
         UNPROTECT(1);
         r_column = PROTECT(coerce_to_rtype(r_column, rtype, file_member_type));
         H5Tclose(file_member_type);
@@ -154,7 +170,7 @@ SEXP read_data_frame(
         int val; memcpy(&val, src, sizeof(int));
         INTEGER(r_column)[r] = val;
       }
-      hid_t file_member_type = H5Tget_member_type(file_type_id, c);
+      hid_t file_member_type = H5Tget_member_type(file_type_id, members[c]);
       int n_levels = H5Tget_nmembers(file_member_type);
       SEXP levels = PROTECT(allocVector(STRSXP, n_levels));
       for (int i = 0; i < n_levels; i++) {
@@ -173,11 +189,15 @@ SEXP read_data_frame(
     else if (mclass == H5T_STRING) {
       r_column = PROTECT(allocVector(STRSXP, n_rows));
       
+      h5_strtab_t tab;
+      h5_strtab_init(&tab, (R_xlen_t)n_rows);
+      H5LITE_PROF_BEGIN(t0);
+      
       if (H5Tis_variable_str(mem_member_types[c])) {
         for (hsize_t r = 0; r < n_rows; r++) {
           char *src = buffer + (r * total_mem_size) + member_offset;
           char *str_ptr; memcpy(&str_ptr, src, sizeof(char *)); 
-          if (str_ptr) { SET_STRING_ELT(r_column, r, mkCharCE(str_ptr, CE_UTF8)); }
+          if (str_ptr) { SET_STRING_ELT(r_column, r, h5_mkchar(&tab, str_ptr, strlen(str_ptr))); }
           else         { SET_STRING_ELT(r_column, r, NA_STRING); }
         }
       }
@@ -185,11 +205,11 @@ SEXP read_data_frame(
         size_t str_size = H5Tget_size(mem_member_types[c]);
         for (hsize_t r = 0; r < n_rows; r++) {
           char *src = buffer + (r * total_mem_size) + member_offset;
-          memcpy(fixed_width_buffer, src, str_size);
-          fixed_width_buffer[str_size] = '\0';
-          SET_STRING_ELT(r_column, r, mkCharCE(fixed_width_buffer, CE_UTF8));
+          char *end = (char *)memchr(src, '\0', str_size);
+          SET_STRING_ELT(r_column, r, h5_mkchar(&tab, src, end ? (size_t)(end - src) : str_size));
         }
       }
+      H5LITE_PROF_END(H5LITE_PROF_STRINGS, t0, n_rows * H5Tget_size(mem_member_types[c]), n_rows);
     } 
     else if (mclass == H5T_OPAQUE) {
       r_column = PROTECT(allocVector(RAWSXP, n_rows));
@@ -232,11 +252,11 @@ SEXP read_data_frame(
           hid_t scale_mem_space = H5S_ALL;
           hsize_t total = H5Sget_simple_extent_npoints(s_space);
           
-          /* Extract the specific scale subset mapping to our row offset/count */
+          /* Extract the specific scale subset mapping to our selected rows */
           if (offset != NULL && mem_dims != NULL && s_ndims == 1) {
             hsize_t s_offset[1] = { offset[0] };
             hsize_t s_count[1]  = { mem_dims[0] };
-            H5Sselect_hyperslab(s_space, H5S_SELECT_SET, s_offset, NULL, s_count, NULL);
+            h5_select_coords(s_space, 1, coords, s_offset, s_count);
             scale_mem_space = H5Screate_simple(1, s_count, NULL);
             total = s_count[0];
           }
@@ -283,36 +303,39 @@ SEXP read_data_frame(
 
 
 /*
- * Writes an R data.frame as a compound HDF5 object (dataset or attribute).
+ * Plans the serialization of an R data.frame into HDF5 compound records.
+ *
+ * Each column's member offset and packing kernel are resolved once, here.
+ * pack_rows() then fills a block of records column by column, with one tight
+ * loop per column, so the records never need to exist for all rows at once.
+ * Integer columns written as floats are widened while packing, with NA as
+ * NA_real_, instead of being coerced to a copy of the column.
  *
- * This function handles the complexities of mapping R's column types to HDF5
- * compound members. It uses a "duplicate-and-coerce" strategy to safely handle
- * type promotions (e.g., integer to double for NA values) without altering the
- * user's original R object.
+ * On success, the caller closes pack->file_type_id and pack->mem_type_id.
+ * Variable-length string members point into `data`, which must stay
+ * protected until the records have been written.
  */
-SEXP write_dataframe(
-  hid_t file_id, hid_t loc_id, const char *obj_name, SEXP data, 
-  SEXP dtypes, SEXP compress, int is_attribute) {
+SEXP pack_dataframe(SEXP data, SEXP dtypes, const char *obj_name, h5_df_pack_t *pack) {
 
   /* --- 1. Get data.frame properties --- */
   R_xlen_t n_cols = XLENGTH(data);
   if (n_cols == 0) return errmsg_1("Cannot write empty data.frame '%s'", obj_name);
-  R_xlen_t n_rows = (n_cols > 0) ? XLENGTH(VECTOR_ELT(data, 0)) : 0;
   
-  data = PROTECT(duplicate(data));
   SEXP col_names = PROTECT(getAttrib(data, R_NamesSymbol));
   
-  /* --- 2. Prepare Columns, Types, and Coercion --- */
-  SEXP *col_ptrs = (SEXP *) R_alloc(n_cols, sizeof(SEXP));
-
+  pack->n_cols  = n_cols;
+  pack->n_rows  = XLENGTH(VECTOR_ELT(data, 0));
+  pack->cols    = (SEXP *)       R_alloc(n_cols, sizeof(SEXP));
+  pack->offsets = (size_t *)     R_alloc(n_cols, sizeof(size_t));
+  pack->widths  = (size_t *)     R_alloc(n_cols, sizeof(size_t));
+  pack->kinds   = (h5_pack_t *)  R_alloc(n_cols, sizeof(h5_pack_t));
+  
+  /* --- 2. Prepare Columns and Types --- */
   hid_t *ft_members = (hid_t *) R_alloc(n_cols, sizeof(hid_t));
   hid_t *mt_members = (hid_t *) R_alloc(n_cols, sizeof(hid_t));
   
-  /* Array to store the fixed byte width for each column (0 = variable length) */
-  size_t *col_fixed_widths = (size_t *) R_alloc(n_cols, sizeof(size_t));
-  
   size_t total_file_size = 0;
-  size_t total_mem_size = 0;
+  size_t total_mem_size  = 0;
 
   for (R_xlen_t c = 0; c < n_cols; c++) {
     SEXP r_column = VECTOR_ELT(data, c);
@@ -321,127 +344,152 @@ SEXP write_dataframe(
     /* Pre-calculate string width. 
      * If dtype_str is e.g. "ascii[10]", this returns 10. 
      * If "ascii" or "double", returns 0. */
-    col_fixed_widths[c] = get_fixed_byte_width(dtype_str);
+    pack->cols[c]   = r_column;
+    pack->widths[c] = get_fixed_byte_width(dtype_str);
     
-    if (TYPEOF(r_column) == INTSXP || TYPEOF(r_column) == LGLSXP) {
-      if (strcmp(dtype_str, "float64") == 0 ||
-          strcmp(dtype_str, "float32") == 0 ||
-          strcmp(dtype_str, "float16") == 0) {
-        r_column = coerceVector(r_column, REALSXP);
-        SET_VECTOR_ELT(data, c, r_column);
-      }
+    switch (TYPEOF(r_column)) {
+      case REALSXP: pack->kinds[c] = H5_PACK_8;       break;
+      case RAWSXP:  pack->kinds[c] = H5_PACK_1;       break;
+      case CPLXSXP: pack->kinds[c] = H5_PACK_COMPLEX; break;
+      case STRSXP:  pack->kinds[c] = (pack->widths[c] > 0) ? H5_PACK_FIXED_STR : H5_PACK_VLEN_STR; break;
+      case INTSXP:
+      case LGLSXP:
+        pack->kinds[c] = (strcmp(dtype_str, "float64") == 0 ||
+                          strcmp(dtype_str, "float32") == 0 ||
+                          strcmp(dtype_str, "float16") == 0) ? H5_PACK_INT_AS_DOUBLE : H5_PACK_4;
+        break;
+      default: pack->kinds[c] = H5_PACK_NONE; // # nocov
     }
     
-    col_ptrs[c] = r_column;
-
     ft_members[c] = create_h5_file_type(r_column, dtype_str);
-    mt_members[c] = create_r_memory_type(r_column, dtype_str);
+    mt_members[c] = (pack->kinds[c] == H5_PACK_INT_AS_DOUBLE) 
+      ? H5Tcopy(H5T_NATIVE_DOUBLE) : create_r_memory_type(r_column, dtype_str);
     
-    if (ft_members[c] < 0 || mt_members[c] < 0) { // # nocov start
-      for (int i = 0; i < c; i++) { H5Tclose(ft_members[i]); H5Tclose(mt_members[i]); }
-      UNPROTECT(2); // data, col_names
+    if (ft_members[c] < 0 || mt_members[c] < 0 || pack->kinds[c] == H5_PACK_NONE) { // # nocov start
+      for (R_xlen_t i = 0; i <= c; i++) {
+        if (ft_members[i] >= 0) H5Tclose(ft_members[i]);
+        if (mt_members[i] >= 0) H5Tclose(mt_members[i]);
+      }
+      UNPROTECT(1); // col_names
       const char *col_name = Rf_translateCharUTF8(STRING_ELT(col_names, c));
       return errmsg_3("Could not resolve %s data type for column '%s' of object '%s'.", dtype_str, col_name, obj_name);
     } // # nocov end
     
-    total_file_size += H5Tget_size(ft_members[c]);
-    total_mem_size  += H5Tget_size(mt_members[c]);
+    pack->offsets[c]  = total_mem_size;
+    total_file_size  += H5Tget_size(ft_members[c]);
+    total_mem_size   += H5Tget_size(mt_members[c]);
   }
   
   hid_t file_type_id = H5Tcreate(H5T_COMPOUND, total_file_size);
   hid_t mem_type_id  = H5Tcreate(H5T_COMPOUND, total_mem_size);
   size_t file_offset = 0;
-  size_t mem_offset  = 0;
   
   for (R_xlen_t c = 0; c < n_cols; c++) {
     const char *col_name = Rf_translateCharUTF8(STRING_ELT(col_names, c));
-    H5Tinsert(file_type_id, col_name, file_offset, ft_members[c]);
-    H5Tinsert(mem_type_id,  col_name, mem_offset,  mt_members[c]);
+    H5Tinsert(file_type_id, col_name, file_offset,      ft_members[c]);
+    H5Tinsert(mem_type_id,  col_name, pack->offsets[c], mt_members[c]);
     file_offset += H5Tget_size(ft_members[c]);
-    mem_offset  += H5Tget_size(mt_members[c]);
   }
   
-  /* --- 3. Create C Buffer and Serialize Data --- */
-  /* malloc ensures we have a block, but content is undefined. 
-   * We must zero-out memory for fixed-length strings to ensure padding is clean. */
-  char *buffer = (char *) malloc(n_rows * total_mem_size);
-  if (!buffer) { // # nocov start
-    for (int c = 0; c < n_cols; c++) { H5Tclose(ft_members[c]); H5Tclose(mt_members[c]); }
-    H5Tclose(file_type_id); H5Tclose(mem_type_id); UNPROTECT(2); // data, col_names
-    return errmsg_1("Memory allocation failed for data.frame buffer: %s", obj_name);
-  } // # nocov end
+  for (R_xlen_t c = 0; c < n_cols; c++) { H5Tclose(ft_members[c]); H5Tclose(mt_members[c]); }
+  
+  UNPROTECT(1); // col_names
+  
+  pack->file_type_id = file_type_id;
+  pack->mem_type_id  = mem_type_id;
+  pack->row_size     = total_mem_size;
+  
+  return R_NilValue;
+}
+
+
+/*
+ * Fills buf with records [r0, r0 + n) of a data.frame planned by
+ * pack_dataframe(). A write_fill_t for write_rows().
+ */
+int pack_rows(void *ctx, void *buf, hsize_t r0, hsize_t n) {
+  
+  const h5_df_pack_t *pack = (const h5_df_pack_t *)ctx;
+  size_t stride = pack->row_size;
   
-  for (hsize_t r = 0; r < n_rows; r++) {
-    char *row_ptr = buffer + (r * total_mem_size);
-    for (R_xlen_t c = 0; c < n_cols; c++) {
-      size_t col_offset = H5Tget_member_offset(mem_type_id, c);
-      char *dest = row_ptr + col_offset;
-      SEXP r_col = col_ptrs[c];
+  for (R_xlen_t c = 0; c < pack->n_cols; c++) {
+    
+    char *dest = (char *)buf + pack->offsets[c];
+    SEXP  col  = pack->cols[c];
+    
+    switch (pack->kinds[c]) {
       
-      switch (TYPEOF(r_col)) {
-        case REALSXP: {
-          double val = REAL(r_col)[r];
-          memcpy(dest, &val, sizeof(double));
-          break;
-        }
-        case INTSXP: {
-          int int_val = INTEGER(r_col)[r];
-          memcpy(dest, &int_val, sizeof(int));
-          break;
-        }
-        case LGLSXP: {
-          int lgl_val = LOGICAL(r_col)[r];
-          memcpy(dest, &lgl_val, sizeof(int));
-          break;
-        }
-        case RAWSXP: {
-          unsigned char val = RAW(r_col)[r];
-          memcpy(dest, &val, sizeof(unsigned char));
-          break;
+      case H5_PACK_8: {
+        const double *src = REAL(col) + r0;
+        for (hsize_t r = 0; r < n; r++) memcpy(dest + r * stride, src + r, sizeof(double));
+        break;
+      }
+      case H5_PACK_4: {
+        const int *src = (TYPEOF(col) == LGLSXP) ? LOGICAL(col) + r0 : INTEGER(col) + r0;
+        for (hsize_t r = 0; r < n; r++) memcpy(dest + r * stride, src + r, sizeof(int));
+        break;
+      }
+      case H5_PACK_INT_AS_DOUBLE: {
+        const int *src = (TYPEOF(col) == LGLSXP) ? LOGICAL(col) + r0 : INTEGER(col) + r0;
+        for (hsize_t r = 0; r < n; r++) {
+          double val = (src[r] == NA_INTEGER) ? NA_REAL : (double)src[r];
+          memcpy(dest + r * stride, &val, sizeof(double));
         }
-        case CPLXSXP: {
-          Rcomplex val = COMPLEX(r_col)[r];
-          memcpy(dest, &val, sizeof(Rcomplex));
-          break;
+        break;
+      }
+      case H5_PACK_1: {
+        const Rbyte *src = RAW(col) + r0;
+        for (hsize_t r = 0; r < n; r++) dest[r * stride] = (char)src[r];
+        break;
+      }
+      case H5_PACK_COMPLEX: {
+        const Rcomplex *src = COMPLEX(col) + r0;
+        for (hsize_t r = 0; r < n; r++) memcpy(dest + r * stride, src + r, sizeof(Rcomplex));
+        break;
+      }
+      case H5_PACK_FIXED_STR: {
+        size_t width = pack->widths[c];
+        for (hsize_t r = 0; r < n; r++) {
+          SEXP s = STRING_ELT(col, (R_xlen_t)(r0 + r));
+          /* strncpy pads short strings with nulls, and does not null-terminate
+           * strings of `width` bytes or more, as HDF5 expects. NA is empty. */
+          if (s == NA_STRING) memset(dest + r * stride, 0, width);
+          else                strncpy(dest + r * stride, Rf_translateCharUTF8(s), width);
         }
-        case STRSXP: {
-          size_t width = col_fixed_widths[c];
-          SEXP s = STRING_ELT(r_col, r);
-          
-          /* Check if this column is Fixed Length or Variable Length */
-          if (width > 0) {
-            /* FIXED LENGTH LOGIC */
-            /* 1. Zero out the destination buffer (padding) */
-            memset(dest, 0, width);
-            
-            /* 2. Copy data if not NA */
-            if (s != NA_STRING) {
-              const char *utf8_s = Rf_translateCharUTF8(s);
-              /* Copy up to 'width' bytes. 
-               * strncpy does not guarantee null-termination if string >= width, 
-               * which is exactly what HDF5 expects for full fixed-width strings. */
-              strncpy(dest, utf8_s, width);
-            }
-          }
-          else {
-            /* VARIABLE LENGTH LOGIC (POINTER) */
-            const char *ptr = (s == NA_STRING) ? NULL : Rf_translateCharUTF8(s);
-            memcpy(dest, &ptr, sizeof(const char *));
-          }
-          break;
+        break;
+      }
+      case H5_PACK_VLEN_STR: {
+        for (hsize_t r = 0; r < n; r++) {
+          SEXP s = STRING_ELT(col, (R_xlen_t)(r0 + r));
+          const char *ptr = (s == NA_STRING) ? NULL : Rf_translateCharUTF8(s);
+          memcpy(dest + r * stride, &ptr, sizeof(const char *));
         }
-        default: { // # nocov start
-          free(buffer); UNPROTECT(2); // data, col_names
-          for (int i = 0; i < n_cols; i++) { H5Tclose(ft_members[i]); H5Tclose(mt_members[i]); }
-          H5Tclose(file_type_id); H5Tclose(mem_type_id);
-          return errmsg_1("Unsupported R column type in data.frame: %s", CHAR(STRING_ELT(dtypes, c)));
-        } // # nocov end
+        break;
       }
+      default: return -1; // # nocov
     }
   }
   
-  /* --- 4. Create Dataspace and Object --- */
-  hsize_t h5_dims = (hsize_t) n_rows;
+  return 0;
+}
+
+
+/*
+ * Writes an R data.frame as a compound HDF5 object (dataset or attribute).
+ * The records are packed by pack_rows(), in blocks for datasets.
+ */
+SEXP write_dataframe(
+  hid_t file_id, hid_t loc_id, const char *obj_name, SEXP data, 
+  SEXP dtypes, SEXP compress, int is_attribute) {
+  
+  h5_df_pack_t pack;
+  SEXP errmsg = pack_dataframe(data, dtypes, obj_name, &pack);
+  if (errmsg != R_NilValue) return errmsg;
+  
+  hid_t file_type_id = pack.file_type_id, mem_type_id = pack.mem_type_id;
+  
+  /* --- 1. Create Dataspace and Object --- */
+  hsize_t h5_dims = (hsize_t) pack.n_rows;
   hid_t space_id = H5Screate_simple(1, &h5_dims, NULL);
   hid_t obj_id = -1;
   
@@ -458,9 +506,9 @@ SEXP write_dataframe(
     H5Pset_char_encoding(lcpl_id, H5T_CSET_UTF8);
     
     hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
-    if (n_rows > 0) {
+    if (pack.n_rows > 0) {
       hsize_t chunk_dims = 0;
-      calculate_chunk_dims(1, &h5_dims, total_mem_size, compress, &chunk_dims);
+      calculate_chunk_dims(1, &h5_dims, H5Tget_size(mem_type_id), compress, &chunk_dims);
       apply_compression(dcpl_id, file_type_id, 1, &chunk_dims, compress);
     }
     obj_id = H5Dcreate2(loc_id, obj_name, file_type_id, space_id, lcpl_id, dcpl_id, H5P_DEFAULT);
@@ -468,15 +516,15 @@ SEXP write_dataframe(
   }
   
   if (obj_id < 0) { // # nocov start
-    free(buffer); UNPROTECT(2); // data, col_names
-    for(int i = 0; i < n_cols; i++) { H5Tclose(ft_members[i]); H5Tclose(mt_members[i]); }
     H5Tclose(file_type_id); H5Tclose(mem_type_id); H5Sclose(space_id);
     if (is_attribute) { return errmsg_1("Failed to create compound attribute '%s'", obj_name); } 
     else              { return errmsg_1("Failed to create compound dataset '%s'", obj_name);   }
   } // # nocov end
   
-  /* --- 5. Write Data and Clean Up --- */
-  herr_t status = write_buffer_to_object(obj_id, mem_type_id, buffer);
+  /* --- 2. Write Data and Clean Up --- */
+  herr_t status = write_rows(obj_id, mem_type_id, 1, &h5_dims, pack.row_size, H5S_ALL, 1, pack_rows, &pack);
+  
+  if (!is_attribute && status >= 0) write_auto_choice(obj_id, compress);
   
   /* Attach Row Names as Dimension Scale (if Dataset) */
   if (!is_attribute && status >= 0) {
@@ -491,8 +539,6 @@ SEXP write_dataframe(
   if (is_attribute) { H5Aclose(obj_id); }
   else              { H5Dclose(obj_id); }
   
-  free(buffer); UNPROTECT(2); // data, col_names
-  for(int i = 0; i < n_cols; i++) { H5Tclose(ft_members[i]); H5Tclose(mt_members[i]); }
   H5Tclose(file_type_id); H5Tclose(mem_type_id); H5Sclose(space_id);
   
   if (status < 0) {
@@ -502,3 +548,143 @@ SEXP write_dataframe(
   
   return R_NilValue;
 }
+
+
+/* --- COLUMNAR LAYOUT --- */
+
+/*
+ * A data.frame written with layout = "columnar" is a group holding one 1D
+ * dataset per column, plus an optional "_rownames" dimension scale attached
+ * to dimension 0 of every column. The column order is kept by R in the
+ * group's "h5lite_columns" attribute.
+ */
+
+#define ROWNAMES_SCALE "_rownames"
+
+
+/*
+ * Reads the named columns of an open columnar data.frame group, each
+ * restricted to the same row selection (as for read_dataset()), and
+ * assembles them into a data.frame. Returns a CHARSXP on error.
+ */
+SEXP read_columns(hid_t group_id, SEXP columns, SEXP rmap, SEXP start, SEXP count, SEXP index) {
+  
+  R_xlen_t n_cols = XLENGTH(columns);
+  SEXP     result = PROTECT(allocVector(VECSXP, n_cols));
+  SEXP     errmsg = R_NilValue;
+  R_xlen_t n_rows = -1;
+  
+  for (R_xlen_t c = 0; c < n_cols && errmsg == R_NilValue; c++) {
+    
+    const char *col_name = Rf_translateCharUTF8(STRING_ELT(columns, c));
+    
+    hid_t dset_id = h5_dataset_open(group_id, col_name, 0);
+    if (dset_id < 0) { errmsg = errmsg_1("Failed to open column '%s'", col_name); break; }
+    
+    SEXP col = read_dataset(dset_id, rmap, col_name, start, count, index, R_NilValue, 0);
+    H5Dclose(dset_id);
+    
+    if (TYPEOF(col) == CHARSXP) { errmsg = col; break; }
+    
+    SET_VECTOR_ELT(result, c, col);
+    if (n_rows < 0 && col != R_NilValue) n_rows = XLENGTH(col);
+  }
+  if (n_rows < 0) n_rows = 0;
+  
+  if (errmsg != R_NilValue) { UNPROTECT(1); return errmsg; }
+  
+  /* Row names, read with the same row selection as the columns */
+  SEXP row_names = R_NilValue;
+  
+  if (H5Lexists(group_id, ROWNAMES_SCALE, H5P_DEFAULT) > 0) {
+    hid_t scale_id = H5Dopen2(group_id, ROWNAMES_SCALE, H5P_DEFAULT);
+    if (scale_id >= 0) {
+      row_names = read_dataset(scale_id, R_NilValue, ROWNAMES_SCALE, start, count, index, R_NilValue, 0);
+      H5Dclose(scale_id);
+      if (TYPEOF(row_names) != STRSXP || XLENGTH(row_names) != n_rows) row_names = R_NilValue; // # nocov
+    }
+  }
+  PROTECT(row_names);
+  
+  setAttrib(result, R_NamesSymbol, columns);
+  
+  SEXP class_attr = PROTECT(allocVector(STRSXP, 1));
+  SET_STRING_ELT(class_attr, 0, mkChar("data.frame"));
+  setAttrib(result, R_ClassSymbol, class_attr);
+  
+  if (row_names == R_NilValue) {
+    row_names = allocVector(INTSXP, 2);
+    INTEGER(row_names)[0] = NA_INTEGER;
+    INTEGER(row_names)[1] = -(int)n_rows;
+  }
+  setAttrib(result, R_RowNamesSymbol, row_names);
+  
+  UNPROTECT(3);
+  return result;
+}
+
+
+/* C implementation of h5_read() for a columnar data.frame group. */
+SEXP C_h5_read_columns(
+    SEXP filename, SEXP group_name, SEXP columns, SEXP rmap, 
+    SEXP start, SEXP count, SEXP index) {
+  
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename,   0));
+  const char *gname = Rf_translateCharUTF8(STRING_ELT(group_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+  
+  hid_t group_id = H5Gopen2(file_id, gname, H5P_DEFAULT);
+  if (group_id < 0) { h5_file_close(file_id); error("Failed to open group: %s", gname); }
+  
+  SEXP result = PROTECT(read_columns(group_id, columns, rmap, start, count, index));
+  
+  H5Gclose(group_id);
+  h5_file_close(file_id);
+  
+  if (TYPEOF(result) == CHARSXP) error("Error reading data.frame '%s'\n%s", gname, CHAR(result));
+  
+  UNPROTECT(1);
+  return result;
+}
+
+
+/*
+ * Writes `rownames` as the "_rownames" dimension scale of a columnar
+ * data.frame group, and attaches it to dimension 0 of every column.
+ */
+SEXP C_h5_write_rownames(SEXP filename, SEXP group_name, SEXP columns, SEXP rownames) {
+  
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename,   0));
+  const char *gname = Rf_translateCharUTF8(STRING_ELT(group_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+  
+  hid_t group_id = H5Gopen2(file_id, gname, H5P_DEFAULT);
+  if (group_id < 0) { h5_file_close(file_id); error("Failed to open group: %s", gname); }
+  
+  hid_t scale_id = -1;
+  
+  for (R_xlen_t c = 0; c < XLENGTH(columns); c++) {
+    
+    const char *col_name = Rf_translateCharUTF8(STRING_ELT(columns, c));
+    hid_t dset_id = H5Dopen2(group_id, col_name, H5P_DEFAULT);
+    if (dset_id < 0) continue; // # nocov
+    
+    if (scale_id < 0) {
+      write_single_scale(group_id, dset_id, ROWNAMES_SCALE, rownames, 0);
+      scale_id = H5Dopen2(group_id, ROWNAMES_SCALE, H5P_DEFAULT);
+    } else {
+      H5DSattach_scale(dset_id, scale_id, 0);
+    }
+    H5Dclose(dset_id);
+  }
+  
+  if (scale_id >= 0) H5Dclose(scale_id);
+  H5Gclose(group_id);
+  h5_file_close(file_id);
+  
+  return R_NilValue;
+}
@@ -33,9 +33,11 @@ return 1; /* Stop iteration after finding the first scale */
  * Reads Dimension Scales attached to a dataset and converts them into R 
  * dimnames (list of character vectors).
  */
-void read_r_dimscales(hid_t dset_id, int rank, SEXP result, hsize_t *offset, hsize_t *mem_dims) {
+void read_r_dimscales(hid_t dset_id, int rank, SEXP result, hsize_t *offset, hsize_t *mem_dims, 
+                      hsize_t **coords) {
   if (rank == 0) return; 
   
+  H5LITE_PROF_BEGIN(t0);
   SEXP dimnames_list = R_NilValue;
   int has_any_scale = 0;
   
@@ -60,11 +62,11 @@ void read_r_dimscales(hid_t dset_id, int rank, SEXP result, hsize_t *offset, hsi
         hid_t scale_mem_space = H5S_ALL;
         hsize_t total = 1;
         
-        /* Apply hyperslab to the 1D scale matching dimension i */
+        /* Apply the dataset's selection along dimension i to its 1D scale */
         if (offset != NULL && mem_dims != NULL && s_ndims == 1) {
           hsize_t s_offset[1] = { offset[i] };
           hsize_t s_count[1]  = { mem_dims[i] };
-          H5Sselect_hyperslab(space, H5S_SELECT_SET, s_offset, NULL, s_count, NULL);
+          h5_select_coords(space, 1, coords ? &coords[i] : NULL, s_offset, s_count);
           scale_mem_space = H5Screate_simple(1, s_count, NULL);
           total     = s_count[0];
           s_dims[0] = s_count[0];
@@ -97,6 +99,7 @@ void read_r_dimscales(hid_t dset_id, int rank, SEXP result, hsize_t *offset, hsi
     }
   }
   UNPROTECT(1); 
+  H5LITE_PROF_END(H5LITE_PROF_DIMSCALES, t0, 0, rank);
 }
 
 
@@ -0,0 +1,151 @@
+#include "h5lite.h"
+
+/*
+ * File format and file-space settings from h5_format().
+ *
+ * Settings come from the h5_format() object given to h5_open() or
+ * h5_create_file(), and getOption("h5lite.format") otherwise. The file-space
+ * strategy, page size and free-space tracking go on the file creation
+ * property list and are stored in the file, so they only take effect when a
+ * file is created. The format version bounds, metadata block size and page
+ * buffer go on the file access property list and apply whenever h5lite opens
+ * a file with these settings.
+ */
+
+
+static SEXP format_field(SEXP x, const char *name) {
+  SEXP names = getAttrib(x, R_NamesSymbol);
+  if (names == R_NilValue) return R_NilValue;
+  for (R_xlen_t i = 0; i < XLENGTH(x); i++)
+    if (strcmp(CHAR(STRING_ELT(names, i)), name) == 0) return VECTOR_ELT(x, i);
+  return R_NilValue;
+}
+
+static double format_number(SEXP x, const char *name) {
+  SEXP val = format_field(x, name);
+  if ((isReal(val) || isInteger(val)) && XLENGTH(val) == 1) return asReal(val);
+  return NA_REAL;
+}
+
+static const char *format_string(SEXP x, const char *name) {
+  SEXP val = format_field(x, name);
+  if (isString(val) && XLENGTH(val) == 1 && STRING_ELT(val, 0) != NA_STRING)
+    return CHAR(STRING_ELT(val, 0));
+  return "";
+}
+
+
+/*
+ * Fills `out` from an h5_format() object. Anything else - including NULL -
+ * leaves HDF5's defaults: the earliest format and no free-space tracking.
+ */
+void h5_format_parse(SEXP x, h5_format_t *out) {
+
+  out->libver   = -1;
+  out->strategy = -1;
+  out->persist  = 0;
+  out->threshold   = out->page_size = NA_REAL;
+  out->page_buffer = out->meta_block = NA_REAL;
+
+  if (TYPEOF(x) != VECSXP) return;
+
+  const char *libver = format_string(x, "libver");
+  if      (strcmp(libver, "v18")    == 0) out->libver = H5F_LIBVER_V18;
+  else if (strcmp(libver, "v110")   == 0) out->libver = H5F_LIBVER_V110;
+  else if (strcmp(libver, "latest") == 0) out->libver = H5F_LIBVER_LATEST;
+
+  const char *strategy = format_string(x, "strategy");
+  if      (strcmp(strategy, "paged")     == 0) out->strategy = H5F_FSPACE_STRATEGY_PAGE;
+  else if (strcmp(strategy, "aggregate") == 0) out->strategy = H5F_FSPACE_STRATEGY_AGGR;
+  else if (strcmp(strategy, "none")      == 0) out->strategy = H5F_FSPACE_STRATEGY_NONE;
+
+  SEXP persist = format_field(x, "persist");
+  out->persist = (isLogical(persist) && XLENGTH(persist) == 1 && LOGICAL(persist)[0] == TRUE);
+
+  out->threshold   = format_number(x, "threshold");
+  out->page_size   = format_number(x, "page_size");
+  out->page_buffer = format_number(x, "page_buffer");
+  out->meta_block  = format_number(x, "meta_block");
+}
+
+
+/*
+ * Builds a file creation property list from `fmt`, or from the h5lite.format
+ * option when `fmt` is NULL. Returns H5P_DEFAULT when nothing differs from
+ * HDF5's defaults; otherwise the caller closes the returned list.
+ */
+hid_t h5_fcpl(const h5_format_t *fmt) {
+
+  h5_format_t opt;
+  if (fmt == NULL) { h5_format_parse(GetOption1(install("h5lite.format")), &opt); fmt = &opt; }
+
+  if (fmt->strategy < 0 && !fmt->persist && ISNAN(fmt->threshold) && ISNAN(fmt->page_size))
+    return H5P_DEFAULT;
+
+  hid_t fcpl_id = H5Pcreate(H5P_FILE_CREATE);
+  if (fcpl_id < 0) return H5P_DEFAULT; // # nocov
+
+  H5F_fspace_strategy_t strategy = (fmt->strategy < 0) ? H5F_FSPACE_STRATEGY_FSM_AGGR : (H5F_fspace_strategy_t)fmt->strategy;
+  hsize_t threshold = ISNAN(fmt->threshold) ? 1 : (hsize_t)fmt->threshold;
+  H5Pset_file_space_strategy(fcpl_id, strategy, (hbool_t)fmt->persist, threshold);
+
+  if (!ISNAN(fmt->page_size))
+    H5Pset_file_space_page_size(fcpl_id, (hsize_t)fmt->page_size);
+
+  return fcpl_id;
+}
+
+
+/*
+ * Adds the access properties of `fmt` (or the h5lite.format option when
+ * NULL) to fapl_id, which may be H5P_DEFAULT. Returns fapl_id itself when
+ * there is nothing to add, else a list that the caller closes.
+ */
+hid_t h5_format_fapl(hid_t fapl_id, const h5_format_t *fmt) {
+
+  h5_format_t opt;
+  if (fmt == NULL) { h5_format_parse(GetOption1(install("h5lite.format")), &opt); fmt = &opt; }
+
+  if (fmt->libver < 0 && ISNAN(fmt->meta_block) && ISNAN(fmt->page_buffer))
+    return fapl_id;
+
+  if (fapl_id == H5P_DEFAULT) fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+  if (fapl_id < 0) return H5P_DEFAULT; // # nocov
+
+  if (fmt->libver >= 0)
+    H5Pset_libver_bounds(fapl_id, (H5F_libver_t)fmt->libver, H5F_LIBVER_LATEST);
+
+  if (!ISNAN(fmt->meta_block))
+    H5Pset_meta_block_size(fapl_id, (hsize_t)fmt->meta_block);
+
+  if (!ISNAN(fmt->page_buffer))
+    H5Pset_page_buffer_size(fapl_id, (size_t)fmt->page_buffer, 0, 0);
+
+  return fapl_id;
+}
+
+
+/*
+ * H5Fopen() for lists from h5_format_fapl(). HDF5 refuses a page buffer for
+ * files that were not created with paged aggregation, so a failed open is
+ * retried without one (which modifies fapl_id).
+ */
+hid_t h5_fopen(const char *fname, unsigned flags, hid_t fapl_id) {
+
+  size_t   page_buffer = 0;
+  unsigned min_meta, min_raw;
+  if (fapl_id != H5P_DEFAULT) H5Pget_page_buffer_size(fapl_id, &page_buffer, &min_meta, &min_raw);
+  if (page_buffer == 0) return H5Fopen(fname, flags, fapl_id);
+
+  H5E_auto2_t old_func;
+  void *old_client_data;
+  H5Eget_auto(H5E_DEFAULT, &old_func, &old_client_data);
+  H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+  hid_t file_id = H5Fopen(fname, flags, fapl_id);
+  H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
+  if (file_id >= 0) return file_id;
+
+  H5Pset_page_buffer_size(fapl_id, 0, 0, 0);
+  return H5Fopen(fname, flags, fapl_id);
+}
+
@@ -3,6 +3,7 @@
 
 #include <R.h>
 #include <Rinternals.h>
+#include <R_ext/Rdynload.h>
 #include <hdf5.h>
 #include <H5DSpublic.h> /* Dimension Scales */
 #include <limits.h>
@@ -12,6 +13,75 @@
 #include <math.h>
 #include <stdint.h>
 
+/* Default for getOption("h5lite.block_size"): 16 MiB of scratch per block. */
+#define H5LITE_BLOCK_BYTES ((size_t)16 * 1024 * 1024)
+
+/* Returned by h5_read_chunks() when the caller should use H5Dread() instead. */
+#define H5LITE_CHUNKS_FALLBACK 1
+
+/* Returned by write_rows() when a scratch buffer cannot be allocated. */
+#define H5LITE_WRITE_NOMEM ((herr_t)-2)
+
+/* Attribute recording the h5_compression(access = ) hint of a dataset. */
+#define H5LITE_ACCESS_ATTR "h5lite_access"
+
+/* Attribute naming the pipeline that h5_compression("auto") picked. */
+#define H5LITE_COMPRESS_ATTR "h5lite_compress"
+
+/* Attribute holding the column order of a columnar data.frame group. */
+#define H5LITE_COLUMNS_ATTR "h5lite_columns"
+
+/* Attribute holding the strings of a dataset written with as = "dict". */
+#define H5LITE_DICT_ATTR "h5lite_dict"
+
+/* Growth increment of in-memory files held by the core driver: 1 MiB. */
+#define H5LITE_CORE_INCREMENT ((size_t)1024 * 1024)
+
+/* Times a stage for h5_profile(): a single branch while profiling is off. */
+#define H5LITE_PROF_BEGIN(t) double t = h5_profiling ? h5_prof_now() : 0
+#define H5LITE_PROF_END(stage, t, bytes, elements) \
+  do { if (h5_profiling) h5_prof_add((stage), (t), (double)(bytes), (double)(elements)); } while (0)
+
+typedef enum {
+  H5LITE_ACCESS_BALANCED,
+  H5LITE_ACCESS_ROW,
+  H5LITE_ACCESS_COLUMN,
+  H5LITE_ACCESS_CUSTOM
+} h5_access_t;
+
+/* Stages counted by h5_profile(). Keep in sync with stage_names in profile.c. */
+typedef enum {
+  H5LITE_PROF_OPEN,
+  H5LITE_PROF_META,
+  H5LITE_PROF_READ,
+  H5LITE_PROF_WRITE,
+  H5LITE_PROF_TRANSPOSE,
+  H5LITE_PROF_COERCE,
+  H5LITE_PROF_STRINGS,
+  H5LITE_PROF_DIMSCALES,
+  H5LITE_PROF_N
+} h5_stage_t;
+
+/* Parsed h5_cache() settings. NA fields keep HDF5's defaults ("auto" for chunk_bytes). */
+typedef struct {
+  double chunk_bytes;
+  double chunk_slots;
+  double preempt;
+  double meta_bytes;
+  double sieve_bytes;
+} h5_cache_t;
+
+/* Parsed h5_format() settings. Negative and NA fields keep HDF5's defaults. */
+typedef struct {
+  int    libver;      /* Lower H5F_libver_t bound */
+  int    strategy;    /* H5F_fspace_strategy_t */
+  int    persist;
+  double threshold;
+  double page_size;
+  double page_buffer;
+  double meta_block;
+} h5_format_t;
+
 /* For mapping the user's `as` argument. */
 typedef enum {
   R_TYPE_NOMATCH,
@@ -33,6 +103,45 @@ typedef struct {
   int show_scales;
 } h5_op_data_t;
 
+/* Table of CHARSXPs already made by a string read. See h5_mkchar(). */
+typedef struct {
+  SEXP     *slots;
+  uint32_t *hashes;
+  size_t    mask;
+  size_t    used;
+  size_t    lookups;
+  size_t    hits;
+  int       active;
+} h5_strtab_t;
+
+/* How pack_rows() copies a data.frame column into compound records. */
+typedef enum {
+  H5_PACK_NONE,
+  H5_PACK_1,              /* raw */
+  H5_PACK_4,              /* integer, logical, factor */
+  H5_PACK_8,              /* double, integer64 */
+  H5_PACK_INT_AS_DOUBLE,  /* integer or logical written as a float */
+  H5_PACK_COMPLEX,
+  H5_PACK_FIXED_STR,
+  H5_PACK_VLEN_STR
+} h5_pack_t;
+
+/* A data.frame's compound types and record layout. See pack_dataframe(). */
+typedef struct {
+  hid_t      file_type_id;
+  hid_t      mem_type_id;
+  R_xlen_t   n_cols;
+  R_xlen_t   n_rows;
+  size_t     row_size;  /* Bytes per record in memory */
+  SEXP      *cols;
+  size_t    *offsets;   /* Of each member within a record */
+  size_t    *widths;    /* Of fixed-length string members, else 0 */
+  h5_pack_t *kinds;
+} h5_df_pack_t;
+
+/* Fills rows [r0, r0 + n) of a blocked write into buf. See write_rows(). */
+typedef int (*write_fill_t)(void *ctx, void *buf, hsize_t r0, hsize_t n);
+
 /* Callback data struct for finding the first attached scale */
 typedef struct {
   hid_t scale_id;
@@ -40,28 +149,63 @@ typedef struct {
 } scale_visitor_t;
 
 
+/* --- apply.c --- */
+SEXP C_h5_cursor_open(SEXP filename, SEXP dataset_name, SEXP block);
+SEXP C_h5_cursor_read(SEXP ptr, SEXP rmap, SEXP element_name, SEXP start, SEXP count);
+SEXP C_h5_cursor_close(SEXP ptr);
+
+/* --- cache.c --- */
+void  h5_cache_parse(SEXP x, h5_cache_t *out);
+hid_t h5_fapl(const h5_cache_t *cfg);
+hid_t h5_dataset_open(hid_t loc_id, const char *name, int axis);
+
+/* --- chunks.c --- */
+herr_t h5_read_chunks(hid_t dset_id, hid_t mem_type_id, size_t el_size, void *dest,
+                      int ndims, hsize_t *dims, hid_t file_space_id);
+herr_t h5_write_chunks(hid_t dset_id, hid_t mem_type_id, int ndims, hsize_t *dims,
+                       const void *buf, int n_threads);
+
+/* --- compress.c --- */
+SEXP C_h5_compress_trial(SEXP data, SEXP dtype, SEXP dims, SEXP candidates, SEXP sample_bytes);
+
 /* --- data.frame.c --- */
 SEXP read_data_frame(
     hid_t obj_id, int is_dataset, hid_t file_type_id, hid_t space_id, SEXP rmap, 
-    hid_t mem_space_id, hid_t file_space_id, hsize_t *offset, hsize_t *mem_dims);
+    hid_t mem_space_id, hid_t file_space_id, hsize_t *offset, hsize_t *mem_dims, hsize_t **coords, 
+    SEXP cols);
+SEXP pack_dataframe(SEXP data, SEXP dtypes, const char *obj_name, h5_df_pack_t *pack);
+int  pack_rows(void *ctx, void *buf, hsize_t r0, hsize_t n);
 SEXP write_dataframe(
     hid_t file_id, hid_t loc_id, const char *obj_name, SEXP data, 
     SEXP dtypes, SEXP compress, int is_attribute);
+SEXP read_columns(hid_t group_id, SEXP columns, SEXP rmap, SEXP start, SEXP count, SEXP index);
+SEXP C_h5_read_columns(
+    SEXP filename, SEXP group_name, SEXP columns, SEXP rmap, 
+    SEXP start, SEXP count, SEXP index);
+SEXP C_h5_write_rownames(SEXP filename, SEXP group_name, SEXP columns, SEXP rownames);
 
 /* --- dimscales.c --- */
 herr_t visitor_find_scale(hid_t dset, unsigned dim, hid_t scale, void *visitor_data);
 void set_r_dimensions(SEXP result, int ndims, hsize_t *dims);
-void read_r_dimscales(hid_t dset_id, int rank, SEXP result, hsize_t *offset, hsize_t *mem_dims);
+void read_r_dimscales(hid_t dset_id, int rank, SEXP result, hsize_t *offset, hsize_t *mem_dims, 
+                      hsize_t **coords);
 void write_r_dimscales(hid_t loc_id, hid_t dset_id, const char *dname, SEXP data);
 void write_single_scale(hid_t loc_id, hid_t dset_id, const char *scale_name, SEXP labels, unsigned int dim_idx);
 
+/* --- format.c --- */
+void  h5_format_parse(SEXP x, h5_format_t *out);
+hid_t h5_fcpl(const h5_format_t *fmt);
+hid_t h5_format_fapl(hid_t fapl_id, const h5_format_t *fmt);
+hid_t h5_fopen(const char *fname, unsigned flags, hid_t fapl_id);
+
 /* --- inspect.c --- */
-SEXP C_h5_inspect(SEXP filename, SEXP dset_name);
+SEXP C_h5_inspect(SEXP filename, SEXP dset_name, SEXP chunks);
 
 /* --- info.c --- */
 SEXP h5_type_to_rstr(hid_t type_id);
 SEXP C_h5_typeof(SEXP filename, SEXP dset_name);
 SEXP C_h5_typeof_attr(SEXP filename, SEXP obj_name, SEXP attr_name);
+SEXP C_h5_member_types(SEXP filename, SEXP dset_name);
 SEXP C_h5_dim(SEXP filename, SEXP dset_name);
 SEXP C_h5_dim_attr(SEXP filename, SEXP obj_name, SEXP attr_name);
 SEXP C_h5_exists(SEXP filename, SEXP obj_name, SEXP attr_name);
@@ -70,20 +214,59 @@ SEXP C_h5_is_dataset(SEXP filename, SEXP name);
 SEXP C_h5_names(SEXP filename, SEXP dset_name, SEXP attr_name);
 SEXP C_h5_attr_names(SEXP filename, SEXP obj_name);
 
+/* --- lazy.c --- */
+SEXP h5_read_lazy(const char *fname, const char *dname, hid_t dset_id, SEXP rmap, const char *el_name);
+SEXP C_h5_read_lazy(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name);
+void h5_lazy_init(DllInfo *dll);
+
 /* --- ls.c --- */
 SEXP C_h5_str(SEXP filename, SEXP obj_name, SEXP attrs, SEXP members, SEXP markup);
 SEXP C_h5_ls(SEXP filename, SEXP group_name, SEXP recursive, SEXP full_names, SEXP scales);
 
+/* --- mmap.c --- */
+SEXP h5_read_mmap(const char *fname, hid_t file_id, hid_t dset_id, SEXP rmap, const char *el_name);
+SEXP C_h5_read_mmap(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name);
+void h5_mmap_init(DllInfo *dll);
+
+/* --- open.c --- */
+char *h5_canonical_path(const char *fname);
+hid_t h5_file_open(const char *fname, unsigned flags);
+hid_t h5_file_cached(const char *fname, unsigned flags);
+int   h5_handle_cache(hid_t loc_id, h5_cache_t *out);
+herr_t h5_file_close(hid_t file_id);
+int   h5_file_is_memory(const char *fname);
+SEXP C_h5_open(SEXP filename, SEXP readonly, SEXP cache, SEXP format, SEXP image);
+SEXP C_h5_close(SEXP ptr);
+SEXP C_h5_flush(SEXP ptr);
+SEXP C_h5_is_memory(SEXP filename);
+SEXP C_h5_serialize(SEXP filename);
+
 /* --- organize.c --- */
 SEXP C_h5_create_group(SEXP filename, SEXP group_name);
+SEXP C_h5_create_file(SEXP filename, SEXP format);
 SEXP C_h5_move(SEXP filename, SEXP from_name, SEXP to_name);
+SEXP C_h5_copy(SEXP from_file, SEXP from_name, SEXP to_file, SEXP to_name);
+SEXP C_h5_repack(SEXP filename, SEXP dset_name, SEXP compress);
 SEXP C_h5_delete(SEXP filename, SEXP name);
 SEXP C_h5_delete_attr(SEXP filename, SEXP obj_name, SEXP attr_name);
 
+/* --- profile.c --- */
+extern int h5_profiling;
+void   h5_profile_refresh(void);
+double h5_prof_now(void);
+void   h5_prof_add(h5_stage_t stage, double since, double bytes, double elements);
+void   h5_prof_io(h5_stage_t stage, double since, hid_t obj_id, hid_t mem_type_id, hid_t mem_space_id);
+SEXP   C_h5_profile_counters(SEXP reset);
+
 /* --- read.c --- */
+SEXP read_dataset(hid_t dset_id, SEXP rmap, const char *el_name, SEXP start, SEXP count, 
+                  SEXP index, SEXP cols, int scales);
 SEXP C_h5_read_dataset(
-    SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name, SEXP start, SEXP count);
+    SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name, SEXP start, SEXP count, 
+    SEXP index, SEXP cols);
 SEXP C_h5_read_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP rmap);
+SEXP C_h5_read_attributes(SEXP filename, SEXP obj_name, SEXP rmap);
+SEXP C_h5_read_group(SEXP filename, SEXP group_name, SEXP rmap, SEXP attr_rmap, SEXP mmap, SEXP lazy);
 SEXP read_character(
     hid_t loc_id, int is_dataset, hid_t file_type_id, hid_t space_id, int ndims, hsize_t *dims, 
     hsize_t total_elements, hid_t mem_space_id, hid_t file_space_id);
@@ -94,23 +277,45 @@ SEXP errmsg_2(const char *fmt, const char *str1, const char *str2);
 SEXP errmsg_3(const char *fmt, const char *str1, const char *str2, const char *str3);
 void *get_R_data_ptr(SEXP data);
 size_t get_R_el_size(SEXP data);
+size_t h5_block_bytes(void);
+int h5_threads(void);
+h5_access_t h5_access_hint(hid_t dset_id);
+void h5_strtab_init(h5_strtab_t *tab, R_xlen_t n);
+SEXP h5_mkchar(h5_strtab_t *tab, const char *str, size_t len);
+herr_t h5_select_coords(hid_t space_id, int rank, hsize_t **coords, const hsize_t *offset, 
+                        const hsize_t *count);
 void h5_transpose(void *src, void *dest, int rank, hsize_t *dims, size_t el_size, int direction_to_r);
+void h5_transpose_slab(void *c_buf, void *r_buf, int rank, hsize_t *dims, size_t el_size,
+                       hsize_t start, hsize_t count, int direction_to_r);
 R_TYPE rtype_from_map(hid_t file_type_id, SEXP rmap, const char *el_name);
+int rmap_is_factor(SEXP rmap, const char *el_name);
+int h5_int_in_range(hid_t type_id);
 SEXP coerce_to_rtype(SEXP data, R_TYPE rtype, hid_t file_type_id);
 
 /* --- write.c --- */
 SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SEXP dims, SEXP compress);
 SEXP C_h5_write_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP data, SEXP dtype, SEXP dims);
+SEXP C_h5_write_attributes(SEXP filename, SEXP obj_name, SEXP attrs);
+SEXP C_h5_append_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SEXP dims, SEXP compress);
+SEXP C_h5_write_batch(SEXP filename, SEXP ops);
 SEXP write_atomic_dataset(hid_t obj_id, SEXP data, const char *dtype_str, int rank, hsize_t *h5_dims);
+SEXP write_atomic_selection(hid_t obj_id, SEXP data, const char *dtype_str, int rank, hsize_t *h5_dims, 
+                            hid_t file_space_id, int n_threads);
+herr_t write_rows(hid_t obj_id, hid_t mem_type_id, int rank, hsize_t *h5_dims, size_t row_bytes,
+                  hid_t file_space_id, int n_threads, write_fill_t fill, void *ctx);
 
 /* --- write_utils.c --- */
 void apply_compression(hid_t dcpl_id, hid_t type_id, int rank, hsize_t *chunk_dims, SEXP compress);
-hid_t open_or_create_file(const char *fname);
+hid_t open_or_create_file(const char *fname, const h5_cache_t *cache, const h5_format_t *format);
 hid_t create_dataspace(SEXP dims, SEXP data, int *out_rank, hsize_t **out_h5_dims);
 herr_t handle_overwrite(hid_t file_id, const char *name);
 herr_t handle_attribute_overwrite(hid_t file_id, hid_t obj_id, const char *attr_name);
 herr_t write_buffer_to_object(hid_t obj_id, hid_t mem_type_id, void *buffer);
 void calculate_chunk_dims(int rank, const hsize_t *dims, size_t type_size, SEXP compress, hsize_t *out_chunk_dims);
+int compress_threads(SEXP compress);
+int compress_is_plain(SEXP compress);
+void write_access_hint(hid_t dset_id, int rank, SEXP compress);
+void write_auto_choice(hid_t dset_id, SEXP compress);
 hid_t create_r_memory_type(SEXP data, const char *dtype);
 hid_t create_h5_file_type(SEXP data, const char *dtype);
 hid_t create_string_type(const char *dtype);
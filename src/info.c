@@ -86,12 +86,12 @@ SEXP C_h5_typeof(SEXP filename, SEXP dset_name) {
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t dset_id = H5Dopen2(file_id, dname, H5P_DEFAULT);
   if (dset_id < 0) { // # nocov start
-    H5Fclose(file_id);
+    h5_file_close(file_id);
     error("Failed to open dataset: %s", dname);
   } // # nocov end
   
@@ -102,14 +102,14 @@ SEXP C_h5_typeof(SEXP filename, SEXP dset_name) {
   H5S_class_t space_class = H5Sget_simple_extent_type(space_id);
   H5Sclose(space_id);
   if (space_class == H5S_NULL) {
-    H5Dclose(dset_id); H5Fclose(file_id);
+    H5Dclose(dset_id); h5_file_close(file_id);
     return mkString("null");
   }
   
   hid_t type_id = H5Dget_type(dset_id);
   SEXP  result  = h5_type_to_rstr(type_id);
   
-  H5Tclose(type_id); H5Dclose(dset_id); H5Fclose(file_id);
+  H5Tclose(type_id); H5Dclose(dset_id); h5_file_close(file_id);
   return result;
 }
 
@@ -121,12 +121,12 @@ SEXP C_h5_typeof_attr(SEXP filename, SEXP obj_name, SEXP attr_name) {
   const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
   const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t attr_id = H5Aopen_by_name(file_id, oname, aname, H5P_DEFAULT, H5P_DEFAULT);
   if (attr_id < 0) { // # nocov start
-    H5Fclose(file_id);
+    h5_file_close(file_id);
     error("Failed to open attribute: %s", aname);
   } // # nocov end
   
@@ -135,14 +135,58 @@ SEXP C_h5_typeof_attr(SEXP filename, SEXP obj_name, SEXP attr_name) {
   H5S_class_t space_class = H5Sget_simple_extent_type(space_id);
   H5Sclose(space_id);
   if (space_class == H5S_NULL) {
-    H5Aclose(attr_id); H5Fclose(file_id);
+    H5Aclose(attr_id); h5_file_close(file_id);
     return mkString("null");
   }
   
   hid_t type_id = H5Aget_type(attr_id);
   SEXP  result  = h5_type_to_rstr(type_id);
   
-  H5Tclose(type_id); H5Aclose(attr_id); H5Fclose(file_id);
+  H5Tclose(type_id); H5Aclose(attr_id); h5_file_close(file_id);
+  return result;
+}
+
+/* --- MEMBER TYPES OF A COMPOUND DATASET --- */
+/*
+ * Returns a named character vector with the h5_typeof() string of each member
+ * of a compound dataset, or NULL for non-compound datasets.
+ */
+SEXP C_h5_member_types(SEXP filename, SEXP dset_name) {
+  
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+  
+  hid_t dset_id = H5Dopen2(file_id, dname, H5P_DEFAULT);
+  if (dset_id < 0) { // # nocov start
+    h5_file_close(file_id);
+    error("Failed to open dataset: %s", dname);
+  } // # nocov end
+  
+  hid_t type_id = H5Dget_type(dset_id);
+  SEXP  result  = R_NilValue;
+  
+  if (H5Tget_class(type_id) == H5T_COMPOUND) {
+    int n_members = H5Tget_nmembers(type_id);
+    result = PROTECT(allocVector(STRSXP, n_members));
+    SEXP names = PROTECT(allocVector(STRSXP, n_members));
+    
+    for (int i = 0; i < n_members; i++) {
+      hid_t member_id = H5Tget_member_type(type_id, i);
+      char *name      = H5Tget_member_name(type_id, i);
+      SET_STRING_ELT(result, i, STRING_ELT(h5_type_to_rstr(member_id), 0));
+      SET_STRING_ELT(names,  i, mkCharCE(name, CE_UTF8));
+      H5free_memory(name);
+      H5Tclose(member_id);
+    }
+    
+    setAttrib(result, R_NamesSymbol, names);
+    UNPROTECT(2);
+  }
+  
+  H5Tclose(type_id); H5Dclose(dset_id); h5_file_close(file_id);
   return result;
 }
 
@@ -152,12 +196,12 @@ SEXP C_h5_dim(SEXP filename, SEXP dset_name) {
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t dset_id = H5Dopen2(file_id, dname, H5P_DEFAULT);
   if (dset_id < 0) { // # nocov start
-    H5Fclose(file_id);
+    h5_file_close(file_id);
     error("Failed to open dataset: %s", dname);
   } // # nocov end
   
@@ -166,7 +210,7 @@ SEXP C_h5_dim(SEXP filename, SEXP dset_name) {
   int   ndims    = H5Sget_simple_extent_ndims(space_id);
   
   if (ndims < 0) { // # nocov start
-    H5Tclose(type_id); H5Sclose(space_id); H5Dclose(dset_id); H5Fclose(file_id);
+    H5Tclose(type_id); H5Sclose(space_id); H5Dclose(dset_id); h5_file_close(file_id);
     error("Failed to get dataset space: %s", dname);
   } // # nocov end
   
@@ -198,7 +242,7 @@ SEXP C_h5_dim(SEXP filename, SEXP dset_name) {
     }
   }
   
-  H5Tclose(type_id); H5Sclose(space_id); H5Dclose(dset_id); H5Fclose(file_id);
+  H5Tclose(type_id); H5Sclose(space_id); H5Dclose(dset_id); h5_file_close(file_id);
   UNPROTECT(1);
   return result;
 }
@@ -210,18 +254,18 @@ SEXP C_h5_dim_attr(SEXP filename, SEXP obj_name, SEXP attr_name) {
   const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
   const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t attr_id = H5Aopen_by_name(file_id, oname, aname, H5P_DEFAULT, H5P_DEFAULT);
-  if (attr_id < 0) { H5Fclose(file_id); error("Failed to open attribute: %s", aname); }
+  if (attr_id < 0) { h5_file_close(file_id); error("Failed to open attribute: %s", aname); }
   
   hid_t space_id = H5Aget_space(attr_id);
   hid_t type_id  = H5Aget_type(attr_id);
   int   ndims    = H5Sget_simple_extent_ndims(space_id);
   
   if (ndims < 0) { // # nocov start
-    H5Tclose(type_id); H5Sclose(space_id); H5Aclose(attr_id); H5Fclose(file_id);
+    H5Tclose(type_id); H5Sclose(space_id); H5Aclose(attr_id); h5_file_close(file_id);
     error("Failed to get attribute space: %s", aname);
   } // # nocov end
   
@@ -245,7 +289,7 @@ SEXP C_h5_dim_attr(SEXP filename, SEXP obj_name, SEXP attr_name) {
     }
   }
   
-  H5Tclose(type_id); H5Sclose(space_id); H5Aclose(attr_id); H5Fclose(file_id);
+  H5Tclose(type_id); H5Sclose(space_id); H5Aclose(attr_id); h5_file_close(file_id);
   UNPROTECT(1);
   return result;
 }
@@ -271,7 +315,7 @@ SEXP C_h5_exists(SEXP filename, SEXP obj_name, SEXP attr_name) {
   htri_t result = 0; // Default to FALSE
   
   /* Try to open the file. */
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   
   if (file_id >= 0) { /* File is valid HDF5 */
   if (attr_name != R_NilValue) { /* Check if the attribute exists */
@@ -281,7 +325,7 @@ SEXP C_h5_exists(SEXP filename, SEXP obj_name, SEXP attr_name) {
   else { /* Check if the link exists (dataset, group, etc.) */
   result = H5Lexists(file_id, oname, H5P_DEFAULT);
   }
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   }
   
   /* Restore error handler */
@@ -293,7 +337,7 @@ SEXP C_h5_exists(SEXP filename, SEXP obj_name, SEXP attr_name) {
 /* --- HELPER: Check object type --- */
 static int check_obj_type(const char *fname, const char *oname, H5O_type_t check_type) {
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) return 0;
   
   int result = 0;
@@ -317,7 +361,7 @@ static int check_obj_type(const char *fname, const char *oname, H5O_type_t check
     }
   }
   
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   return result;
 }
 
@@ -348,7 +392,7 @@ SEXP C_h5_names(SEXP filename, SEXP dset_name, SEXP attr_name ) {
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t loc_id;
@@ -359,12 +403,12 @@ SEXP C_h5_names(SEXP filename, SEXP dset_name, SEXP attr_name ) {
   if (attr_name != R_NilValue) {
     const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
     loc_id = H5Aopen_by_name(file_id, dname, aname, H5P_DEFAULT, H5P_DEFAULT);
-    if (loc_id < 0) { H5Fclose(file_id); error("Failed to open attribute: %s", aname); }
+    if (loc_id < 0) { h5_file_close(file_id); error("Failed to open attribute: %s", aname); }
     type_id = H5Aget_type(loc_id);
     is_dataset = 0; /* Attributes cannot have Dimension Scales */
   } else {
     loc_id = H5Dopen2(file_id, dname, H5P_DEFAULT);
-    if (loc_id < 0) { H5Fclose(file_id); error("Failed to open dataset: %s", dname); }
+    if (loc_id < 0) { h5_file_close(file_id); error("Failed to open dataset: %s", dname); }
     type_id = H5Dget_type(loc_id);
     is_dataset = 1;
   }
@@ -442,7 +486,7 @@ SEXP C_h5_names(SEXP filename, SEXP dset_name, SEXP attr_name ) {
   H5Tclose(type_id);
   if (attr_name != R_NilValue) { H5Aclose(loc_id); }
   else                         { H5Dclose(loc_id); }
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   /* --- Return --- */
   if (result != R_NilValue) UNPROTECT(1);
@@ -474,17 +518,17 @@ SEXP C_h5_attr_names(SEXP filename, SEXP obj_name) {
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t obj_id = H5Oopen(file_id, oname, H5P_DEFAULT);
-  if (obj_id < 0) { H5Fclose(file_id); error("Failed to open object: %s", oname); }
+  if (obj_id < 0) { h5_file_close(file_id); error("Failed to open object: %s", oname); }
   
   /* Get the number of attributes on the object. */
   H5O_info_t oinfo;
   herr_t     status = H5Oget_info(obj_id, &oinfo, H5O_INFO_NUM_ATTRS);
   if (status < 0) { // # nocov start
-    H5Oclose(obj_id); H5Fclose(file_id);
+    H5Oclose(obj_id); h5_file_close(file_id);
     error("Failed to get object info");
   } // # nocov end
   
@@ -503,7 +547,7 @@ SEXP C_h5_attr_names(SEXP filename, SEXP obj_name) {
   }
   
   H5Oclose(obj_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   UNPROTECT(1);
   return result;
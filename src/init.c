@@ -28,9 +28,22 @@ static const R_CallMethodDef CallEntries[] = {
   {"C_register_hdf5_filters", (DL_FUNC) &C_register_hdf5_filters, 0},
   {"C_destroy_hdf5_filters",  (DL_FUNC) &C_destroy_hdf5_filters,  0},
   
+  /* apply.c */
+  {"C_h5_cursor_open",  (DL_FUNC) &C_h5_cursor_open, 3},
+  {"C_h5_cursor_read",  (DL_FUNC) &C_h5_cursor_read, 5},
+  {"C_h5_cursor_close", (DL_FUNC) &C_h5_cursor_close, 1},
+  
+  /* compress.c */
+  {"C_h5_compress_trial", (DL_FUNC) &C_h5_compress_trial, 5},
+  
+  /* data.frame.c */
+  {"C_h5_read_columns",   (DL_FUNC) &C_h5_read_columns, 7},
+  {"C_h5_write_rownames", (DL_FUNC) &C_h5_write_rownames, 4},
+  
   /* info.c */
   {"C_h5_typeof",      (DL_FUNC) &C_h5_typeof, 2},
   {"C_h5_typeof_attr", (DL_FUNC) &C_h5_typeof_attr, 3},
+  {"C_h5_member_types", (DL_FUNC) &C_h5_member_types, 2},
   {"C_h5_dim",         (DL_FUNC) &C_h5_dim, 2},
   {"C_h5_dim_attr",    (DL_FUNC) &C_h5_dim_attr, 3},
   {"C_h5_exists",      (DL_FUNC) &C_h5_exists, 3},
@@ -40,25 +53,49 @@ static const R_CallMethodDef CallEntries[] = {
   {"C_h5_attr_names",  (DL_FUNC) &C_h5_attr_names, 2},
   
   /* inspect.c */
-  {"C_h5_inspect",     (DL_FUNC) &C_h5_inspect, 2},
+  {"C_h5_inspect",     (DL_FUNC) &C_h5_inspect, 3},
+  
+  /* lazy.c */
+  {"C_h5_read_lazy", (DL_FUNC) &C_h5_read_lazy, 4},
   
   /* ls.c */
   {"C_h5_str", (DL_FUNC) &C_h5_str, 5},
   {"C_h5_ls",  (DL_FUNC) &C_h5_ls, 5},
   
+  /* open.c */
+  {"C_h5_open",      (DL_FUNC) &C_h5_open, 5},
+  {"C_h5_close",     (DL_FUNC) &C_h5_close, 1},
+  {"C_h5_flush",     (DL_FUNC) &C_h5_flush, 1},
+  {"C_h5_is_memory", (DL_FUNC) &C_h5_is_memory, 1},
+  {"C_h5_serialize", (DL_FUNC) &C_h5_serialize, 1},
+  
+  /* mmap.c */
+  {"C_h5_read_mmap", (DL_FUNC) &C_h5_read_mmap, 4},
+  
   /* organize.c */
   {"C_h5_create_group", (DL_FUNC) &C_h5_create_group, 2},
+  {"C_h5_create_file",  (DL_FUNC) &C_h5_create_file, 2},
   {"C_h5_move",         (DL_FUNC) &C_h5_move, 3},
+  {"C_h5_copy",         (DL_FUNC) &C_h5_copy, 4},
+  {"C_h5_repack",       (DL_FUNC) &C_h5_repack, 3},
   {"C_h5_delete",       (DL_FUNC) &C_h5_delete, 2},
   {"C_h5_delete_attr",  (DL_FUNC) &C_h5_delete_attr, 3},
   
+  /* profile.c */
+  {"C_h5_profile_counters", (DL_FUNC) &C_h5_profile_counters, 1},
+  
   /* read.c */
-  {"C_h5_read_dataset",   (DL_FUNC) &C_h5_read_dataset, 6},
-  {"C_h5_read_attribute", (DL_FUNC) &C_h5_read_attribute, 4},
+  {"C_h5_read_dataset",    (DL_FUNC) &C_h5_read_dataset, 8},
+  {"C_h5_read_attribute",  (DL_FUNC) &C_h5_read_attribute, 4},
+  {"C_h5_read_attributes", (DL_FUNC) &C_h5_read_attributes, 3},
+  {"C_h5_read_group",      (DL_FUNC) &C_h5_read_group, 6},
   
   /* write.c */
-  {"C_h5_write_dataset",   (DL_FUNC) &C_h5_write_dataset, 6},
-  {"C_h5_write_attribute", (DL_FUNC) &C_h5_write_attribute, 6},
+  {"C_h5_write_dataset",    (DL_FUNC) &C_h5_write_dataset, 6},
+  {"C_h5_write_attribute",  (DL_FUNC) &C_h5_write_attribute, 6},
+  {"C_h5_write_attributes", (DL_FUNC) &C_h5_write_attributes, 3},
+  {"C_h5_append_dataset",   (DL_FUNC) &C_h5_append_dataset, 6},
+  {"C_h5_write_batch",      (DL_FUNC) &C_h5_write_batch, 2},
   
   {NULL, NULL, 0}
 };
@@ -67,8 +104,11 @@ static const R_CallMethodDef CallEntries[] = {
  * This function is called by R when the package is loaded.
  * It registers the C functions defined in CallEntries with R's dynamic loading system.
  * R_useDynamicSymbols(dll, FALSE) tells R that we are providing an explicit registration list.
+ * The ALTREP classes for memory-mapped and lazy reads are registered here too.
  */
 void R_init_h5lite(DllInfo *dll) {
   R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
   R_useDynamicSymbols(dll, FALSE);
+  h5_mmap_init(dll);
+  h5_lazy_init(dll);
 }
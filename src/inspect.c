@@ -59,26 +59,153 @@ static const char* get_filter_name(H5Z_filter_t filter_id) {
 }
 
 
+/* --- CHUNK STATISTICS --- */
+
+/* Columns of the per-chunk data.frame, filled in storage order. */
+typedef struct {
+  int      rank;
+  R_xlen_t n, i;
+  double   chunk_bytes;   /* Uncompressed size of a (full) chunk */
+  double  *start[H5S_MAX_RANK];
+  double  *addr, *size, *ratio;
+  int     *mask;
+} chunk_stats_t;
+
+static void record_chunk(chunk_stats_t *ctx, const hsize_t *offset, unsigned mask, haddr_t addr, hsize_t size) {
+  R_xlen_t i = ctx->i++;
+  for (int d = 0; d < ctx->rank; d++) ctx->start[d][i] = (double)offset[d] + 1;
+  ctx->addr[i]  = (double)addr;
+  ctx->size[i]  = (double)size;
+  ctx->ratio[i] = (size > 0) ? ctx->chunk_bytes / (double)size : NA_REAL;
+  ctx->mask[i]  = (int)mask;
+}
+
+#if H5_VERSION_GE(1, 14, 1)
+static int chunk_iter_cb(const hsize_t *offset, unsigned mask, haddr_t addr, hsize_t size, void *op_data) {
+  chunk_stats_t *ctx = (chunk_stats_t *)op_data;
+  if (ctx->i >= ctx->n) return H5_ITER_STOP; // # nocov
+  record_chunk(ctx, offset, mask, addr, size);
+  return H5_ITER_CONT;
+}
+#endif
+
+
+/*
+ * Returns a data.frame with one row per allocated chunk of dset_id - its
+ * 1-based start along each chunk dimension, file address, stored size,
+ * compression ratio and filter mask - and sets `n_grid` to the number of
+ * chunks the dataset's extent spans, allocated or not.
+ *
+ * H5Dchunk_iter() walks the chunk index once, where looking chunks up one
+ * by one with H5Dget_chunk_info() costs a search per chunk; the latter is
+ * only used with HDF5 releases that lack it.
+ */
+static SEXP inspect_chunks(hid_t dset_id, hid_t dcpl_id, double *n_grid) {
+  
+  hid_t space_id = H5Dget_space(dset_id);
+  hid_t type_id  = H5Dget_type(dset_id);
+  int   rank     = H5Sget_simple_extent_ndims(space_id);
+  
+  hsize_t dims[H5S_MAX_RANK], chunk[H5S_MAX_RANK];
+  H5Sget_simple_extent_dims(space_id, dims, NULL);
+  H5Pget_chunk(dcpl_id, rank, chunk);
+  
+  chunk_stats_t ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.rank        = rank;
+  ctx.chunk_bytes = (double)H5Tget_size(type_id);
+  H5Tclose(type_id);
+  
+  *n_grid = 1;
+  for (int d = 0; d < rank; d++) {
+    ctx.chunk_bytes *= (double)chunk[d];
+    *n_grid         *= (chunk[d] > 0) ? (double)((dims[d] + chunk[d] - 1) / chunk[d]) : 0;
+  }
+  
+  hsize_t n_chunks = 0;
+  if (H5Dget_num_chunks(dset_id, space_id, &n_chunks) < 0) n_chunks = 0; // # nocov
+  ctx.n = (R_xlen_t)n_chunks;
+  
+  int  n_cols = rank + 4;
+  SEXP result = PROTECT(allocVector(VECSXP, n_cols));
+  SEXP names  = PROTECT(allocVector(STRSXP, n_cols));
+  
+  for (int d = 0; d < rank; d++) {
+    char col[32];
+    snprintf(col, sizeof(col), "start_%d", d + 1);
+    SET_VECTOR_ELT(result, d, allocVector(REALSXP, ctx.n));
+    SET_STRING_ELT(names,  d, mkChar(col));
+    ctx.start[d] = REAL(VECTOR_ELT(result, d));
+  }
+  SET_VECTOR_ELT(result, rank,     allocVector(REALSXP, ctx.n)); SET_STRING_ELT(names, rank,     mkChar("address"));
+  SET_VECTOR_ELT(result, rank + 1, allocVector(REALSXP, ctx.n)); SET_STRING_ELT(names, rank + 1, mkChar("size"));
+  SET_VECTOR_ELT(result, rank + 2, allocVector(REALSXP, ctx.n)); SET_STRING_ELT(names, rank + 2, mkChar("ratio"));
+  SET_VECTOR_ELT(result, rank + 3, allocVector(INTSXP,  ctx.n)); SET_STRING_ELT(names, rank + 3, mkChar("filter_mask"));
+  ctx.addr  = REAL(VECTOR_ELT(result, rank));
+  ctx.size  = REAL(VECTOR_ELT(result, rank + 1));
+  ctx.ratio = REAL(VECTOR_ELT(result, rank + 2));
+  ctx.mask  = INTEGER(VECTOR_ELT(result, rank + 3));
+  
+  if (ctx.n > 0) {
+#if H5_VERSION_GE(1, 14, 1)
+    H5Dchunk_iter(dset_id, H5P_DEFAULT, chunk_iter_cb, &ctx);
+#else
+    hsize_t  offset[H5S_MAX_RANK];
+    unsigned mask;
+    haddr_t  addr;
+    hsize_t  size;
+    for (hsize_t i = 0; i < n_chunks; i++)
+      if (H5Dget_chunk_info(dset_id, space_id, i, offset, &mask, &addr, &size) >= 0)
+        record_chunk(&ctx, offset, mask, addr, size);
+#endif
+  }
+  H5Sclose(space_id);
+  
+  /* Chunks that could not be queried leave NA rows rather than garbage. */
+  for (R_xlen_t i = ctx.i; i < ctx.n; i++) { // # nocov start
+    for (int d = 0; d < rank; d++) ctx.start[d][i] = NA_REAL;
+    ctx.addr[i] = ctx.size[i] = ctx.ratio[i] = NA_REAL;
+    ctx.mask[i] = NA_INTEGER;
+  } // # nocov end
+  
+  setAttrib(result, R_NamesSymbol, names);
+  
+  SEXP class_attr = PROTECT(mkString("data.frame"));
+  setAttrib(result, R_ClassSymbol, class_attr);
+  
+  SEXP row_names_attr = PROTECT(allocVector(INTSXP, 2));
+  INTEGER(row_names_attr)[0] = NA_INTEGER;
+  INTEGER(row_names_attr)[1] = -(int)ctx.n;
+  setAttrib(result, R_RowNamesSymbol, row_names_attr);
+  
+  UNPROTECT(4);
+  return result;
+}
+
+
 /*
  * C_h5_inspect
  * * Inspects a dataset and returns an R list describing its DCPL properties:
  * - layout: The storage layout (compact, contiguous, chunked, virtual)
  * - chunk_dims: R numeric vector of chunk dimensions (if chunked), otherwise NULL
  * - filters: A list of lists describing each filter in the pipeline
+ * With `chunks = TRUE`, chunked datasets also get:
+ * - n_chunks: The number of chunks spanned by the dataset's extent
+ * - chunks: A data.frame describing each allocated chunk (see above)
  */
-SEXP C_h5_inspect(SEXP filename, SEXP dset_name) {
+SEXP C_h5_inspect(SEXP filename, SEXP dset_name, SEXP chunks) {
   int nprotect = 0;
   
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
   
   /* Open the file and dataset read-only */
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file for inspection: %s", fname);
   
   hid_t dset_id = H5Dopen2(file_id, dname, H5P_DEFAULT);
   if (dset_id < 0) { // # nocov start
-    H5Fclose(file_id);
+    h5_file_close(file_id);
     error("Failed to open dataset: %s", dname);
   } // # nocov end
   
@@ -86,7 +213,7 @@ SEXP C_h5_inspect(SEXP filename, SEXP dset_name) {
   hid_t dcpl_id = H5Dget_create_plist(dset_id);
   if (dcpl_id < 0) { // # nocov start
     H5Dclose(dset_id);
-    H5Fclose(file_id);
+    h5_file_close(file_id);
     error("Failed to retrieve DCPL for dataset: %s", dname);
   } // # nocov end
   
@@ -190,8 +317,18 @@ SEXP C_h5_inspect(SEXP filename, SEXP dset_name) {
   H5Tclose(type_id);
   H5Sclose(space_id);
   
-  /* --- 5. Assemble Final List --- */
-  SEXP r_out = PROTECT(allocVector(VECSXP, 6));
+  /* --- 5. Inspect Chunks --- */
+  int  with_chunks = (layout == H5D_CHUNKED && asLogical(chunks) == TRUE);
+  SEXP r_chunks    = R_NilValue;
+  double n_grid    = 0;
+  if (with_chunks) {
+    r_chunks = PROTECT(inspect_chunks(dset_id, dcpl_id, &n_grid));
+    nprotect++;
+  }
+  
+  /* --- 6. Assemble Final List --- */
+  int  n_out = with_chunks ? 8 : 6;
+  SEXP r_out = PROTECT(allocVector(VECSXP, n_out));
   nprotect++;
   
   SET_VECTOR_ELT(r_out, 0, r_type);
@@ -201,7 +338,7 @@ SEXP C_h5_inspect(SEXP filename, SEXP dset_name) {
   SET_VECTOR_ELT(r_out, 4, r_chunk_dims);
   SET_VECTOR_ELT(r_out, 5, r_filters);
   
-  SEXP out_names = PROTECT(allocVector(STRSXP, 6));
+  SEXP out_names = PROTECT(allocVector(STRSXP, n_out));
   nprotect++;
   SET_STRING_ELT(out_names, 0, mkChar("type"));
   SET_STRING_ELT(out_names, 1, mkChar("layout"));
@@ -209,12 +346,18 @@ SEXP C_h5_inspect(SEXP filename, SEXP dset_name) {
   SET_STRING_ELT(out_names, 3, mkChar("storage_size"));
   SET_STRING_ELT(out_names, 4, mkChar("chunk_dims"));
   SET_STRING_ELT(out_names, 5, mkChar("filters"));
+  if (with_chunks) {
+    SET_VECTOR_ELT(r_out,     6, ScalarReal(n_grid));
+    SET_VECTOR_ELT(r_out,     7, r_chunks);
+    SET_STRING_ELT(out_names, 6, mkChar("n_chunks"));
+    SET_STRING_ELT(out_names, 7, mkChar("chunks"));
+  }
   setAttrib(r_out, R_NamesSymbol, out_names);
   
   /* Clean up HDF5 resources */
   H5Pclose(dcpl_id);
   H5Dclose(dset_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   UNPROTECT(nprotect);
   return r_out;
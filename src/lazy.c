@@ -0,0 +1,488 @@
+#include "h5lite.h"
+#include <R_ext/Altrep.h>
+
+/*
+ * Lazy datasets behind h5_read(lazy = TRUE).
+ *
+ * A lazy vector holds only a reference to its dataset. Its length, dims and
+ * dimnames come from metadata when it is created, and elements are read on
+ * access: single elements and regions through a window of consecutive
+ * elements that is kept between calls, and linear subsets (`x[i]`) as one
+ * point selection. Anything that needs a pointer to the whole vector - most
+ * arithmetic, and any modification - reads it with read_dataset() into
+ * data2, which is used from then on.
+ *
+ * The file is opened for each read, so that nothing stays locked between
+ * accesses; an h5_open() handle for the file makes those opens free.
+ */
+
+/* Elements per window: 64 KiB of doubles. */
+#define H5LITE_LAZY_WINDOW ((R_xlen_t)8192)
+
+typedef struct {
+  char     *fname;        /* Canonical path of the file */
+  char     *dname;
+  SEXPTYPE  type;         /* REALSXP, INTSXP or LGLSXP */
+  int       native_int;   /* Integers that HDF5 can convert straight to int */
+  int       range_na;     /* 1 once values out of int range read as NA, 2 once warned */
+  int       ndims;
+  hsize_t   dims[H5S_MAX_RANK];
+  R_xlen_t  length;
+  R_xlen_t  win_start;    /* Cached window of elements, in R order */
+  R_xlen_t  win_len;
+  void     *win;
+} h5_lazy_t;
+
+static R_altrep_class_t lazy_real_class;
+static R_altrep_class_t lazy_int_class;
+static R_altrep_class_t lazy_lgl_class;
+
+
+static void lazy_finalizer(SEXP ptr) {
+  h5_lazy_t *m = (h5_lazy_t *)R_ExternalPtrAddr(ptr);
+  if (m == NULL) return;
+  free(m->fname); free(m->dname); free(m->win);
+  free(m);
+  R_ClearExternalPtr(ptr);
+}
+
+static h5_lazy_t *lazy_info(SEXP x) {
+  return (h5_lazy_t *)R_ExternalPtrAddr(R_altrep_data1(x));
+}
+
+static size_t lazy_el_size(SEXPTYPE type) {
+  return (type == REALSXP) ? sizeof(double) : sizeof(int);
+}
+
+static R_altrep_class_t lazy_class(SEXPTYPE type) {
+  if (type == REALSXP) return lazy_real_class;
+  if (type == INTSXP)  return lazy_int_class;
+  return lazy_lgl_class;
+}
+
+
+/* --- READING --- */
+
+/*
+ * Reads `n` elements into buf, converted as read_dataset() would. The
+ * elements are the R-order (column-major) positions start .. start + n - 1,
+ * or the 0-based positions in `pos` when it is not NULL. Returns NULL on
+ * success, or an error message. Values out of int range are flagged in
+ * m->range_na, for lazy_check() to warn about once the file is closed.
+ */
+static const char *lazy_read(h5_lazy_t *m, R_xlen_t start, R_xlen_t n, const R_xlen_t *pos, void *buf) {
+
+  if (n <= 0) return NULL;
+
+  hid_t file_id = h5_file_open(m->fname, H5F_ACC_RDONLY);
+  if (file_id < 0) return "Failed to open file";
+
+  hid_t dset_id = h5_dataset_open(file_id, m->dname, 0);
+  if (dset_id < 0) { h5_file_close(file_id); return "Failed to open dataset"; }
+
+  const char *err      = NULL;
+  hid_t       space_id = H5Dget_space(dset_id);
+  hsize_t     dims[H5S_MAX_RANK];
+  int         ndims    = H5Sget_simple_extent_ndims(space_id);
+
+  if (ndims != m->ndims) {
+    err = "Dataset has changed since it was read lazily";
+  }
+  else {
+    H5Sget_simple_extent_dims(space_id, dims, NULL);
+    for (int i = 0; i < ndims; i++)
+      if (dims[i] != m->dims[i]) err = "Dataset has changed since it was read lazily";
+  }
+
+  if (err == NULL) {
+
+    /* A range within one column is a hyperslab; anything else is a list of points. */
+    hsize_t d0 = m->dims[0];
+    if (pos == NULL && (ndims == 1 || (hsize_t)(start % d0) + (hsize_t)n <= d0)) {
+      hsize_t offset[H5S_MAX_RANK], count[H5S_MAX_RANK];
+      hsize_t rest = (hsize_t)start;
+      for (int i = 0; i < ndims; i++) {
+        offset[i] = rest % m->dims[i];
+        rest     /= m->dims[i];
+        count[i]  = 1;
+      }
+      count[0] = (hsize_t)n;
+      H5Sselect_hyperslab(space_id, H5S_SELECT_SET, offset, NULL, count, NULL);
+    }
+    else {
+      hsize_t *coords = (hsize_t *)malloc((size_t)n * ndims * sizeof(hsize_t));
+      if (coords == NULL) { err = "Memory allocation failed"; } // # nocov
+      else {
+        for (R_xlen_t k = 0; k < n; k++) {
+          hsize_t rest = (hsize_t)(pos ? pos[k] : start + k);
+          for (int i = 0; i < ndims; i++) {
+            coords[k * ndims + i] = rest % m->dims[i];
+            rest /= m->dims[i];
+          }
+        }
+        H5Sselect_elements(space_id, H5S_SELECT_SET, (size_t)n, coords);
+        free(coords);
+      }
+    }
+  }
+
+  if (err == NULL) {
+
+    hsize_t mem_dims[1] = { (hsize_t)n };
+    hid_t   mem_space   = H5Screate_simple(1, mem_dims, NULL);
+    herr_t  status;
+
+    if (m->native_int || m->type == REALSXP) {
+      hid_t mem_type = (m->type == REALSXP) ? H5T_NATIVE_DOUBLE : H5T_NATIVE_INT;
+      status = H5Dread(dset_id, mem_type, mem_space, space_id, H5P_DEFAULT, buf);
+      if (status >= 0 && m->type == LGLSXP) {
+        int *v = (int *)buf;
+        for (R_xlen_t k = 0; k < n; k++) v[k] = (v[k] != 0);
+      }
+      else if (status >= 0 && m->type == INTSXP && !m->range_na) {
+        /* INT_MIN of an int32 is R's NA_integer_ */
+        const int *v = (const int *)buf;
+        for (R_xlen_t k = 0; k < n && !m->range_na; k++) if (v[k] == NA_INTEGER) m->range_na = 1;
+      }
+    }
+    else {
+      /* Floats and wide integers as integer/logical: convert like coerceVector(). */
+      double *tmp = (double *)malloc((size_t)n * sizeof(double));
+      if (tmp == NULL) { status = -1; } // # nocov
+      else {
+        status = H5Dread(dset_id, H5T_NATIVE_DOUBLE, mem_space, space_id, H5P_DEFAULT, tmp);
+        int *v = (int *)buf;
+        for (R_xlen_t k = 0; status >= 0 && k < n; k++) {
+          double d = tmp[k];
+          if (ISNAN(d))              v[k] = (m->type == LGLSXP) ? NA_LOGICAL : NA_INTEGER;
+          else if (m->type == LGLSXP) v[k] = (d != 0);
+          else if (d >= INT_MAX + 1. || d <= INT_MIN) { v[k] = NA_INTEGER; if (!m->range_na) m->range_na = 1; }
+          else                       v[k] = (int)d;
+        }
+        free(tmp);
+      }
+    }
+
+    H5Sclose(mem_space);
+    if (status < 0) err = "Failed to read numeric data";
+  }
+
+  H5Sclose(space_id);
+  H5Dclose(dset_id); h5_file_close(file_id);
+  return err;
+}
+
+/* Raises lazy_read()'s error, or warns like coerceVector() the first time values were out of range. */
+static void lazy_check(h5_lazy_t *m, const char *err) {
+  if (err != NULL) error("Error reading dataset '%s' lazily\n%s", m->dname, err);
+  if (m->range_na == 1) {
+    m->range_na = 2;
+    warning("NAs introduced by coercion to integer range");
+  }
+}
+
+
+/* Reads the whole dataset into data2 (once) and returns it. */
+static SEXP lazy_materialize(SEXP x) {
+
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) return copy;
+
+  h5_lazy_t *m = lazy_info(x);
+
+  hid_t file_id = h5_file_open(m->fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", m->fname);
+
+  hid_t dset_id = h5_dataset_open(file_id, m->dname, 0);
+  if (dset_id < 0) { h5_file_close(file_id); error("Failed to open dataset: %s", m->dname); }
+
+  const char *as = (m->type == REALSXP) ? "double" : (m->type == INTSXP) ? "integer" : "logical";
+  SEXP rmap = PROTECT(mkString(as));
+  copy = PROTECT(read_dataset(dset_id, rmap, m->dname, R_NilValue, R_NilValue, R_NilValue, R_NilValue, 0));
+
+  H5Dclose(dset_id); h5_file_close(file_id);
+
+  if (TYPEOF(copy) == CHARSXP)
+    error("Error reading dataset '%s'\n%s", m->dname, CHAR(copy)); // # nocov
+  if (TYPEOF(copy) != m->type || XLENGTH(copy) != m->length)
+    error("Error reading dataset '%s' lazily\nDataset has changed since it was read lazily", m->dname);
+
+  R_set_altrep_data2(x, copy);
+  free(m->win);
+  m->win     = NULL;
+  m->win_len = 0;
+
+  UNPROTECT(2);
+  return copy;
+}
+
+
+/* Points the window at the block of elements that holds element i. */
+static const void *lazy_window(SEXP x, R_xlen_t i) {
+
+  h5_lazy_t *m = lazy_info(x);
+
+  if (m->win == NULL || i < m->win_start || i >= m->win_start + m->win_len) {
+
+    if (m->win == NULL) {
+      m->win = malloc((size_t)H5LITE_LAZY_WINDOW * lazy_el_size(m->type));
+      if (m->win == NULL) error("Memory allocation failed"); // # nocov
+    }
+
+    R_xlen_t w0 = (i / H5LITE_LAZY_WINDOW) * H5LITE_LAZY_WINDOW;
+    R_xlen_t n  = m->length - w0;
+    if (n > H5LITE_LAZY_WINDOW) n = H5LITE_LAZY_WINDOW;
+
+    m->win_len = 0;
+    lazy_check(m, lazy_read(m, w0, n, NULL, m->win));
+    m->win_start = w0;
+    m->win_len   = n;
+  }
+
+  return (const char *)m->win + (size_t)(i - m->win_start) * lazy_el_size(m->type);
+}
+
+
+/* --- ALTREP METHODS --- */
+
+static R_xlen_t lazy_Length(SEXP x) {
+  return lazy_info(x)->length;
+}
+
+static const void *lazy_Dataptr_or_null(SEXP x) {
+  SEXP copy = R_altrep_data2(x);
+  return (copy == R_NilValue) ? NULL : DATAPTR_RO(copy);
+}
+
+static void *lazy_Dataptr(SEXP x, Rboolean writeable) {
+  return DATAPTR(lazy_materialize(x));
+}
+
+/* Duplicates share the dataset reference until one of them is materialized. */
+static SEXP lazy_Duplicate(SEXP x, Rboolean deep) {
+  if (R_altrep_data2(x) != R_NilValue) return NULL;
+  return R_new_altrep(lazy_class(TYPEOF(x)), R_altrep_data1(x), R_NilValue);
+}
+
+static Rboolean lazy_Inspect(SEXP x, int pre, int deep, int pvec,
+                             void (*inspect_subtree)(SEXP, int, int, int)) {
+  h5_lazy_t *m = lazy_info(x);
+  Rprintf(" h5lite lazy %s in %s (%s)\n", m->dname, m->fname,
+          (R_altrep_data2(x) == R_NilValue) ? "on disk" : "in memory");
+  return TRUE;
+}
+
+static double lazy_real_Elt(SEXP x, R_xlen_t i) {
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) return REAL(copy)[i];
+  return *(const double *)lazy_window(x, i);
+}
+
+static int lazy_int_Elt(SEXP x, R_xlen_t i) {
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) return INTEGER(copy)[i];
+  return *(const int *)lazy_window(x, i);
+}
+
+static int lazy_lgl_Elt(SEXP x, R_xlen_t i) {
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) return LOGICAL(copy)[i];
+  return *(const int *)lazy_window(x, i);
+}
+
+/* Regions within a window are served from it; longer regions are read directly. */
+static R_xlen_t lazy_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, void *buf) {
+
+  h5_lazy_t *m       = lazy_info(x);
+  size_t     el_size = lazy_el_size(m->type);
+  R_xlen_t   ncpy    = (i + n > m->length) ? m->length - i : n;
+  if (ncpy <= 0) return 0;
+
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) {
+    memcpy(buf, (const char *)DATAPTR_RO(copy) + (size_t)i * el_size, (size_t)ncpy * el_size);
+    return ncpy;
+  }
+
+  if (ncpy > H5LITE_LAZY_WINDOW) {
+    lazy_check(m, lazy_read(m, i, ncpy, NULL, buf));
+    return ncpy;
+  }
+
+  for (R_xlen_t done = 0; done < ncpy; ) {
+    const char *src = (const char *)lazy_window(x, i + done);
+    R_xlen_t    len = m->win_start + m->win_len - (i + done);
+    if (len > ncpy - done) len = ncpy - done;
+    memcpy((char *)buf + (size_t)done * el_size, src, (size_t)len * el_size);
+    done += len;
+  }
+  return ncpy;
+}
+
+static R_xlen_t lazy_real_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, double *buf) {
+  return lazy_Get_region(x, i, n, buf);
+}
+
+static R_xlen_t lazy_int_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, int *buf) {
+  return lazy_Get_region(x, i, n, buf);
+}
+
+/*
+ * x[indx] for in-bounds 1-based indices: reads only the selected elements,
+ * in one point selection. Returns NULL - letting R subset element by element
+ * through the window - for NA or out-of-bounds indices, for vectors that are
+ * already in memory, and for selections so large that the whole vector is
+ * read instead.
+ */
+static SEXP lazy_Extract_subset(SEXP x, SEXP indx, SEXP call) {
+
+  if (R_altrep_data2(x) != R_NilValue) return NULL;
+  if (TYPEOF(indx) != INTSXP && TYPEOF(indx) != REALSXP) return NULL;
+
+  h5_lazy_t *m = lazy_info(x);
+  R_xlen_t   n = XLENGTH(indx);
+  if (n == 0) return NULL;
+
+  if (n > m->length / 4) {
+    lazy_materialize(x);
+    return NULL;
+  }
+
+  R_xlen_t *pos = (R_xlen_t *)R_alloc((size_t)n, sizeof(R_xlen_t));
+  for (R_xlen_t k = 0; k < n; k++) {
+    double i = (TYPEOF(indx) == INTSXP) ?
+      ((INTEGER(indx)[k] == NA_INTEGER) ? NA_REAL : (double)INTEGER(indx)[k]) : REAL(indx)[k];
+    if (ISNAN(i) || i < 1 || i >= (double)m->length + 1) return NULL;
+    pos[k] = (R_xlen_t)i - 1;
+  }
+
+  SEXP result = PROTECT(allocVector(m->type, n));
+  lazy_check(m, lazy_read(m, 0, n, pos, DATAPTR(result)));
+  UNPROTECT(1);
+  return result;
+}
+
+
+/* --- ENTRY POINT --- */
+
+/*
+ * The R type a lazy read of the dataset produces, or NILSXP when it can only
+ * be known from the values (integers of 32 bits or more read with "auto"),
+ * or the dataset is not an atomic numeric array.
+ */
+static SEXPTYPE lazy_type(hid_t type_id, R_TYPE rtype) {
+
+  H5T_class_t class_id = H5Tget_class(type_id);
+  if (class_id != H5T_INTEGER && class_id != H5T_FLOAT) return NILSXP;
+
+  if (rtype == R_TYPE_DOUBLE)  return REALSXP;
+  if (rtype == R_TYPE_AUTO && class_id == H5T_FLOAT) return REALSXP;
+  if (rtype == R_TYPE_INTEGER) return INTSXP;
+  if (rtype == R_TYPE_LOGICAL) return LGLSXP;
+  if (rtype == R_TYPE_AUTO && class_id == H5T_INTEGER && H5Tget_size(type_id) < 4) return INTSXP;
+
+  return NILSXP;
+}
+
+
+/*
+ * Makes a lazy vector for the open dataset `dname` of fname. Returns NULL
+ * when the dataset cannot be read lazily, so that the caller falls back to a
+ * regular read.
+ */
+SEXP h5_read_lazy(const char *fname, const char *dname, hid_t dset_id, SEXP rmap, const char *el_name) {
+
+  hid_t    type_id  = H5Dget_type(dset_id);
+  hid_t    space_id = H5Dget_space(dset_id);
+  int      ndims    = H5Sget_simple_extent_ndims(space_id);
+  SEXPTYPE type     = lazy_type(type_id, rtype_from_map(type_id, rmap, el_name));
+
+  /* Dictionary codes only make sense once decoded */
+  if (H5Aexists(dset_id, H5LITE_DICT_ATTR) > 0) type = NILSXP;
+
+  hsize_t dims[H5S_MAX_RANK];
+  double  total = 0;
+  if (H5Sget_simple_extent_type(space_id) == H5S_SIMPLE && ndims > 0) {
+    H5Sget_simple_extent_dims(space_id, dims, NULL);
+    total = 1;
+    for (int i = 0; i < ndims; i++) total *= (double)dims[i];
+  }
+
+  SEXP result = R_NilValue;
+
+  if (type != NILSXP && total > 0 && total <= (double)R_XLEN_T_MAX) {
+
+    h5_lazy_t *m = (h5_lazy_t *)calloc(1, sizeof(h5_lazy_t));
+    if (m == NULL) { H5Tclose(type_id); H5Sclose(space_id); return R_NilValue; } // # nocov
+
+    size_t type_size = H5Tget_size(type_id);
+    m->fname      = h5_canonical_path(fname);
+    m->dname      = strdup(dname);
+    m->type       = type;
+    m->native_int = H5Tget_class(type_id) == H5T_INTEGER &&
+      (type_size < 4 || (type_size == 4 && H5Tget_sign(type_id) == H5T_SGN_2));
+    m->ndims      = ndims;
+    m->length     = (R_xlen_t)total;
+    for (int i = 0; i < ndims; i++) m->dims[i] = dims[i];
+
+    SEXP tag = PROTECT(mkString(dname));
+    SEXP ptr = PROTECT(R_MakeExternalPtr(m, tag, R_NilValue));
+    R_RegisterCFinalizerEx(ptr, lazy_finalizer, TRUE);
+
+    result = PROTECT(R_new_altrep(lazy_class(type), ptr, R_NilValue));
+    set_r_dimensions(result, ndims, dims);
+    read_r_dimscales(dset_id, ndims, result, NULL, NULL, NULL);
+    UNPROTECT(3);
+  }
+
+  H5Tclose(type_id); H5Sclose(space_id);
+
+  return result;
+}
+
+
+/* C implementation of h5_read(lazy = TRUE) for a single dataset. */
+SEXP C_h5_read_lazy(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name) {
+
+  const char *fname   = Rf_translateCharUTF8(STRING_ELT(filename,     0));
+  const char *dname   = Rf_translateCharUTF8(STRING_ELT(dataset_name, 0));
+  const char *el_name = Rf_translateCharUTF8(STRING_ELT(element_name, 0));
+
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+
+  hid_t dset_id = h5_dataset_open(file_id, dname, 0);
+  if (dset_id < 0) { h5_file_close(file_id); error("Failed to open dataset: %s", dname); }
+
+  SEXP result = PROTECT(h5_read_lazy(fname, dname, dset_id, rmap, el_name));
+
+  H5Dclose(dset_id); h5_file_close(file_id);
+
+  UNPROTECT(1);
+  return result;
+}
+
+
+/* Registers the ALTREP classes. Called from R_init_h5lite(). */
+void h5_lazy_init(DllInfo *dll) {
+
+  lazy_real_class = R_make_altreal_class("h5lite_lazy_real", "h5lite", dll);
+  lazy_int_class  = R_make_altinteger_class("h5lite_lazy_int", "h5lite", dll);
+  lazy_lgl_class  = R_make_altlogical_class("h5lite_lazy_lgl", "h5lite", dll);
+
+  R_altrep_class_t classes[] = { lazy_real_class, lazy_int_class, lazy_lgl_class };
+  for (int i = 0; i < 3; i++) {
+    R_set_altrep_Length_method(classes[i], lazy_Length);
+    R_set_altrep_Duplicate_method(classes[i], lazy_Duplicate);
+    R_set_altrep_Inspect_method(classes[i], lazy_Inspect);
+    R_set_altvec_Dataptr_method(classes[i], lazy_Dataptr);
+    R_set_altvec_Dataptr_or_null_method(classes[i], lazy_Dataptr_or_null);
+    R_set_altvec_Extract_subset_method(classes[i], lazy_Extract_subset);
+  }
+  R_set_altreal_Elt_method(lazy_real_class, lazy_real_Elt);
+  R_set_altreal_Get_region_method(lazy_real_class, lazy_real_Get_region);
+  R_set_altinteger_Elt_method(lazy_int_class, lazy_int_Elt);
+  R_set_altinteger_Get_region_method(lazy_int_class, lazy_int_Get_region);
+  R_set_altlogical_Elt_method(lazy_lgl_class, lazy_lgl_Elt);
+  R_set_altlogical_Get_region_method(lazy_lgl_class, lazy_int_Get_region);
+}
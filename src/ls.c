@@ -347,12 +347,12 @@ SEXP C_h5_str(SEXP filename, SEXP group_name, SEXP attrs, SEXP members, SEXP mar
   int show_members = LOGICAL(members)[0];
   int show_markup  = LOGICAL(markup)[0];
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t group_id = H5Oopen(file_id, gname, H5P_DEFAULT);
   if (group_id < 0) { // # nocov start
-    H5Fclose(file_id); 
+    h5_file_close(file_id); 
     error("Failed to open group/object: %s", gname); 
   } // # nocov end
   
@@ -370,7 +370,7 @@ SEXP C_h5_str(SEXP filename, SEXP group_name, SEXP attrs, SEXP members, SEXP mar
   h5_list_recursive(group_id, "", show_attrs, show_members, show_markup);
   
   H5Oclose(group_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   return R_NilValue;
 }
@@ -479,11 +479,11 @@ SEXP C_h5_ls(SEXP filename, SEXP group_name, SEXP recursive, SEXP full_names, SE
   int use_full_names = LOGICAL(full_names)[0];
   int show_scales    = LOGICAL(scales)[0];
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t group_id = H5Oopen(file_id, gname, H5P_DEFAULT);
-  if (group_id < 0) { H5Fclose(file_id); error("Failed to open group/object: %s", gname); }
+  if (group_id < 0) { h5_file_close(file_id); error("Failed to open group/object: %s", gname); }
   
   /* Initialize the data structure to pass to the callback. */
   h5_op_data_t op_data;
@@ -508,7 +508,7 @@ SEXP C_h5_ls(SEXP filename, SEXP group_name, SEXP recursive, SEXP full_names, SE
   }
   
   H5Oclose(group_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   UNPROTECT(1);
   return op_data.names;
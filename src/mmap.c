@@ -0,0 +1,290 @@
+#include "h5lite.h"
+#include <R_ext/Altrep.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Memory-mapped reads behind h5_read(mmap = TRUE).
+ *
+ * A contiguous, unfiltered 1D dataset whose file type matches R's in-memory
+ * representation is already laid out on disk exactly as R would hold it, so
+ * instead of copying it into the heap the file region is mapped read-only and
+ * wrapped in an ALTREP vector. Pages are loaded on demand and shared, through
+ * the OS page cache, with every other process mapping the same file.
+ *
+ * The mapping is held by an external pointer (data1) that duplicates share.
+ * Anything that asks for a writable pointer gets a private copy instead,
+ * stored in data2, which takes over from the mapping from then on.
+ */
+typedef struct {
+  void    *map;      /* Page-aligned start of the mapping */
+  size_t   map_len;
+  void    *data;     /* First element of the dataset, inside the mapping */
+  R_xlen_t length;
+} h5_mmap_t;
+
+static R_altrep_class_t mmap_real_class;
+static R_altrep_class_t mmap_int_class;
+
+
+#ifndef _WIN32
+
+static void mmap_finalizer(SEXP ptr) {
+  h5_mmap_t *m = (h5_mmap_t *)R_ExternalPtrAddr(ptr);
+  if (m == NULL) return;
+  munmap(m->map, m->map_len);
+  free(m);
+  R_ClearExternalPtr(ptr);
+}
+
+static h5_mmap_t *mmap_info(SEXP x) {
+  return (h5_mmap_t *)R_ExternalPtrAddr(R_altrep_data1(x));
+}
+
+static size_t mmap_el_size(SEXP x) {
+  return (TYPEOF(x) == REALSXP) ? sizeof(double) : sizeof(int);
+}
+
+
+/* --- ALTREP METHODS --- */
+
+static R_xlen_t mmap_Length(SEXP x) {
+  return mmap_info(x)->length;
+}
+
+static const void *mmap_Dataptr_or_null(SEXP x) {
+  SEXP copy = R_altrep_data2(x);
+  return (copy == R_NilValue) ? mmap_info(x)->data : DATAPTR_RO(copy);
+}
+
+static void *mmap_Dataptr(SEXP x, Rboolean writeable) {
+
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) return DATAPTR(copy);
+  if (!writeable)         return mmap_info(x)->data;
+
+  /* The mapping is read-only: writes go to a private copy. */
+  h5_mmap_t *m = mmap_info(x);
+  copy = PROTECT(allocVector(TYPEOF(x), m->length));
+  memcpy(DATAPTR(copy), m->data, (size_t)m->length * mmap_el_size(x));
+  R_set_altrep_data2(x, copy);
+  UNPROTECT(1);
+
+  return DATAPTR(copy);
+}
+
+/* Duplicates share the mapping until one of them is written to. */
+static SEXP mmap_Duplicate(SEXP x, Rboolean deep) {
+  if (R_altrep_data2(x) != R_NilValue) return NULL;
+  R_altrep_class_t cls = (TYPEOF(x) == REALSXP) ? mmap_real_class : mmap_int_class;
+  return R_new_altrep(cls, R_altrep_data1(x), R_NilValue);
+}
+
+static Rboolean mmap_Inspect(SEXP x, int pre, int deep, int pvec,
+                             void (*inspect_subtree)(SEXP, int, int, int)) {
+  SEXP tag = R_ExternalPtrTag(R_altrep_data1(x));
+  Rprintf(" h5lite mmap of %s (%s)\n",
+          (TYPEOF(tag) == STRSXP) ? CHAR(STRING_ELT(tag, 0)) : "?",
+          (R_altrep_data2(x) == R_NilValue) ? "mapped" : "copied");
+  return TRUE;
+}
+
+static double mmap_real_Elt(SEXP x, R_xlen_t i) {
+  return ((const double *)mmap_Dataptr_or_null(x))[i];
+}
+
+static int mmap_int_Elt(SEXP x, R_xlen_t i) {
+  return ((const int *)mmap_Dataptr_or_null(x))[i];
+}
+
+static R_xlen_t mmap_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, void *buf) {
+  R_xlen_t len  = mmap_Length(x);
+  R_xlen_t ncpy = (i + n > len) ? len - i : n;
+  if (ncpy <= 0) return 0;
+  size_t el_size = mmap_el_size(x);
+  memcpy(buf, (const char *)mmap_Dataptr_or_null(x) + (size_t)i * el_size, (size_t)ncpy * el_size);
+  return ncpy;
+}
+
+static R_xlen_t mmap_real_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, double *buf) {
+  return mmap_Get_region(x, i, n, buf);
+}
+
+static R_xlen_t mmap_int_Get_region(SEXP x, R_xlen_t i, R_xlen_t n, int *buf) {
+  return mmap_Get_region(x, i, n, buf);
+}
+
+
+/*
+ * Returns the SEXPTYPE a zero-copy read of dset_id would produce, or NILSXP
+ * if its driver, layout, type or size rule out mapping. On success, `offset`
+ * and `n` give the position of the raw data in the file and its length.
+ */
+static SEXPTYPE mmap_eligible(hid_t file_id, hid_t dset_id, SEXP rmap, const char *el_name,
+                              haddr_t *offset, R_xlen_t *n) {
+
+  SEXPTYPE result = NILSXP;
+
+  /* Only the default POSIX driver maps file offsets to on-disk bytes. */
+  hid_t fapl_id = H5Fget_access_plist(file_id);
+  int   sec2    = (fapl_id >= 0 && H5Pget_driver(fapl_id) == H5FD_SEC2);
+  if (fapl_id >= 0) H5Pclose(fapl_id);
+  if (!sec2) return NILSXP;
+
+  hid_t dcpl_id  = H5Dget_create_plist(dset_id);
+  hid_t space_id = H5Dget_space(dset_id);
+  hid_t type_id  = H5Dget_type(dset_id);
+
+  if (H5Pget_layout(dcpl_id) == H5D_CONTIGUOUS && H5Pget_external_count(dcpl_id) == 0 &&
+      H5Pget_nfilters(dcpl_id) == 0 && H5Sget_simple_extent_type(space_id) == H5S_SIMPLE &&
+      H5Sget_simple_extent_ndims(space_id) == 1) {
+
+    hsize_t dims[1];
+    H5Sget_simple_extent_dims(space_id, dims, NULL);
+
+    /* Whole-number int32 data may be read as double by "auto", so integers
+     * are only mapped when `as` asks for them explicitly. */
+    R_TYPE rtype = rtype_from_map(type_id, rmap, el_name);
+    if (H5Tequal(type_id, H5T_NATIVE_DOUBLE) > 0 && (rtype == R_TYPE_AUTO || rtype == R_TYPE_DOUBLE))
+      result = REALSXP;
+    else if (H5Tequal(type_id, H5T_NATIVE_INT) > 0 && rtype == R_TYPE_INTEGER)
+      result = INTSXP;
+
+    size_t el_size = (result == REALSXP) ? sizeof(double) : sizeof(int);
+    *offset = H5Dget_offset(dset_id);
+    *n      = (R_xlen_t)dims[0];
+
+    if (dims[0] == 0 || *offset == HADDR_UNDEF ||
+        H5Dget_storage_size(dset_id) < dims[0] * el_size)
+      result = NILSXP;
+  }
+
+  H5Tclose(type_id); H5Sclose(space_id); H5Pclose(dcpl_id);
+  return result;
+}
+
+
+static SEXP mmap_dataset(const char *fname, hid_t file_id, hid_t dset_id, SEXP rmap, const char *el_name) {
+
+  /* In-memory files have no file on disk to map. */
+  if (h5_file_is_memory(fname)) return R_NilValue;
+
+  haddr_t  offset = 0;
+  R_xlen_t n      = 0;
+  SEXPTYPE type   = mmap_eligible(file_id, dset_id, rmap, el_name, &offset, &n);
+  if (type == NILSXP) return R_NilValue;
+
+  /* Raw data may still be in HDF5's sieve buffer if this process wrote it. */
+  unsigned intent = 0;
+  H5Fget_intent(file_id, &intent);
+  if (intent & H5F_ACC_RDWR) H5Fflush(file_id, H5F_SCOPE_LOCAL);
+
+  size_t bytes = (size_t)n * ((type == REALSXP) ? sizeof(double) : sizeof(int));
+  long   page  = sysconf(_SC_PAGESIZE);
+  off_t  start = (off_t)(offset - (offset % (haddr_t)page));
+  size_t len   = bytes + (size_t)(offset - (haddr_t)start);
+
+  int fd = open(fname, O_RDONLY);
+  if (fd < 0) return R_NilValue; // # nocov
+  void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, start);
+  close(fd);
+  if (map == MAP_FAILED) return R_NilValue; // # nocov
+
+  /* INT_MIN would read as NA_integer_. Such data goes to the regular read,
+   * which coerces it with R's out-of-range warning. */
+  if (type == INTSXP) {
+    const int *ints = (const int *)((char *)map + (offset - (haddr_t)start));
+    R_xlen_t i = 0;
+    while (i < n && ints[i] != NA_INTEGER) i++;
+    if (i < n) { munmap(map, len); return R_NilValue; }
+  }
+
+  h5_mmap_t *m = (h5_mmap_t *)malloc(sizeof(h5_mmap_t));
+  if (m == NULL) { munmap(map, len); return R_NilValue; } // # nocov
+
+  m->map     = map;
+  m->map_len = len;
+  m->data    = (char *)map + (offset - (haddr_t)start);
+  m->length  = n;
+
+  SEXP tag = PROTECT(mkString(fname));
+  SEXP ptr = PROTECT(R_MakeExternalPtr(m, tag, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, mmap_finalizer, TRUE);
+
+  SEXP result = R_new_altrep((type == REALSXP) ? mmap_real_class : mmap_int_class, ptr, R_NilValue);
+  UNPROTECT(2);
+  return result;
+}
+
+#endif /* _WIN32 */
+
+
+/*
+ * Maps an open dataset of fname into memory, with its dimnames. Returns NULL
+ * when the dataset cannot be mapped, so that the caller falls back to a
+ * regular read.
+ */
+SEXP h5_read_mmap(const char *fname, hid_t file_id, hid_t dset_id, SEXP rmap, const char *el_name) {
+
+#ifdef _WIN32
+  return R_NilValue;
+#else
+  SEXP result = PROTECT(mmap_dataset(fname, file_id, dset_id, rmap, el_name));
+  if (result != R_NilValue) read_r_dimscales(dset_id, 1, result, NULL, NULL, NULL);
+  UNPROTECT(1);
+  return result;
+#endif
+}
+
+
+/* C implementation of h5_read(mmap = TRUE) for a single dataset. */
+SEXP C_h5_read_mmap(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name) {
+
+#ifdef _WIN32
+  return R_NilValue;
+#else
+  const char *fname   = Rf_translateCharUTF8(STRING_ELT(filename,     0));
+  const char *dname   = Rf_translateCharUTF8(STRING_ELT(dataset_name, 0));
+  const char *el_name = Rf_translateCharUTF8(STRING_ELT(element_name, 0));
+
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+
+  hid_t dset_id = h5_dataset_open(file_id, dname, 0);
+  if (dset_id < 0) { h5_file_close(file_id); error("Failed to open dataset: %s", dname); }
+
+  SEXP result = PROTECT(h5_read_mmap(fname, file_id, dset_id, rmap, el_name));
+
+  H5Dclose(dset_id); h5_file_close(file_id);
+
+  UNPROTECT(1);
+  return result;
+#endif
+}
+
+
+/* Registers the ALTREP classes. Called from R_init_h5lite(). */
+void h5_mmap_init(DllInfo *dll) {
+
+  mmap_real_class = R_make_altreal_class("h5lite_mmap_real", "h5lite", dll);
+  mmap_int_class  = R_make_altinteger_class("h5lite_mmap_int", "h5lite", dll);
+
+#ifndef _WIN32
+  R_altrep_class_t classes[] = { mmap_real_class, mmap_int_class };
+  for (int i = 0; i < 2; i++) {
+    R_set_altrep_Length_method(classes[i], mmap_Length);
+    R_set_altrep_Duplicate_method(classes[i], mmap_Duplicate);
+    R_set_altrep_Inspect_method(classes[i], mmap_Inspect);
+    R_set_altvec_Dataptr_method(classes[i], mmap_Dataptr);
+    R_set_altvec_Dataptr_or_null_method(classes[i], mmap_Dataptr_or_null);
+  }
+  R_set_altreal_Elt_method(mmap_real_class, mmap_real_Elt);
+  R_set_altreal_Get_region_method(mmap_real_class, mmap_real_Get_region);
+  R_set_altinteger_Elt_method(mmap_int_class, mmap_int_Elt);
+  R_set_altinteger_Get_region_method(mmap_int_class, mmap_int_Get_region);
+#endif
+}
@@ -0,0 +1,426 @@
+#include "h5lite.h"
+
+/*
+ * Registry of files held open by h5_open() handles.
+ *
+ * Every C entry point obtains its file id through h5_file_open() and
+ * releases it through h5_file_close(). When a handle for the file is
+ * registered here, the cached id is returned and the close is a no-op, so
+ * the HDF5 superblock, metadata cache and chunk cache survive across calls.
+ * Without any registered handles, both functions behave exactly like
+ * H5Fopen() / H5Fclose(), with the access properties of the h5lite.cache and
+ * h5lite.format options.
+ *
+ * In-memory files live only in the registry: they are held by HDF5's core
+ * driver, without a backing store, under a name that h5_open() makes up.
+ * As every entry point resolves that name here first, all of h5lite works
+ * on them unchanged. The file is gone once its last handle is closed.
+ */
+typedef struct h5_handle {
+  char  *given;     /* Path exactly as passed to h5_open() */
+  char  *canon;     /* Canonical path, for matching other spellings */
+  hid_t  file_id;
+  unsigned long fileno; /* HDF5's number for the underlying file */
+  int    readonly;
+  int    has_cache; /* Whether h5_open() was given `cache` */
+  int    memory;    /* Held in memory by the core driver */
+  h5_cache_t cache;
+  struct h5_handle *next;
+} h5_handle_t;
+
+static h5_handle_t *open_handles = NULL;
+
+
+/*
+ * Resolves symlinks and relative components so that "./a.h5" and
+ * "/full/path/a.h5" map to the same registry entry. Falls back to a copy of
+ * the input when the file does not exist yet. The caller frees the result.
+ */
+char *h5_canonical_path(const char *fname) {
+#ifdef _WIN32
+  char *buf = _fullpath(NULL, fname, 0);
+#else
+  char *buf = realpath(fname, NULL);
+#endif
+  if (buf == NULL) buf = strdup(fname);
+  return buf;
+}
+
+/*
+ * Returns the newest handle registered for fname. Several handles may share
+ * a file; with `writable`, a read-write one is preferred over any read-only
+ * handle opened after it, so that plain h5_*() writes are not refused.
+ */
+static h5_handle_t *find_handle(const char *fname, int writable) {
+
+  if (open_handles == NULL) return NULL;
+
+  h5_handle_t *found = NULL;
+
+  /* Fast path: the h5 object passes the same string it registered. */
+  for (h5_handle_t *h = open_handles; h != NULL; h = h->next)
+    if (strcmp(h->given, fname) == 0) {
+      if (found == NULL) found = h;
+      if (!writable || !h->readonly) return h;
+    }
+
+  char *canon = h5_canonical_path(fname);
+  if (canon == NULL) return found; // # nocov
+
+  for (h5_handle_t *h = open_handles; h != NULL; h = h->next)
+    if (strcmp(h->canon, canon) == 0) {
+      if (found == NULL) found = h;
+      if (!writable || !h->readonly) { found = h; break; }
+    }
+
+  free(canon);
+  return found;
+}
+
+
+/*
+ * Drop-in replacement for H5Fopen(fname, flags, H5P_DEFAULT).
+ * Returns the cached id when an h5_open() handle is registered for fname.
+ * Otherwise the file is opened with the access properties of h5_fapl() and
+ * h5_format_fapl().
+ */
+hid_t h5_file_open(const char *fname, unsigned flags) {
+
+  h5_profile_refresh();
+  h5_handle_t *h = find_handle(fname, (flags & H5F_ACC_RDWR) != 0);
+
+  if (h != NULL) {
+    if ((flags & H5F_ACC_RDWR) && h->readonly)
+      error("File is open read-only by an h5_open() handle: %s", fname);
+    return h->file_id;
+  }
+
+  H5LITE_PROF_BEGIN(t0);
+  hid_t fapl_id = h5_format_fapl(h5_fapl(NULL), NULL);
+  hid_t file_id = h5_fopen(fname, flags, fapl_id);
+  if (fapl_id != H5P_DEFAULT) H5Pclose(fapl_id);
+  H5LITE_PROF_END(H5LITE_PROF_OPEN, t0, 0, 0);
+  return file_id;
+}
+
+
+/*
+ * Drop-in replacement for H5Fclose().
+ * Leaves ids owned by an h5_open() handle open.
+ */
+herr_t h5_file_close(hid_t file_id) {
+
+  for (h5_handle_t *h = open_handles; h != NULL; h = h->next)
+    if (h->file_id == file_id) return 0;
+
+  return H5Fclose(file_id);
+}
+
+
+/*
+ * Returns the cached id for fname if one is registered and writable.
+ * Used by open_or_create_file() to skip the H5Fis_hdf5() probe.
+ */
+hid_t h5_file_cached(const char *fname, unsigned flags) {
+
+  h5_handle_t *h = find_handle(fname, (flags & H5F_ACC_RDWR) != 0);
+  if (h == NULL) return -1;
+
+  if ((flags & H5F_ACC_RDWR) && h->readonly)
+    error("File is open read-only by an h5_open() handle: %s", fname);
+
+  return h->file_id;
+}
+
+
+/*
+ * Copies the h5_open(cache = ) settings of the handle that owns loc_id's
+ * file into `out`. Returns 0, leaving `out` untouched, when there is no such
+ * handle or it was opened without `cache`. Runs on every dataset open, so
+ * the file is matched by HDF5's file number rather than by name.
+ */
+int h5_handle_cache(hid_t loc_id, h5_cache_t *out) {
+
+  if (open_handles == NULL) return 0;
+
+  hid_t file_id = (H5Iget_type(loc_id) == H5I_FILE) ? loc_id : H5Iget_file_id(loc_id);
+  if (file_id < 0) return 0; // # nocov
+
+  unsigned long fileno;
+  herr_t status = H5Fget_fileno(file_id, &fileno);
+  if (file_id != loc_id) H5Fclose(file_id);
+  if (status < 0) return 0; // # nocov
+
+  for (h5_handle_t *h = open_handles; h != NULL; h = h->next) {
+    if (h->fileno != fileno) continue;
+    if (!h->has_cache) return 0;
+    *out = h->cache;
+    return 1;
+  }
+
+  return 0;
+}
+
+
+/* Unlinks and frees a registry entry, closing its HDF5 file id. */
+static void release_handle(h5_handle_t *target) {
+
+  h5_handle_t **pp = &open_handles;
+  while (*pp != NULL && *pp != target) pp = &(*pp)->next;
+  if (*pp == NULL) return; // # nocov
+  *pp = target->next;
+
+  H5Fclose(target->file_id);
+  free(target->given);
+  free(target->canon);
+  free(target);
+}
+
+static void handle_finalizer(SEXP ptr) {
+  h5_handle_t *h = (h5_handle_t *)R_ExternalPtrAddr(ptr);
+  if (h == NULL) return;
+  release_handle(h);
+  R_ClearExternalPtr(ptr);
+}
+
+
+/* Whether fname names an in-memory file made by h5_open(). */
+int h5_file_is_memory(const char *fname) {
+  h5_handle_t *h = find_handle(fname, 0);
+  return (h != NULL && h->memory);
+}
+
+
+/*
+ * Opens a file held in memory by the core driver: a copy of `image`, or a new
+ * empty file when `image` is empty. Nothing is ever written to disk.
+ */
+static hid_t open_memory_file(const char *fname, SEXP image, int ro,
+                              const h5_cache_t *cfg, const h5_format_t *fmt) {
+
+  hid_t fapl_id = h5_format_fapl(h5_fapl(cfg), fmt);
+  if (fapl_id == H5P_DEFAULT) fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+  if (fapl_id < 0) return -1; // # nocov
+
+  hid_t file_id = -1;
+  if (H5Pset_fapl_core(fapl_id, H5LITE_CORE_INCREMENT, 0) >= 0) {
+    if (XLENGTH(image) > 0) {
+      /* A bad image is reported by C_h5_open(); hide HDF5's traceback. */
+      H5E_auto2_t old_func;
+      void *old_client_data;
+      H5Eget_auto(H5E_DEFAULT, &old_func, &old_client_data);
+      H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+      if (H5Pset_file_image(fapl_id, RAW(image), (size_t)XLENGTH(image)) >= 0)
+        file_id = h5_fopen(fname, ro ? H5F_ACC_RDONLY : H5F_ACC_RDWR, fapl_id);
+      H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
+    } else {
+      hid_t fcpl_id = h5_fcpl(fmt);
+      file_id = H5Fcreate(fname, H5F_ACC_TRUNC, fcpl_id, fapl_id);
+      if (fcpl_id != H5P_DEFAULT) H5Pclose(fcpl_id);
+    }
+  }
+
+  H5Pclose(fapl_id);
+  return file_id;
+}
+
+
+/*
+ * C implementation of h5_open().
+ * Opens (or creates) the file and registers its id. The returned external
+ * pointer owns the id: it is released by C_h5_close() or, failing that, by
+ * the garbage collector. A non-NULL `cache` (from h5_cache()) replaces the
+ * h5lite.cache option for every call that goes through this file, and a
+ * non-NULL `format` (from h5_format()) the h5lite.format option when the file
+ * is opened or created. A raw `image` (possibly empty) opens an in-memory file
+ * named `filename` instead.
+ */
+SEXP C_h5_open(SEXP filename, SEXP readonly, SEXP cache, SEXP format, SEXP image) {
+
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  int ro = asLogical(readonly);
+
+  h5_cache_t cfg;
+  h5_cache_parse(cache, &cfg);
+  int has_cache = (cache != R_NilValue);
+
+  h5_format_t fmt;
+  h5_format_parse(format, &fmt);
+  const h5_format_t *fmt_ptr = (format != R_NilValue) ? &fmt : NULL;
+
+  h5_handle_t *existing = find_handle(fname, !ro);
+  if (existing != NULL && existing->readonly && !ro)
+    error("File is already open read-only by another h5_open() handle: %s", fname);
+
+  int   memory = (TYPEOF(image) == RAWSXP);
+  hid_t file_id;
+  if (memory) {
+    if (existing != NULL) error("An in-memory file named '%s' is already open.", fname);
+    file_id = open_memory_file(fname, image, ro, has_cache ? &cfg : NULL, fmt_ptr);
+    if (file_id < 0) error("Failed to open the HDF5 file image: not a valid HDF5 file.");
+  } else if (existing != NULL) {
+    /* Share the open file; HDF5 reference-counts the underlying file. */
+    file_id = H5Freopen(existing->file_id);
+  } else if (ro) {
+    hid_t fapl_id = h5_format_fapl(h5_fapl(has_cache ? &cfg : NULL), fmt_ptr);
+    file_id = h5_fopen(fname, H5F_ACC_RDONLY, fapl_id);
+    if (fapl_id != H5P_DEFAULT) H5Pclose(fapl_id);
+  } else {
+    file_id = open_or_create_file(fname, has_cache ? &cfg : NULL, fmt_ptr);
+  }
+  if (file_id < 0) error("Failed to open file: %s", fname);
+
+  h5_handle_t *h = (h5_handle_t *)malloc(sizeof(h5_handle_t));
+  if (h == NULL) { H5Fclose(file_id); error("Memory allocation failed"); } // # nocov
+
+  h->given     = strdup(fname);
+  h->canon     = memory ? strdup(fname) : h5_canonical_path(fname);
+  h->file_id   = file_id;
+  h->fileno    = 0;
+  H5Fget_fileno(file_id, &h->fileno);
+  h->readonly  = ro;
+  h->has_cache = has_cache;
+  h->memory    = memory || (existing != NULL && existing->memory);
+  h->cache     = cfg;
+  h->next      = open_handles;
+  open_handles = h;
+
+  SEXP ptr = PROTECT(R_MakeExternalPtr(h, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, handle_finalizer, TRUE);
+  UNPROTECT(1);
+  return ptr;
+}
+
+
+/* C implementation of h5$close(). Safe to call more than once. */
+SEXP C_h5_close(SEXP ptr) {
+  handle_finalizer(ptr);
+  return R_NilValue;
+}
+
+
+/* C implementation of h5$flush(). Pushes all buffered changes to disk. */
+SEXP C_h5_flush(SEXP ptr) {
+  h5_handle_t *h = (h5_handle_t *)R_ExternalPtrAddr(ptr);
+  if (h == NULL) error("This h5 file handle has been closed.");
+  if (!h->readonly && H5Fflush(h->file_id, H5F_SCOPE_GLOBAL) < 0)
+    error("Failed to flush file: %s", h->given); // # nocov
+  return R_NilValue;
+}
+
+
+/* C implementation of the in-memory check behind validate_strings(). */
+SEXP C_h5_is_memory(SEXP filename) {
+  return ScalarLogical(h5_file_is_memory(Rf_translateCharUTF8(STRING_ELT(filename, 0))));
+}
+
+
+/* Jenkins' lookup3 hash, with which HDF5 checksums its metadata. */
+#define LOOKUP3_ROT(x, k) (((x) << (k)) ^ ((x) >> (32 - (k))))
+
+static uint32_t lookup3(const unsigned char *k, size_t length) {
+
+  uint32_t a, b, c;
+  a = b = c = 0xdeadbeef + (uint32_t)length;
+
+  while (length > 12) {
+    a += k[0] + ((uint32_t)k[1] << 8) + ((uint32_t)k[2]  << 16) + ((uint32_t)k[3]  << 24);
+    b += k[4] + ((uint32_t)k[5] << 8) + ((uint32_t)k[6]  << 16) + ((uint32_t)k[7]  << 24);
+    c += k[8] + ((uint32_t)k[9] << 8) + ((uint32_t)k[10] << 16) + ((uint32_t)k[11] << 24);
+    a -= c; a ^= LOOKUP3_ROT(c, 4);  c += b;
+    b -= a; b ^= LOOKUP3_ROT(a, 6);  a += c;
+    c -= b; c ^= LOOKUP3_ROT(b, 8);  b += a;
+    a -= c; a ^= LOOKUP3_ROT(c, 16); c += b;
+    b -= a; b ^= LOOKUP3_ROT(a, 19); a += c;
+    c -= b; c ^= LOOKUP3_ROT(b, 4);  b += a;
+    length -= 12; k += 12;
+  }
+
+  switch (length) {
+    case 12: c += (uint32_t)k[11] << 24; /* fall through */
+    case 11: c += (uint32_t)k[10] << 16; /* fall through */
+    case 10: c += (uint32_t)k[9]  << 8;  /* fall through */
+    case 9:  c += k[8];                  /* fall through */
+    case 8:  b += (uint32_t)k[7]  << 24; /* fall through */
+    case 7:  b += (uint32_t)k[6]  << 16; /* fall through */
+    case 6:  b += (uint32_t)k[5]  << 8;  /* fall through */
+    case 5:  b += k[4];                  /* fall through */
+    case 4:  a += (uint32_t)k[3]  << 24; /* fall through */
+    case 3:  a += (uint32_t)k[2]  << 16; /* fall through */
+    case 2:  a += (uint32_t)k[1]  << 8;  /* fall through */
+    case 1:  a += k[0]; break;
+    case 0:  return c; // # nocov
+  }
+
+  c ^= b; c -= LOOKUP3_ROT(b, 14);
+  a ^= c; a -= LOOKUP3_ROT(c, 11);
+  b ^= a; b -= LOOKUP3_ROT(a, 25);
+  c ^= b; c -= LOOKUP3_ROT(b, 16);
+  a ^= c; a -= LOOKUP3_ROT(c, 4);
+  b ^= a; b -= LOOKUP3_ROT(a, 14);
+  c ^= b; c -= LOOKUP3_ROT(b, 24);
+  return c;
+}
+
+
+/*
+ * H5Fget_file_image() zeroes the status flags of version 2 and 3 superblocks
+ * in the image it returns, but does not recompute the superblock checksum.
+ * HDF5 sets those flags (H5F_SUPER_WRITE_ACCESS, H5F_SUPER_FILE_OK) while a
+ * file in the 1.10 format or later is open for writing, so the image of such
+ * a file - every in-memory file, and any file behind a read-write handle -
+ * fails to open again with "incorrect metadata checksum". Flushing does not
+ * help; only closing the file clears the flags. Recomputes the checksum. The
+ * superblock follows the signature, at offset 0 or a power of two from 512
+ * (after a user block).
+ */
+static void fix_superblock_checksum(unsigned char *img, size_t size) {
+
+  static const unsigned char signature[8] = { 0x89, 'H', 'D', 'F', '\r', '\n', 0x1a, '\n' };
+
+  for (size_t at = 0; at + 12 <= size; at = (at == 0) ? 512 : at * 2) {
+    if (memcmp(img + at, signature, 8) != 0) continue;
+
+    unsigned version = img[at + 8], offset_size = img[at + 9];
+    if (version < 2) return;
+
+    /* Signature, version, sizes and flags; four addresses; the checksum */
+    size_t len = 12 + 4 * (size_t)offset_size;
+    if (at + len + 4 > size) return; // # nocov
+
+    uint32_t sum = lookup3(img + at, len);
+    for (int i = 0; i < 4; i++) img[at + len + i] = (unsigned char)(sum >> (8 * i));
+    return;
+  }
+}
+
+
+/*
+ * C implementation of h5_serialize().
+ * Returns the bytes of the whole file - in memory or on disk - as they would
+ * be on disk at this moment, including changes buffered by an open handle.
+ */
+SEXP C_h5_serialize(SEXP filename) {
+
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+
+  unsigned intent = 0;
+  H5Fget_intent(file_id, &intent);
+  if (intent & H5F_ACC_RDWR) H5Fflush(file_id, H5F_SCOPE_LOCAL);
+
+  ssize_t size = H5Fget_file_image(file_id, NULL, 0);
+  if (size < 0) { h5_file_close(file_id); error("Failed to get the image of file: %s", fname); } // # nocov
+
+  SEXP result = PROTECT(allocVector(RAWSXP, (R_xlen_t)size));
+  ssize_t got = H5Fget_file_image(file_id, RAW(result), (size_t)size);
+  h5_file_close(file_id);
+
+  if (got != size) error("Failed to get the image of file: %s", fname); // # nocov
+  if (intent & H5F_ACC_RDWR) fix_superblock_checksum(RAW(result), (size_t)size);
+
+  UNPROTECT(1);
+  return result;
+}
@@ -14,12 +14,12 @@ SEXP C_h5_create_group(SEXP filename, SEXP group_name) {
    * We just need to ensure the file exists.
    */
   if (strcmp(gname, "/") == 0) {
-    hid_t file_id = open_or_create_file(fname);
-    if (file_id >= 0) H5Fclose(file_id);
+    hid_t file_id = open_or_create_file(fname, NULL, NULL);
+    if (file_id >= 0) h5_file_close(file_id);
     return R_NilValue;
   }
   
-  hid_t file_id = open_or_create_file(fname);
+  hid_t file_id = open_or_create_file(fname, NULL, NULL);
   
   /* Create Link Creation Property List to enable intermediate group creation */
   hid_t lcpl_id = H5Pcreate(H5P_LINK_CREATE);
@@ -55,7 +55,7 @@ SEXP C_h5_create_group(SEXP filename, SEXP group_name) {
     if (check_id >= 0) {
       H5Gclose(check_id); /* It exists and is a group. Success. */
     } else {
-      H5Fclose(file_id);
+      h5_file_close(file_id);
       /* Now we allow the error to be raised to R (e.g. file permission, or it's a Dataset) */
       error("Failed to create group (or object exists and is not a group): %s", gname);
     }
@@ -64,7 +64,27 @@ SEXP C_h5_create_group(SEXP filename, SEXP group_name) {
     H5Gclose(group_id);
   }
   
-  H5Fclose(file_id);
+  h5_file_close(file_id);
+  return R_NilValue;
+}
+
+
+/*
+ * C implementation of h5_create_file().
+ * Creates the file with the creation properties of `format` (an h5_format()
+ * object, or NULL for the h5lite.format option). Existing files are only
+ * checked to be valid HDF5.
+ */
+SEXP C_h5_create_file(SEXP filename, SEXP format) {
+
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+
+  h5_format_t fmt;
+  h5_format_parse(format, &fmt);
+
+  hid_t file_id = open_or_create_file(fname, NULL, (format != R_NilValue) ? &fmt : NULL);
+  h5_file_close(file_id);
+
   return R_NilValue;
 }
 
@@ -78,7 +98,7 @@ SEXP C_h5_move(SEXP filename, SEXP from_name, SEXP to_name) {
   const char *src   = Rf_translateCharUTF8(STRING_ELT(from_name, 0));
   const char *dest  = Rf_translateCharUTF8(STRING_ELT(to_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDWR, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   /* Create Link Creation Property List to auto-create parent groups for destination */
@@ -89,13 +109,530 @@ SEXP C_h5_move(SEXP filename, SEXP from_name, SEXP to_name) {
   herr_t status = H5Lmove(file_id, src, file_id, dest, lcpl_id, H5P_DEFAULT);
   
   H5Pclose(lcpl_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   if (status < 0) error("Failed to move/rename object from '%s' to '%s'", src, dest);
   
   return R_NilValue;
 }
 
+/* --- COPY --- */
+
+/*
+ * H5Ocopy() copies the object references in a dataset's DIMENSION_LIST
+ * as they are, so a copy's names and dimnames would still point at the
+ * source's dimension scales - or at nothing, in another file. Once the
+ * objects are copied, every copied dataset is given scales of its own:
+ * those copied along with it when they were part of the copied group, and
+ * otherwise a copy next to it, named as h5_write() would name it.
+ */
+typedef struct {
+  hid_t       src_file;
+  hid_t       dst_file;
+  const char *from_abs;   /* Absolute paths of the copied object */
+  const char *to_abs;
+} h5_copy_t;
+
+/* "<parent>/<name>", where a name of "." is the parent itself. */
+static const char *join_path(const char *parent, const char *name) {
+  if (strcmp(name, ".") == 0) return parent;
+  int    is_root = (strcmp(parent, "/") == 0);
+  size_t len     = strlen(parent) + strlen(name) + 2;
+  char  *path    = R_alloc(len, sizeof(char));
+  snprintf(path, len, "%s/%s", is_root ? "" : parent, name);
+  return path;
+}
+
+static const char *object_path(hid_t obj_id) {
+  ssize_t len  = H5Iget_name(obj_id, NULL, 0);
+  char   *path = R_alloc(len > 0 ? (size_t)len + 1 : 2, sizeof(char));
+  if (len <= 0 || H5Iget_name(obj_id, path, (size_t)len + 1) < 0) strcpy(path, "/");
+  return path;
+}
+
+/* Where the copy of dataset src_d's scale `scale` lives: see above. */
+static const char *copied_scale_path(const h5_copy_t *ctx, const char *src_d, const char *dst_d, const char *scale) {
+  
+  size_t n_from = strlen(ctx->from_abs), n_src = strlen(src_d);
+  
+  if (strncmp(scale, ctx->from_abs, n_from) == 0 && scale[n_from] == '/')
+    return join_path(ctx->to_abs, scale + n_from + 1);
+  
+  size_t len  = strlen(dst_d) + strlen(scale) + 2;
+  char  *path = R_alloc(len, sizeof(char));
+  
+  if (strncmp(scale, src_d, n_src) == 0) {
+    snprintf(path, len, "%s%s", dst_d, scale + n_src);           /* "<name>_rownames" */
+  }
+  else {
+    const char *base = strrchr(scale, '/');
+    snprintf(path, len, "%s_%s", dst_d, base ? base + 1 : scale); // # nocov
+  }
+  return path;
+}
+
+/* H5Ovisit() callback on the copy: drops back-references to the source's datasets. */
+static herr_t drop_reflist_cb(hid_t obj, const char *name, const H5O_info_t *info, void *op_data) {
+  if (info->type == H5O_TYPE_DATASET && H5Aexists_by_name(obj, name, "REFERENCE_LIST", H5P_DEFAULT) > 0)
+    H5Adelete_by_name(obj, name, "REFERENCE_LIST", H5P_DEFAULT);
+  return 0;
+}
+
+/* H5Ovisit() callback on the source: attaches scales to each copied dataset. */
+static herr_t relink_scales_cb(hid_t obj, const char *name, const H5O_info_t *info, void *op_data) {
+  
+  h5_copy_t *ctx = (h5_copy_t *)op_data;
+  
+  if (info->type != H5O_TYPE_DATASET) return 0;
+  if (H5Aexists_by_name(obj, name, "DIMENSION_LIST", H5P_DEFAULT) <= 0) return 0;
+  
+  const char *src_d  = join_path(ctx->from_abs, name);
+  const char *dst_d  = join_path(ctx->to_abs,   name);
+  hid_t       src_id = H5Dopen2(obj, name, H5P_DEFAULT);
+  hid_t       dst_id = H5Dopen2(ctx->dst_file, dst_d, H5P_DEFAULT);
+  if (src_id < 0 || dst_id < 0) { // # nocov start
+    if (src_id >= 0) H5Dclose(src_id);
+    if (dst_id >= 0) H5Dclose(dst_id);
+    return -1;
+  } // # nocov end
+  
+  hid_t space_id = H5Dget_space(src_id);
+  int   rank     = H5Sget_simple_extent_ndims(space_id);
+  H5Sclose(space_id);
+  
+  hid_t scales[H5S_MAX_RANK];
+  for (int i = 0; i < rank; i++) {
+    
+    scales[i] = -1;
+    if (H5DSget_num_scales(src_id, (unsigned)i) <= 0) continue;
+    
+    scale_visitor_t vis_data = { -1, 0 };
+    H5DSiterate_scales(src_id, (unsigned)i, NULL, visitor_find_scale, &vis_data);
+    if (!vis_data.found || vis_data.scale_id < 0) continue; // # nocov
+    
+    const char *scale = object_path(vis_data.scale_id);
+    const char *dest  = copied_scale_path(ctx, src_d, dst_d, scale);
+    H5Dclose(vis_data.scale_id);
+    
+    if (H5Lexists(ctx->dst_file, dest, H5P_DEFAULT) <= 0) {
+      hid_t ocpypl_id = H5Pcreate(H5P_OBJECT_COPY);
+      H5Pset_copy_object(ocpypl_id, H5O_COPY_WITHOUT_ATTR_FLAG);
+      herr_t status = H5Ocopy(ctx->src_file, scale, ctx->dst_file, dest, ocpypl_id, H5P_DEFAULT);
+      H5Pclose(ocpypl_id);
+      if (status < 0) continue; // # nocov
+      
+      hid_t scale_id = H5Dopen2(ctx->dst_file, dest, H5P_DEFAULT);
+      H5DSset_scale(scale_id, NULL);
+      scales[i] = scale_id;
+    }
+    else {
+      scales[i] = H5Dopen2(ctx->dst_file, dest, H5P_DEFAULT);
+    }
+  }
+  
+  H5Adelete(dst_id, "DIMENSION_LIST");
+  for (int i = 0; i < rank; i++) {
+    if (scales[i] < 0) continue;
+    H5DSattach_scale(dst_id, scales[i], (unsigned)i);
+    H5Dclose(scales[i]);
+  }
+  
+  H5Dclose(dst_id); H5Dclose(src_id);
+  return 0;
+}
+
+
+/*
+ * C implementation of h5_copy().
+ * Wraps H5Ocopy to copy an object (and, for a group, everything below it)
+ * within a file or to another one. The data is copied as stored, without
+ * being decompressed or converted.
+ */
+SEXP C_h5_copy(SEXP from_file, SEXP from_name, SEXP to_file, SEXP to_name) {
+  const char *src_fname = Rf_translateCharUTF8(STRING_ELT(from_file, 0));
+  const char *dst_fname = Rf_translateCharUTF8(STRING_ELT(to_file, 0));
+  const char *src       = Rf_translateCharUTF8(STRING_ELT(from_name, 0));
+  const char *dest      = Rf_translateCharUTF8(STRING_ELT(to_name, 0));
+  
+  int same_file = (strcmp(src_fname, dst_fname) == 0);
+  
+  hid_t dst_id = open_or_create_file(dst_fname, NULL, NULL);
+  hid_t src_id = same_file ? dst_id : h5_file_open(src_fname, H5F_ACC_RDONLY);
+  if (src_id < 0) { h5_file_close(dst_id); error("Failed to open file: %s", src_fname); }
+  
+  /* Create Link Creation Property List to auto-create parent groups for destination */
+  hid_t lcpl_id = H5Pcreate(H5P_LINK_CREATE);
+  H5Pset_create_intermediate_group(lcpl_id, 1);
+  H5Pset_char_encoding(lcpl_id, H5T_CSET_UTF8);
+  
+  herr_t status = H5Ocopy(src_id, src, dst_id, dest, H5P_DEFAULT, lcpl_id);
+  H5Pclose(lcpl_id);
+  
+  if (status >= 0) {
+    hid_t from_id = H5Oopen(src_id, src,  H5P_DEFAULT);
+    hid_t to_id   = H5Oopen(dst_id, dest, H5P_DEFAULT);
+    
+    h5_copy_t ctx = { src_id, dst_id, object_path(from_id), object_path(to_id) };
+    
+    H5Ovisit(to_id,   H5_INDEX_NAME, H5_ITER_NATIVE, drop_reflist_cb,  &ctx, H5O_INFO_BASIC);
+    H5Ovisit(from_id, H5_INDEX_NAME, H5_ITER_NATIVE, relink_scales_cb, &ctx, H5O_INFO_BASIC);
+    
+    H5Oclose(to_id); H5Oclose(from_id);
+  }
+  
+  if (!same_file) h5_file_close(src_id);
+  h5_file_close(dst_id);
+  
+  if (status < 0) error("Failed to copy object from '%s' to '%s'", src, dest);
+  
+  return R_NilValue;
+}
+
+
+/* --- REPACK --- */
+
+/*
+ * h5_repack() rewrites a dataset with a new chunk shape and filter
+ * pipeline. A new, anonymous dataset is filled from the old one, takes over
+ * its attributes and dimension scales, and is then linked under the old
+ * name. If anything fails, that link included, the original is left as it
+ * was, with its name and dimension scales.
+ */
+
+/* Source rows for write_rows(): read in the file type, so nothing is converted. */
+typedef struct {
+  hid_t    dset_id;
+  hid_t    type_id;
+  int      rank;
+  hsize_t *dims;
+  size_t   row_bytes;
+  int      is_vlen;   /* Rows hold pointers to memory that HDF5 allocated */
+  void    *vlen;      /* Copy of the last slab, to free what they point to */
+  size_t   vlen_size;
+  hsize_t  vlen_rows;
+} repack_rows_t;
+
+/* Frees the variable-length data HDF5 allocated for the previous slab. */
+static void repack_reclaim(repack_rows_t *ctx) {
+  
+  if (ctx->vlen_rows == 0) return;
+  
+  hsize_t count[H5S_MAX_RANK];
+  for (int i = 0; i < ctx->rank; i++) count[i] = ctx->dims[i];
+  count[0] = ctx->vlen_rows;
+  
+  hid_t space_id = H5Screate_simple(ctx->rank, count, NULL);
+  H5Dvlen_reclaim(ctx->type_id, space_id, H5P_DEFAULT, ctx->vlen);
+  H5Sclose(space_id);
+  ctx->vlen_rows = 0;
+}
+
+static int fill_repack_rows(void *data, void *dest, hsize_t r0, hsize_t n) {
+  
+  repack_rows_t *ctx = (repack_rows_t *)data;
+  repack_reclaim(ctx);
+  
+  hsize_t start[H5S_MAX_RANK], count[H5S_MAX_RANK];
+  for (int i = 0; i < ctx->rank; i++) { start[i] = 0; count[i] = ctx->dims[i]; }
+  start[0] = r0;
+  count[0] = n;
+  
+  hid_t file_space_id = H5Dget_space(ctx->dset_id);
+  hid_t mem_space_id  = H5Screate_simple(ctx->rank, count, NULL);
+  H5Sselect_hyperslab(file_space_id, H5S_SELECT_SET, start, NULL, count, NULL);
+  herr_t status = H5Dread(ctx->dset_id, ctx->type_id, mem_space_id, file_space_id, H5P_DEFAULT, dest);
+  H5Sclose(mem_space_id); H5Sclose(file_space_id);
+  
+  if (status < 0) return 1;
+  if (!ctx->is_vlen) return 0;
+  
+  size_t bytes = (size_t)n * ctx->row_bytes;
+  if (bytes > ctx->vlen_size) {
+    void *grown = realloc(ctx->vlen, bytes);
+    if (grown == NULL) return 1; // # nocov
+    ctx->vlen      = grown;
+    ctx->vlen_size = bytes;
+  }
+  memcpy(ctx->vlen, dest, bytes);
+  ctx->vlen_rows = n;
+  
+  return 0;
+}
+
+
+/* Whether two chunked layouts share chunk dimensions and filters, so that raw chunks can be moved as is. */
+static int same_pipeline(hid_t old_dcpl, hid_t new_dcpl, int rank) {
+  
+  if (H5Pget_layout(old_dcpl) != H5D_CHUNKED || H5Pget_layout(new_dcpl) != H5D_CHUNKED) return 0;
+  
+  hsize_t old_chunk[H5S_MAX_RANK], new_chunk[H5S_MAX_RANK];
+  if (H5Pget_chunk(old_dcpl, rank, old_chunk) != rank || H5Pget_chunk(new_dcpl, rank, new_chunk) != rank) return 0;
+  for (int i = 0; i < rank; i++) if (old_chunk[i] != new_chunk[i]) return 0;
+  
+  int n_filters = H5Pget_nfilters(old_dcpl);
+  if (n_filters != H5Pget_nfilters(new_dcpl)) return 0;
+  
+  for (int i = 0; i < n_filters; i++) {
+    unsigned int old_flags, new_flags, old_cd[16], new_cd[16];
+    size_t       old_n = 16, new_n = 16;
+    H5Z_filter_t old_id = H5Pget_filter2(old_dcpl, (unsigned)i, &old_flags, &old_n, old_cd, 0, NULL, NULL);
+    H5Z_filter_t new_id = H5Pget_filter2(new_dcpl, (unsigned)i, &new_flags, &new_n, new_cd, 0, NULL, NULL);
+    if (old_id != new_id || old_flags != new_flags || old_n != new_n) return 0;
+    for (size_t k = 0; k < old_n && k < 16; k++) if (old_cd[k] != new_cd[k]) return 0;
+  }
+  
+  return 1;
+}
+
+
+/* Moves every allocated chunk from old to new without decoding it. */
+static herr_t copy_raw_chunks(hid_t old_id, hid_t new_id) {
+  
+  hid_t   space_id = H5Dget_space(old_id);
+  hsize_t n_chunks = 0;
+  herr_t  status   = H5Dget_num_chunks(old_id, space_id, &n_chunks);
+  
+  void  *buf      = NULL;
+  size_t buf_size = 0;
+  
+  for (hsize_t i = 0; i < n_chunks && status >= 0; i++) {
+    
+    hsize_t  offset[H5S_MAX_RANK], size = 0;
+    unsigned filter_mask = 0;
+    haddr_t  addr;
+    
+    status = H5Dget_chunk_info(old_id, space_id, i, offset, &filter_mask, &addr, &size);
+    if (status < 0 || size == 0) continue;
+    
+    if (size > buf_size) {
+      void *grown = realloc(buf, (size_t)size);
+      if (grown == NULL) { status = H5LITE_WRITE_NOMEM; break; } // # nocov
+      buf      = grown;
+      buf_size = (size_t)size;
+    }
+    
+    uint32_t mask = 0;
+#if defined(H5Dread_chunk_vers) && H5Dread_chunk_vers >= 2
+    size_t read_size = buf_size;
+    status = H5Dread_chunk(old_id, H5P_DEFAULT, offset, &mask, buf, &read_size);
+#else
+    status = H5Dread_chunk(old_id, H5P_DEFAULT, offset, &mask, buf);
+#endif
+    if (status >= 0) status = H5Dwrite_chunk(new_id, H5P_DEFAULT, mask, offset, (size_t)size, buf);
+  }
+  
+  free(buf);
+  H5Sclose(space_id);
+  return status;
+}
+
+
+/* H5Aiterate2() callback: copies the attributes h5_repack() does not rebuild. */
+static herr_t copy_attr_cb(hid_t loc_id, const char *aname, const H5A_info_t *ainfo, void *op_data) {
+  
+  hid_t new_id = *(hid_t *)op_data;
+  
+  if (strcmp(aname, "DIMENSION_LIST") == 0 || strcmp(aname, H5LITE_ACCESS_ATTR) == 0) return 0;
+  if (strcmp(aname, H5LITE_COMPRESS_ATTR) == 0) return 0;   /* "auto"'s choice no longer applies */
+  
+  hid_t attr_id  = H5Aopen(loc_id, aname, H5P_DEFAULT);
+  if (attr_id < 0) return -1; // # nocov
+  
+  hid_t    type_id  = H5Aget_type(attr_id);
+  hid_t    space_id = H5Aget_space(attr_id);
+  hid_t    acpl_id  = H5Aget_create_plist(attr_id);
+  hssize_t n        = H5Sget_simple_extent_npoints(space_id);
+  herr_t   status   = -1;
+  
+  void *buf = malloc((n > 0 ? (size_t)n : 1) * H5Tget_size(type_id));
+  if (buf != NULL && H5Aread(attr_id, type_id, buf) >= 0) {
+    
+    hid_t copy_id = H5Acreate2(new_id, aname, type_id, space_id, acpl_id, H5P_DEFAULT);
+    if (copy_id >= 0) {
+      status = H5Awrite(copy_id, type_id, buf);
+      H5Aclose(copy_id);
+    }
+    if (H5Tdetect_class(type_id, H5T_VLEN) > 0 || H5Tdetect_class(type_id, H5T_STRING) > 0)
+      H5Treclaim(type_id, space_id, H5P_DEFAULT, buf);
+  }
+  
+  free(buf);
+  H5Pclose(acpl_id); H5Sclose(space_id); H5Tclose(type_id); H5Aclose(attr_id);
+  return status;
+}
+
+
+/* Opens the dimension scale of each dimension, or gives -1 where there is none. */
+static void open_dimscales(hid_t dset_id, int rank, hid_t *scale_ids) {
+  
+  for (int i = 0; i < rank; i++) {
+    
+    scale_ids[i] = -1;
+    if (H5DSget_num_scales(dset_id, (unsigned)i) <= 0) continue;
+    
+    scale_visitor_t vis_data = { -1, 0 };
+    H5DSiterate_scales(dset_id, (unsigned)i, NULL, visitor_find_scale, &vis_data);
+    if (vis_data.found) scale_ids[i] = vis_data.scale_id;
+  }
+}
+
+
+/* Attaches those dimension scales to a dataset, or detaches them from it. */
+static void attach_dimscales(hid_t dset_id, int rank, const hid_t *scale_ids, int attach) {
+  
+  for (int i = 0; i < rank; i++) {
+    if (scale_ids[i] < 0) continue;
+    if (attach) H5DSattach_scale(dset_id, scale_ids[i], (unsigned)i);
+    else        H5DSdetach_scale(dset_id, scale_ids[i], (unsigned)i);
+  }
+}
+
+
+/* Fills new_id with the data of old_id, as raw chunks when the layouts allow it. */
+static SEXP repack_data(hid_t old_id, hid_t new_id, hid_t type_id, int rank, hsize_t *dims, int raw) {
+  
+  if (raw) {
+    if (copy_raw_chunks(old_id, new_id) < 0) return mkChar("Failed to copy raw chunks"); // # nocov
+    return R_NilValue;
+  }
+  
+  size_t row_bytes = H5Tget_size(type_id);
+  for (int i = 1; i < rank; i++) row_bytes *= (size_t)dims[i];
+  if (dims[0] == 0 || row_bytes == 0) return R_NilValue;
+  
+  repack_rows_t ctx = { old_id, type_id, rank, dims, row_bytes, 0, NULL, 0, 0 };
+  ctx.is_vlen = H5Tdetect_class(type_id, H5T_VLEN) > 0 || H5Tis_variable_str(type_id) > 0 ||
+    (H5Tget_class(type_id) == H5T_COMPOUND && H5Tdetect_class(type_id, H5T_STRING) > 0);
+  
+  herr_t status = write_rows(new_id, type_id, rank, dims, row_bytes, H5S_ALL, 1, fill_repack_rows, &ctx);
+  
+  repack_reclaim(&ctx);
+  free(ctx.vlen);
+  
+  if (status == H5LITE_WRITE_NOMEM) return mkChar("Failed to read the dataset, or out of memory");
+  if (status < 0)                   return mkChar("Failed to write the repacked dataset"); // # nocov
+  return R_NilValue;
+}
+
+
+/*
+ * C implementation of h5_repack() for a single dataset.
+ * Scalar and empty (NULL dataspace) datasets have no layout to change, and
+ * dimension scales are owned by the datasets they label: these are left as
+ * they are. Returns TRUE if the dataset was rewritten.
+ *
+ * Data is streamed a slab of rows at a time, aligned to the new chunks, in
+ * the dataset's own file type. When the chunk shape and filters are
+ * unchanged, the chunks are copied raw instead, without being decoded.
+ */
+SEXP C_h5_repack(SEXP filename, SEXP dset_name, SEXP compress) {
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+  
+  hid_t old_id = h5_dataset_open(file_id, dname, 0);
+  if (old_id < 0) { h5_file_close(file_id); error("Failed to open dataset: %s", dname); }
+  
+  hid_t space_id = H5Dget_space(old_id);
+  int   rank     = H5Sget_simple_extent_ndims(space_id);
+  
+  if (rank <= 0 || H5Sget_simple_extent_type(space_id) != H5S_SIMPLE || H5DSis_scale(old_id) > 0) {
+    H5Sclose(space_id); H5Dclose(old_id); h5_file_close(file_id);
+    return ScalarLogical(FALSE);
+  }
+  
+  hsize_t dims[H5S_MAX_RANK], max_dims[H5S_MAX_RANK];
+  H5Sget_simple_extent_dims(space_id, dims, max_dims);
+  
+  int extensible = 0, n_points = 1;
+  for (int i = 0; i < rank; i++) {
+    if (max_dims[i] != dims[i]) extensible = 1;
+    if (dims[i] == 0)           n_points   = 0;
+  }
+  
+  hid_t type_id  = H5Dget_type(old_id);
+  hid_t old_dcpl = H5Dget_create_plist(old_id);
+  hid_t new_dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  
+  /* Chunks and filters as C_h5_write_dataset() and C_h5_append_dataset()
+   * would choose them. Extensible datasets must stay chunked. */
+  if (extensible || (n_points && !compress_is_plain(compress))) {
+    hsize_t plan_dims[H5S_MAX_RANK], chunk_dims[H5S_MAX_RANK];
+    for (int i = 0; i < rank; i++) plan_dims[i] = (dims[i] > 0) ? dims[i] : 1;
+    calculate_chunk_dims(rank, plan_dims, H5Tget_size(type_id), compress, chunk_dims);
+    apply_compression(new_dcpl, type_id, rank, chunk_dims, compress);
+  }
+  
+  /* Keep dense attribute storage, which needs HDF5 1.8's object headers. */
+  unsigned     max_compact = 8, min_dense = 6;
+  H5F_libver_t low = H5F_LIBVER_V18, high = H5F_LIBVER_LATEST;
+  H5Pget_attr_phase_change(old_dcpl, &max_compact, &min_dense);
+  if (max_compact != 8 || min_dense != 6) {
+    hid_t fapl_id = H5Fget_access_plist(file_id);
+    H5Pget_libver_bounds(fapl_id, &low, &high);
+    H5Pclose(fapl_id);
+    if (low < H5F_LIBVER_V18) H5Fset_libver_bounds(file_id, H5F_LIBVER_V18, high);
+    H5Pset_attr_phase_change(new_dcpl, max_compact, min_dense);
+  }
+  
+  SEXP  errmsg = R_NilValue;
+  int   raw    = same_pipeline(old_dcpl, new_dcpl, rank);
+  hid_t new_id = H5Dcreate_anon(file_id, type_id, space_id, new_dcpl, H5P_DEFAULT);
+  
+  /* Only the object header needed the bound. Restore it before anything
+   * that can raise an R error, as the file id may be an open handle's. */
+  if (low < H5F_LIBVER_V18) H5Fset_libver_bounds(file_id, low, high);
+  
+  if (new_id < 0) {
+    errmsg = errmsg_1("Failed to create repacked dataset for '%s'", dname); // # nocov
+  }
+  else {
+    errmsg = repack_data(old_id, new_id, type_id, rank, dims, raw);
+    
+    if (errmsg == R_NilValue &&
+        H5Aiterate2(old_id, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, copy_attr_cb, &new_id) < 0)
+      errmsg = errmsg_1("Failed to copy the attributes of '%s'", dname); // # nocov
+    if (errmsg == R_NilValue) write_access_hint(new_id, rank, compress);
+    
+    if (errmsg == R_NilValue) {
+      hid_t lcpl_id = H5Pcreate(H5P_LINK_CREATE);
+      H5Pset_char_encoding(lcpl_id, H5T_CSET_UTF8);
+      
+      /* HDF5 only detaches scales from a dataset that is still linked, so
+       * they come off the original before it gives up its name, and go on
+       * the new one once it has taken it. If it cannot, the original gets
+       * its name and scales back. */
+      hid_t scale_ids[H5S_MAX_RANK];
+      open_dimscales(old_id, rank, scale_ids);
+      attach_dimscales(old_id, rank, scale_ids, 0);
+      
+      int unlinked = H5Ldelete(file_id, dname, H5P_DEFAULT) >= 0;
+      if (unlinked && H5Olink(new_id, file_id, dname, lcpl_id, H5P_DEFAULT) >= 0) {
+        attach_dimscales(new_id, rank, scale_ids, 1);
+      }
+      else { // # nocov start
+        if (unlinked) H5Olink(old_id, file_id, dname, lcpl_id, H5P_DEFAULT);
+        attach_dimscales(old_id, rank, scale_ids, 1);
+        errmsg = errmsg_1("Failed to replace dataset '%s'", dname);
+      } // # nocov end
+      
+      for (int i = 0; i < rank; i++) if (scale_ids[i] >= 0) H5Dclose(scale_ids[i]);
+      H5Pclose(lcpl_id);
+    }
+    H5Dclose(new_id);
+  }
+  
+  H5Pclose(new_dcpl); H5Pclose(old_dcpl); H5Tclose(type_id);
+  H5Sclose(space_id); H5Dclose(old_id); h5_file_close(file_id);
+  
+  if (TYPEOF(errmsg) == CHARSXP) error("%s", CHAR(errmsg));
+  
+  return ScalarLogical(TRUE);
+}
+
+
 /*
  * C implementation of h5_delete().
  * Deletes a link (Group or Dataset) using H5Ldelete.
@@ -104,12 +641,12 @@ SEXP C_h5_delete(SEXP filename, SEXP name) {
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *obj   = Rf_translateCharUTF8(STRING_ELT(name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDWR, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   herr_t status = H5Ldelete(file_id, obj, H5P_DEFAULT);
   
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   if (status < 0) error("Failed to delete object: %s", obj);
   
@@ -125,16 +662,16 @@ SEXP C_h5_delete_attr(SEXP filename, SEXP obj_name, SEXP attr_name) {
   const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
   const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDWR, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
   hid_t obj_id = H5Oopen(file_id, oname, H5P_DEFAULT);
-  if (obj_id < 0) { H5Fclose(file_id); error("Failed to open object: %s", oname); }
+  if (obj_id < 0) { h5_file_close(file_id); error("Failed to open object: %s", oname); }
   
   herr_t status = H5Adelete(obj_id, aname);
   
   H5Oclose(obj_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
   
   if (status < 0) error("Failed to delete attribute '%s' from '%s'", aname, oname);
   
@@ -0,0 +1,118 @@
+#include "h5lite.h"
+#include <time.h>
+
+/*
+ * Opt-in I/O counters behind h5_profile() and options(h5lite.profile = TRUE).
+ *
+ * Each stage of a read or write is bracketed by H5LITE_PROF_BEGIN() and
+ * H5LITE_PROF_END(), which cost one branch on `h5_profiling` while the option
+ * is off. The flag follows the option: it is refreshed whenever an entry point
+ * opens its file, so a call is profiled either as a whole or not at all.
+ *
+ * Times are inclusive. Stages that run inside others (the dimension scales of
+ * a dataset are themselves read, for instance) count towards both.
+ */
+
+int h5_profiling = 0;
+
+typedef struct {
+  double calls;
+  double seconds;
+  double bytes;
+  double elements;
+} h5_prof_counter_t;
+
+static h5_prof_counter_t counters[H5LITE_PROF_N];
+
+static const char *stage_names[H5LITE_PROF_N] = {
+  "open", "metadata", "read", "write", "transpose", "coerce", "strings", "dimscales"
+};
+
+
+void h5_profile_refresh(void) {
+  SEXP opt = GetOption1(install("h5lite.profile"));
+  h5_profiling = (TYPEOF(opt) == LGLSXP && XLENGTH(opt) == 1 && LOGICAL(opt)[0] == TRUE);
+}
+
+
+/* Seconds on a monotonic clock, with sub-microsecond resolution. */
+double h5_prof_now(void) {
+  struct timespec ts;
+#ifdef _WIN32
+  timespec_get(&ts, TIME_UTC);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+void h5_prof_add(h5_stage_t stage, double since, double bytes, double elements) {
+  h5_prof_counter_t *c = &counters[stage];
+  c->calls    += 1;
+  c->seconds  += h5_prof_now() - since;
+  c->bytes    += bytes;
+  c->elements += elements;
+}
+
+
+/*
+ * Records an H5Dread/H5Dwrite/H5Aread/H5Awrite of obj_id. Elements are those
+ * selected in mem_space_id, or the whole object for H5S_ALL; bytes are in the
+ * memory type, i.e. what HDF5 delivered after decompression and conversion.
+ */
+void h5_prof_io(h5_stage_t stage, double since, hid_t obj_id, hid_t mem_type_id, hid_t mem_space_id) {
+
+  if (!h5_profiling) return;
+
+  double  now      = h5_prof_now();
+  hid_t   space_id = mem_space_id;
+  if (space_id == H5S_ALL)
+    space_id = (H5Iget_type(obj_id) == H5I_ATTR) ? H5Aget_space(obj_id) : H5Dget_space(obj_id);
+
+  hssize_t n = (space_id >= 0) ? H5Sget_select_npoints(space_id) : 0;
+  if (n < 0) n = 0; // # nocov
+  if (space_id != mem_space_id && space_id >= 0) H5Sclose(space_id);
+
+  /* The dataspace queries above are not part of the I/O. */
+  h5_prof_add(stage, since + (h5_prof_now() - now), (double)n * (double)H5Tget_size(mem_type_id), (double)n);
+}
+
+
+/*
+ * C implementation of h5_profile(). Returns the counters accumulated so far
+ * as list(stage, calls, seconds, bytes, elements), then clears them if
+ * `reset` is TRUE.
+ */
+SEXP C_h5_profile_counters(SEXP reset) {
+
+  h5_profile_refresh();
+
+  SEXP stage    = PROTECT(allocVector(STRSXP,  H5LITE_PROF_N));
+  SEXP calls    = PROTECT(allocVector(REALSXP, H5LITE_PROF_N));
+  SEXP seconds  = PROTECT(allocVector(REALSXP, H5LITE_PROF_N));
+  SEXP bytes    = PROTECT(allocVector(REALSXP, H5LITE_PROF_N));
+  SEXP elements = PROTECT(allocVector(REALSXP, H5LITE_PROF_N));
+
+  for (int i = 0; i < H5LITE_PROF_N; i++) {
+    SET_STRING_ELT(stage, i, mkChar(stage_names[i]));
+    REAL(calls)[i]    = counters[i].calls;
+    REAL(seconds)[i]  = counters[i].seconds;
+    REAL(bytes)[i]    = counters[i].bytes;
+    REAL(elements)[i] = counters[i].elements;
+  }
+
+  if (asLogical(reset) == TRUE) memset(counters, 0, sizeof(counters));
+
+  SEXP result = PROTECT(allocVector(VECSXP, 5));
+  SEXP names  = PROTECT(allocVector(STRSXP, 5));
+  SET_VECTOR_ELT(result, 0, stage);    SET_STRING_ELT(names, 0, mkChar("stage"));
+  SET_VECTOR_ELT(result, 1, calls);    SET_STRING_ELT(names, 1, mkChar("calls"));
+  SET_VECTOR_ELT(result, 2, seconds);  SET_STRING_ELT(names, 2, mkChar("seconds"));
+  SET_VECTOR_ELT(result, 3, bytes);    SET_STRING_ELT(names, 3, mkChar("bytes"));
+  SET_VECTOR_ELT(result, 4, elements); SET_STRING_ELT(names, 4, mkChar("elements"));
+  setAttrib(result, R_NamesSymbol, names);
+
+  UNPROTECT(7);
+  return result;
+}
@@ -2,35 +2,239 @@
 
 /* Internal helper to dispatch H5Dread or H5Aread based on the object type. */
 static herr_t h5_read_impl(hid_t loc_id, hid_t mem_type_id, void *buf, int is_dataset, hid_t mem_space_id, hid_t file_space_id) {
-  if (is_dataset) { return H5Dread(loc_id, mem_type_id, mem_space_id, file_space_id, H5P_DEFAULT, buf); }
-  else            { return H5Aread(loc_id, mem_type_id, buf); }
+  H5LITE_PROF_BEGIN(t0);
+  herr_t status;
+  if (is_dataset) { status = H5Dread(loc_id, mem_type_id, mem_space_id, file_space_id, H5P_DEFAULT, buf); }
+  else            { status = H5Aread(loc_id, mem_type_id, buf); }
+  h5_prof_io(H5LITE_PROF_READ, t0, loc_id, mem_type_id, is_dataset ? mem_space_id : H5S_ALL);
+  return status;
+}
+
+
+/* --- BLOCKED READS --- */
+
+/*
+ * HDF5 stores arrays row-major; R wants them column-major. Rather than
+ * reading everything and transposing a duplicate, a multi-dimensional
+ * dataset selection is read in slabs of whole rows (along the first
+ * dimension) into a bounded scratch buffer, and each slab is transposed
+ * straight into the destination R vector.
+ *
+ * Selections made with `index` are unions of blocks rather than one block.
+ * They are read with a single H5Dread into a scratch buffer for the whole
+ * selection and transposed in one pass.
+ */
+typedef struct {
+  hid_t    dset_id;
+  hid_t    file_space_id; /* Private copy of the file dataspace */
+  int      ndims;
+  hsize_t *dims;          /* Shape of the selection (= the R dims) */
+  hsize_t *origin;        /* File coordinates of the selection's first element */
+  hsize_t  row_elems;     /* Elements per row: prod(dims[1 .. ndims-1]) */
+  hsize_t  slab_rows;     /* Rows per H5Dread */
+  hsize_t  chunk_rows;    /* Chunk extent along dims[0], or 1 if not chunked */
+  int      scattered;     /* Selection is not a single block: read it whole */
+} slab_plan_t;
+
+static void plan_slabs(slab_plan_t *plan, hid_t dset_id, hid_t file_space_id, 
+                       int ndims, hsize_t *dims, size_t el_size) {
+  
+  plan->dset_id       = dset_id;
+  plan->file_space_id = (file_space_id == H5S_ALL) ? H5Dget_space(dset_id) : H5Scopy(file_space_id);
+  plan->ndims         = ndims;
+  plan->dims          = dims;
+  plan->origin        = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+  plan->chunk_rows    = 1;
+  
+  /* A single-block selection starts at the low corner of its bounding box,
+   * and fills it. Anything else is a union of blocks. */
+  hsize_t *hi = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+  H5Sget_select_bounds(plan->file_space_id, plan->origin, hi);
+  
+  hsize_t box = 1;
+  for (int i = 0; i < ndims; i++) box *= hi[i] - plan->origin[i] + 1;
+  plan->scattered = ((hsize_t)H5Sget_select_npoints(plan->file_space_id) != box);
+  
+  plan->row_elems = 1;
+  for (int i = 1; i < ndims; i++) plan->row_elems *= dims[i];
+  
+  if (plan->scattered) {
+    plan->slab_rows = dims[0];
+    return;
+  }
+  
+  size_t  row_bytes = (plan->row_elems > 0 ? plan->row_elems : 1) * el_size;
+  hsize_t rows      = h5_block_bytes() / row_bytes;
+  if (rows < 1) rows = 1;
+  
+  /* Whole chunk rows per slab, so that every chunk is decompressed once.
+   * Chunks written with access = "column" hold every row; aligning to them
+   * would make the slab the whole selection. */
+  hid_t dcpl_id = H5Dget_create_plist(dset_id);
+  if (H5Pget_layout(dcpl_id) == H5D_CHUNKED && h5_access_hint(dset_id) != H5LITE_ACCESS_COLUMN) {
+    hsize_t *chunk_dims = (hsize_t *)R_alloc(ndims, sizeof(hsize_t));
+    if (H5Pget_chunk(dcpl_id, ndims, chunk_dims) == ndims && chunk_dims[0] > 0) {
+      plan->chunk_rows = chunk_dims[0];
+      rows = (rows < chunk_dims[0]) ? chunk_dims[0] : rows - (rows % chunk_dims[0]);
+    }
+  }
+  H5Pclose(dcpl_id);
+  
+  plan->slab_rows = (rows < dims[0]) ? rows : dims[0];
+}
+
+/* Number of rows in the slab starting at selection row r0, ending on a chunk boundary. */
+static hsize_t next_slab_rows(slab_plan_t *plan, hsize_t r0) {
+  hsize_t n = plan->slab_rows;
+  if (plan->chunk_rows > 1) {
+    hsize_t misalign = (plan->origin[0] + r0) % plan->chunk_rows;
+    if (n > misalign) n -= misalign;
+  }
+  if (n > plan->dims[0] - r0) n = plan->dims[0] - r0;
+  return n;
+}
+
+/* Reads rows [r0, r0 + n) of the selection into buf, in C order. */
+static herr_t read_slab(slab_plan_t *plan, hsize_t r0, hsize_t n, hid_t mem_type_id, 
+                        void *buf, hid_t *out_mem_space) {
+  
+  hsize_t start[H5S_MAX_RANK], count[H5S_MAX_RANK];
+  for (int i = 0; i < plan->ndims; i++) {
+    start[i] = plan->origin[i];
+    count[i] = plan->dims[i];
+  }
+  start[0] += r0;
+  count[0]  = n;
+  
+  /* A scattered selection is always read whole (one slab), as selected. */
+  if (!plan->scattered)
+    H5Sselect_hyperslab(plan->file_space_id, H5S_SELECT_SET, start, NULL, count, NULL);
+  H5LITE_PROF_BEGIN(t0);
+  hid_t  mem_space_id = H5Screate_simple(plan->ndims, count, NULL);
+  herr_t status = H5Dread(plan->dset_id, mem_type_id, mem_space_id, plan->file_space_id, H5P_DEFAULT, buf);
+  h5_prof_io(H5LITE_PROF_READ, t0, plan->dset_id, mem_type_id, mem_space_id);
+  
+  if (out_mem_space) { *out_mem_space = mem_space_id; }
+  else               { H5Sclose(mem_space_id);        }
+  return status;
+}
+
+
+/*
+ * Reads the selection into dest in R's column-major order.
+ * With options(h5lite.threads), eligible chunked datasets are decompressed in
+ * parallel by h5_read_chunks(). Otherwise, vectors are read in place and
+ * multi-dimensional datasets are streamed slab by slab; attributes (which
+ * HDF5 cannot read partially, and which are small) go through a single
+ * scratch buffer.
+ */
+static herr_t read_to_r_order(hid_t loc_id, int is_dataset, hid_t mem_type_id, size_t el_size, 
+                              void *dest, int ndims, hsize_t *dims, hsize_t total_elements, 
+                              hid_t mem_space_id, hid_t file_space_id) {
+  
+  /* Compressed chunks can be inflated on several threads at once. */
+  if (is_dataset) {
+    herr_t status = h5_read_chunks(loc_id, mem_type_id, el_size, dest, ndims, dims, file_space_id);
+    if (status != H5LITE_CHUNKS_FALLBACK) return status;
+  }
+  
+  if (ndims <= 1)
+    return h5_read_impl(loc_id, mem_type_id, dest, is_dataset, mem_space_id, file_space_id);
+  
+  if (total_elements == 0) return 0;
+  
+  herr_t status = 0;
+  
+  if (!is_dataset) {
+    void *buf = malloc(total_elements * el_size);
+    if (!buf) return -1; // # nocov
+    status = h5_read_impl(loc_id, mem_type_id, buf, 0, H5S_ALL, H5S_ALL);
+    if (status >= 0) h5_transpose(buf, dest, ndims, dims, el_size, 1);
+    free(buf);
+    return status;
+  }
+  
+  slab_plan_t plan;
+  plan_slabs(&plan, loc_id, file_space_id, ndims, dims, el_size);
+  
+  void *buf = malloc(plan.slab_rows * plan.row_elems * el_size);
+  if (!buf) { H5Sclose(plan.file_space_id); return -1; } // # nocov
+  
+  for (hsize_t r0 = 0; r0 < dims[0] && status >= 0; ) {
+    hsize_t n = next_slab_rows(&plan, r0);
+    status = read_slab(&plan, r0, n, mem_type_id, buf, NULL);
+    if (status >= 0) h5_transpose_slab(buf, dest, ndims, dims, el_size, r0, n, 1);
+    r0 += n;
+  }
+  
+  free(buf);
+  H5Sclose(plan.file_space_id);
+  return status;
 }
 
 
 /* --- READERS FOR ATOMIC TYPES --- */
 
+/*
+ * Integer file types narrower than 32 bits, signed 32-bit integers, and wider
+ * types whose precision keeps them in range fit in R's int. Reading them
+ * straight into an INTSXP/LGLSXP lets HDF5 do a single conversion pass and
+ * avoids the intermediate double vector and range scan.
+ */
+static int fits_native_int(hid_t file_type_id, H5T_class_t class_id, R_TYPE rtype) {
+  if (class_id != H5T_INTEGER) return 0;
+  if (rtype != R_TYPE_AUTO && rtype != R_TYPE_INTEGER && rtype != R_TYPE_LOGICAL) return 0;
+  size_t type_size = H5Tget_size(file_type_id);
+  return (type_size < 4) || (type_size == 4 && H5Tget_sign(file_type_id) == H5T_SGN_2) ||
+         h5_int_in_range(file_type_id);
+}
+
 static SEXP read_numeric(hid_t loc_id, int is_dataset, hid_t file_type_id, H5T_class_t class_id, 
                          int ndims, hsize_t *dims, hsize_t total_elements, R_TYPE rtype, 
                          hid_t mem_space_id, hid_t file_space_id) {
   
-  SEXP result = PROTECT(allocVector(REALSXP, (R_xlen_t)total_elements));
-  
+  SEXP   result = R_NilValue;
   herr_t status;
-  char   as_bit64 = (rtype == R_TYPE_BIT64);
-  if (as_bit64) { status = h5_read_impl(loc_id, H5T_NATIVE_INT64,  REAL(result), is_dataset, mem_space_id, file_space_id); }
-  else          { status = h5_read_impl(loc_id, H5T_NATIVE_DOUBLE, REAL(result), is_dataset, mem_space_id, file_space_id); }
+  
+  if (fits_native_int(file_type_id, class_id, rtype)) {
+    
+    SEXPTYPE sexp_type = (rtype == R_TYPE_LOGICAL) ? LGLSXP : INTSXP;
+    result = PROTECT(allocVector(sexp_type, (R_xlen_t)total_elements));
+    int *int_vec = (sexp_type == LGLSXP) ? LOGICAL(result) : INTEGER(result);
+    
+    status = read_to_r_order(loc_id, is_dataset, H5T_NATIVE_INT, sizeof(int), int_vec, 
+                             ndims, dims, total_elements, mem_space_id, file_space_id);
+    if (status < 0) { UNPROTECT(1); return mkChar("Failed to read numeric data"); }
+    
+    if (sexp_type == LGLSXP) {
+      for (hsize_t i = 0; i < total_elements; i++) int_vec[i] = (int_vec[i] != 0);
+    }
+    else if (!h5_int_in_range(file_type_id)) {
+      /* INT_MIN is R's NA_integer_. Such data goes through the double path:
+       * "auto" keeps it as double, and "integer" coerces it with R's
+       * out-of-range warning. */
+      hsize_t i = 0;
+      while (i < total_elements && int_vec[i] != NA_INTEGER) i++;
+      if (i < total_elements) { UNPROTECT(1); result = R_NilValue; }
+    }
+    
+    if (result != R_NilValue) {
+      set_r_dimensions(result, ndims, dims);
+      UNPROTECT(1);
+      return result;
+    }
+  }
+  
+  result = PROTECT(allocVector(REALSXP, (R_xlen_t)total_elements));
+  
+  hid_t mem_type_id = (rtype == R_TYPE_BIT64) ? H5T_NATIVE_INT64 : H5T_NATIVE_DOUBLE;
+  status = read_to_r_order(loc_id, is_dataset, mem_type_id, sizeof(double), REAL(result), 
+                           ndims, dims, total_elements, mem_space_id, file_space_id);
   if (status < 0) { UNPROTECT(1); return mkChar("Failed to read numeric data"); }
   
   UNPROTECT(1);
   result = PROTECT(coerce_to_rtype(result, rtype, file_type_id));
-  
-  if (ndims > 1) {
-    SEXP   dup_result = PROTECT(duplicate(result));
-    size_t el_size    = (TYPEOF(result) == REALSXP) ? sizeof(double) : sizeof(int);
-    h5_transpose(get_R_data_ptr(dup_result), get_R_data_ptr(result), ndims, dims, el_size, 1);
-    set_r_dimensions(result, ndims, dims);
-    UNPROTECT(1); 
-  }
+  set_r_dimensions(result, ndims, dims);
   
   UNPROTECT(1);
   return result; 
@@ -42,90 +246,148 @@ static SEXP read_complex(
   
   SEXP result = PROTECT(allocVector(CPLXSXP, (R_xlen_t)total_elements));
   hid_t mem_type_id = H5Tcomplex_create(H5T_NATIVE_DOUBLE);
-  herr_t status     = h5_read_impl(loc_id, mem_type_id, COMPLEX(result), is_dataset, mem_space_id, file_space_id);
+  herr_t status     = read_to_r_order(loc_id, is_dataset, mem_type_id, sizeof(Rcomplex), COMPLEX(result), 
+                                      ndims, dims, total_elements, mem_space_id, file_space_id);
   H5Tclose(mem_type_id);
   
   if (status < 0) { UNPROTECT(1); return mkChar("Failed to read complex data"); }
   
-  if (ndims > 1) {
-    SEXP dup_result = PROTECT(duplicate(result));
-    h5_transpose(COMPLEX(dup_result), COMPLEX(result), ndims, dims, sizeof(Rcomplex), 1);
-    set_r_dimensions(result, ndims, dims);
-    UNPROTECT(1); 
-  }
+  set_r_dimensions(result, ndims, dims);
   
   UNPROTECT(1);
   return result;
 }
 
+
+/*
+ * Stores rows [r0, r0 + n) of a string selection into result. `slab` holds
+ * those rows in C order, as char* (variable-length) or fixed-width records.
+ * For ndims > 1 the slab is first transposed into `scratch` (same size), which
+ * then holds a column-major (n, dims[1], ...) block: element i + c*n of it
+ * belongs at R index c*dims[0] + r0 + i.
+ */
+static void store_string_slab(SEXP result, char *slab, char *scratch, int ndims, hsize_t *dims, 
+                              hsize_t r0, hsize_t n, size_t el_size, int is_vlen, h5_strtab_t *tab) {
+  
+  hsize_t row_elems = 1;
+  char   *src       = slab;
+  
+  if (ndims > 1) {
+    hsize_t slab_dims[H5S_MAX_RANK];
+    for (int i = 0; i < ndims; i++) slab_dims[i] = dims[i];
+    slab_dims[0] = n;
+    for (int i = 1; i < ndims; i++) row_elems *= dims[i];
+    h5_transpose(slab, scratch, ndims, slab_dims, el_size, 1);
+    src = scratch;
+  }
+  
+  hsize_t stride = (ndims > 1) ? dims[0] : n;
+  
+  H5LITE_PROF_BEGIN(t0);
+  for (hsize_t c = 0; c < row_elems; c++) {
+    for (hsize_t i = 0; i < n; i++) {
+      char    *el  = src + (i + c * n) * el_size;
+      R_xlen_t idx = (R_xlen_t)(c * stride + r0 + i);
+      if (is_vlen) {
+        char *str_ptr; memcpy(&str_ptr, el, sizeof(char *));
+        if (str_ptr) { SET_STRING_ELT(result, idx, h5_mkchar(tab, str_ptr, strlen(str_ptr))); }
+        else         { SET_STRING_ELT(result, idx, NA_STRING); } // # nocov
+      } else {
+        /* Fixed-width records end at the first nul, if any */
+        char *end = (char *)memchr(el, '\0', el_size);
+        SET_STRING_ELT(result, idx, h5_mkchar(tab, el, end ? (size_t)(end - el) : el_size));
+      }
+    }
+  }
+  H5LITE_PROF_END(H5LITE_PROF_STRINGS, t0, n * row_elems * el_size, n * row_elems);
+}
+
 SEXP read_character(
     hid_t loc_id, int is_dataset, hid_t file_type_id, hid_t space_id, int ndims, 
     hsize_t *dims, hsize_t total_elements, hid_t mem_space_id, hid_t file_space_id) {
   
-  SEXP result = R_NilValue;
-  
-  /* 1. Detect the character set of the file dataset */
+  /* 1. Detect the character set and layout of the file dataset */
   H5T_cset_t file_cset = H5Tget_cset(file_type_id);
+  int        is_vlen   = H5Tis_variable_str(file_type_id);
+  size_t     el_size   = is_vlen ? sizeof(char *) : H5Tget_size(file_type_id);
   
-  if (H5Tis_variable_str(file_type_id)) {
-    char **c_buffer = (char **)malloc(total_elements * sizeof(char *));
-    char **f_buffer = (char **)malloc(total_elements * sizeof(char *));
-    if (!c_buffer || !f_buffer) { // # nocov start
-      free(c_buffer); free(f_buffer);
-      return mkChar("Memory allocation failed for variable-length strings");
-    } // # nocov end
+  hid_t mem_type = H5Tcopy(H5T_C_S1);
+  H5Tset_size(mem_type, is_vlen ? H5T_VARIABLE : el_size);
+  H5Tset_cset(mem_type, file_cset);
+  
+  SEXP result = PROTECT(allocVector(STRSXP, (R_xlen_t)total_elements));
+  
+  h5_strtab_t tab;
+  h5_strtab_init(&tab, (R_xlen_t)total_elements);
+  int  failed = 0;
+  
+  if (is_dataset && ndims > 1 && total_elements > 0) {
     
-    hid_t mem_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(mem_type, H5T_VARIABLE); 
-    H5Tset_cset(mem_type, file_cset);
+    /* 2a. Stream multi-dimensional datasets slab by slab */
+    slab_plan_t plan;
+    plan_slabs(&plan, loc_id, file_space_id, ndims, dims, el_size);
     
-    if (h5_read_impl(loc_id, mem_type, c_buffer, is_dataset, mem_space_id, file_space_id) < 0) {
-      result = PROTECT(mkChar("Failed to read variable-length strings")); // # nocov
-    } else {
-      result = PROTECT(allocVector(STRSXP, (R_xlen_t)total_elements));
-      h5_transpose(c_buffer, f_buffer, ndims, dims, sizeof(char*), 1);
-      for (hsize_t i = 0; i < total_elements; i++) {
-        if (f_buffer[i]) { SET_STRING_ELT(result, i, mkCharCE(f_buffer[i], CE_UTF8)); }
-        else             { SET_STRING_ELT(result, i, NA_STRING); } // # nocov
+    size_t slab_bytes = plan.slab_rows * plan.row_elems * el_size;
+    char  *slab       = (char *)malloc(slab_bytes);
+    char  *scratch    = (char *)malloc(slab_bytes);
+    
+    if (!slab || !scratch) { // # nocov start
+      free(slab); free(scratch); H5Tclose(mem_type); H5Sclose(plan.file_space_id); UNPROTECT(1);
+      return mkChar("Memory allocation failed for strings");
+    } // # nocov end
+    
+    for (hsize_t r0 = 0; r0 < dims[0] && !failed; ) {
+      hsize_t n = next_slab_rows(&plan, r0);
+      hid_t   slab_space;
+      if (read_slab(&plan, r0, n, mem_type, slab, &slab_space) < 0) {
+        failed = 1; // # nocov
+      } else {
+        store_string_slab(result, slab, scratch, ndims, dims, r0, n, el_size, is_vlen, &tab);
+        if (is_vlen) H5Dvlen_reclaim(mem_type, slab_space, H5P_DEFAULT, slab);
       }
+      H5Sclose(slab_space);
+      r0 += n;
     }
-    /* --- CLEANUP (Hyperslab-safe) --- */
-    hid_t reclaim_space = (mem_space_id != H5S_ALL) ? mem_space_id : space_id;
-    if (is_dataset) { H5Dvlen_reclaim(mem_type, reclaim_space, H5P_DEFAULT, c_buffer); }
-    else            { H5Treclaim(mem_type, reclaim_space, H5P_DEFAULT, c_buffer);      }
-    free(c_buffer); free(f_buffer); H5Tclose(mem_type);
+    
+    free(slab); free(scratch);
+    H5Sclose(plan.file_space_id);
   }
-  else {
-    size_t type_size = H5Tget_size(file_type_id);
-    char *c_buffer = (char *)malloc(total_elements * type_size);
-    char *f_buffer = (char *)malloc(total_elements * type_size);
-    if (!c_buffer || !f_buffer) { // # nocov start
-      free(c_buffer); free(f_buffer);
-      return mkChar("Memory allocation failed for fixed-length strings");
-    } // # nocov end
+  else if (total_elements > 0) {
     
-    hid_t mem_type = H5Tcopy(H5T_C_S1);
-    H5Tset_size(mem_type, type_size);
-    H5Tset_cset(mem_type, file_cset);
+    /* 2b. Vectors, scalars, and attributes are read in one go */
+    char *c_buffer = (char *)malloc(total_elements * el_size);
+    char *scratch  = (ndims > 1) ? (char *)malloc(total_elements * el_size) : NULL;
+    
+    if (!c_buffer || (ndims > 1 && !scratch)) { // # nocov start
+      free(c_buffer); free(scratch); H5Tclose(mem_type); UNPROTECT(1);
+      return mkChar("Memory allocation failed for strings");
+    } // # nocov end
     
     if (h5_read_impl(loc_id, mem_type, c_buffer, is_dataset, mem_space_id, file_space_id) < 0) {
-      result = PROTECT(mkChar("Failed to read fixed-length strings")); // # nocov
-    }else {
-      result = PROTECT(allocVector(STRSXP, (R_xlen_t)total_elements));
-      h5_transpose(c_buffer, f_buffer, ndims, dims, type_size, 1);
-      char *single_str = (char *)R_alloc(type_size + 1, sizeof(char));
-      for (hsize_t i = 0; i < total_elements; i++) {
-        memcpy(single_str, f_buffer + (i * type_size), type_size);
-        single_str[type_size] = '\0';
-        SET_STRING_ELT(result, i, mkCharCE(single_str, CE_UTF8));
+      failed = 1; // # nocov
+    } else {
+      hsize_t rows = (ndims > 1) ? dims[0] : total_elements;
+      store_string_slab(result, c_buffer, scratch, ndims, dims, 0, rows, el_size, is_vlen, &tab);
+      
+      /* --- CLEANUP (Hyperslab-safe) --- */
+      if (is_vlen) {
+        hid_t reclaim_space = (mem_space_id != H5S_ALL) ? mem_space_id : space_id;
+        if (is_dataset) { H5Dvlen_reclaim(mem_type, reclaim_space, H5P_DEFAULT, c_buffer); }
+        else            { H5Treclaim(mem_type, reclaim_space, H5P_DEFAULT, c_buffer);      }
       }
     }
-    free(c_buffer); free(f_buffer); H5Tclose(mem_type);
+    free(c_buffer); free(scratch);
   }
   
-  if (TYPEOF(result) != CHARSXP)
-    set_r_dimensions(result, ndims, dims);
+  H5Tclose(mem_type);
+  UNPROTECT(1);
+  
+  if (failed) { // # nocov start
+    return mkChar(is_vlen ? "Failed to read variable-length strings" : "Failed to read fixed-length strings");
+  } // # nocov end
   
+  PROTECT(result);
+  set_r_dimensions(result, ndims, dims);
   UNPROTECT(1);
   return result;
 }
@@ -139,19 +401,14 @@ static SEXP read_raw(
   
   hid_t  mem_type = H5Tcreate(H5T_OPAQUE, type_size);
   SEXP   result   = PROTECT(allocVector(RAWSXP, (R_xlen_t)total_elements));
-  herr_t status   = h5_read_impl(loc_id, mem_type, RAW(result), is_dataset, mem_space_id, file_space_id);
+  herr_t status   = read_to_r_order(loc_id, is_dataset, mem_type, type_size, RAW(result), 
+                                    ndims, dims, total_elements, mem_space_id, file_space_id);
+  H5Tclose(mem_type);
   
-  if (status < 0) {
-    result = PROTECT(mkChar("Failed to read raw data")); // # nocov
-  }
-  else if (ndims > 1) {
-    SEXP dup_result = PROTECT(duplicate(result));
-    h5_transpose(RAW(dup_result), RAW(result), ndims, dims, type_size, 1);
-    set_r_dimensions(result, ndims, dims);
-    UNPROTECT(1); 
-  }
+  if (status < 0) { UNPROTECT(1); return mkChar("Failed to read raw data"); } // # nocov
+  
+  set_r_dimensions(result, ndims, dims);
   
-  H5Tclose(mem_type);
   UNPROTECT(1);
   return result;
 }
@@ -186,10 +443,11 @@ static SEXP read_factor(
     }
   }
 
-  /* 3. Read the data using the custom memory Enum type */
+  /* 3. Read the data using the custom memory Enum type, in R order */
   /* HDF5 will automatically match names from the file to our 1-based integers */
   SEXP result = PROTECT(allocVector(INTSXP, (R_xlen_t)total_elements));
-  herr_t status = h5_read_impl(loc_id, mem_type_id, INTEGER(result), is_dataset, mem_space_id, file_space_id);
+  herr_t status = read_to_r_order(loc_id, is_dataset, mem_type_id, sizeof(int), INTEGER(result), 
+                                  ndims, dims, total_elements, mem_space_id, file_space_id);
   
   H5Tclose(mem_type_id);
 
@@ -198,15 +456,9 @@ static SEXP read_factor(
     return mkChar("Failed to read enum values"); 
   } // # nocov end
   
-  /* 4. Handle Transposition (if necessary) */
-  if (ndims > 1) {
-    SEXP dup_result = PROTECT(duplicate(result));
-    h5_transpose(INTEGER(dup_result), INTEGER(result), ndims, dims, sizeof(int), 1);
-    set_r_dimensions(result, ndims, dims);
-    UNPROTECT(1); 
-  }
+  set_r_dimensions(result, ndims, dims);
   
-  /* 5. Set Class and Levels */
+  /* 4. Set Class and Levels */
   setAttrib(result, R_LevelsSymbol, levels);
   
   SEXP class_attr = PROTECT(allocVector(STRSXP, 1));
@@ -219,19 +471,76 @@ static SEXP read_factor(
 }
 
 
-/* --- DATASET READ ENTRY POINT --- */
-
-SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name, SEXP start, SEXP count) {
+/*
+ * Reads a dataset written with as = "dict": unsigned integer codes into the
+ * strings of its "h5lite_dict" attribute, with 0 standing for NA. Returns a
+ * character vector, or with `as_factor`, a factor whose levels are the
+ * dictionary.
+ */
+static SEXP read_dict(hid_t dset_id, hid_t file_type_id, int ndims, hsize_t *dims, 
+                      hsize_t total_elements, int as_factor, hid_t mem_space_id, hid_t file_space_id) {
   
-  const char *fname   = Rf_translateCharUTF8(STRING_ELT(filename,     0));
-  const char *dname   = Rf_translateCharUTF8(STRING_ELT(dataset_name, 0));
-  const char *el_name = Rf_translateCharUTF8(STRING_ELT(element_name, 0));
+  /* Codes come back as integers: uint8 and uint16 ones read natively, uint32
+   * ones through double and coerceVector(). Codes above INT_MAX become NA and
+   * fail the range check below. */
+  SEXP codes = PROTECT(read_numeric(dset_id, 1, file_type_id, H5T_INTEGER, ndims, dims, total_elements, 
+                                    R_TYPE_INTEGER, mem_space_id, file_space_id));
+  if (TYPEOF(codes) == CHARSXP) { UNPROTECT(1); return codes; } // # nocov
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
-  if (file_id < 0) error("Failed to open file: %s", fname);
+  hid_t   attr_id  = H5Aopen(dset_id, H5LITE_DICT_ATTR, H5P_DEFAULT);
+  hid_t   atype_id = H5Aget_type(attr_id);
+  hid_t   aspace   = H5Aget_space(attr_id);
+  hsize_t n_dict   = (hsize_t)H5Sget_simple_extent_npoints(aspace);
   
-  hid_t dset_id = H5Dopen2(file_id, dname, H5P_DEFAULT);
-  if (dset_id < 0) { H5Fclose(file_id); error("Failed to open dataset: %s", dname); }
+  SEXP dict = PROTECT(read_character(attr_id, 0, atype_id, aspace, 1, &n_dict, n_dict, H5S_ALL, H5S_ALL));
+  H5Sclose(aspace); H5Tclose(atype_id); H5Aclose(attr_id);
+  
+  if (TYPEOF(dict) == CHARSXP) { UNPROTECT(2); return dict; } // # nocov
+  
+  R_xlen_t n      = (R_xlen_t)total_elements;
+  SEXP     result = PROTECT(allocVector(as_factor ? INTSXP : STRSXP, n));
+  
+  for (R_xlen_t i = 0; i < n; i++) {
+    double code = (TYPEOF(codes) == INTSXP) ? INTEGER(codes)[i] : REAL(codes)[i];
+    if (!(code >= 0 && code <= (double)n_dict)) { // # nocov start
+      UNPROTECT(3);
+      return mkChar("Dictionary code out of range");
+    } // # nocov end
+    if (as_factor) INTEGER(result)[i] = (code == 0) ? NA_INTEGER : (int)code;
+    else           SET_STRING_ELT(result, i, (code == 0) ? NA_STRING : STRING_ELT(dict, (R_xlen_t)code - 1));
+  }
+  
+  set_r_dimensions(result, ndims, dims);
+  
+  if (as_factor) {
+    setAttrib(result, R_LevelsSymbol, dict);
+    SEXP class_attr = PROTECT(allocVector(STRSXP, 1));
+    SET_STRING_ELT(class_attr, 0, mkChar("factor"));
+    setAttrib(result, R_ClassSymbol, class_attr);
+    UNPROTECT(1);
+  }
+  
+  UNPROTECT(3);
+  return result;
+}
+
+
+/* --- DATASET READ --- */
+
+/*
+ * Reads all of an open dataset, the hyperslab described by `start` and
+ * `count`, or the per-dimension index sets in `index`, into an R object.
+ * Shared by C_h5_read_dataset() and the block cursor used by h5_apply().
+ * Returns a CHARSXP error message on failure.
+ *
+ * `index` is NULL or a list with one element per dimension, each NULL (the
+ * whole dimension) or a double vector of sorted, distinct, in-bounds 1-based
+ * indices, as validated by h5_read(). `cols` is NULL or the names of the
+ * compound members to read. With `scales` = 0, attached dimension scales are
+ * not read into names/dimnames.
+ */
+SEXP read_dataset(hid_t dset_id, SEXP rmap, const char *el_name, SEXP start, SEXP count, 
+                  SEXP index, SEXP cols, int scales) {
   
   hid_t       file_type_id = H5Dget_type(dset_id);
   H5T_class_t class_id     = H5Tget_class(file_type_id);
@@ -239,7 +548,7 @@ SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element
   R_TYPE      rtype        = rtype_from_map(file_type_id, rmap, el_name);
   
   if (H5Sget_simple_extent_type(space_id) == H5S_NULL || rtype == R_TYPE_NULL) {
-    H5Sclose(space_id); H5Tclose(file_type_id); H5Dclose(dset_id); H5Fclose(file_id);
+    H5Sclose(space_id); H5Tclose(file_type_id);
     return R_NilValue;
   }
   
@@ -248,6 +557,7 @@ SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element
   hsize_t *dims      = NULL;
   hsize_t *mem_dims  = NULL;
   hsize_t *offset    = NULL;
+  hsize_t **coords   = NULL;
   hid_t mem_space_id = H5S_ALL;
   int has_hyperslab = 0;
   
@@ -302,9 +612,26 @@ SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element
       }
     }
     
+    /* 1b. Parse Index Sets (Guaranteed by R to have one entry per dimension) */
+    if (index != R_NilValue && Rf_length(index) == ndims) {
+      has_hyperslab = 1;
+      coords = (hsize_t **)R_alloc(ndims, sizeof(hsize_t *));
+      
+      for (int i = 0; i < ndims; i++) {
+        SEXP idx  = VECTOR_ELT(index, i);
+        coords[i] = NULL;
+        if (idx == R_NilValue) continue;
+        
+        R_xlen_t n = XLENGTH(idx);
+        coords[i]  = (hsize_t *)R_alloc(n > 0 ? n : 1, sizeof(hsize_t));
+        for (R_xlen_t k = 0; k < n; k++) coords[i][k] = (hsize_t)REAL(idx)[k] - 1;
+        mem_dims[i] = (hsize_t)n;
+      }
+    }
+    
     /* 2. Apply Selection */
     if (has_hyperslab) {
-      H5Sselect_hyperslab(space_id, H5S_SELECT_SET, offset, NULL, mem_dims, NULL);
+      h5_select_coords(space_id, ndims, coords, offset, mem_dims);
       mem_space_id = H5Screate_simple(ndims, mem_dims, NULL);
       
       /* Recalculate total elements based on the newly selected hyperslab block */
@@ -319,7 +646,11 @@ SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element
   hsize_t *final_dims = has_hyperslab ? mem_dims : dims;
   
   /* Dispatch to specific readers, passing the memory and file dataspace IDs */
-  if (class_id == H5T_INTEGER || class_id == H5T_FLOAT) {
+  if (class_id == H5T_INTEGER && H5Aexists(dset_id, H5LITE_DICT_ATTR) > 0) {
+    result = read_dict(dset_id, file_type_id, ndims, final_dims, total_elements, 
+                       rmap_is_factor(rmap, el_name), mem_space_id, space_id);
+  }
+  else if (class_id == H5T_INTEGER || class_id == H5T_FLOAT) {
     result = read_numeric(dset_id, 1, file_type_id, class_id, ndims, final_dims, total_elements, rtype, mem_space_id, space_id);
   }
   else if (class_id == H5T_COMPLEX) {
@@ -336,50 +667,72 @@ SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element
   }
   else if (class_id == H5T_COMPOUND) {
     result = read_data_frame(dset_id, 1, file_type_id, space_id, rmap, mem_space_id, space_id, 
-                             has_hyperslab ? offset : NULL, has_hyperslab ? mem_dims : NULL);
+                             has_hyperslab ? offset : NULL, has_hyperslab ? mem_dims : NULL, coords, cols);
   }
   else {
     result = mkChar("Unsupported HDF5 type"); // # nocov
   }
   
   /* For Atomic types, check for attached Dimension Scales and restore names/dimnames */
-  if (class_id != H5T_COMPOUND && TYPEOF(result) != CHARSXP) {
-    read_r_dimscales(dset_id, ndims, result, has_hyperslab ? offset : NULL, has_hyperslab ? mem_dims : NULL);
+  if (scales && class_id != H5T_COMPOUND && TYPEOF(result) != CHARSXP) {
+    read_r_dimscales(dset_id, ndims, result, has_hyperslab ? offset : NULL, has_hyperslab ? mem_dims : NULL, coords);
   }
   
   /* Clean up */
   if (mem_space_id != H5S_ALL) H5Sclose(mem_space_id);
-  H5Tclose(file_type_id); H5Sclose(space_id); H5Dclose(dset_id); H5Fclose(file_id);
-  
-  if (TYPEOF(result) == CHARSXP)
-    error("Error reading dataset '%s'\n%s", dname, CHAR(result)); // # nocov
+  H5Tclose(file_type_id); H5Sclose(space_id);
   
   return result;
 }
 
 
-/* --- ATTRIBUTE READ ENTRY POINT --- */
+/* --- DATASET READ ENTRY POINT --- */
 
-SEXP C_h5_read_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP rmap) {
-  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
-  const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
-  const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
+SEXP C_h5_read_dataset(SEXP filename, SEXP dataset_name, SEXP rmap, SEXP element_name, 
+                       SEXP start, SEXP count, SEXP index, SEXP cols) {
+  
+  const char *fname   = Rf_translateCharUTF8(STRING_ELT(filename,     0));
+  const char *dname   = Rf_translateCharUTF8(STRING_ELT(dataset_name, 0));
+  const char *el_name = Rf_translateCharUTF8(STRING_ELT(element_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
   if (file_id < 0) error("Failed to open file: %s", fname);
   
-  hid_t attr_id = H5Aopen_by_name(file_id, oname, aname, H5P_DEFAULT, H5P_DEFAULT);
-  if (attr_id < 0) { H5Fclose(file_id); error("Failed to open attribute: %s", aname); }
+  hid_t dset_id = h5_dataset_open(file_id, dname, 0);
+  if (dset_id < 0) { h5_file_close(file_id); error("Failed to open dataset: %s", dname); }
+  
+  SEXP result = read_dataset(dset_id, rmap, el_name, start, count, index, cols, 1);
+  
+  H5Dclose(dset_id); h5_file_close(file_id);
+  
+  if (TYPEOF(result) == CHARSXP)
+    error("Error reading dataset '%s'\n%s", dname, CHAR(result)); // # nocov
+  
+  return result;
+}
+
+
+/* --- ATTRIBUTE READ ENTRY POINTS --- */
+
+/* Attributes that h5lite uses internally and h5_read() does not return. */
+static const char *hidden_attrs[] = {
+  "DIMENSION_LIST", "REFERENCE_LIST", H5LITE_ACCESS_ATTR, H5LITE_COLUMNS_ATTR, H5LITE_DICT_ATTR,
+  H5LITE_COMPRESS_ATTR
+};
+
+
+/* Reads an open attribute. Returns NULL for empty ones, or a CHARSXP error. */
+static SEXP read_attribute(hid_t attr_id, const char *aname, SEXP rmap) {
   
   hid_t       file_type_id = H5Aget_type(attr_id);
   H5T_class_t class_id     = H5Tget_class(file_type_id);
   hid_t       space_id     = H5Aget_space(attr_id);
   R_TYPE      rtype        = rtype_from_map(file_type_id, rmap, aname);
   
-  if (H5Sget_simple_extent_type(space_id) == H5S_NULL || rtype == R_TYPE_NULL) { // # nocov start
-    H5Sclose(space_id); H5Tclose(file_type_id); H5Aclose(attr_id); H5Fclose(file_id);
+  if (H5Sget_simple_extent_type(space_id) == H5S_NULL || rtype == R_TYPE_NULL) {
+    H5Sclose(space_id); H5Tclose(file_type_id);
     return R_NilValue;
-  } // # nocov end
+  }
   
   int ndims = H5Sget_simple_extent_ndims(space_id);
   hsize_t total_elements = 1;
@@ -409,16 +762,425 @@ SEXP C_h5_read_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP rmap
     result = read_factor(attr_id, 0, file_type_id, ndims, dims, total_elements, H5S_ALL, H5S_ALL);
   }
   else if (class_id == H5T_COMPOUND) {
-    result = read_data_frame(attr_id, 0, file_type_id, space_id, rmap, H5S_ALL, H5S_ALL, NULL, NULL);
+    result = read_data_frame(attr_id, 0, file_type_id, space_id, rmap, H5S_ALL, H5S_ALL, NULL, NULL, NULL, R_NilValue);
   }
   else {
     result = mkChar("Unsupported HDF5 type"); // # nocov
   }
   
-  H5Tclose(file_type_id); H5Sclose(space_id); H5Aclose(attr_id); H5Fclose(file_id);
+  H5Tclose(file_type_id); H5Sclose(space_id);
+  return result;
+}
+
+
+SEXP C_h5_read_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP rmap) {
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
+  const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+  
+  hid_t attr_id = H5Aopen_by_name(file_id, oname, aname, H5P_DEFAULT, H5P_DEFAULT);
+  if (attr_id < 0) { h5_file_close(file_id); error("Failed to open attribute: %s", aname); }
+  
+  SEXP result = read_attribute(attr_id, aname, rmap);
+  
+  H5Aclose(attr_id); h5_file_close(file_id);
   
   if (TYPEOF(result) == CHARSXP)
     error("Error reading attribute '%s': %s", aname, CHAR(result)); // # nocov
   
   return result;
 }
+
+
+typedef struct {
+  SEXP        rmap;
+  SEXP        values;   /* Preallocated for every attribute of the object */
+  SEXP        names;
+  R_xlen_t    n;        /* Number of values read so far */
+  SEXP        errmsg;   /* Set when an attribute could not be read */
+} h5_attr_read_t;
+
+/*
+ * H5Aiterate2() callback for read_attributes(). Skips h5lite's own
+ * attributes, and those of a class that h5_class() has no R class for.
+ */
+static herr_t read_attr_cb(hid_t loc_id, const char *aname, const H5A_info_t *ainfo, void *op_data) {
+  
+  h5_attr_read_t *ctx = (h5_attr_read_t *)op_data;
+  
+  for (size_t i = 0; i < sizeof(hidden_attrs) / sizeof(*hidden_attrs); i++)
+    if (strcmp(aname, hidden_attrs[i]) == 0) return 0;
+  
+  hid_t attr_id = H5Aopen(loc_id, aname, H5P_DEFAULT);
+  if (attr_id < 0) { // # nocov start
+    ctx->errmsg = errmsg_2("Error reading attribute '%s': %s", aname, "Failed to open attribute");
+    return -1;
+  } // # nocov end
+  
+  hid_t       type_id  = H5Aget_type(attr_id);
+  H5T_class_t class_id = H5Tget_class(type_id);
+  hid_t       space_id = H5Aget_space(attr_id);
+  int         readable = H5Sget_simple_extent_type(space_id) == H5S_NULL ||
+    class_id == H5T_INTEGER || class_id == H5T_FLOAT  || class_id == H5T_STRING ||
+    class_id == H5T_COMPLEX || class_id == H5T_OPAQUE || class_id == H5T_ENUM   ||
+    class_id == H5T_COMPOUND;
+  H5Sclose(space_id); H5Tclose(type_id);
+  
+  SEXP val = readable ? read_attribute(attr_id, aname, ctx->rmap) : R_NilValue;
+  H5Aclose(attr_id);
+  
+  if (TYPEOF(val) == CHARSXP) { // # nocov start
+    PROTECT(val);
+    ctx->errmsg = errmsg_2("Error reading attribute '%s': %s", aname, CHAR(val));
+    UNPROTECT(1);
+    return -1;
+  } // # nocov end
+  if (val == R_NilValue) return 0;
+  
+  SET_VECTOR_ELT(ctx->values, ctx->n, val);
+  SET_STRING_ELT(ctx->names,  ctx->n, mkCharCE(aname, CE_UTF8));
+  ctx->n++;
+  
+  return 0;
+}
+
+
+/*
+ * Reads every attribute of an open object through H5Aiterate2(), for the
+ * `num_attrs` that H5Oget_info() reports. Returns a named list, without
+ * h5lite's own attributes, unreadable ones, and those that are empty or read
+ * with `as = "null"`; or a CHARSXP on error.
+ */
+static SEXP read_attributes(hid_t obj_id, hsize_t num_attrs, SEXP rmap) {
+  
+  h5_attr_read_t ctx;
+  ctx.rmap   = rmap;
+  ctx.values = PROTECT(allocVector(VECSXP, (R_xlen_t)num_attrs));
+  ctx.names  = PROTECT(allocVector(STRSXP, (R_xlen_t)num_attrs));
+  ctx.n      = 0;
+  ctx.errmsg = R_NilValue;
+  
+  if (num_attrs > 0)
+    H5Aiterate2(obj_id, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, read_attr_cb, &ctx);
+  
+  if (ctx.errmsg != R_NilValue) { UNPROTECT(2); return ctx.errmsg; } // # nocov
+  
+  SEXP result = PROTECT(lengthgets(ctx.values, ctx.n));
+  setAttrib(result, R_NamesSymbol, lengthgets(ctx.names, ctx.n));
+  
+  UNPROTECT(3);
+  return result;
+}
+
+
+/*
+ * C implementation of the attributes that h5_read() attaches to an object.
+ * Opens the object once and reads every attribute through H5Aiterate2(),
+ * rather than re-opening the file and object once per attribute.
+ */
+SEXP C_h5_read_attributes(SEXP filename, SEXP obj_name, SEXP rmap) {
+  
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (file_id < 0) error("Failed to open file: %s", fname);
+  
+  hid_t obj_id = H5Oopen(file_id, oname, H5P_DEFAULT);
+  if (obj_id < 0) { h5_file_close(file_id); error("Failed to open object: %s", oname); }
+  
+  H5O_info_t oinfo;
+  if (H5Oget_info(obj_id, &oinfo, H5O_INFO_NUM_ATTRS) < 0) { // # nocov start
+    H5Oclose(obj_id); h5_file_close(file_id);
+    error("Failed to get object info");
+  } // # nocov end
+  
+  SEXP result = PROTECT(read_attributes(obj_id, oinfo.num_attrs, rmap));
+  
+  H5Oclose(obj_id); h5_file_close(file_id);
+  
+  if (TYPEOF(result) == CHARSXP) error("%s", CHAR(result)); // # nocov
+  
+  UNPROTECT(1);
+  return result;
+}
+
+
+/* --- GROUP READ ENTRY POINT --- */
+
+typedef struct {
+  SEXP        filename;
+  const char *fname;
+  SEXP        group_name;
+  SEXP        rmap;
+  SEXP        attr_rmap;
+  int         mmap;
+  int         lazy;
+  SEXP        session;   /* Temporary handle, or NULL */
+  hid_t       file_id;
+  hid_t       group_id;
+} h5_group_read_t;
+
+typedef struct {
+  SEXP     names;     /* Preallocated for every link in the group */
+  R_xlen_t n;
+} h5_group_members_t;
+
+static SEXP read_group(h5_group_read_t *ctx, hid_t group_id, const char *gname);
+
+
+/* "<group>/<name>", as h5_ls(full.names = TRUE) would return it. */
+static const char *child_path(const char *gname, const char *cname) {
+  int    is_root = (strcmp(gname, "/") == 0);
+  size_t len     = strlen(gname) + strlen(cname) + 2;
+  char  *path    = R_alloc(len, sizeof(char));
+  snprintf(path, len, "%s/%s", is_root ? "" : gname, cname);
+  return path;
+}
+
+
+/* H5Literate() callback for read_group(): collects the names of the members. */
+static herr_t group_member_cb(hid_t group_id, const char *name, const H5L_info_t *info, void *op_data) {
+  h5_group_members_t *m = (h5_group_members_t *)op_data;
+  if (m->n >= XLENGTH(m->names)) return 1; // # nocov
+  SET_STRING_ELT(m->names, m->n++, mkCharCE(name, CE_UTF8));
+  return 0;
+}
+
+
+/* Drops the columns of a columnar data.frame skipped with `as = "null"`. */
+static SEXP drop_null_columns(SEXP df) {
+  
+  R_xlen_t n = XLENGTH(df), n_keep = 0;
+  for (R_xlen_t i = 0; i < n; i++) n_keep += (VECTOR_ELT(df, i) != R_NilValue);
+  if (n_keep == n) return df;
+  
+  SEXP names  = getAttrib(df, R_NamesSymbol);
+  SEXP result = PROTECT(allocVector(VECSXP, n_keep));
+  SEXP rnames = PROTECT(allocVector(STRSXP, n_keep));
+  
+  for (R_xlen_t i = 0, j = 0; i < n; i++) {
+    if (VECTOR_ELT(df, i) == R_NilValue) continue;
+    SET_VECTOR_ELT(result, j, VECTOR_ELT(df, i));
+    SET_STRING_ELT(rnames, j, STRING_ELT(names, i));
+    j++;
+  }
+  setAttrib(result, R_NamesSymbol,    rnames);
+  setAttrib(result, R_ClassSymbol,    getAttrib(df, R_ClassSymbol));
+  setAttrib(result, R_RowNamesSymbol, getAttrib(df, R_RowNamesSymbol));
+  
+  UNPROTECT(2);
+  return result;
+}
+
+
+/* Reads an open columnar data.frame group, with the columns it lists. */
+static SEXP read_group_columns(h5_group_read_t *ctx, hid_t group_id, const char *path) {
+  
+  hid_t attr_id = H5Aopen(group_id, H5LITE_COLUMNS_ATTR, H5P_DEFAULT);
+  if (attr_id < 0) return errmsg_1("Failed to open attribute: %s", H5LITE_COLUMNS_ATTR); // # nocov
+  
+  SEXP cols = PROTECT(read_attribute(attr_id, H5LITE_COLUMNS_ATTR, R_NilValue));
+  H5Aclose(attr_id);
+  
+  SEXP res = (TYPEOF(cols) == STRSXP)
+    ? read_columns(group_id, cols, ctx->rmap, R_NilValue, R_NilValue, R_NilValue)
+    : mkChar("Invalid column list"); // # nocov
+  PROTECT(res);
+  
+  res = (TYPEOF(res) == CHARSXP)
+    ? errmsg_2("Error reading data.frame '%s'\n%s", path, CHAR(res))
+    : drop_null_columns(res);
+  
+  UNPROTECT(2);
+  return res;
+}
+
+
+/* Reads an open dataset: mapped, lazily or in full, as requested. */
+static SEXP read_group_dataset(h5_group_read_t *ctx, hid_t dset_id, const char *path, const char *name) {
+  
+  SEXP res = R_NilValue;
+  
+  if (ctx->mmap)
+    res = h5_read_mmap(ctx->fname, ctx->file_id, dset_id, ctx->rmap, name);
+  if (ctx->lazy && res == R_NilValue)
+    res = h5_read_lazy(ctx->fname, path, dset_id, ctx->rmap, name);
+  if (res == R_NilValue) {
+    res = PROTECT(read_dataset(dset_id, ctx->rmap, name, R_NilValue, R_NilValue, R_NilValue, R_NilValue, 1));
+    if (TYPEOF(res) == CHARSXP) res = errmsg_2("Error reading dataset '%s'\n%s", path, CHAR(res)); // # nocov
+    UNPROTECT(1);
+  }
+  
+  return res;
+}
+
+
+/*
+ * Reads the member `name` of an open group, with its attributes, from the
+ * object's own id. Sets *skip for members that h5_ls() does not list.
+ * Returns a CHARSXP on error.
+ */
+static SEXP read_group_child(h5_group_read_t *ctx, hid_t group_id, const char *gname, 
+                             const char *name, int *skip) {
+  
+  const char *path = child_path(gname, name);
+  *skip = 0;
+  
+  hid_t obj_id = H5Oopen(group_id, name, H5P_DEFAULT);
+  if (obj_id < 0) return errmsg_1("Failed to open object: %s", path);
+  
+  H5O_info_t oinfo;
+  if (H5Oget_info(obj_id, &oinfo, H5O_INFO_BASIC | H5O_INFO_NUM_ATTRS) < 0) { // # nocov start
+    H5Oclose(obj_id);
+    return errmsg_1("Failed to get object info: %s", path);
+  } // # nocov end
+  
+  SEXP res;
+  
+  if (oinfo.type == H5O_TYPE_GROUP) {
+    res = (H5Aexists(obj_id, H5LITE_COLUMNS_ATTR) > 0)
+      ? read_group_columns(ctx, obj_id, path)
+      : read_group(ctx, obj_id, path);
+  }
+  else if (oinfo.type == H5O_TYPE_DATASET) {
+    if (H5DSis_scale(obj_id) > 0) { H5Oclose(obj_id); *skip = 1; return R_NilValue; }
+    res = read_group_dataset(ctx, obj_id, path, name);
+  }
+  else {
+    res = errmsg_1("Failed to open dataset: %s", path);
+  }
+  PROTECT(res);
+  
+  /* Attach the object's attributes, as read_data() does in R. */
+  if (res != R_NilValue && TYPEOF(res) != CHARSXP) {
+    SEXP attrs = PROTECT(read_attributes(obj_id, oinfo.num_attrs, ctx->attr_rmap));
+    if (TYPEOF(attrs) == CHARSXP) {
+      res = attrs; // # nocov
+    }
+    else {
+      SEXP names = getAttrib(attrs, R_NamesSymbol);
+      for (R_xlen_t i = 0; i < XLENGTH(attrs); i++)
+        setAttrib(res, install(Rf_translateChar(STRING_ELT(names, i))), VECTOR_ELT(attrs, i));
+    }
+    UNPROTECT(1);
+  }
+  
+  H5Oclose(obj_id);
+  
+  UNPROTECT(1);
+  return res;
+}
+
+
+/*
+ * Reads every member of an open group into a named list, ordered as R's
+ * sort() orders their names. The group is walked once with H5Literate(), and
+ * each member is read from its own id; member groups are read recursively.
+ * Returns a CHARSXP on error.
+ */
+static SEXP read_group(h5_group_read_t *ctx, hid_t group_id, const char *gname) {
+  
+  H5G_info_t ginfo;
+  if (H5Gget_info(group_id, &ginfo) < 0) return errmsg_1("Failed to read group: %s", gname); // # nocov
+  
+  h5_group_members_t members;
+  members.names = PROTECT(allocVector(STRSXP, (R_xlen_t)ginfo.nlinks));
+  members.n     = 0;
+  H5Literate(group_id, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, group_member_cb, &members);
+  
+  R_xlen_t n = members.n;
+  if (n < XLENGTH(members.names)) members.names = lengthgets(members.names, n); // # nocov
+  PROTECT(members.names);
+  
+  int *order = (int *)R_alloc(n > 0 ? n : 1, sizeof(int));
+  R_orderVector1(order, (int)n, members.names, TRUE, FALSE);
+  
+  SEXP     result = PROTECT(allocVector(VECSXP, n));
+  SEXP     names  = PROTECT(allocVector(STRSXP, n));
+  R_xlen_t n_read = 0;
+  
+  for (R_xlen_t i = 0; i < n; i++) {
+    SEXP el_name = STRING_ELT(members.names, order[i]);
+    int  skip;
+    SEXP el = read_group_child(ctx, group_id, gname, Rf_translateCharUTF8(el_name), &skip);
+    if (TYPEOF(el) == CHARSXP) { UNPROTECT(4); return el; }
+    if (skip) continue;
+    SET_VECTOR_ELT(result, n_read, el);
+    SET_STRING_ELT(names,  n_read, el_name);
+    n_read++;
+  }
+  
+  int nprotect = 4;
+  if (n_read < n) {
+    result = PROTECT(lengthgets(result, n_read));
+    names  = PROTECT(lengthgets(names,  n_read));
+    nprotect += 2;
+  }
+  if (n_read > 0) setAttrib(result, R_NamesSymbol, names);
+  
+  UNPROTECT(nprotect);
+  return result;
+}
+
+
+static SEXP run_group_read(void *data) {
+  h5_group_read_t *ctx = (h5_group_read_t *)data;
+  return read_group(ctx, ctx->group_id, Rf_translateCharUTF8(STRING_ELT(ctx->group_name, 0)));
+}
+
+static void end_group_read(void *data) {
+  h5_group_read_t *ctx = (h5_group_read_t *)data;
+  if (ctx->group_id >= 0) H5Gclose(ctx->group_id);
+  if (ctx->file_id  >= 0) h5_file_close(ctx->file_id);
+  if (ctx->session != R_NilValue) C_h5_close(ctx->session);
+}
+
+
+/*
+ * C implementation of h5_read() for a whole group.
+ * Builds the nested list of every member, with their attributes, in one
+ * pass over the file. As with C_h5_write_batch(), the file is held open by a
+ * temporary handle for the duration of the read unless an h5_open() handle
+ * already holds it, so that lazy and mapped members do not re-open it.
+ */
+SEXP C_h5_read_group(SEXP filename, SEXP group_name, SEXP rmap, SEXP attr_rmap, SEXP mmap, SEXP lazy) {
+  
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename,   0));
+  const char *gname = Rf_translateCharUTF8(STRING_ELT(group_name, 0));
+  
+  h5_group_read_t ctx;
+  ctx.filename   = filename;
+  ctx.fname      = fname;
+  ctx.group_name = group_name;
+  ctx.rmap       = rmap;
+  ctx.attr_rmap  = attr_rmap;
+  ctx.mmap       = asLogical(mmap) == TRUE;
+  ctx.lazy       = asLogical(lazy) == TRUE;
+  ctx.session    = R_NilValue;
+  ctx.file_id    = -1;
+  ctx.group_id   = -1;
+  
+  if (h5_file_cached(fname, H5F_ACC_RDONLY) < 0) {
+    SEXP readonly = PROTECT(ScalarLogical(TRUE));
+    ctx.session = C_h5_open(filename, readonly, R_NilValue, R_NilValue, R_NilValue);
+    UNPROTECT(1);
+  }
+  PROTECT(ctx.session);
+  
+  ctx.file_id = h5_file_open(fname, H5F_ACC_RDONLY);
+  if (ctx.file_id >= 0) ctx.group_id = H5Gopen2(ctx.file_id, gname, H5P_DEFAULT);
+  if (ctx.group_id < 0) {
+    end_group_read(&ctx);
+    error("Failed to open group: %s", gname);
+  }
+  
+  SEXP result = PROTECT(R_ExecWithCleanup(run_group_read, &ctx, end_group_read, &ctx));
+  if (TYPEOF(result) == CHARSXP) error("%s", CHAR(result));
+  
+  UNPROTECT(2);
+  return result;
+}
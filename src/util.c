@@ -54,86 +54,391 @@ void* get_R_data_ptr(SEXP data) {
 }
 
 /*
- * Transposes a multi-dimensional array between R's column-major order and
- * HDF5's row-major (C) order.
+ * Target size, in bytes, of the scratch buffers used when data is streamed
+ * through HDF5 in blocks. Set with options(h5lite.block_size = bytes).
+ */
+size_t h5_block_bytes(void) {
+  SEXP opt = GetOption1(install("h5lite.block_size"));
+  if (opt != R_NilValue && (isReal(opt) || isInteger(opt)) && XLENGTH(opt) == 1) {
+    double val = asReal(opt);
+    if (R_FINITE(val) && val >= 1) return (size_t)val;
+  }
+  return H5LITE_BLOCK_BYTES;
+}
+
+/*
+ * Number of threads used to decompress chunks in parallel (see chunks.c).
+ * Set with options(h5lite.threads = n); defaults to 1, i.e. no threading.
+ */
+int h5_threads(void) {
+  SEXP opt = GetOption1(install("h5lite.threads"));
+  if (opt != R_NilValue && (isReal(opt) || isInteger(opt)) && XLENGTH(opt) == 1) {
+    double val = asReal(opt);
+    if (R_FINITE(val) && val >= 1) return (val > 1024) ? 1024 : (int)val;
+  }
+  return 1;
+}
+
+
+/*
+ * Reads the "h5lite_access" hint that h5_write() records for datasets whose
+ * chunks were shaped with h5_compression(access = ). Datasets without the
+ * attribute are H5LITE_ACCESS_BALANCED.
+ */
+h5_access_t h5_access_hint(hid_t dset_id) {
+  
+  h5_access_t res = H5LITE_ACCESS_BALANCED;
+  if (H5Aexists(dset_id, H5LITE_ACCESS_ATTR) <= 0) return res;
+  
+  hid_t attr_id = H5Aopen(dset_id, H5LITE_ACCESS_ATTR, H5P_DEFAULT);
+  if (attr_id < 0) return res; // # nocov
+  
+  char   buf[16] = { 0 };
+  hid_t  type_id = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type_id, sizeof(buf) - 1);
+  
+  if (H5Aread(attr_id, type_id, buf) >= 0) {
+    if      (strcmp(buf, "row")    == 0) res = H5LITE_ACCESS_ROW;
+    else if (strcmp(buf, "column") == 0) res = H5LITE_ACCESS_COLUMN;
+    else if (strcmp(buf, "custom") == 0) res = H5LITE_ACCESS_CUSTOM;
+  }
+  
+  H5Tclose(type_id);
+  H5Aclose(attr_id);
+  return res;
+}
+
+
+/* --- STRINGS --- */
+
+/* Smallest table worth setting up, and the most slots a table may have. */
+#define H5LITE_STRTAB_MIN ((R_xlen_t)64)
+#define H5LITE_STRTAB_MAX ((size_t)1 << 17)
+
+/*
+ * Prepares `tab` for reading `n` strings. String datasets are often
+ * low-cardinality (sample IDs, labels, categories), and each repeat that
+ * h5_mkchar() finds in the table skips mkCharLenCE()'s validation of the
+ * bytes and its lookup in R's global CHARSXP cache. Small reads get no table.
+ */
+void h5_strtab_init(h5_strtab_t *tab, R_xlen_t n) {
+  
+  tab->used = tab->lookups = tab->hits = 0;
+  tab->active = (n >= H5LITE_STRTAB_MIN);
+  tab->slots  = NULL;
+  tab->hashes = NULL;
+  tab->mask   = 0;
+  if (!tab->active) return;
+  
+  size_t size = 64;
+  while (size < (size_t)n * 2 && size < H5LITE_STRTAB_MAX) size *= 2;
+  
+  tab->slots  = (SEXP *)R_alloc(size, sizeof(SEXP));
+  tab->hashes = (uint32_t *)R_alloc(size, sizeof(uint32_t));
+  tab->mask   = size - 1;
+  memset(tab->slots, 0, size * sizeof(SEXP));
+}
+
+
+/*
+ * mkCharLenCE(str, len, CE_UTF8), returning the CHARSXP made earlier for the
+ * same bytes when there is one. The table does not protect its entries: the
+ * caller must store each result in a protected vector before the next call.
+ * It stops growing once half full, and is switched off altogether when the
+ * first lookups show the strings are mostly distinct.
+ */
+SEXP h5_mkchar(h5_strtab_t *tab, const char *str, size_t len) {
+  
+  if (!tab->active) return mkCharLenCE(str, (int)len, CE_UTF8);
+  
+  /* FNV-1a */
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) { hash ^= (unsigned char)str[i]; hash *= 16777619u; }
+  
+  size_t slot = hash & tab->mask;
+  for (; tab->slots[slot] != NULL; slot = (slot + 1) & tab->mask) {
+    SEXP ch = tab->slots[slot];
+    if (tab->hashes[slot] == hash && (size_t)LENGTH(ch) == len && memcmp(CHAR(ch), str, len) == 0) {
+      tab->hits++; tab->lookups++;
+      return ch;
+    }
+  }
+  
+  SEXP ch = mkCharLenCE(str, (int)len, CE_UTF8);
+  
+  if (tab->used < (tab->mask + 1) / 2) {
+    tab->slots[slot]  = ch;
+    tab->hashes[slot] = hash;
+    tab->used++;
+  }
+  
+  if (++tab->lookups == 4096 && tab->hits < 1024) tab->active = 0;
+  
+  return ch;
+}
+
+
+/* --- SELECTIONS --- */
+
+/*
+ * Selects the cartesian product of per-dimension coordinate sets on space_id.
+ * Along dimension d, coords[d] holds count[d] sorted, distinct 0-based
+ * coordinates; a NULL coords (or coords[d]) stands for the contiguous range
+ * [offset[d], offset[d] + count[d]). Consecutive coordinates are merged into
+ * runs, and the blocks are OR-ed together in row-major order, which is also
+ * the order in which HDF5 transfers the selected elements.
+ */
+herr_t h5_select_coords(hid_t space_id, int rank, hsize_t **coords, const hsize_t *offset, 
+                        const hsize_t *count) {
+  
+  if (rank == 0) return H5Sselect_all(space_id);
+  
+  hsize_t *run_start[H5S_MAX_RANK], *run_len[H5S_MAX_RANK];
+  hsize_t  n_runs[H5S_MAX_RANK], pos[H5S_MAX_RANK];
+  hsize_t  start[H5S_MAX_RANK], block[H5S_MAX_RANK];
+  
+  for (int d = 0; d < rank; d++) {
+    
+    if (count[d] == 0) return H5Sselect_none(space_id);
+    
+    const hsize_t *c = coords ? coords[d] : NULL;
+    pos[d] = 0;
+    
+    if (c == NULL) {
+      run_start[d] = (hsize_t *)R_alloc(1, sizeof(hsize_t));
+      run_len[d]   = (hsize_t *)R_alloc(1, sizeof(hsize_t));
+      run_start[d][0] = offset[d];
+      run_len[d][0]   = count[d];
+      n_runs[d] = 1;
+      continue;
+    }
+    
+    hsize_t n = 1;
+    for (hsize_t k = 1; k < count[d]; k++) if (c[k] != c[k - 1] + 1) n++;
+    
+    run_start[d] = (hsize_t *)R_alloc(n, sizeof(hsize_t));
+    run_len[d]   = (hsize_t *)R_alloc(n, sizeof(hsize_t));
+    n_runs[d]    = n;
+    
+    hsize_t r = 0;
+    run_start[d][0] = c[0];
+    run_len[d][0]   = 1;
+    for (hsize_t k = 1; k < count[d]; k++) {
+      if (c[k] == c[k - 1] + 1) { run_len[d][r]++; continue; }
+      r++;
+      run_start[d][r] = c[k];
+      run_len[d][r]   = 1;
+    }
+  }
+  
+  H5S_seloper_t op = H5S_SELECT_SET;
+  
+  for (;;) {
+    for (int d = 0; d < rank; d++) {
+      start[d] = run_start[d][pos[d]];
+      block[d] = run_len[d][pos[d]];
+    }
+    if (H5Sselect_hyperslab(space_id, op, start, NULL, block, NULL) < 0) return -1; // # nocov
+    op = H5S_SELECT_OR;
+    
+    /* Advance the run odometer, last dimension fastest */
+    int d = rank - 1;
+    while (d >= 0 && ++pos[d] == n_runs[d]) pos[d--] = 0;
+    if (d < 0) break;
+  }
+  
+  return 0;
+}
+
+
+/* --- TRANSPOSITION --- */
+
+/* Tile edge (in elements). 32x32 tiles of 8-byte elements fill 16 KB, which
+ * keeps both the source rows and destination columns of a tile in L1. */
+#define TRANSPOSE_TILE 32
+
+/*
+ * Tiled 2-D copy kernel: element (i, j) moves from src[i*src_i + j*src_j] to
+ * dest[i*dest_i + j*dest_j] (strides in elements). A fixed element size lets
+ * the compiler turn each memcpy into a single load/store.
+ */
+#define DEFINE_TRANSPOSE_KERNEL(NAME, SIZE)                                   \
+static void NAME(const char *src, char *dest, hsize_t n_i, hsize_t n_j,       \
+                 hsize_t src_i, hsize_t src_j, hsize_t dest_i, hsize_t dest_j) { \
+  for (hsize_t ii = 0; ii < n_i; ii += TRANSPOSE_TILE) {                      \
+    hsize_t i_end = (n_i - ii > TRANSPOSE_TILE) ? ii + TRANSPOSE_TILE : n_i;  \
+    for (hsize_t jj = 0; jj < n_j; jj += TRANSPOSE_TILE) {                    \
+      hsize_t j_end = (n_j - jj > TRANSPOSE_TILE) ? jj + TRANSPOSE_TILE : n_j;\
+      for (hsize_t i = ii; i < i_end; i++) {                                  \
+        const char *s = src  + (i * src_i  + jj * src_j)  * (SIZE);           \
+        char       *d = dest + (i * dest_i + jj * dest_j) * (SIZE);           \
+        for (hsize_t j = jj; j < j_end; j++) {                                \
+          memcpy(d, s, (SIZE));                                               \
+          s += src_j  * (SIZE);                                               \
+          d += dest_j * (SIZE);                                               \
+        }                                                                     \
+      }                                                                       \
+    }                                                                         \
+  }                                                                           \
+}
+
+DEFINE_TRANSPOSE_KERNEL(transpose_2d_1,  1)
+DEFINE_TRANSPOSE_KERNEL(transpose_2d_2,  2)
+DEFINE_TRANSPOSE_KERNEL(transpose_2d_4,  4)
+DEFINE_TRANSPOSE_KERNEL(transpose_2d_8,  8)
+DEFINE_TRANSPOSE_KERNEL(transpose_2d_16, 16)
+
+/* Fallback for odd element sizes (e.g. fixed-length strings). */
+static void transpose_2d_n(const char *src, char *dest, hsize_t n_i, hsize_t n_j,
+                           hsize_t src_i, hsize_t src_j, hsize_t dest_i, hsize_t dest_j,
+                           size_t el_size) {
+  for (hsize_t ii = 0; ii < n_i; ii += TRANSPOSE_TILE) {
+    hsize_t i_end = (n_i - ii > TRANSPOSE_TILE) ? ii + TRANSPOSE_TILE : n_i;
+    for (hsize_t jj = 0; jj < n_j; jj += TRANSPOSE_TILE) {
+      hsize_t j_end = (n_j - jj > TRANSPOSE_TILE) ? jj + TRANSPOSE_TILE : n_j;
+      for (hsize_t i = ii; i < i_end; i++)
+        for (hsize_t j = jj; j < j_end; j++)
+          memcpy(dest + (i * dest_i + j * dest_j) * el_size,
+                 src  + (i * src_i  + j * src_j)  * el_size, el_size);
+    }
+  }
+}
+
+static void transpose_2d(const char *src, char *dest, hsize_t n_i, hsize_t n_j,
+                         hsize_t src_i, hsize_t src_j, hsize_t dest_i, hsize_t dest_j,
+                         size_t el_size) {
+  switch (el_size) {
+    case 1:  transpose_2d_1 (src, dest, n_i, n_j, src_i, src_j, dest_i, dest_j); break;
+    case 2:  transpose_2d_2 (src, dest, n_i, n_j, src_i, src_j, dest_i, dest_j); break;
+    case 4:  transpose_2d_4 (src, dest, n_i, n_j, src_i, src_j, dest_i, dest_j); break;
+    case 8:  transpose_2d_8 (src, dest, n_i, n_j, src_i, src_j, dest_i, dest_j); break;
+    case 16: transpose_2d_16(src, dest, n_i, n_j, src_i, src_j, dest_i, dest_j); break;
+    default: transpose_2d_n (src, dest, n_i, n_j, src_i, src_j, dest_i, dest_j, el_size);
+  }
+}
+
+
+/*
+ * Transposes a slab of rows between HDF5's row-major (C) order and R's
+ * column-major order.
  *
- * This function uses an "odometer" approach to iterate through multi-dimensional
- * coordinates, mapping the linear index from source to destination.
+ * `c_buf` holds rows [start, start + count) of the first dimension in C order,
+ * i.e. an array of dims (count, dims[1], ..., dims[rank-1]). `r_buf` is the
+ * complete column-major array of dims (dims[0], ..., dims[rank-1]). Reading a
+ * dataset slab-by-slab and transposing each slab as it arrives means the full
+ * C-ordered copy never has to exist.
  *
- * @param src Pointer to the source data buffer.
- * @param dest Pointer to the destination data buffer.
- * @param rank The number of dimensions of the array.
- * @param dims An array containing the size of each dimension.
+ * Whatever the rank, the reordering reverses the order of the strides: the
+ * first and the last dimension trade places, and so - from rank 4 on - do
+ * the middle dimensions among themselves. Each dimension's stride in either
+ * buffer is still a plain product of dims, so for every combination of middle
+ * coordinates this is a strided 2-D transpose of a count x dims[rank-1]
+ * matrix, which is handed to a tiled kernel.
+ *
+ * @param c_buf   Row-major slab buffer.
+ * @param r_buf   Column-major full-array buffer.
+ * @param rank    The number of dimensions of the array.
+ * @param dims    The size of each dimension of the full array.
  * @param el_size The size in bytes of a single element.
- * @param direction_to_r If 1, transposes from HDF5 to R. If 0, transposes from R to HDF5.
- * direction_to_r = 0 : R (Col-Major) -> HDF5 (Row-Major)
- * direction_to_r = 1 : HDF5 (Row-Major) -> R (Col-Major)
+ * @param start   First row (along dims[0]) held in c_buf.
+ * @param count   Number of rows held in c_buf.
+ * @param direction_to_r If 1, copies c_buf into r_buf. If 0, copies r_buf into c_buf.
  */
-void h5_transpose(void *src, void *dest, int rank, hsize_t *dims, size_t el_size, int direction_to_r) {
-  /* For scalars (rank=0) or vectors (rank=1), no transposition is needed, just a direct copy. */
+static void transpose_slab(void *c_buf, void *r_buf, int rank, hsize_t *dims, size_t el_size,
+                           hsize_t start, hsize_t count, int direction_to_r) {
+  
+  char *c_bytes = (char *)c_buf;
+  char *r_bytes = (char *)r_buf;
+  
+  /* Scalars and vectors share the same layout in both orders. */
   if (rank <= 1) {
-    hsize_t total = 1;
-    if (rank == 1) total = dims[0];
-    memcpy(dest, src, total * el_size);
+    if (rank == 0) { start = 0; count = 1; }
+    if (direction_to_r) memcpy(r_bytes + start * el_size, c_bytes, count * el_size);
+    else                memcpy(c_bytes, r_bytes + start * el_size, count * el_size);
     return;
   }
   
-  hsize_t total_elements = 1;
-  for (int i = 0; i < rank; i++) total_elements *= dims[i];
-  
-  /* Calculate strides for C (row-major) order. 
-   * Last dimension varies fastest (stride = 1).
-   */
-  hsize_t *c_strides = (hsize_t *)malloc(rank * sizeof(hsize_t));
-  c_strides[rank - 1] = 1;
-  for (int i = rank - 2; i >= 0; i--) c_strides[i] = c_strides[i + 1] * dims[i + 1];
-  
-  /* Calculate strides for R (column-major) order. 
-   * First dimension varies fastest (stride = 1).
-   */
-  hsize_t *r_strides = (hsize_t *)malloc(rank * sizeof(hsize_t));
-  r_strides[0] = 1;
-  for (int i = 1; i < rank; i++) r_strides[i] = r_strides[i - 1] * dims[i - 1];
-  
-  /* Determine which set of strides to use for the destination. */
-  hsize_t *dest_strides = direction_to_r ? r_strides : c_strides;
-  
-  /* 'coords' acts as an odometer, keeping track of the current multi-dimensional index. */
-  hsize_t *coords = (hsize_t *)calloc(rank, sizeof(hsize_t));
-  char *src_bytes = (char *)src;
-  char *dest_bytes = (char *)dest;
-  
-  /* Iterate through the source buffer linearly, one element at a time. */
-  for (hsize_t i = 0; i < total_elements; i++) {
-    
-    /* Calculate the destination index using the current coordinates and destination strides. */
-    hsize_t dest_idx = 0;
-    for (int d = 0; d < rank; d++) {
-      dest_idx += coords[d] * dest_strides[d];
+  /* Strides of the first and last dimension, in elements. */
+  hsize_t c_first = 1; /* C order: stride of dims[0] */
+  for (int d = 1; d < rank; d++) c_first *= dims[d];
+  hsize_t r_last = 1;  /* R order: stride of dims[rank-1] */
+  for (int d = 0; d < rank - 1; d++) r_last *= dims[d];
+  
+  hsize_t n_j = dims[rank - 1];
+  if (count == 0 || n_j == 0 || c_first == 0) return;
+  
+  /* Odometer over the middle dimensions (1 .. rank-2), tracking the C and R
+   * offsets incrementally. */
+  int      n_mid  = rank - 2;
+  hsize_t  c_off  = 0;
+  hsize_t  r_off  = start;
+  hsize_t *coords = NULL, *c_str = NULL, *r_str = NULL;
+  
+  if (n_mid > 0) {
+    coords = (hsize_t *)R_alloc(3 * n_mid, sizeof(hsize_t)); /* R thread only */
+    memset(coords, 0, n_mid * sizeof(hsize_t));
+    c_str  = coords + n_mid;
+    r_str  = coords + 2 * n_mid;
+    for (int m = 0; m < n_mid; m++) {
+      int d = m + 1;
+      c_str[m] = 1; for (int k = d + 1; k < rank; k++) c_str[m] *= dims[k];
+      r_str[m] = 1; for (int k = 0;     k < d;    k++) r_str[m] *= dims[k];
     }
+  }
+  
+  for (;;) {
+    if (direction_to_r)
+      transpose_2d(c_bytes + c_off * el_size, r_bytes + r_off * el_size,
+                   count, n_j, c_first, 1, 1, r_last, el_size);
+    else
+      transpose_2d(r_bytes + r_off * el_size, c_bytes + c_off * el_size,
+                   count, n_j, 1, r_last, c_first, 1, el_size);
     
-    /* Copy the element from the linear source position to the calculated destination position. */
-    memcpy(dest_bytes + (dest_idx * el_size), src_bytes + (i * el_size), el_size);
-    
-    /* Increment Odometer (based on Source Layout) */
-    if (direction_to_r) {
-      /* Source is C (Last dim fast) */
-      for (int d = rank - 1; d >= 0; d--) {
-        coords[d]++;
-        if (coords[d] < dims[d]) break;
-        coords[d] = 0;
-      }
-    } else {
-      /* Source is R (First dim fast) */
-      for (int d = 0; d < rank; d++) {
-        coords[d]++;
-        if (coords[d] < dims[d]) break;
-        coords[d] = 0;
-      }
+    /* Advance the middle-dimension odometer */
+    int m = 0;
+    for (; m < n_mid; m++) {
+      coords[m]++;
+      c_off += c_str[m];
+      r_off += r_str[m];
+      if (coords[m] < dims[m + 1]) break;
+      c_off -= coords[m] * c_str[m];
+      r_off -= coords[m] * r_str[m];
+      coords[m] = 0;
     }
+    if (m == n_mid) break;
   }
-  
-  free(coords); free(c_strides); free(r_strides);
+}
+
+/* Timed as the "transpose" stage of h5_profile(). */
+void h5_transpose_slab(void *c_buf, void *r_buf, int rank, hsize_t *dims, size_t el_size,
+                       hsize_t start, hsize_t count, int direction_to_r) {
+  H5LITE_PROF_BEGIN(t0);
+  transpose_slab(c_buf, r_buf, rank, dims, el_size, start, count, direction_to_r);
+  if (h5_profiling) {
+    hsize_t n = (rank > 0) ? count : 1;
+    for (int d = 1; d < rank; d++) n *= dims[d];
+    H5LITE_PROF_END(H5LITE_PROF_TRANSPOSE, t0, n * el_size, n);
+  }
+}
+
+
+/*
+ * Transposes a multi-dimensional array between R's column-major order and
+ * HDF5's row-major (C) order. See h5_transpose_slab() for the algorithm.
+ *
+ * @param src Pointer to the source data buffer.
+ * @param dest Pointer to the destination data buffer.
+ * @param rank The number of dimensions of the array.
+ * @param dims An array containing the size of each dimension.
+ * @param el_size The size in bytes of a single element.
+ * @param direction_to_r If 1, transposes from HDF5 to R. If 0, transposes from R to HDF5.
+ * direction_to_r = 0 : R (Col-Major) -> HDF5 (Row-Major)
+ * direction_to_r = 1 : HDF5 (Row-Major) -> R (Col-Major)
+ */
+void h5_transpose(void *src, void *dest, int rank, hsize_t *dims, size_t el_size, int direction_to_r) {
+  hsize_t rows = (rank > 0) ? dims[0] : 1;
+  if (direction_to_r) h5_transpose_slab(src,  dest, rank, dims, el_size, 0, rows, 1);
+  else                h5_transpose_slab(dest, src,  rank, dims, el_size, 0, rows, 0);
 }
 
 /*
@@ -228,6 +533,7 @@ R_TYPE rtype_from_map(hid_t file_type_id, SEXP rmap, const char *el_name) {
       const char *value = CHAR(STRING_ELT(rmap, i));
       
       R_TYPE result = R_TYPE_DOUBLE;
+      if (strcmp(value, "factor")  == 0) result = (class_id == H5T_FLOAT) ? R_TYPE_DOUBLE : R_TYPE_AUTO;
       if (strcmp(value, "logical") == 0) result = R_TYPE_LOGICAL;
       if (strcmp(value, "integer") == 0) result = R_TYPE_INTEGER;
       if (strcmp(value, "bit64")   == 0) result = R_TYPE_BIT64;
@@ -248,46 +554,117 @@ R_TYPE rtype_from_map(hid_t file_type_id, SEXP rmap, const char *el_name) {
 }
 
 
+/*
+ * Whether the `as` map asks for el_name to be read as a factor, either by name
+ * or through the "." default. Only datasets written with as = "dict" can be:
+ * for any other data, "factor" reads as "auto".
+ */
+int rmap_is_factor(SEXP rmap, const char *el_name) {
+  
+  if (rmap == R_NilValue || LENGTH(rmap) == 0) return 0;
+  
+  SEXP names_vec = getAttrib(rmap, R_NamesSymbol);
+  
+  if (names_vec == R_NilValue)
+    return (LENGTH(rmap) == 1 && strcmp(CHAR(STRING_ELT(rmap, 0)), "factor") == 0);
+  
+  int dot = 0;
+  for (int i = 0; i < LENGTH(rmap); i++) {
+    const char *key   = Rf_translateCharUTF8(STRING_ELT(names_vec, i));
+    int         match = (strcmp(CHAR(STRING_ELT(rmap, i)), "factor") == 0);
+    if (strcmp(key, el_name) == 0) return match;
+    if (strcmp(key, ".") == 0)     dot = match;
+  }
+  
+  return dot;
+}
+
+
+/*
+ * Returns 1 if the precision of integer type `type_id` proves that all of its
+ * values are valid R ints, i.e. none is out of range or INT_MIN (NA_integer_).
+ * That holds for up to 31 significant bits, signed or not. HDF5 keeps the
+ * precision apart from the size, so e.g. N-bit packed types qualify too.
+ */
+int h5_int_in_range(hid_t type_id) {
+  return H5Tget_class(type_id) == H5T_INTEGER && H5Tget_precision(type_id) <= 31;
+}
+
+
+/* Elements per block of the range check in narrow_to_int(). */
+#define H5LITE_SCAN_BLOCK ((R_xlen_t)4096)
+
+/*
+ * Returns 1 if all n whole-number doubles fit in R's int, excluding INT_MIN.
+ * A branch-free min/max reduction, which compilers vectorize.
+ */
+static int block_in_range(const double *x, R_xlen_t n) {
+  if (n == 0) return 1;
+  double lo = x[0], hi = x[0];
+  for (R_xlen_t i = 1; i < n; i++) {
+    lo = (x[i] < lo) ? x[i] : lo;
+    hi = (x[i] > hi) ? x[i] : hi;
+  }
+  return lo > INT_MIN && hi <= INT_MAX;
+}
+
+/*
+ * Converts whole-number doubles to ints, block by block: each block is range
+ * checked (unless `in_range`) and then converted while it is still in cache,
+ * so the data is only brought in from memory once. Returns 0, leaving `out`
+ * partly filled, at the first block with a value that does not fit.
+ */
+static int narrow_to_int(const double *x, int *out, R_xlen_t n, int in_range) {
+  for (R_xlen_t i0 = 0; i0 < n; i0 += H5LITE_SCAN_BLOCK) {
+    R_xlen_t len = (n - i0 < H5LITE_SCAN_BLOCK) ? n - i0 : H5LITE_SCAN_BLOCK;
+    if (!in_range && !block_in_range(x + i0, len)) return 0;
+    for (R_xlen_t i = i0; i < i0 + len; i++) out[i] = (int)x[i];
+  }
+  return 1;
+}
+
+
 /*
  * Coerces a numeric R vector to the target R type (integer, logical, etc.).
  *
  * This function handles the final conversion step after reading data from HDF5.
  * It supports:
  * 1. "auto": Checks if double values fit within R's integer range. If so, converts
- * to integer. Otherwise, leaves as double. Only checks H5T_INTEGER file classes.
+ * to integer. Otherwise, leaves as double. Only applies to H5T_INTEGER file classes.
  * 2. "bit64": Adds the "integer64" class attribute for 64-bit integers.
  * 3. "logical" / "integer": Forces coercion using R's standard coercion functions.
  *
  * @param data         The R vector (usually REALSXP) containing the read data.
  * @param rtype        The target type determined by `rtype_from_map`.
- * @param file_type_id The HDF5 file datatype ID (used for size checks in "auto" mode).
+ * @param file_type_id The HDF5 file datatype ID (used for range checks in "auto" mode).
  * @return             The coerced R vector (protected).
  */
 SEXP coerce_to_rtype(SEXP data, R_TYPE rtype, hid_t file_type_id) {
   
+  H5LITE_PROF_BEGIN(t0);
   PROTECT(data);
+  R_xlen_t n_elements = XLENGTH(data);
   
   H5T_class_t data_class = H5Tget_class(file_type_id);
   
   if (rtype == R_TYPE_AUTO && data_class == H5T_INTEGER) {
-    char as_integer = 1;
     
     /* Check for R integer overflow.
-     * If the HDF5 type is 32-bit or larger (e.g. uint32, int64), values might
-     * exceed R's 32-bit integer range (+/- 2e9). We scan the data to verify.
+     * Values of 32-bit or wider types (e.g. uint32, int64) might exceed R's
+     * 32-bit integer range (+/- 2e9), unless the type's precision rules it
+     * out. The check is fused with the conversion from DOUBLE to INTEGER,
+     * and the first block is checked up front so that wide data does not
+     * cost an integer vector that is then thrown away.
      */
-    if (H5Tget_size(file_type_id) >= 4) {
-      double *dbl_vec = REAL(data);
-      R_xlen_t n_rows = XLENGTH(data);
-      for (R_xlen_t i = 0; (i < n_rows) && as_integer; i++) {
-        double val = dbl_vec[i];
-        /* Check if value is within [INT_MIN, INT_MAX], (INT_MIN used for NA) */
-        as_integer = (val > INT_MIN && val <= INT_MAX);
-      }
-    }
+    R_xlen_t n        = XLENGTH(data);
+    int      in_range = h5_int_in_range(file_type_id);
     
-    /* If all values fit in R's int, then convert from DOUBLE to INTEGER */
-    if (as_integer) rtype = R_TYPE_INTEGER;
+    if (in_range || block_in_range(REAL(data), (n < H5LITE_SCAN_BLOCK) ? n : H5LITE_SCAN_BLOCK)) {
+      SEXP ints = PROTECT(allocVector(INTSXP, n));
+      if (narrow_to_int(REAL(data), INTEGER(ints), n, in_range)) data = ints;
+      UNPROTECT(2);
+      PROTECT(data);
+    }
   }
   
   /* Add "integer64" class for R's bit64 package */
@@ -306,6 +683,7 @@ SEXP coerce_to_rtype(SEXP data, R_TYPE rtype, hid_t file_type_id) {
     data = coerceVector(data, INTSXP);
   }
   
+  H5LITE_PROF_END(H5LITE_PROF_COERCE, t0, n_elements * sizeof(double), n_elements);
   UNPROTECT(1);
   return data;
 }
@@ -1,14 +1,222 @@
 #include "h5lite.h"
 
 
+/*
+ * Writes a C-order buffer either to the whole object (file_space_id == H5S_ALL)
+ * or to the selection in file_space_id, which must hold as many elements as
+ * the rank/h5_dims memory shape.
+ */
+static herr_t write_buffer_to_space(hid_t obj_id, hid_t mem_type_id, int rank, hsize_t *h5_dims, 
+                                    hid_t file_space_id, void *buffer) {
+  
+  if (file_space_id == H5S_ALL) return write_buffer_to_object(obj_id, mem_type_id, buffer);
+  
+  H5LITE_PROF_BEGIN(t0);
+  hid_t  mem_space_id = H5Screate_simple(rank, h5_dims, NULL);
+  herr_t status       = H5Dwrite(obj_id, mem_type_id, mem_space_id, file_space_id, H5P_DEFAULT, buffer);
+  h5_prof_io(H5LITE_PROF_WRITE, t0, obj_id, mem_type_id, mem_space_id);
+  H5Sclose(mem_space_id);
+  
+  return status;
+}
+
+
+/* --- BLOCKED WRITES --- */
+
+/*
+ * The mirror image of the blocked reads in read.c. R vectors are laid out
+ * exactly as HDF5 expects, so unless they need widening they are handed to
+ * HDF5 as is. Matrices, arrays and compound records are filled a slab of
+ * whole rows (along h5_dims[0]) at a time into a scratch buffer of about
+ * h5_block_bytes(), and each slab is written to its own hyperslab of the file
+ * selection. Slabs hold whole chunk rows, so that no chunk is compressed
+ * more than once.
+ */
+
+/* Rows per slab: whole chunk rows, about h5_block_bytes() of the memory type. */
+static hsize_t write_slab_rows(hid_t obj_id, int rank, hsize_t n_rows, size_t row_bytes, hsize_t *chunk_rows) {
+  
+  hsize_t rows = h5_block_bytes() / (row_bytes > 0 ? row_bytes : 1);
+  if (rows < 1) rows = 1;
+  *chunk_rows = 1;
+  
+  hid_t dcpl_id = (H5Iget_type(obj_id) == H5I_DATASET) ? H5Dget_create_plist(obj_id) : -1;
+  if (dcpl_id >= 0) {
+    hsize_t chunk_dims[H5S_MAX_RANK];
+    if (rank > 0 && H5Pget_layout(dcpl_id) == H5D_CHUNKED &&
+        H5Pget_chunk(dcpl_id, rank, chunk_dims) == rank && chunk_dims[0] > 0) {
+      *chunk_rows = chunk_dims[0];
+      rows = (rows < chunk_dims[0]) ? chunk_dims[0] : rows - (rows % chunk_dims[0]);
+    }
+    H5Pclose(dcpl_id);
+  }
+  
+  return (rows < n_rows) ? rows : n_rows;
+}
+
+
+/*
+ * Writes h5_dims[0] rows of row_bytes each (in mem_type_id) to the whole
+ * object or to the single-block selection in file_space_id. `fill` puts rows
+ * [r0, r0 + n) in C order into the scratch buffer, returning non-zero on
+ * failure. Attributes, which HDF5 writes whole, and threaded whole-dataset
+ * writes (see chunks.c) are filled in one go. Returns H5LITE_WRITE_NOMEM if
+ * a buffer could not be allocated.
+ */
+herr_t write_rows(hid_t obj_id, hid_t mem_type_id, int rank, hsize_t *h5_dims, size_t row_bytes,
+                  hid_t file_space_id, int n_threads, write_fill_t fill, void *ctx) {
+  
+  hsize_t n_rows     = (rank > 0) ? h5_dims[0] : 1;
+  int     whole      = (H5Iget_type(obj_id) != H5I_DATASET) || (n_threads > 1 && file_space_id == H5S_ALL);
+  hsize_t chunk_rows = 1;
+  hsize_t slab_rows  = whole ? n_rows : write_slab_rows(obj_id, rank, n_rows, row_bytes, &chunk_rows);
+  if (slab_rows < 1) slab_rows = 1;
+  
+  void *buf = malloc(slab_rows * row_bytes + 1);
+  if (!buf) return H5LITE_WRITE_NOMEM; // # nocov
+  
+  herr_t status;
+  
+  if (slab_rows >= n_rows) {
+    status = fill(ctx, buf, 0, n_rows) ? H5LITE_WRITE_NOMEM : H5LITE_CHUNKS_FALLBACK;
+    if (status == H5LITE_CHUNKS_FALLBACK && file_space_id == H5S_ALL)
+      status = h5_write_chunks(obj_id, mem_type_id, rank, h5_dims, buf, n_threads);
+    if (status == H5LITE_CHUNKS_FALLBACK)
+      status = write_buffer_to_space(obj_id, mem_type_id, rank, h5_dims, file_space_id, buf);
+  }
+  else {
+    
+    /* Slabs go to hyperslabs of the file selection, offset from its origin. */
+    hid_t   space_id = (file_space_id == H5S_ALL) ? H5Dget_space(obj_id) : H5Scopy(file_space_id);
+    hsize_t origin[H5S_MAX_RANK], hi[H5S_MAX_RANK], count[H5S_MAX_RANK];
+    H5Sget_select_bounds(space_id, origin, hi);
+    for (int i = 0; i < rank; i++) count[i] = h5_dims[i];
+    
+    status = 0;
+    for (hsize_t r0 = 0; r0 < n_rows && status >= 0; ) {
+      
+      hsize_t n        = slab_rows;
+      hsize_t misalign = (origin[0] + r0) % chunk_rows;
+      if (n > misalign)    n -= misalign;
+      if (n > n_rows - r0) n  = n_rows - r0;
+      
+      if (fill(ctx, buf, r0, n)) { status = H5LITE_WRITE_NOMEM; break; } // # nocov
+      
+      hsize_t start[H5S_MAX_RANK];
+      for (int i = 0; i < rank; i++) start[i] = origin[i];
+      start[0] += r0;
+      count[0]  = n;
+      
+      H5Sselect_hyperslab(space_id, H5S_SELECT_SET, start, NULL, count, NULL);
+      H5LITE_PROF_BEGIN(t0);
+      hid_t mem_space_id = H5Screate_simple(rank, count, NULL);
+      status = H5Dwrite(obj_id, mem_type_id, mem_space_id, space_id, H5P_DEFAULT, buf);
+      h5_prof_io(H5LITE_PROF_WRITE, t0, obj_id, mem_type_id, mem_space_id);
+      H5Sclose(mem_space_id);
+      
+      r0 += n;
+    }
+    
+    H5Sclose(space_id);
+  }
+  
+  free(buf);
+  return status;
+}
+
+
+/* Numeric R data for fill_numeric_rows(). */
+typedef struct {
+  void    *r_data;
+  int      promote;   /* Widen R integers/logicals to doubles */
+  int      rank;
+  hsize_t *h5_dims;
+  size_t   el_size;   /* Of the R data */
+  hsize_t  row_elems;
+} numeric_rows_t;
+
+/*
+ * Fills `dest` with rows [r0, r0 + n) of R data in C order and in the memory
+ * type. Widened integers go through a transposed copy of the rows in their
+ * own type, with NA as NA_real_.
+ */
+static int fill_numeric_rows(void *ctx, void *dest, hsize_t r0, hsize_t n) {
+  
+  numeric_rows_t *x = (numeric_rows_t *)ctx;
+  
+  if (!x->promote) {
+    h5_transpose_slab(dest, x->r_data, x->rank, x->h5_dims, x->el_size, r0, n, 0);
+    return 0;
+  }
+  
+  void      *tmp = NULL;
+  const int *src = (const int *)x->r_data + r0;
+  if (x->rank > 1) {
+    tmp = malloc(n * x->row_elems * sizeof(int) + 1);
+    if (!tmp) return -1; // # nocov
+    h5_transpose_slab(tmp, x->r_data, x->rank, x->h5_dims, sizeof(int), r0, n, 0);
+    src = (const int *)tmp;
+  }
+  
+  double *dbl = (double *)dest;
+  for (hsize_t i = 0; i < n * x->row_elems; i++)
+    dbl[i] = (src[i] == NA_INTEGER) ? NA_REAL : (double)src[i];
+  
+  free(tmp);
+  return 0;
+}
+
+
+/*
+ * Writes numeric R data (one element of mem_type_id per R element, or per int
+ * when promoting) to the whole object or to the single-block selection in
+ * file_space_id.
+ */
+static herr_t write_numeric(hid_t obj_id, hid_t mem_type_id, SEXP data, int promote, int rank,
+                            hsize_t *h5_dims, hid_t file_space_id, int n_threads) {
+  
+  void *r_data = get_R_data_ptr(data);
+  if (!r_data) return -1; // # nocov
+  
+  /* Vectors are already in C order: write them in place. */
+  if (rank <= 1 && !promote) {
+    herr_t status = H5LITE_CHUNKS_FALLBACK;
+    if (file_space_id == H5S_ALL)
+      status = h5_write_chunks(obj_id, mem_type_id, rank, h5_dims, r_data, n_threads);
+    if (status == H5LITE_CHUNKS_FALLBACK)
+      status = write_buffer_to_space(obj_id, mem_type_id, rank, h5_dims, file_space_id, r_data);
+    return status;
+  }
+  
+  size_t el_size = H5Tget_size(mem_type_id);
+  
+  numeric_rows_t ctx = { r_data, promote, rank, h5_dims, promote ? sizeof(int) : el_size, 1 };
+  for (int i = 1; i < rank; i++) ctx.row_elems *= h5_dims[i];
+  
+  return write_rows(obj_id, mem_type_id, rank, h5_dims, ctx.row_elems * el_size,
+                    file_space_id, n_threads, fill_numeric_rows, &ctx);
+}
+
+
 /*
  * Writes an atomic R vector (numeric, character, etc.) to an already created HDF5
  * dataset or attribute. This function handles data transposition and NA values for strings.
  * It is a lower-level helper called by C_h5_write_dataset and write_atomic_attribute.
  */
 SEXP write_atomic_dataset(hid_t obj_id, SEXP data, const char *dtype_str, int rank, hsize_t *h5_dims) {
+  return write_atomic_selection(obj_id, data, dtype_str, rank, h5_dims, H5S_ALL, 1);
+}
+
+
+/*
+ * As write_atomic_dataset(), but targets the selection in file_space_id.
+ * Used by h5_append() to write new rows into an extended dataset.
+ * Whole-dataset numeric writes with n_threads > 1 compress their chunks in
+ * parallel (see chunks.c).
+ */
+SEXP write_atomic_selection(hid_t obj_id, SEXP data, const char *dtype_str, int rank, hsize_t *h5_dims, 
+                            hid_t file_space_id, int n_threads) {
   herr_t status = -1;
-  int must_unprotect_data = 0;
   H5I_type_t obj_type = H5Iget_type(obj_id);
 
   if (obj_type != H5I_DATASET && obj_type != H5I_ATTR)
@@ -52,7 +260,7 @@ SEXP write_atomic_dataset(hid_t obj_id, SEXP data, const char *dtype_str, int ra
       /* 4. Write */
       /* create_string_type handles fixed widths based on the slash syntax */
       hid_t mem_type_id = create_string_type(dtype_str);
-      status = write_buffer_to_object(obj_id, mem_type_id, c_buffer);
+      status = write_buffer_to_space(obj_id, mem_type_id, rank, h5_dims, file_space_id, c_buffer);
 
       free(f_buffer); free(c_buffer); H5Tclose(mem_type_id);
     }
@@ -75,7 +283,7 @@ SEXP write_atomic_dataset(hid_t obj_id, SEXP data, const char *dtype_str, int ra
       h5_transpose((void*)f_buffer, (void*)c_buffer, rank, h5_dims, sizeof(char*), 0);
 
       hid_t mem_type_id = create_string_type(dtype_str);
-      status = write_buffer_to_object(obj_id, mem_type_id, c_buffer);
+      status = write_buffer_to_space(obj_id, mem_type_id, rank, h5_dims, file_space_id, c_buffer);
 
       free(f_buffer); free(c_buffer); H5Tclose(mem_type_id);
     }
@@ -83,52 +291,23 @@ SEXP write_atomic_dataset(hid_t obj_id, SEXP data, const char *dtype_str, int ra
   
   /* --- Handle Numeric, Logical, Opaque, Factor Data --- */
   else {
-    hsize_t total_elements = 1;
-    if (rank > 0 && h5_dims) {
-      for(int i=0; i<rank; i++) total_elements *= h5_dims[i];
-    }
     
-    /* --- Special Handling for Integer/Logical to Double Promotion --- */
-    if (TYPEOF(data) == INTSXP || TYPEOF(data) == LGLSXP) {
-      if (strcmp(dtype_str, "float64") == 0 ||
-          strcmp(dtype_str, "float32") == 0 ||
-          strcmp(dtype_str, "float16") == 0) {
-        
-        data = PROTECT(coerceVector(data, REALSXP));
-        must_unprotect_data = 1;
-      }
-    }
-
-    /* Get a direct pointer to the R object's data. */
-    void *r_data_ptr = get_R_data_ptr(data);
-    if (!r_data_ptr) { // # nocov start
-      if (must_unprotect_data) UNPROTECT(1);
-      return errmsg_1("Failed to get data pointer for %s.", dtype_str);
-    } // # nocov end
-
-    hid_t mem_type_id = create_r_memory_type(data, dtype_str);
-    if (mem_type_id < 0) { // # nocov start
-      if (must_unprotect_data) UNPROTECT(1);
-      return errmsg_1("Failed to get memory for %s.", dtype_str);
-    } // # nocov end
+    /* Integers and logicals written as floats are widened by write_numeric(),
+     * block by block, rather than coerced to a double vector up front. */
+    int promote = (TYPEOF(data) == INTSXP || TYPEOF(data) == LGLSXP) && 
+                  (strcmp(dtype_str, "float64") == 0 ||
+                   strcmp(dtype_str, "float32") == 0 ||
+                   strcmp(dtype_str, "float16") == 0);
     
-    /* Allocate a C buffer and transpose the R data into it. */
-    size_t el_size = H5Tget_size(mem_type_id);
-    void *c_buffer = malloc(total_elements * el_size);
-    if (!c_buffer) { // # nocov start
-       H5Tclose(mem_type_id);
-       if (must_unprotect_data) UNPROTECT(1);
-       return errmsg_1("Memory allocation failed for %s.", dtype_str);
-    } // # nocov end
-
-    /* Transpose from R's column-major to C's row-major order. */
-    h5_transpose(r_data_ptr, c_buffer, rank, h5_dims, el_size, 0);
-
-    status = write_buffer_to_object(obj_id, mem_type_id, c_buffer);
-
-    free(c_buffer);
+    hid_t mem_type_id = promote ? H5Tcopy(H5T_NATIVE_DOUBLE) : create_r_memory_type(data, dtype_str);
+    if (mem_type_id < 0) // # nocov
+      return errmsg_1("Failed to get memory for %s.", dtype_str); // # nocov
+    
+    status = write_numeric(obj_id, mem_type_id, data, promote, rank, h5_dims, file_space_id, n_threads);
     H5Tclose(mem_type_id);
-    if (must_unprotect_data) UNPROTECT(1);
+    
+    if (status == H5LITE_WRITE_NOMEM)
+      return errmsg_1("Memory allocation failed for %s.", dtype_str); // # nocov
   }
 
   if (status < 0)
@@ -186,6 +365,27 @@ static SEXP write_atomic_attribute(hid_t file_id, hid_t obj_id, const char *attr
   return R_NilValue;
 }
 
+/*
+ * For as = "dict", `data` is a factor of the strings to store, made by R's
+ * dict_encode(). Returns its codes as an integer vector in which NA is 0,
+ * and sets `code_type` to the smallest unsigned type that holds them.
+ */
+static SEXP dict_codes(SEXP data, R_xlen_t n_levels, const char **code_type) {
+  
+  R_xlen_t n     = XLENGTH(data);
+  SEXP     codes = PROTECT(allocVector(INTSXP, n));
+  int     *src   = INTEGER(data), *dest = INTEGER(codes);
+  
+  for (R_xlen_t i = 0; i < n; i++) dest[i] = (src[i] == NA_INTEGER) ? 0 : src[i];
+  
+  if      (n_levels <= 255)   *code_type = "uint8";
+  else if (n_levels <= 65535) *code_type = "uint16";
+  else                        *code_type = "uint32";
+  
+  UNPROTECT(1);
+  return codes;
+}
+
 /*
  * Creates a dataset with a null dataspace.
  */
@@ -238,12 +438,12 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
   const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
   
-  hid_t file_id = open_or_create_file(fname);
+  hid_t file_id = open_or_create_file(fname, NULL, NULL);
 
   /* --- Overwrite Logic --- */
   herr_t status = handle_overwrite(file_id, dname);
   if (status < 0) { // # nocov start
-    H5Fclose(file_id);
+    h5_file_close(file_id);
     error("Failed to overwrite existing dataset: %s", dname);
   } // # nocov end
 
@@ -254,7 +454,7 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
     /* Now creates Dimension Scale for row.names inside this function.
        write_dataframe creates its own property lists, so we don't need to do it here. */
     errmsg = write_dataframe(file_id, file_id, dname, data, dtype, compress, 0);
-    H5Fclose(file_id);
+    h5_file_close(file_id);
   }
 
   /* --- Atomic Dataset Logic --- */
@@ -264,14 +464,19 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
     int rank = 0;
     hsize_t *h5_dims = NULL; /* Will be created by R_alloc() - no need to free() */
     
+    /* Dictionary-encoded strings are stored as their integer codes */
+    int  is_dict = (strcmp(dtype_str, "dict") == 0);
+    SEXP dict    = is_dict ? getAttrib(data, R_LevelsSymbol) : R_NilValue;
+    SEXP values  = PROTECT(is_dict ? dict_codes(data, XLENGTH(dict), &dtype_str) : data);
+    
     if (strcmp(dtype_str, "null") == 0) {
       errmsg = write_null_dataset(file_id, dname);
-      H5Fclose(file_id);
+      h5_file_close(file_id);
     }
     else {
   
-      hid_t space_id     = create_dataspace(dims, data, &rank, &h5_dims);
-      hid_t file_type_id = create_h5_file_type(data, dtype_str);
+      hid_t space_id     = create_dataspace(dims, values, &rank, &h5_dims);
+      hid_t file_type_id = create_h5_file_type(values, dtype_str);
       
       /* Create Link Creation Property List (LCPL)
        * 1. create_intermediate_group = 1: Auto-create parents (like mkdir -p).
@@ -285,7 +490,7 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
       hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
       
       /* Only apply chunking/compression if requested and applicable */
-      if (rank > 0 && XLENGTH(data) > 0) {
+      if (rank > 0 && XLENGTH(values) > 0 && !compress_is_plain(compress)) {
         size_t type_size = H5Tget_size(file_type_id);
         hsize_t *chunk_dims = (hsize_t *) R_alloc(rank, sizeof(hsize_t));
         calculate_chunk_dims(rank, h5_dims, type_size, compress, chunk_dims);
@@ -293,16 +498,42 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
         apply_compression(dcpl_id, file_type_id, rank, chunk_dims, compress);
       }
       
+      /* Dense attribute storage lifts the 64 KiB limit on the dictionary, and
+       * indexes attributes by name rather than scanning the object header for
+       * each one, but needs the object header format of HDF5 1.8 or later. */
+      H5F_libver_t low = H5F_LIBVER_V18, high = H5F_LIBVER_LATEST;
+      if (is_dict || asLogical(getAttrib(compress, install("dense_attrs"))) == TRUE) {
+        hid_t fapl_id = H5Fget_access_plist(file_id);
+        H5Pget_libver_bounds(fapl_id, &low, &high);
+        H5Pclose(fapl_id);
+        if (low < H5F_LIBVER_V18) H5Fset_libver_bounds(file_id, H5F_LIBVER_V18, high);
+        H5Pset_attr_phase_change(dcpl_id, 0, 0);
+      }
+      
       /* Create the dataset passing both LCPL (name encoding) and DCPL (compression) */
       hid_t dset_id = H5Dcreate2(file_id, dname, file_type_id, space_id, lcpl_id, dcpl_id, H5P_DEFAULT);
       H5Pclose(lcpl_id);
       H5Pclose(dcpl_id);
       
+      /* Only the object header needed the bound. Restore it before anything
+       * that can raise an R error, as the file id may be an open handle's. */
+      if (low < H5F_LIBVER_V18) H5Fset_libver_bounds(file_id, low, high);
+      
       if (dset_id < 0) {
         errmsg = errmsg_1("Failed to create dataset for '%s'", dname); // # nocov
       } else {
         /* Write the main data */
-        errmsg = write_atomic_dataset(dset_id, data, dtype_str, rank, h5_dims);
+        errmsg = write_atomic_selection(dset_id, values, dtype_str, rank, h5_dims, H5S_ALL, 
+                                        compress_threads(compress));
+        if (errmsg == R_NilValue && XLENGTH(values) > 0) write_access_hint(dset_id, rank, compress);
+        if (errmsg == R_NilValue) write_auto_choice(dset_id, compress);
+        
+        if (errmsg == R_NilValue && is_dict) {
+          SEXP utf8   = PROTECT(mkString("utf8"));
+          SEXP n_dict = PROTECT(ScalarInteger((int)XLENGTH(dict)));
+          errmsg = write_atomic_attribute(file_id, dset_id, H5LITE_DICT_ATTR, dict, utf8, n_dict);
+          UNPROTECT(2);
+        }
         
         /* --- Write Dimension Scales if present --- */
         if (errmsg == R_NilValue) {
@@ -312,8 +543,9 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
         H5Dclose(dset_id);
       }
       
-      H5Tclose(file_type_id); H5Sclose(space_id); H5Fclose(file_id);
+      H5Tclose(file_type_id); H5Sclose(space_id); h5_file_close(file_id);
     }
+    UNPROTECT(1);
   }
 
   if (TYPEOF(errmsg) == CHARSXP) error("%s", CHAR(errmsg));
@@ -322,44 +554,351 @@ SEXP C_h5_write_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SE
 }
 
 
-/* --- WRITER: ATTRIBUTE --- */
-SEXP C_h5_write_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP data, SEXP dtype, SEXP dims) {
+/* --- APPENDER: DATASET --- */
+
+/* Returns 1 if `name` resolves to an existing link, without printing HDF5 errors. */
+static int link_exists(hid_t file_id, const char *name) {
+  herr_t (*old_func)(hid_t, void*);
+  void *old_client_data;
+  H5Eget_auto(H5E_DEFAULT, &old_func, &old_client_data);
+  H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+  
+  htri_t exists = H5Lexists(file_id, name, H5P_DEFAULT);
+  
+  H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
+  return exists > 0;
+}
+
+/*
+ * Creates an empty dataset whose first dimension can grow without limit.
+ * Chunks are sized as if the dataset already had enough rows to fill one,
+ * so that small first batches do not lock in tiny chunks.
+ */
+static hid_t create_appendable_dataset(hid_t file_id, const char *dname, hid_t file_type_id, 
+                                       int rank, const hsize_t *h5_dims, SEXP compress) {
+  
+  hsize_t *cur_dims   = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  hsize_t *max_dims   = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  hsize_t *plan_dims  = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  hsize_t *chunk_dims = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  
+  size_t  type_size = H5Tget_size(file_type_id);
+  hsize_t row_bytes = type_size;
+  
+  for (int i = 0; i < rank; i++) {
+    cur_dims[i]  = (i == 0) ? 0 : h5_dims[i];
+    max_dims[i]  = (i == 0) ? H5S_UNLIMITED : h5_dims[i];
+    plan_dims[i] = (h5_dims[i] > 0) ? h5_dims[i] : 1;
+    if (i > 0) row_bytes *= plan_dims[i];
+  }
+  
+  hsize_t target_rows = (hsize_t)asInteger(getAttrib(compress, install("chunk_size"))) / row_bytes;
+  if (plan_dims[0] < target_rows) plan_dims[0] = target_rows;
+  
+  calculate_chunk_dims(rank, plan_dims, type_size, compress, chunk_dims);
+  
+  hid_t space_id = H5Screate_simple(rank, cur_dims, max_dims);
+  
+  hid_t lcpl_id = H5Pcreate(H5P_LINK_CREATE);
+  H5Pset_create_intermediate_group(lcpl_id, 1);
+  H5Pset_char_encoding(lcpl_id, H5T_CSET_UTF8);
+  
+  /* Extensible datasets must be chunked, even without compression. */
+  hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
+  apply_compression(dcpl_id, file_type_id, rank, chunk_dims, compress);
+  
+  hid_t dset_id = H5Dcreate2(file_id, dname, file_type_id, space_id, lcpl_id, dcpl_id, H5P_DEFAULT);
+  if (dset_id >= 0) write_access_hint(dset_id, rank, compress);
+  if (dset_id >= 0) write_auto_choice(dset_id, compress);
+  
+  H5Pclose(lcpl_id); H5Pclose(dcpl_id); H5Sclose(space_id);
+  return dset_id;
+}
+
+/*
+ * Grows the first dimension of dset_id by h5_dims[0] and returns a file
+ * dataspace with the new rows selected, or a CHARSXP error message if the
+ * dataset cannot take rows of this shape. `old_rows` receives the length of
+ * the first dimension before it grew.
+ */
+static SEXP extend_rows(hid_t dset_id, const char *dname, int rank, const hsize_t *h5_dims, 
+                        hid_t *out_space_id, hsize_t *old_rows) {
+  
+  hid_t space_id = H5Dget_space(dset_id);
+  int   ndims    = H5Sget_simple_extent_ndims(space_id);
+  
+  if (H5Sget_simple_extent_type(space_id) != H5S_SIMPLE || ndims != rank) {
+    H5Sclose(space_id);
+    return errmsg_1("Cannot append to '%s': data must have the same number of dimensions as the dataset.", dname);
+  }
+  
+  hsize_t *dims     = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  hsize_t *max_dims = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  hsize_t *offset   = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+  H5Sget_simple_extent_dims(space_id, dims, max_dims);
+  H5Sclose(space_id);
+  
+  if (max_dims[0] != H5S_UNLIMITED)
+    return errmsg_1("Cannot append to '%s': the dataset was not created by h5_append() and is not extensible.", dname);
+  
+  for (int i = 1; i < rank; i++)
+    if (dims[i] != h5_dims[i])
+      return errmsg_1("Cannot append to '%s': all dimensions except the first must match the dataset.", dname);
+  
+  for (int i = 0; i < rank; i++) offset[i] = (i == 0) ? dims[0] : 0;
+  *old_rows = dims[0];
+  dims[0] += h5_dims[0];
+  
+  if (H5Dset_extent(dset_id, dims) < 0)
+    return errmsg_1("Failed to extend dataset '%s'", dname); // # nocov
+  
+  space_id = H5Dget_space(dset_id);
+  H5Sselect_hyperslab(space_id, H5S_SELECT_SET, offset, NULL, h5_dims, NULL);
+  
+  *out_space_id = space_id;
+  return R_NilValue;
+}
+
+/*
+ * Appends rows to a dataset along its first dimension, creating an
+ * extensible dataset on the first call. Only the new hyperslab is written.
+ */
+SEXP C_h5_append_dataset(SEXP filename, SEXP dset_name, SEXP data, SEXP dtype, SEXP dims, SEXP compress) {
   const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
-  const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
-  const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
+  const char *dname = Rf_translateCharUTF8(STRING_ELT(dset_name, 0));
   
-  hid_t file_id = H5Fopen(fname, H5F_ACC_RDWR, H5P_DEFAULT);
-  if (file_id < 0) error("File must exist to write attributes: %s", fname);
+  hid_t file_id = open_or_create_file(fname, NULL, NULL);
+  int   exists  = link_exists(file_id, dname);
   
-  hid_t obj_id = H5Oopen(file_id, oname, H5P_DEFAULT);
-  if (obj_id < 0) { H5Fclose(file_id); error("Failed to open object: %s", oname); }
+  SEXP    errmsg       = R_NilValue;
+  int     is_compound  = (TYPEOF(data) == VECSXP);
+  int     rank         = 1;
+  hsize_t *h5_dims     = NULL;
+  hid_t   file_type_id = -1, mem_type_id = -1;
+  h5_df_pack_t pack;
+  
+  /* --- 1. Shape and types of the new rows --- */
+  if (is_compound) {
+    h5_dims    = (hsize_t *)R_alloc(1, sizeof(hsize_t));
+    h5_dims[0] = (XLENGTH(data) > 0) ? (hsize_t)XLENGTH(VECTOR_ELT(data, 0)) : 0;
+    errmsg     = pack_dataframe(data, dtype, dname, &pack);
+    if (errmsg != R_NilValue) { h5_file_close(file_id); error("%s", CHAR(errmsg)); }
+    file_type_id = pack.file_type_id;
+    mem_type_id  = pack.mem_type_id;
+  }
+  else {
+    hid_t space_id = create_dataspace(dims, data, &rank, &h5_dims);
+    if (space_id < 0 || rank == 0) {
+      if (space_id >= 0) H5Sclose(space_id);
+      h5_file_close(file_id);
+      error("Cannot append scalar data to '%s'.", dname);
+    }
+    H5Sclose(space_id);
+    file_type_id = create_h5_file_type(data, CHAR(STRING_ELT(dtype, 0)));
+  }
+  
+  /* --- 2. Open or create the target --- */
+  hid_t dset_id = exists 
+    ? h5_dataset_open(file_id, dname, 0)
+    : create_appendable_dataset(file_id, dname, file_type_id, rank, h5_dims, compress);
+  
+  if (dset_id < 0) {
+    errmsg = exists
+      ? errmsg_1("Failed to open dataset: %s", dname)
+      : errmsg_1("Failed to create dataset for '%s'", dname); // # nocov
+  }
+  
+  /* --- 3. Extend and write the new rows --- */
+  else if (h5_dims[0] > 0) {
+    hid_t   file_space_id = -1;
+    hsize_t old_rows      = 0;
+    errmsg = extend_rows(dset_id, dname, rank, h5_dims, &file_space_id, &old_rows);
+    
+    if (errmsg == R_NilValue) {
+      if (is_compound) {
+        if (write_rows(dset_id, mem_type_id, 1, h5_dims, pack.row_size, file_space_id, 1, pack_rows, &pack) < 0)
+          errmsg = errmsg_1("Failed to append to compound dataset '%s'", dname);
+      }
+      else {
+        errmsg = write_atomic_selection(dset_id, data, CHAR(STRING_ELT(dtype, 0)), rank, h5_dims, file_space_id, 1);
+      }
+      H5Sclose(file_space_id);
+      
+      /* Drop the rows again, so that a failed append leaves no fill values behind. */
+      if (errmsg != R_NilValue) {
+        hsize_t *old_dims = (hsize_t *)R_alloc(rank, sizeof(hsize_t));
+        for (int i = 0; i < rank; i++) old_dims[i] = (i == 0) ? old_rows : h5_dims[i];
+        H5Dset_extent(dset_id, old_dims);
+      }
+    }
+  }
+  
+  /* --- 4. Clean up --- */
+  if (dset_id >= 0) H5Dclose(dset_id);
+  if (mem_type_id >= 0) H5Tclose(mem_type_id);
+  if (file_type_id >= 0) H5Tclose(file_type_id);
+  h5_file_close(file_id);
+  
+  if (TYPEOF(errmsg) == CHARSXP) error("%s", CHAR(errmsg));
+  
+  return R_NilValue;
+}
 
-  SEXP errmsg = R_NilValue;
+
+/* --- WRITER: ATTRIBUTE --- */
+/* Writes one attribute to an open object, replacing any existing one. */
+static SEXP write_attribute(hid_t file_id, hid_t obj_id, const char *aname, SEXP data, SEXP dtype, SEXP dims) {
   
   /* --- Overwrite Logic --- */
   herr_t status = handle_attribute_overwrite(file_id, obj_id, aname);
 
   if (status < 0) { /* Attribute exists and could not be overwritten */
-    errmsg = errmsg_1("Failed to overwrite existing attribute '%s'", aname); // # nocov
+    return errmsg_1("Failed to overwrite existing attribute '%s'", aname); // # nocov
   }
-  else if (TYPEOF(data) == VECSXP) { /* a data.frame */
+  
+  if (TYPEOF(data) == VECSXP) { /* a data.frame */
     /* Attribute writing mode: is_attribute = 1. Scales will NOT be written.
        write_dataframe handles internal ACPL creation for UTF-8 names. */
-    errmsg = write_dataframe(file_id, obj_id, aname, data, dtype, R_NilValue, 1);
-  }
-  else { /* an atomic type or NULL */
-    const char *dtype_str_check = CHAR(STRING_ELT(dtype, 0));
-    if (strcmp(dtype_str_check, "null") == 0) {
-      errmsg = write_null_attribute(file_id, obj_id, aname);
-    } else {
-      errmsg = write_atomic_attribute(file_id, obj_id, aname, data, dtype, dims);
-    }
+    return write_dataframe(file_id, obj_id, aname, data, dtype, R_NilValue, 1);
   }
   
+  /* an atomic type or NULL */
+  if (strcmp(CHAR(STRING_ELT(dtype, 0)), "null") == 0)
+    return write_null_attribute(file_id, obj_id, aname);
+  
+  return write_atomic_attribute(file_id, obj_id, aname, data, dtype, dims);
+}
+
+
+SEXP C_h5_write_attribute(SEXP filename, SEXP obj_name, SEXP attr_name, SEXP data, SEXP dtype, SEXP dims) {
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
+  const char *aname = Rf_translateCharUTF8(STRING_ELT(attr_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
+  if (file_id < 0) error("File must exist to write attributes: %s", fname);
+  
+  hid_t obj_id = H5Oopen(file_id, oname, H5P_DEFAULT);
+  if (obj_id < 0) { h5_file_close(file_id); error("Failed to open object: %s", oname); }
+
+  SEXP errmsg = write_attribute(file_id, obj_id, aname, data, dtype, dims);
+  
   H5Oclose(obj_id);
-  H5Fclose(file_id);
+  h5_file_close(file_id);
+
+  if (TYPEOF(errmsg) == CHARSXP) error("%s", CHAR(errmsg));
 
+  return R_NilValue;
+}
+
+
+/*
+ * C implementation of the attributes that h5_write() attaches to an object.
+ * `attrs` is a list of list(attr_name, data, dtype, dims), one per attribute,
+ * as C_h5_write_attribute() takes them. The object is opened once for all of
+ * them. Stops at the first attribute that cannot be written.
+ */
+SEXP C_h5_write_attributes(SEXP filename, SEXP obj_name, SEXP attrs) {
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+  const char *oname = Rf_translateCharUTF8(STRING_ELT(obj_name, 0));
+  
+  hid_t file_id = h5_file_open(fname, H5F_ACC_RDWR);
+  if (file_id < 0) error("File must exist to write attributes: %s", fname);
+  
+  hid_t obj_id = H5Oopen(file_id, oname, H5P_DEFAULT);
+  if (obj_id < 0) { h5_file_close(file_id); error("Failed to open object: %s", oname); }
+  
+  SEXP errmsg = R_NilValue;
+  
+  for (R_xlen_t i = 0; i < XLENGTH(attrs) && errmsg == R_NilValue; i++) {
+    SEXP        attr  = VECTOR_ELT(attrs, i);
+    const char *aname = Rf_translateCharUTF8(STRING_ELT(VECTOR_ELT(attr, 0), 0));
+    errmsg = write_attribute(file_id, obj_id, aname, VECTOR_ELT(attr, 1), VECTOR_ELT(attr, 2), VECTOR_ELT(attr, 3));
+  }
+  
+  H5Oclose(obj_id);
+  h5_file_close(file_id);
+  
   if (TYPEOF(errmsg) == CHARSXP) error("%s", CHAR(errmsg));
+  
+  return R_NilValue;
+}
+
+
+/* --- BATCHED WRITES --- */
+
+/*
+ * h5_write() of a nested list resolves and validates the whole tree in R,
+ * then hands it over as a list of write operations. Each operation is
+ * list(routine, <routine's arguments>), run by the entry point of the same
+ * name. While they run, the file is held open by a temporary h5_open()
+ * handle, so every operation reuses one file id and the file is flushed and
+ * closed once at the end rather than once per dataset and attribute.
+ */
+/* The "group" operation: replaces `name` with a new, empty group. */
+static void replace_group(SEXP filename, SEXP group_name) {
+
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename,   0));
+  const char *gname = Rf_translateCharUTF8(STRING_ELT(group_name, 0));
+
+  hid_t  file_id = open_or_create_file(fname, NULL, NULL);
+  herr_t status  = handle_overwrite(file_id, gname);
+  h5_file_close(file_id);
+
+  if (status < 0) error("Failed to delete object: %s", gname);
+
+  C_h5_create_group(filename, group_name);
+}
+
+static SEXP run_batch(void *data) {
+
+  SEXP ops = (SEXP)data;
+
+  for (R_xlen_t i = 0; i < XLENGTH(ops); i++) {
+
+    SEXP        op      = VECTOR_ELT(ops, i);
+    const char *routine = CHAR(STRING_ELT(VECTOR_ELT(op, 0), 0));
+#define ARG(k) VECTOR_ELT(op, k)
+
+    if      (strcmp(routine, "group") == 0)                replace_group(ARG(1), ARG(2));
+    else if (strcmp(routine, "C_h5_write_dataset") == 0)   C_h5_write_dataset(ARG(1), ARG(2), ARG(3), ARG(4), ARG(5), ARG(6));
+    else if (strcmp(routine, "C_h5_write_attribute") == 0) C_h5_write_attribute(ARG(1), ARG(2), ARG(3), ARG(4), ARG(5), ARG(6));
+    else if (strcmp(routine, "C_h5_write_attributes") == 0) C_h5_write_attributes(ARG(1), ARG(2), ARG(3));
+    else if (strcmp(routine, "C_h5_write_rownames") == 0)  C_h5_write_rownames(ARG(1), ARG(2), ARG(3), ARG(4));
+    else error("Unknown write operation: %s", routine); // # nocov
+
+#undef ARG
+  }
+
+  return R_NilValue;
+}
+
+static void end_batch(void *data) {
+  SEXP session = (SEXP)data;
+  if (session != R_NilValue) C_h5_close(session);
+}
+
+
+/*
+ * C implementation of batched writes for h5_write().
+ * Runs the operations in `ops` in order. When no h5_open() handle
+ * holds the file already, one is opened for the duration of the batch and
+ * closed afterwards, even if an operation fails.
+ */
+SEXP C_h5_write_batch(SEXP filename, SEXP ops) {
+
+  const char *fname = Rf_translateCharUTF8(STRING_ELT(filename, 0));
+
+  SEXP session = R_NilValue;
+  if (h5_file_cached(fname, H5F_ACC_RDWR) < 0) {
+    SEXP readonly = PROTECT(ScalarLogical(FALSE));
+    session = C_h5_open(filename, readonly, R_NilValue, R_NilValue, R_NilValue);
+    UNPROTECT(1);
+  }
+  PROTECT(session);
+
+  R_ExecWithCleanup(run_batch, ops, end_batch, session);
 
+  UNPROTECT(1);
   return R_NilValue;
 }
@@ -164,9 +164,20 @@ void apply_compression(hid_t dcpl_id, hid_t type_id, int rank, hsize_t *chunk_di
  * Opens an HDF5 file with read-write access.
  * If the file does not exist, it creates a new one.
  * If the file exists but is not a valid HDF5 file (e.g., text file), it throws an error.
+ * The file is opened with h5_fapl(cache) and h5_format_fapl(format), which
+ * fall back to the h5lite.cache and h5lite.format options when NULL; a new
+ * file is created with h5_fcpl(format). Release the returned id with
+ * h5_file_close().
  */
-hid_t open_or_create_file(const char *fname) {
-  hid_t file_id = -1;
+hid_t open_or_create_file(const char *fname, const h5_cache_t *cache, const h5_format_t *format) {
+  
+  /* A file held open by h5_open() is known to exist and be valid HDF5. */
+  h5_profile_refresh();
+  hid_t file_id = h5_file_cached(fname, H5F_ACC_RDWR);
+  if (file_id >= 0) return file_id;
+  
+  H5LITE_PROF_BEGIN(t0);
+  
   /* Suppress HDF5's auto error printing for H5Fis_hdf5.
    * It will (correctly) error if the file doesn't exist,
    * but we don't want to show that stack trace to the user.
@@ -183,21 +194,32 @@ hid_t open_or_create_file(const char *fname) {
   /* Restore error handler */
   H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
   
+  hid_t fapl_id = h5_format_fapl(h5_fapl(cache), format);
+  
   if (is_hdf5 > 0) {
     /* File exists and is a valid HDF5 file, open it. */
-    file_id = H5Fopen(fname, H5F_ACC_RDWR, H5P_DEFAULT);
+    file_id = h5_fopen(fname, H5F_ACC_RDWR, fapl_id);
   }
   else {
     /* File is not a valid HDF5 file. Check if it exists at all. */
     FILE *fp = fopen(fname, "r");
     
     /* File exists but is not HDF5. This is an error (prevent overwriting user data). */
-    if (fp != NULL) { fclose(fp); error("File exists but is not a valid HDF5 file: %s", fname); }
+    if (fp != NULL) {
+      fclose(fp);
+      if (fapl_id != H5P_DEFAULT) H5Pclose(fapl_id);
+      error("File exists but is not a valid HDF5 file: %s", fname);
+    }
     
     /* File does not exist, so create it. */
-    file_id = H5Fcreate(fname, H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t fcpl_id = h5_fcpl(format);
+    file_id = H5Fcreate(fname, H5F_ACC_EXCL, fcpl_id, fapl_id);
+    if (fcpl_id != H5P_DEFAULT) H5Pclose(fcpl_id);
   }
   
+  if (fapl_id != H5P_DEFAULT) H5Pclose(fapl_id);
+  H5LITE_PROF_END(H5LITE_PROF_OPEN, t0, 0, 0);
+  
   if (file_id < 0)
     error("Failed to open or create file: %s", fname); // # nocov
   
@@ -291,6 +313,7 @@ herr_t write_buffer_to_object(hid_t obj_id, hid_t mem_type_id, void *buffer) {
   /* Check if obj_id is a dataset or an attribute and call the appropriate write function. */
   H5I_type_t obj_type = H5Iget_type(obj_id);
   
+  H5LITE_PROF_BEGIN(t0);
   if (obj_type == H5I_DATASET) {
     /* For datasets, we specify memory and file space (H5S_ALL means entire space). */
     status = H5Dwrite(obj_id, mem_type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer);
@@ -298,39 +321,164 @@ herr_t write_buffer_to_object(hid_t obj_id, hid_t mem_type_id, void *buffer) {
     /* For attributes, the dataspace is part of the attribute, so we only need the memory type. */
     status = H5Awrite(obj_id, mem_type_id, buffer);
   }
+  h5_prof_io(H5LITE_PROF_WRITE, t0, obj_id, mem_type_id, H5S_ALL);
   
   return status;
 }
 
 
+/* Halves the largest of out_chunk_dims[from .. to) until the chunk fits target_size. */
+static void shrink_chunk(int rank, hsize_t *out_chunk_dims, size_t type_size, hsize_t target_size, 
+                         int from, int to) {
+  
+  hsize_t current_bytes = type_size;
+  for (int i = 0; i < rank; i++) current_bytes *= out_chunk_dims[i];
+  
+  while (current_bytes > target_size) {
+    int max_idx = from;
+    for (int i = from + 1; i < to; i++) {
+      if (out_chunk_dims[i] > out_chunk_dims[max_idx]) max_idx = i;
+    }
+    if (out_chunk_dims[max_idx] <= 1) break;
+    out_chunk_dims[max_idx] = (out_chunk_dims[max_idx] + 1) / 2;
+    
+    current_bytes = type_size;
+    for (int i = 0; i < rank; i++) current_bytes *= out_chunk_dims[i];
+  }
+}
+
+
 /*
  * Implements a heuristic to determine chunk dimensions for a dataset.
  * The goal is to create chunks that are roughly 1MB in size (default)
  * by iteratively halving the largest dimension until the target size is met.
+ * 
+ * The `access` hint of the compress object changes which dimensions are cut:
+ *   "row"    - whole rows (dims 1..rank-1) stay in one chunk; dim 0 is cut first.
+ *   "column" - all of dim 0 stays in one chunk; the other dims are cut first.
+ *   numeric  - explicit chunk dims, used as given (clamped to the data).
+ * Vectors, and explicit dims of the wrong rank, use the default heuristic.
  */
 void calculate_chunk_dims(int rank, const hsize_t *dims, size_t type_size, SEXP compress, hsize_t *out_chunk_dims) {
   
-  hsize_t target_size   = (hsize_t)asInteger(getAttrib(compress, install("chunk_size")));
-  hsize_t current_bytes = type_size;
+  hsize_t target_size = (hsize_t)asInteger(getAttrib(compress, install("chunk_size")));
+  SEXP    access      = getAttrib(compress, install("access"));
 
   for (int i = 0; i < rank; i++) {
     out_chunk_dims[i] = dims[i];
-    current_bytes *= dims[i];
   }
 
-  if (current_bytes > target_size) {
-    while (current_bytes > target_size) {
-      int max_idx = 0;
-      for (int i = 1; i < rank; i++) {
-        if (out_chunk_dims[i] > out_chunk_dims[max_idx]) max_idx = i;
-      }
-      if (out_chunk_dims[max_idx] <= 1) break;
-      out_chunk_dims[max_idx] = (out_chunk_dims[max_idx] + 1) / 2;
-      
-      current_bytes = type_size;
-      for (int i = 0; i < rank; i++) current_bytes *= out_chunk_dims[i];
+  if (isReal(access) && XLENGTH(access) == rank) {
+    for (int i = 0; i < rank; i++) {
+      hsize_t want = (hsize_t)REAL(access)[i];
+      if (want < 1)       want = 1;
+      if (want < dims[i]) out_chunk_dims[i] = want;
     }
+    return;
+  }
+
+  const char *hint = isString(access) ? CHAR(STRING_ELT(access, 0)) : "balanced";
+
+  if (rank > 1 && strcmp(hint, "row") == 0) {
+    shrink_chunk(rank, out_chunk_dims, type_size, target_size, 0, 1);
+    shrink_chunk(rank, out_chunk_dims, type_size, target_size, 1, rank);
+  }
+  else if (rank > 1 && strcmp(hint, "column") == 0) {
+    shrink_chunk(rank, out_chunk_dims, type_size, target_size, 1, rank);
+    shrink_chunk(rank, out_chunk_dims, type_size, target_size, 0, 1);
+  }
+  else {
+    shrink_chunk(rank, out_chunk_dims, type_size, target_size, 0, rank);
+  }
+}
+
+
+/*
+ * Records a non-default `access` hint on a new dataset as the string
+ * attribute "h5lite_access" ("row", "column", or "custom"), so that readers
+ * can choose block sizes that match the chunk shape.
+ */
+void write_access_hint(hid_t dset_id, int rank, SEXP compress) {
+  
+  SEXP access = getAttrib(compress, install("access"));
+  const char *hint = NULL;
+  
+  if      (isReal(access) && XLENGTH(access) == rank) hint = "custom";
+  else if (isString(access) && rank > 1)              hint = CHAR(STRING_ELT(access, 0));
+  
+  if (hint == NULL || strcmp(hint, "balanced") == 0) return;
+  
+  hid_t type_id  = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type_id, strlen(hint) + 1);
+  hid_t space_id = H5Screate(H5S_SCALAR);
+  hid_t attr_id  = H5Acreate2(dset_id, H5LITE_ACCESS_ATTR, type_id, space_id, H5P_DEFAULT, H5P_DEFAULT);
+  
+  if (attr_id >= 0) {
+    H5Awrite(attr_id, type_id, hint);
+    H5Aclose(attr_id);
   }
+  H5Sclose(space_id);
+  H5Tclose(type_id);
+}
+
+
+/*
+ * Records the pipeline that h5_compression("auto") chose for a new dataset
+ * - the compression string, e.g. "bshuf-zstd" - as the string attribute
+ * "h5lite_compress". Does nothing for explicitly chosen pipelines.
+ */
+void write_auto_choice(hid_t dset_id, SEXP compress) {
+  
+  if (getAttrib(compress, install("auto")) == R_NilValue || !isString(compress)) return;
+  
+  const char *choice = CHAR(STRING_ELT(compress, 0));
+  
+  hid_t type_id  = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type_id, strlen(choice) + 1);
+  hid_t space_id = H5Screate(H5S_SCALAR);
+  hid_t attr_id  = H5Acreate2(dset_id, H5LITE_COMPRESS_ATTR, type_id, space_id, H5P_DEFAULT, H5P_DEFAULT);
+  
+  if (attr_id >= 0) {
+    H5Awrite(attr_id, type_id, choice);
+    H5Aclose(attr_id);
+  }
+  H5Sclose(space_id);
+  H5Tclose(type_id);
+}
+
+
+/*
+ * Threads for compressing chunks: the `threads` of an h5_compression()
+ * object, or getOption("h5lite.threads") when that is NA.
+ */
+int compress_threads(SEXP compress) {
+  SEXP threads = getAttrib(compress, install("threads"));
+  if (threads == R_NilValue || asInteger(threads) == NA_INTEGER) return h5_threads();
+  return (asInteger(threads) < 1) ? 1 : asInteger(threads);
+}
+
+/*
+ * Whether a dataset can skip chunking: h5_compression("none") with no
+ * checksum, no Scale-Offset packing and the default "balanced" access hint.
+ * Such datasets are stored contiguously, like HDF5's own default, which also
+ * lets h5_read(mmap = TRUE) map them.
+ */
+int compress_is_plain(SEXP compress) {
+  
+  SEXP codec = getAttrib(compress, install("codec"));
+  if (codec == R_NilValue || strcmp(CHAR(STRING_ELT(codec, 0)), "none") != 0) return 0;
+  
+  SEXP checksum = getAttrib(compress, install("checksum"));
+  if (checksum != R_NilValue && asLogical(checksum) == TRUE) return 0;
+  
+  SEXP ip = getAttrib(compress, install("int_packing"));
+  SEXP fr = getAttrib(compress, install("float_rounding"));
+  if (ip != R_NilValue && asInteger(ip) != NA_INTEGER) return 0;
+  if (fr != R_NilValue && asInteger(fr) != NA_INTEGER) return 0;
+  
+  SEXP access = getAttrib(compress, install("access"));
+  if (access == R_NilValue) return 1;
+  return TYPEOF(access) == STRSXP && strcmp(CHAR(STRING_ELT(access, 0)), "balanced") == 0;
 }
 
 /*
@@ -0,0 +1,87 @@
+local({
+  #test_that("h5_append grows vectors and matrices", {
+  file <- tempfile(fileext = ".h5")
+  
+  h5_append(1:5, file, "v")
+  h5_append(6:10, file, "v")
+  expect_equal(h5_read(file, "v"), 1:10)
+  expect_equal(h5_typeof(file, "v"), "int32")
+  
+  h5_append(c(0.5, 1.5), file, "dbl")
+  h5_append(1:2, file, "dbl")
+  expect_equal(h5_read(file, "dbl"), c(0.5, 1.5, 1, 2))
+  
+  m <- matrix(1:12, ncol = 3)
+  h5_append(m[1:2, ], file, "grp/m")
+  h5_append(m[3:4, , drop = FALSE], file, "grp/m")
+  expect_equal(h5_read(file, "grp/m"), m)
+  
+  h5_append(c("a", "bb"), file, "s")
+  h5_append(c("a much longer string", NA), file, "s")
+  expect_equal(h5_read(file, "s"), c("a", "bb", "a much longer string", NA))
+  
+  # An empty first batch defines the shape
+  h5_append(matrix(numeric(0), ncol = 2), file, "empty")
+  h5_append(matrix(1:4, ncol = 2), file, "empty")
+  expect_equal(h5_dim(file, "empty"), c(2, 2))
+  
+  unlink(file)
+})
+
+local({
+  #test_that("h5_append grows data.frames", {
+  file <- tempfile(fileext = ".h5")
+  
+  df1 <- data.frame(id = 1:3, score = c(1.5, 2.5, 3.5), label = c("a", "b", "c"))
+  df2 <- data.frame(label = c("dd", "ee"), id = 4:5, score = c(4.5, 5.5))
+  
+  h5_append(df1, file, "df")
+  h5_append(df2, file, "df")   # Columns are matched by name
+  h5_append(df1[0, ], file, "df")
+  
+  res <- h5_read(file, "df")
+  expect_equal(res$id, 1:5)
+  expect_equal(res$score, c(1.5, 2.5, 3.5, 4.5, 5.5))
+  expect_equal(res$label, c("a", "b", "c", "dd", "ee"))
+  
+  expect_error(h5_append(df1[, 1:2], file, "df"), "columns must match")
+  expect_error(h5_append(1:3, file, "df"), "must be a data.frame")
+  
+  unlink(file)
+})
+
+local({
+  #test_that("h5_append honors `as` and `compress` and validates input", {
+  file <- tempfile(fileext = ".h5")
+  
+  h5_append(1:10, file, "u16", as = "uint16", compress = "lz4")
+  h5_append(11:20, file, "u16")
+  expect_equal(h5_typeof(file, "u16"), "uint16")
+  expect_equal(h5_read(file, "u16"), 1:20)
+  expect_equal(h5_inspect(file, "u16")$layout, "chunked")
+  
+  expect_error(h5_append(c(1L, NA), file, "u16"), "requires float type")
+  expect_error(h5_append(-1, file, "u16"), "exceeds")
+  expect_error(h5_append(letters, file, "u16"), "Cannot append character data")
+  expect_error(h5_append(matrix(1:4, 2), file, "u16"), "same number of dimensions")
+  
+  h5_append(matrix(1:4, 2), file, "m")
+  expect_error(h5_append(matrix(1:3, 1), file, "m"), "all dimensions except the first")
+  
+  h5_write(1:3, file, "fixed")
+  expect_error(h5_append(4:6, file, "fixed"), "not extensible")
+  
+  h5_create_group(file, "grp")
+  expect_error(h5_append(1, file, "grp"), "not a dataset")
+  expect_error(h5_append(list(a = 1), file, "lst"), "must be a vector")
+  
+  # The h5 handle method
+  h5 <- h5_open(file)
+  h5$cd("grp")
+  h5$append(1:2, "x")
+  h5$append(3L, "x")
+  expect_equal(h5$read("x"), 1:3)
+  h5$close()
+  
+  unlink(file)
+})
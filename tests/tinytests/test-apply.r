@@ -0,0 +1,70 @@
+local({
+  #test_that("h5_apply streams matrices in row blocks", {
+  file <- tempfile(fileext = ".h5")
+  m <- matrix(as.numeric(1:(103 * 4)), nrow = 103, ncol = 4)
+  h5_write(m, file, "m")
+  
+  res <- h5_apply(file, "m", identity, block = 25)
+  expect_equal(length(res), 5)
+  expect_equal(dim(res[[5]]), c(3L, 4L))
+  expect_equal(do.call(rbind, res), m)
+  
+  sums <- h5_apply(file, "m", colSums, block = 10)
+  expect_equal(Reduce(`+`, sums), colSums(m))
+  
+  # Extra arguments are passed on to FUN
+  res <- h5_apply(file, "m", function (x, k) nrow(x) * k, k = 2, block = 100)
+  expect_equal(unlist(res), c(200, 6))
+  
+  # The default block covers the whole (small) dataset
+  expect_equal(h5_apply(file, "m", identity)[[1]], m)
+  
+  unlink(file)
+})
+
+local({
+  #test_that("h5_apply handles vectors, arrays, and data.frames", {
+  file <- tempfile(fileext = ".h5")
+  
+  v <- 1:50
+  h5_write(v, file, "v")
+  expect_equal(unlist(h5_apply(file, "v", identity, block = 7)), v)
+  expect_equal(h5_apply(file, "v", identity, block = 7, as = "double")[[1]], as.numeric(1:7))
+  
+  arr <- array(1:60, dim = c(3, 4, 5))
+  h5_write(arr, file, "arr")
+  res <- h5_apply(file, "arr", identity, block = 2)
+  expect_equal(length(res), 3)
+  expect_equal(res[[2]], arr[, , 3:4])
+  expect_equal(dim(res[[3]]), c(3L, 4L, 1L))
+  
+  df <- data.frame(x = 1:20, y = letters[1:20])
+  h5_write(df, file, "df")
+  res <- h5_apply(file, "df", nrow, block = 8)
+  expect_equal(unlist(res), c(8L, 8L, 4L))
+  expect_equal(h5_apply(file, "df", identity, block = 8)[[3]]$y, letters[17:20])
+  
+  unlink(file)
+})
+
+local({
+  #test_that("h5_apply validates its arguments", {
+  file <- tempfile(fileext = ".h5")
+  h5_write(1:10, file, "v")
+  h5_create_group(file, "grp")
+  
+  expect_error(h5_apply(file, "grp", identity), "is not a dataset")
+  expect_error(h5_apply(file, "missing", identity), "does not exist")
+  expect_error(h5_apply(file, "v", identity, block = 0), "must be positive")
+  expect_error(h5_apply(file, "v", identity, block = 1.5), "must be a scalar integer")
+  expect_error(h5_apply(file, "v", identity, as = "bogus"), "Invalid `as` argument")
+  
+  # The h5 handle method resolves paths against the working directory
+  h5 <- h5_open(file)
+  h5_write(matrix(1:6, 3), file, "grp/m")
+  h5$cd("grp")
+  expect_equal(unlist(h5$apply("m", sum, block = 1)), c(5L, 7L, 9L))
+  h5$close()
+  
+  unlink(file)
+})
@@ -145,6 +145,32 @@ local({
   expect_equal(h5_read(file, "city"), ascii_str)
 })
 
+local({
+  #test_that("Repeated strings are read correctly", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  labels <- c("caf\u00e9", "b", "", "gamma")[rep_len(1:4, 5000)]
+  mtx    <- matrix(labels, nrow = 100)
+  df     <- data.frame(id = seq_along(labels), label = labels)
+  
+  h5_write(labels, file, "vlen")
+  h5_write(labels, file, "fixed", as = "utf8[10]")
+  h5_write(mtx,    file, "mtx")
+  h5_write(df,     file, "df")
+  
+  expect_equal(h5_read(file, "vlen"),  labels)
+  expect_equal(h5_read(file, "fixed"), labels)
+  expect_equal(h5_read(file, "mtx"),   mtx)
+  expect_equal(h5_read(file, "df"),    df)
+  expect_equal(Encoding(h5_read(file, "vlen")[1:2]), c("UTF-8", "unknown"))
+  
+  # Mostly distinct strings
+  ids <- paste0("id", 1:5000)
+  h5_write(ids, file, "ids")
+  expect_equal(h5_read(file, "ids"), ids)
+})
+
 local({
   #test_that("Character errors work", {
   file <- tempfile(fileext = ".h5")
@@ -285,3 +285,160 @@ local({
   # Assert it prints normally without throwing errors for missing attributes
   expect_stdout(print(c_b2_bare), "Codec:\\s+blosc2-zstd-5")
 })
+
+local({
+  #test_that("Threaded chunk decompression matches serial reads", {
+  file <- tempfile(fileext = ".h5")
+  old  <- options(h5lite.threads = NULL, h5lite.block_size = NULL)
+  on.exit({ options(old); unlink(file) })
+  
+  m   <- matrix(rnorm(300 * 70), nrow = 300)
+  arr <- array(as.numeric(1:3600), c(20, 15, 12))
+  v16 <- rep(-1000:999, 25)
+  cmp <- h5_compression("gzip", chunk_size = 4096)
+  
+  h5_write(m,   file, "m",   compress = cmp)
+  h5_write(arr, file, "arr", compress = cmp, as = "float32")
+  h5_write(v16, file, "v16", compress = cmp, as = "int16")
+  h5_write(m,   file, "z",   compress = h5_compression("zstd", chunk_size = 4096))
+  
+  serial <- lapply(c("m", "arr", "v16", "z"), h5_read, file = file)
+  
+  options(h5lite.threads = 4)
+  expect_equal(lapply(c("m", "arr", "v16", "z"), h5_read, file = file), serial)
+  expect_equal(h5_read(file, "m", start = 37, count = 150), m[37:186, ])
+  expect_equal(h5_read(file, "v16", start = 777, count = 31000), v16[777:31776])
+  expect_equal(h5_read(file, "m", index = list(c(2, 250), c(1, 70))), m[c(2, 250), c(1, 70)])
+  
+  options(h5lite.block_size = 10000)
+  expect_equal(h5_read(file, "m"), m)
+})
+
+local({
+  #test_that("Threaded chunk compression writes identical files", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  m   <- matrix(rnorm(301 * 71), nrow = 301)
+  v16 <- rep(-1500:1500, 20)
+  raw <- as.raw(sample(0:255, 50000, replace = TRUE))
+  
+  for (threads in c(1, 4)) {
+    cmp <- h5_compression("gzip-6", chunk_size = 4096, threads = threads)
+    h5_write(m,   file, paste0("m",   threads), compress = cmp)
+    h5_write(v16, file, paste0("v16", threads), compress = cmp, as = "int16")
+    h5_write(raw, file, paste0("raw", threads), compress = cmp)
+  }
+  
+  expect_equal(h5_read(file, "m4"),   m)
+  expect_equal(h5_read(file, "v164"), v16)
+  expect_equal(h5_read(file, "raw4"), raw)
+  for (name in c("m", "v16", "raw"))
+    expect_equal(h5_inspect(file, paste0(name, 4))$storage_size, h5_inspect(file, paste0(name, 1))$storage_size)
+  
+  expect_stdout(print(h5_compression("gzip", threads = 4)), "Threads:\\s+4")
+  expect_error(h5_compression("gzip", threads = 0), "positive")
+  expect_error(h5_compression("gzip", threads = 1.5), "scalar integer")
+})
+
+local({
+  #test_that("access hints shape chunks and block sizes", {
+  file <- tempfile(fileext = ".h5")
+  old  <- options(h5lite.block_size = NULL)
+  on.exit({ options(old); unlink(file) })
+  
+  m <- matrix(as.numeric(1:200000), nrow = 1000, ncol = 200)
+  chunks <- function (name) h5_inspect(file, name)$chunk_dims
+  write  <- function (name, access, data = m)
+    h5_write(data, file, name, compress = h5_compression("gzip", chunk_size = 65536, access = access))
+  
+  write("bal", "balanced")
+  write("row", "row")
+  write("col", "column")
+  write("cus", c(10, 5))
+  write("big", c(5000, 1))
+  write("vec", "row", data = as.numeric(1:100000))
+  
+  expect_equal(chunks("bal"), c(63, 100))
+  expect_equal(chunks("row"), c(32, 200))
+  expect_equal(chunks("col"), c(1000, 7))
+  expect_equal(chunks("cus"), c(10, 5))
+  expect_equal(chunks("big"), c(1000, 1))
+  expect_equal(chunks("vec"), 8192)
+  
+  # The hint is recorded, but not returned as an R attribute
+  expect_true("h5lite_access" %in% h5_attr_names(file, "col"))
+  expect_false("h5lite_access" %in% h5_attr_names(file, "bal"))
+  expect_false("h5lite_access" %in% h5_attr_names(file, "vec"))
+  expect_equal(h5_read(file, "col"), m)
+  expect_equal(h5_read(file, "row", start = 40, count = 3), m[40:42, ])
+  
+  # Row blocks are not stretched to cover chunks that span every row
+  options(h5lite.block_size = 80000)
+  expect_equal(length(h5_apply(file, "col", nrow)), 20)
+  expect_equal(unlist(h5_apply(file, "row", nrow))[[1]], 32)
+  
+  expect_stdout(print(h5_compression(access = "row")),     "Chunk Shape:\\s+Whole rows")
+  expect_stdout(print(h5_compression(access = c(10, 5))),  "Chunk Shape:\\s+10 x 5")
+  expect_error(h5_compression(access = "diagonal"))
+  expect_error(h5_compression(access = c(10, 0)), "positive integer")
+})
+
+local({
+  #test_that("Blocked writes match whole writes", {
+  file <- tempfile(fileext = ".h5")
+  old  <- options(h5lite.block_size = NULL)
+  on.exit({ options(old); unlink(file) })
+  
+  m   <- matrix(rnorm(503 * 37), nrow = 503)
+  mi  <- matrix(c(NA, 2:18000), nrow = 600)
+  arr <- array(1:3003, c(7, 11, 39))
+  cmp <- h5_compression("gzip", chunk_size = 4096)
+  
+  for (size in list(NULL, 1000)) {
+    options(h5lite.block_size = size)
+    tag <- if (is.null(size)) "whole" else "blocks"
+    h5_write(m,   file, paste0("m_",   tag), compress = cmp)
+    h5_write(mi,  file, paste0("mi_",  tag), compress = cmp, as = "float64")
+    h5_write(arr, file, paste0("arr_", tag), compress = cmp)
+  }
+  
+  expect_equal(h5_read(file, "m_blocks"),   m)
+  expect_equal(h5_read(file, "mi_blocks"),  matrix(as.double(mi), nrow = 600))
+  expect_equal(h5_read(file, "arr_blocks"), arr)
+  for (name in c("m", "mi", "arr"))
+    expect_equal(
+      h5_inspect(file, paste0(name, "_blocks"))$storage_size, 
+      h5_inspect(file, paste0(name, "_whole"))$storage_size )
+})
+
+local({
+  #test_that("Automatic codec selection", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  expect_identical(attr(h5_compression("auto"), "auto"), "balanced")
+  expect_identical(attr(h5_compression("auto-ratio"), "auto"), "ratio")
+  
+  x   <- rep(1:50, 400)
+  m   <- matrix(round(rnorm(20000), 2), nrow = 200)
+  chr <- rep(c("a", "bb", "ccc"), 100)
+  
+  h5_write(x,   file, "x",   compress = "auto")
+  h5_write(m,   file, "m",   compress = "auto-ratio")
+  h5_write(x,   file, "xs",  compress = "auto-speed")
+  h5_write(chr, file, "chr", compress = "auto")
+  
+  expect_equal(h5_read(file, "x"),   x)
+  expect_equal(h5_read(file, "m"),   m)
+  expect_equal(h5_read(file, "xs"),  x)
+  expect_equal(h5_read(file, "chr"), chr)
+  
+  for (name in c("x", "m", "xs")) {
+    expect_true("h5lite_compress" %in% h5_attr_names(file, name))
+    expect_null(attr(h5_read(file, name), "h5lite_compress"))
+  }
+  expect_true(h5_inspect(file, "x")$storage_size < length(x) * 4)
+  
+  expect_error(h5_repack(file, "x", compress = "auto"), "not supported")
+})
@@ -103,3 +103,102 @@ local({
   expect_true(is.character(res$time))
   expect_equal(res$time, format(now, format = "%Y-%m-%dT%H:%M:%OSZ"))
 })
+
+local({
+  #test_that("cols reads a subset of data.frame columns", {
+  file <- tempfile(fileext = ".h5")
+  
+  df <- data.frame(
+    id    = 1:10,
+    score = seq(0.5, 5, by = 0.5),
+    label = letters[1:10],
+    grp   = factor(rep(c("a", "b"), 5)),
+    stringsAsFactors = FALSE )
+  h5_write(df, file, "df")
+  h5_write(1:5, file, "vec")
+  
+  expect_equal(h5_read(file, "df", cols = c("score", "id")), df[c("score", "id")])
+  expect_equal(h5_read(file, "df", cols = "grp"), df["grp"])
+  expect_equal(h5_read(file, "df", cols = "label", start = 3, count = 4), df[3:6, "label", drop = FALSE], check.attributes = FALSE)
+  expect_equal(h5_read(file, "df", cols = c("id", "label"), index = c(9, 2)), df[c(9, 2), c("id", "label")], check.attributes = FALSE)
+  expect_equal(h5_read(file, "df", cols = "id", as = c(id = "double"))$id, as.double(1:10))
+  
+  expect_error(h5_read(file, "df", cols = "nope"), "Columns not found")
+  expect_error(h5_read(file, "df", cols = c("id", "id")), "duplicate")
+  expect_error(h5_read(file, "df", cols = 1), "character vector")
+  expect_error(h5_read(file, "vec", cols = "id"), "compound")
+  expect_error(h5_read(file, "/", cols = "id"), "only be used on datasets")
+  
+  unlink(file)
+})
+
+local({
+  #test_that("Columnar data.frames round-trip", {
+  file <- tempfile(fileext = ".h5")
+  
+  df <- data.frame(
+    id    = 1:10,
+    score = seq(0.5, 5, by = 0.5),
+    label = letters[1:10],
+    grp   = factor(rep(c("a", "b"), 5)),
+    stringsAsFactors = FALSE )
+  h5_write(df, file, "df", layout = "columnar")
+  
+  expect_true(h5_is_group(file, "df"))
+  expect_equal(h5_class(file, "df"), "data.frame")
+  expect_equal(h5_dim(file, "df"), c(10, 4))
+  expect_equal(h5_names(file, "df"), names(df))
+  expect_equal(h5_read(file, "df"), df)
+  expect_equal(h5_typeof(file, "df/score"), "float64")
+  
+  # Subsets touch only the selected columns and rows
+  expect_equal(h5_read(file, "df", cols = c("label", "id")), df[c("label", "id")])
+  expect_equal(h5_read(file, "df", start = 3, count = 4), df[3:6, ], check.attributes = FALSE)
+  expect_equal(h5_read(file, "df", index = c(9, 2, 2)), df[c(9, 2, 2), ], check.attributes = FALSE)
+  expect_equal(h5_read(file, "df", as = c(id = "double"))$id, as.double(1:10))
+  
+  # Row names are shared by every column
+  rn <- mtcars[1:6, 1:3]
+  h5_write(rn, file, "rn", layout = "columnar", compress = "none")
+  expect_equal(h5_read(file, "rn"), rn)
+  expect_equal(rownames(h5_read(file, "rn", index = c(5, 1))), rownames(rn)[c(5, 1)])
+  expect_false("_rownames" %in% h5_names(file, "rn"))
+  
+  # Columnar data.frames inside lists
+  h5_write(list(a = df, b = 1:3), file, "grp", layout = "columnar")
+  expect_equal(h5_read(file, "grp/a"), df)
+  
+  expect_error(h5_write(df, file, "df", layout = "rows"))
+  expect_error(h5_write(setNames(df, c("a", "a", "b", "c")), file, "bad", layout = "columnar"), "unique")
+  expect_error(h5_write(setNames(df, c("a", "_rownames", "b", "c")), file, "bad", layout = "columnar"), "_rownames")
+  expect_error(h5_read(file, "df", cols = "nope"), "Columns not found")
+  
+  unlink(file)
+})
+
+local({
+  #test_that("Compound data.frames are written in blocks of records", {
+  file <- tempfile(fileext = ".h5")
+  old  <- options(h5lite.block_size = 4096)
+  on.exit({ options(old); unlink(file) })
+  
+  n  <- 5000
+  df <- data.frame(
+    x   = rnorm(n),
+    i   = replace(seq_len(n), 7, NA),
+    s   = replace(sprintf("row%d", seq_len(n)), 3, NA),
+    f   = sprintf("%04d", seq_len(n) %% 1000),
+    lgl = seq_len(n) %% 2 == 0,
+    raw = as.raw(seq_len(n) %% 256),
+    stringsAsFactors = FALSE )
+  
+  h5_write(df, file, "df", as = c(f = "ascii[4]"))
+  expect_equal(h5_read(file, "df", as = c(i = "integer", lgl = "logical")), df)
+  
+  h5_write(df, file, "gz", as = c(f = "ascii[4]"), compress = "gzip")
+  expect_equal(h5_read(file, "gz", as = c(i = "integer", lgl = "logical")), df)
+  
+  h5_append(df[1:10, ], file, "ap")
+  h5_append(df[11:n, ], file, "ap")
+  expect_equal(h5_read(file, "ap", as = c(i = "integer", lgl = "logical")), df, check.attributes = FALSE)
+})
@@ -62,3 +62,80 @@ local({
   expect_false(read_val == val)
   expect_equal(read_val, val, tolerance = 1e-7)
 })
+
+local({
+  #test_that("mmap reads match regular reads", {
+  file <- tempfile(fileext = ".h5")
+  
+  vec <- setNames(rnorm(5000), paste0("x", 1:5000))
+  int <- 1:100
+  mtx <- matrix(as.double(1:20), 4, 5)
+  
+  h5_write(vec, file, "vec", compress = "none")
+  h5_write(int, file, "int", as = "int32", compress = "none")
+  h5_write(mtx, file, "mtx", compress = "none")
+  h5_write(vec, file, "gz")
+  h5_write(c(1, 2, 3), file, "chk", compress = h5_compression("none", checksum = TRUE))
+  
+  expect_equal(h5_inspect(file, "vec")$layout, "contiguous")
+  expect_equal(h5_inspect(file, "chk")$layout, "chunked")
+  
+  # Mapped: names are still attached
+  x <- h5_read(file, "vec", mmap = TRUE)
+  expect_equal(x, vec)
+  expect_equal(h5_read(file, "int", as = "integer", mmap = TRUE), int)
+  
+  # Writing to a mapped vector modifies a copy, not the file
+  x[1] <- 0
+  expect_equal(x[[1]], 0)
+  expect_equal(h5_read(file, "vec", mmap = TRUE)[[1]], vec[[1]])
+  
+  # Everything else falls back to a regular read
+  expect_equal(h5_read(file, "int", mmap = TRUE), int)
+  expect_equal(h5_read(file, "mtx", mmap = TRUE), mtx)
+  expect_equal(h5_read(file, "gz",  mmap = TRUE), vec)
+  expect_equal(h5_read(file, "chk", mmap = TRUE), c(1, 2, 3))
+  expect_equal(h5_read(file, "vec", start = 2, count = 3, mmap = TRUE), vec[2:4])
+  expect_equal(h5_read(file, mmap = TRUE)$vec, vec)
+
+  # INT_MIN is read normally, with the same warning as without mmap
+  h5_write(c(1, -2^31), file, "i32", as = "int32", compress = "none")
+  expect_warning(res <- h5_read(file, "i32", as = "integer", mmap = TRUE))
+  expect_identical(res, c(1L, NA_integer_))
+  
+  expect_error(h5_read(file, "vec", mmap = NA))
+  
+  unlink(file)
+})
+
+
+local({
+  #test_that("Datasets with many attributes round-trip", {
+  
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  x <- seq(0, 1, by = 0.25)
+  for (i in 1:20) attr(x, sprintf("a%02d", i)) <- i * c(0.5, 1)
+  attr(x, "units") <- "cm"
+  attr(x, "df")    <- data.frame(i = 1:3, j = c("a", "b", "c"))
+  
+  h5_write(x, file, "x")
+  expect_equal(sort(h5_attr_names(file, "x")), sort(names(attributes(x))))
+  expect_equal(h5_read(file, "x"), x)
+  expect_equal(h5_read(file, "x", attr = "a07"), c(3.5, 7))
+  
+  expect_null(attr(h5_read(file, "x", as = c("@units" = "null")), "units"))
+  expect_equal(h5_read(file, "x", as = c("@." = "null")), as.vector(x))
+  
+  # Rewriting an attribute keeps the others
+  h5_write(I("mm"), file, "x", attr = "units")
+  expect_equal(attr(h5_read(file, "x"), "units"), "mm")
+  expect_equal(attr(h5_read(file, "x"), "a20"), c(10, 20))
+  
+  # A few attributes stay compact
+  y <- structure(1.5, note = "one", n = 2)
+  h5_write(y, file, "y")
+  expect_equal(h5_read(file, "y"), y)
+  
+})
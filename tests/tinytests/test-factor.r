@@ -48,3 +48,41 @@ local({
   expect_equal(h5_read(file, "enum_uint8"),  sm)
   expect_equal(h5_read(file, "enum_uint16"), md)
 })
+
+local({
+  #test_that("Dictionary-encoded strings and factors", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  x <- rep(c("ctrl", "trt", NA, "placebo"), 250)
+  h5_write(x, file, "chr", as = "dict")
+  expect_equal(h5_typeof(file, "chr"), "uint8")
+  expect_equal(h5_class(file, "chr"), "character")
+  expect_equal(h5_read(file, "chr"), x)
+  expect_equal(h5_read(file, "chr", as = "factor"), factor(x))
+  expect_null(attributes(h5_read(file, "chr")))
+  
+  f <- factor(c("lo", NA, "hi"), levels = c("lo", "mid", "hi"))
+  h5_write(f, file, "fct", as = "dict")
+  expect_equal(h5_read(file, "fct", as = "factor"), f)
+  
+  m <- matrix(sample(letters, 60, TRUE), 6, 10)
+  h5_write(m, file, "mtx", as = "dict")
+  expect_equal(h5_read(file, "mtx"), m)
+  
+  u <- sprintf("id%05d", 1:20000)
+  h5_write(u, file, "many", as = "dict")
+  expect_equal(h5_typeof(file, "many"), "uint16")
+  expect_equal(h5_read(file, "many"), u)
+  
+  df <- data.frame(g = c("a", "b", "a"), n = 1:3)
+  h5_write(df, file, "cols", as = c(g = "dict"), layout = "columnar")
+  expect_equal(h5_read(file, "cols"), df)
+  
+  h5_write(df, file, "cmpd", as = c(g = "dict"))
+  expect_equal(h5_typeof(file, "cmpd"), "compound[2]")
+  expect_equal(h5_read(file, "cmpd"), df)
+  
+  expect_error(h5_append(x, file, "chr"), "dictionary-encoded")
+  expect_error(h5_append(x, file, "new", as = "dict"), "not supported by h5_append")
+})
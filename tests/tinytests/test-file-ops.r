@@ -51,6 +51,38 @@ local({
   expect_false(h5_exists(file, "b"))
 })
 
+local({
+  #test_that("Copy and Repack", {
+  
+  file1 <- tempfile(fileext = ".h5")
+  file2 <- tempfile(fileext = ".h5")
+  on.exit(unlink(c(file1, file2)))
+  
+  mtx <- matrix(as.double(1:600), 20, dimnames = list(letters[1:20], NULL))
+  h5_write(mtx,    file1, "g/mtx", compress = "none")
+  h5_write(mtcars, file1, "g/df")
+  h5_write("m",    file1, "g/mtx", attr = "units")
+  
+  # Copy within a file and into another one
+  h5_copy(file1, "g/mtx", to_name = "h/mtx")
+  expect_identical(h5_read(file1, "h/mtx"), mtx)
+  h5_copy(file1, "g", file2)
+  expect_identical(h5_read(file2, "g/df"), mtcars)
+  expect_equal(h5_read(file2, "g/mtx"), structure(mtx, units = "m"))
+  expect_error(h5_copy(file1, "g", file2))
+  expect_error(h5_copy(file1, "missing", file2, "x"))
+  
+  # Repack a dataset, then a whole group
+  expect_equal(h5_inspect(file1, "g/mtx")$layout, "contiguous")
+  h5_repack(file1, "g/mtx", compress = "gzip-9")
+  expect_equal(h5_inspect(file1, "g/mtx")$layout, "chunked")
+  expect_equal(h5_read(file1, "g/mtx"), structure(mtx, units = "m"))
+  h5_repack(file1, "g", compress = "none")
+  expect_identical(h5_read(file1, "g/df"), mtcars)
+  expect_equal(h5_inspect(file1, "g/mtx")$layout, "contiguous")
+  expect_equal(h5_read(file1, "g/mtx"), structure(mtx, units = "m"))
+})
+
 local({
   #test_that("ls, str, and names", {
   file <- tempfile(fileext = ".h5")
@@ -85,3 +117,73 @@ local({
   
   expect_error(h5_ls(tempfile())) # file doesn't exist
 })
+
+
+local({
+  #test_that("File format settings", {
+  file1 <- tempfile(fileext = ".h5")
+  file2 <- tempfile(fileext = ".h5")
+  old   <- options(h5lite.format = NULL)
+  on.exit({ options(old); unlink(c(file1, file2)) })
+  
+  fmt <- h5_format("latest", strategy = "paged", persist = TRUE, page_size = 8192, page_buffer = 65536)
+  expect_inherits(fmt, "format")
+  expect_identical(h5_format(fmt), fmt)
+  expect_identical(h5_format("LATEST")$libver, "latest")
+  expect_stdout(print(fmt),         "Page Buffer:\\s+64.00 KB")
+  expect_stdout(print(h5_format()), "Track Free:\\s+No")
+  
+  expect_error(h5_format("v17"))
+  expect_error(h5_format(page_size = 8192),                           "paged")
+  expect_error(h5_format(strategy = "paged", page_size = 100),        "at least 512")
+  expect_error(h5_format(strategy = "paged", page_buffer = 1024),     "one page")
+  expect_error(h5_format(strategy = "none", persist = TRUE),          "persist")
+  expect_error(h5_format(meta_block = 0),                             "positive")
+  
+  # Paged files with tracked free space hold the same data
+  m <- matrix(rnorm(5000), 100)
+  h5_create_file(file1, format = fmt)
+  h5_write(m, file1, "a", compress = "none")
+  expect_equal(h5_read(file1, "a"), m)
+  
+  h5 <- h5_open(file1, format = fmt)
+  h5$write(m, "b", compress = "none")
+  h5$close()
+  h5 <- h5_open(file1, readonly = TRUE, format = fmt)
+  expect_equal(h5$read("b"), m)
+  h5$close()
+  
+  # A page buffer does not stop unpaged files from opening
+  h5_write(m, file2, "a")
+  h5 <- h5_open(file2, format = fmt)
+  expect_equal(h5$read("a"), m)
+  h5$close()
+  unlink(file2)
+  
+  # Space freed in one call is reused by later ones only when tracked
+  options(h5lite.format = h5_format(persist = TRUE))
+  h5_create_file(file2)
+  options(h5lite.format = NULL)
+  file3 <- tempfile(fileext = ".h5")
+  on.exit(unlink(file3), add = TRUE)
+  
+  for (f in c(file2, file3))
+    for (x in c("a", "b", "c")) h5_write(m, f, x, compress = "none")
+  for (i in 1:12) {
+    for (f in c(file2, file3)) {
+      h5_delete(f, c("a", "b", "c")[i %% 3 + 1])
+      h5_write(m, f, c("a", "b", "c")[i %% 3 + 1], compress = "none")
+    }
+  }
+  expect_true(file.size(file2) < file.size(file3) / 2)
+  expect_equal(h5_read(file2, "c"), m)
+  
+  # In-memory files in the latest format serialize to valid files
+  h5 <- h5_open(format = h5_format("latest"))
+  h5$write(m, "a")
+  bytes <- h5$serialize()
+  h5$close()
+  unlink(file2)
+  writeBin(bytes, file2)
+  expect_equal(h5_read(file2, "a"), m)
+})
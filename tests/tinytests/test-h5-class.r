@@ -55,3 +55,171 @@ local({
   expect_stdout(print(h5))
   expect_error(h5$ls(), "handle has been closed")
 })
+
+local({
+  #test_that("h5 handle keeps the file open across calls", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  h5 <- h5_open(file)
+  
+  # Methods and plain functions share the open file
+  h5$write(1:3, "a")
+  h5_write(4:6, file, "b")
+  expect_equal(h5_read(file, "a"), 1:3)
+  expect_equal(h5$read("b"), 4:6)
+  expect_equal(sort(h5$ls()), c("a", "b"))
+  expect_null(h5$flush())
+  
+  # A second handle on the same file shares the open file
+  h5b <- h5_open(file)
+  expect_equal(h5b$read("a"), 1:3)
+  h5b$close()
+  expect_equal(h5$read("a"), 1:3)
+  
+  h5$close()
+  expect_error(h5$flush(), "handle has been closed")
+  expect_equal(h5_read(file, "b"), 4:6)
+})
+
+local({
+  #test_that("Read-only h5 handles", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  expect_error(h5_open(file, readonly = TRUE), "does not exist")
+  expect_error(h5_open(file, readonly = NA))
+  
+  h5_write(1:3, file, "a")
+  
+  h5 <- h5_open(file, readonly = TRUE)
+  expect_equal(h5$read("a"), 1:3)
+  expect_error(h5$write(1, "b"), "read-only")
+  expect_error(h5_write(1, file, "b"), "read-only")
+  expect_error(h5_open(file), "read-only")
+  h5$close()
+  
+  h5_write(1, file, "b")
+  expect_true(h5_exists(file, "b"))
+
+  # A read-only handle stays read-only beside a read-write one
+  rw <- h5_open(file)
+  ro <- h5_open(file, readonly = TRUE)
+  expect_error(ro$write(1, "c"), "read-only")
+  expect_error(ro$delete("b"),   "read-only")
+  expect_equal(ro$read("a"), 1:3)
+  rw$write(2, "c")
+  h5_write(3, file, "d")
+  expect_equal(ro$read("c"), 2)
+  expect_equal(h5_read(file, "d"), 3)
+  ro$close()
+  rw$close()
+})
+
+local({
+  #test_that("Cache settings for h5 handles", {
+  file <- tempfile(fileext = ".h5")
+  old  <- options(h5lite.cache = NULL)
+  on.exit({ options(old); unlink(file) })
+  
+  m   <- matrix(as.numeric(1:200000), nrow = 1000)
+  cmp <- h5_compression("gzip", chunk_size = 65536, access = "column")
+  h5_write(m, file, "mtx", compress = cmp)
+  
+  cfg <- h5_cache(chunk_bytes = 4 * 1024^2, chunk_slots = 1009, preempt = 0.5,
+                  meta_bytes = 4 * 1024^2, sieve_bytes = 256 * 1024)
+  expect_inherits(cfg, "cache")
+  expect_identical(h5_cache(cfg), cfg)
+  expect_equal(cfg$chunk_slots, 1009)
+  expect_true(is.na(h5_cache()$chunk_bytes))
+  expect_stdout(print(cfg),       "Chunk Cache:\\s+4.00 MB")
+  expect_stdout(print(h5_cache()), "Auto")
+  
+  expect_error(h5_cache(chunk_bytes = 0),         "positive")
+  expect_error(h5_cache(chunk_bytes = "big"))
+  expect_error(h5_cache(preempt = 2),             "between 0 and 1")
+  expect_error(h5_cache(meta_bytes = 10),         "between 1 KiB")
+  expect_error(h5_open(file, cache = h5_cache(chunk_slots = -1)), "positive")
+  
+  # Reads through tuned handles and options return the same data
+  h5 <- h5_open(file, readonly = TRUE, cache = cfg)
+  expect_equal(h5$read("mtx"), m)
+  expect_equal(h5_read(file, "mtx", start = 10, count = 5), m[10:14, ])
+  expect_equal(Reduce(`+`, h5$apply("mtx", colSums, block = 90)), colSums(m))
+  h5$close()
+  
+  options(h5lite.cache = h5_cache(meta_bytes = 2 * 1024^2, sieve_bytes = 1024^2))
+  expect_equal(h5_read(file, "mtx"), m)
+  h5_write(1:10, file, "vec")
+  expect_equal(h5_read(file, "vec"), 1:10)
+  
+  options(h5lite.cache = NULL)
+  expect_equal(Reduce(`+`, h5_apply(file, "mtx", colSums, block = 90)), colSums(m))
+})
+
+
+local({
+  #test_that("In-memory files and serialization", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  h5 <- h5_open()
+  name <- as.character(h5)
+  expect_false(file.exists(name))
+  expect_stdout(print(h5), "in memory")
+  
+  h5$write(mtcars, "df")
+  h5$write(matrix(rnorm(200), 20), "grp/mtx", compress = "zstd")
+  expect_equal(h5_read(name, "df"), mtcars)
+  expect_true(h5_exists(name, "grp/mtx"))
+  expect_equal(sort(h5$ls()), c("df", "grp", "grp/mtx"))
+  expect_equal(h5_read(name, "grp/mtx", mmap = TRUE), h5$read("grp/mtx"))
+  
+  bytes <- h5$serialize()
+  expect_true(is.raw(bytes))
+  expect_identical(h5_serialize(h5), bytes)
+  h5$close()
+  expect_false(file.exists(name))
+  expect_error(h5_read(name, "df"), "does not exist")
+  
+  # Reopened bytes hold the same data; on disk they are an ordinary file
+  h5 <- h5_open(raw = bytes, readonly = TRUE)
+  expect_equal(h5$read("df"), mtcars)
+  expect_error(h5$write(1, "x"))
+  h5$close()
+  
+  writeBin(bytes, file)
+  expect_equal(h5_read(file, "df"), mtcars)
+  expect_equal(length(h5_serialize(file)), file.size(file))
+  
+  # Writable copies leave the original bytes untouched
+  h5 <- h5_open(raw = bytes)
+  h5$write(1:5, "x")
+  h5$delete("df")
+  h5_copy(file, "df", as.character(h5), "df2")
+  expect_equal(h5$read("df2"), mtcars)
+  expect_equal(h5_read(file, "df"), mtcars)
+  h5$close()
+
+  # Files in the 1.10+ format serialize while open for writing, in memory
+  # and on disk, though HDF5 leaves a stale superblock checksum in the image
+  file2 <- tempfile(fileext = ".h5")
+  on.exit(unlink(file2), add = TRUE)
+  for (h5 in list(h5_open(format = h5_format("latest")), h5_open(file2, format = h5_format("latest")))) {
+    h5$write(1:5, "x")
+    copy <- h5_open(raw = h5$serialize(), readonly = TRUE)
+    expect_equal(copy$read("x"), 1:5)
+    copy$close()
+    h5$close()
+  }
+  expect_equal(h5_read(file2, "x"), 1:5)
+  copy <- h5_open(raw = h5_serialize(file2), readonly = TRUE)
+  expect_equal(copy$read("x"), 1:5)
+  copy$close()
+
+  expect_error(h5_open(raw = as.raw(1:10)),       "not a valid HDF5 file")
+  expect_error(h5_open(raw = raw(0)),             "non-empty raw vector")
+  expect_error(h5_open(raw = 1:10),               "non-empty raw vector")
+  expect_error(h5_open(readonly = TRUE),          "read-only")
+  expect_error(h5_open(file, raw = bytes),        "file = NULL")
+})
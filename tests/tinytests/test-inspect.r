@@ -187,3 +187,30 @@ local({
   
   unlink(file)
 })
+
+local({
+  #test_that("h5_inspect reports per-chunk statistics", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  mtx <- matrix(as.double(rep(1:100, 200)), 200, 100)
+  h5_write(mtx, file, "mtx", compress = h5_compression("gzip", chunk_size = 8192))
+  h5_write(mtx, file, "flat", compress = "none")
+  
+  res <- h5_inspect(file, "mtx", chunks = TRUE)
+  chk <- res$chunks
+  expect_inherits(chk, "data.frame")
+  expect_equal(nrow(chk), res$n_chunks)
+  expect_equal(names(chk), c("start_1", "start_2", "address", "size", "ratio", "filter_mask"))
+  expect_equal(sum(chk$size), res$storage_size)
+  expect_true(all(chk$ratio > 1))
+  expect_true(all((chk$start_1 - 1) %% res$chunk_dims[1] == 0))
+  
+  out <- capture.output(print(res))
+  expect_true(any(grepl("0.0% unallocated", out)))
+  expect_true(any(grepl("Spread:", out)))
+  
+  expect_null(h5_inspect(file, "mtx")$chunks)
+  expect_null(h5_inspect(file, "flat", chunks = TRUE)$chunks)
+  expect_error(h5_inspect(file, "mtx", chunks = NA))
+})
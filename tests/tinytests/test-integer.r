@@ -104,6 +104,12 @@ local({
 
   # Can't write -100 to a uint
   expect_error(h5_write(val, file, "u8", as = "uint8"))
+
+  # INT_MIN is NA_integer_ in R: doubles by default, a warning when forced
+  h5_write(c(1, -2^31), file, "i32", as = "int32")
+  expect_identical(h5_read(file, "i32"), c(1, -2^31))
+  expect_warning(res <- h5_read(file, "i32", as = "integer"))
+  expect_identical(res, c(1L, NA_integer_))
 })
 
 local({
@@ -175,3 +181,47 @@ local({
 
 
 
+
+local({
+  #test_that("Narrow integer types are read natively", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  h5_write(c(-5, 0, 100), file, "i8", as = "int8")
+  h5_write(c(0, 65535),   file, "u16", as = "uint16")
+  h5_write(c(-2^31 + 1, 2^31 - 1), file, "i32", as = "int32")
+  h5_write(c(-2^31, 1),   file, "i32_min", as = "int32")
+  h5_write(matrix(c(0, 2, 0, 7), 2, 2), file, "mtx", as = "int16")
+  
+  expect_identical(h5_read(file, "i8"),  c(-5L, 0L, 100L))
+  expect_identical(h5_read(file, "u16"), c(0L, 65535L))
+  expect_identical(h5_read(file, "i32"), c(-2147483647L, 2147483647L))
+  expect_identical(h5_read(file, "mtx"), matrix(c(0L, 2L, 0L, 7L), 2, 2))
+  
+  # INT_MIN collides with NA_integer_, so "auto" falls back to double
+  expect_identical(h5_read(file, "i32_min"), c(-2^31, 1))
+  
+  # Logical and double targets
+  expect_identical(h5_read(file, "mtx", as = "logical"), matrix(c(FALSE, TRUE, FALSE, TRUE), 2, 2))
+  expect_identical(h5_read(file, "i8",  as = "double"),  c(-5, 0, 100))
+})
+
+local({
+  #test_that("Wide integer types are narrowed to integer when they fit", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  x <- as.double(1:10000)
+  h5_write(x, file, "i64", as = "int64")
+  h5_write(x, file, "u32", as = "uint32")
+  expect_identical(h5_read(file, "i64"), 1:10000)
+  expect_identical(h5_read(file, "u32"), 1:10000)
+  
+  # Values out of range, early or late in the data, keep it double
+  early <- replace(x, 2,    3e9)
+  late  <- replace(x, 9999, -2^31)
+  h5_write(early, file, "early", as = "int64")
+  h5_write(late,  file, "late",  as = "int64")
+  expect_identical(h5_read(file, "early"), early)
+  expect_identical(h5_read(file, "late"),  late)
+})
@@ -48,3 +48,73 @@ local({
   expect_equal(res, lst)
   
 })
+
+local({
+  #test_that("Large nested lists are written in one batch", {
+  
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  lst <- setNames(lapply(1:500, function (i) structure(i * 1.5, id = i)), paste0("x", 1:500))
+  lst$sub <- list(df = data.frame(a = 1:3, b = c("x", "y", "z")), m = matrix(1:6, 2))
+  attr(lst, "note") <- "batched"
+  
+  h5_write(lst, file, "lst")
+  h5_write(lst$sub, file, "cols", layout = "columnar")
+  
+  # Groups are read back in sorted order
+  res <- h5_read(file, "lst")
+  expect_equal(attr(res, "note"), "batched")
+  expect_equal(res[names(lst)], lst[names(lst)])
+  expect_equal(h5_read(file, "cols"), lst$sub)
+  
+  # Rewriting a group replaces its previous contents
+  h5_write(list(only = 1), file, "lst")
+  expect_equal(h5_ls(file, "lst"), "only")
+  
+  # Validation errors happen before anything is written
+  expect_error(h5_write(list(a = 1, b = factor(NA)), file, "bad"))
+  expect_false(h5_exists(file, "bad"))
+  
+  # Also through a writable handle
+  h5 <- h5_open(file)
+  h5$write(lst, "h")
+  h5$close()
+  expect_equal(h5_read(file, "h")[names(lst)], lst[names(lst)])
+  
+})
+
+
+local({
+  #test_that("Groups are read in a single pass", {
+  
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  df <- data.frame(x = 1:3, y = c("a", "b", "c"))
+  h5_write(df, file, "g/df", layout = "columnar")
+  h5_write(structure(1:4, unit = "cm"), file, "g/b")
+  h5_write(matrix(1:6, 2, dimnames = list(c("r1", "r2"), NULL)), file, "g/a")
+  h5_write(c(TRUE, FALSE), file, "g/sub/flag")
+  h5_create_group(file, "g/empty")
+  
+  res <- h5_read(file, "g")
+  expect_equal(names(res), c("a", "b", "df", "empty", "sub"))
+  expect_equal(res$a, h5_read(file, "g/a"))
+  expect_equal(res$b, h5_read(file, "g/b"))
+  expect_equal(res$df, df)
+  expect_equal(res$empty, list())
+  expect_equal(res$sub, list(flag = c(TRUE, FALSE)))
+  
+  # `as` applies to members and their attributes
+  res <- h5_read(file, "g", as = c(x = "null", b = "double", "@unit" = "null"))
+  expect_equal(names(res$df), "y")
+  expect_true(is.double(res$b))
+  expect_null(attr(res$b, "unit"))
+  
+  # Through a read-only handle
+  h5 <- h5_open(file, readonly = TRUE)
+  expect_equal(h5$read("g"), h5_read(file, "g"))
+  h5$close()
+  
+})
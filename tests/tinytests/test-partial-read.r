@@ -211,3 +211,131 @@ local({
   
   unlink(file)
 })
+
+local({
+  #test_that("blocked reads reassemble arrays regardless of block size", {
+  file <- tempfile(fileext = ".h5")
+  
+  arr <- array(as.numeric(1:(37 * 5 * 3)), dim = c(37, 5, 3))
+  chr <- matrix(sprintf("s%03d", 1:(23 * 4)), nrow = 23)
+  h5_write(arr, file, "arr", compress = "gzip")
+  h5_write(arr, file, "arr_raw", compress = FALSE)
+  h5_write(chr, file, "chr")
+  
+  old <- options(h5lite.block_size = 64)
+  on.exit(options(old), add = TRUE)
+  
+  expect_equal(h5_read(file, "arr"), arr)
+  expect_equal(h5_read(file, "arr_raw"), arr)
+  expect_equal(h5_read(file, "chr"), chr)
+  expect_equal(h5_read(file, "arr", start = 2, count = 2), arr[, , 2:3])
+  
+  options(old)
+  expect_equal(h5_read(file, "arr"), arr)
+  
+  unlink(file)
+})
+
+local({
+  #test_that("index reads match R subsetting, including names", {
+  file <- tempfile(fileext = ".h5")
+  
+  m   <- matrix(as.numeric(1:200), nrow = 20, dimnames = list(paste0("r", 1:20), paste0("c", 1:10)))
+  arr <- array(1:(6 * 5 * 4), dim = c(6, 5, 4))
+  chr <- matrix(sprintf("s%03d", 1:60), nrow = 12)
+  v   <- setNames(seq(10, 100, by = 10), letters[1:10])
+  df  <- data.frame(x = 1:8, y = letters[1:8], row.names = paste0("id", 1:8))
+  h5_write(m,   file, "m", compress = "gzip")
+  h5_write(arr, file, "arr")
+  h5_write(chr, file, "chr")
+  h5_write(v,   file, "v")
+  h5_write(df,  file, "df")
+  h5_write(mtcars[1:6], file, "mt")
+  
+  rows <- c(2, 3, 4, 9, 17)
+  expect_equal(h5_read(file, "m", index = list(rows, NULL)), m[rows, , drop = FALSE])
+  expect_equal(h5_read(file, "m", index = list(NULL, c(1, 10))), m[, c(1, 10), drop = FALSE])
+  expect_equal(h5_read(file, "m", index = list(rows, c(2, 5, 6))), m[rows, c(2, 5, 6), drop = FALSE])
+  expect_equal(h5_read(file, "arr", index = list(c(1, 6), NULL, c(2, 4))), arr[c(1, 6), , c(2, 4), drop = FALSE])
+  expect_equal(h5_read(file, "chr", index = list(c(12, 1), 3:5)), chr[c(12, 1), 3:5, drop = FALSE])
+  expect_equal(h5_read(file, "v", index = c(9, 2, 3)), v[c(9, 2, 3)])
+  expect_equal(h5_read(file, "v", index = list(v > 50)), v[v > 50])
+  
+  # Unsorted and repeated indices
+  expect_equal(h5_read(file, "m", index = list(c(5, 1, 5), c(3, 2))), m[c(5, 1, 5), c(3, 2), drop = FALSE])
+  
+  # Data frames: rows only, with stored or automatic row names
+  expect_equal(h5_read(file, "df", index = c(2, 7, 8)), df[c(2, 7, 8), ])
+  expect_equal(h5_read(file, "mt", index = c(6, 1)), mtcars[c(6, 1), 1:6])
+  
+  # Scattered selections also work with tiny read blocks
+  old <- options(h5lite.block_size = 64)
+  expect_equal(h5_read(file, "m", index = list(rows, c(1, 3))), m[rows, c(1, 3), drop = FALSE])
+  options(old)
+  
+  # Empty selections
+  expect_equal(dim(h5_read(file, "m", index = list(numeric(0), NULL))), c(0L, 10L))
+  
+  expect_error(h5_read(file, "m", index = rows), "one element per dimension")
+  expect_error(h5_read(file, "m", index = list(rows)), "has 1 elements")
+  expect_error(h5_read(file, "m", index = list(21, NULL)), "out of bounds")
+  expect_error(h5_read(file, "m", index = list(1.5, NULL)), "whole numbers")
+  expect_error(h5_read(file, "m", index = list("a", NULL)), "must be numeric")
+  expect_error(h5_read(file, "m", index = list(TRUE, NULL)), "match the dimension length")
+  expect_error(h5_read(file, "m", start = 1, index = list(1, NULL)), "cannot be combined")
+  expect_error(h5_read(file, "/", index = 1), "only be used on datasets")
+  
+  unlink(file)
+})
+
+local({
+  #test_that("lazy reads match regular reads", {
+  file <- tempfile(fileext = ".h5")
+  
+  vec <- setNames(rnorm(20000), paste0("v", 1:20000))
+  mtx <- matrix(rnorm(300 * 40), 300, 40, dimnames = list(NULL, paste0("c", 1:40)))
+  int <- sample(0:200, 5000, replace = TRUE)
+  big <- c(1L, .Machine$integer.max)
+  
+  h5_write(list(vec = vec, mtx = mtx, int = int, big = big, chr = letters), file, "grp")
+  
+  res <- h5_read(file, "grp", lazy = TRUE)
+  expect_equal(res, h5_read(file, "grp"))
+  
+  x <- h5_read(file, "grp/vec", lazy = TRUE)
+  expect_equal(length(x), 20000)
+  expect_equal(x[[12345]], vec[[12345]])
+  expect_equal(x[c(20000, 3, 3)], vec[c(20000, 3, 3)])
+  expect_equal(sum(x), sum(vec))
+  
+  m <- h5_read(file, "grp/mtx", lazy = TRUE)
+  expect_equal(dim(m), c(300L, 40L))
+  expect_equal(m[, "c7"], mtx[, "c7"])
+  expect_equal(m[5, ], mtx[5, ])
+  expect_equal(m * 2, mtx * 2)
+  
+  i <- h5_read(file, "grp/int", lazy = TRUE)
+  expect_identical(i[1:10], int[1:10])
+  expect_identical(h5_read(file, "grp/int", as = "logical", lazy = TRUE), as.logical(int))
+  
+  # Modifying a lazy vector leaves the file untouched
+  x[1] <- 0
+  expect_equal(x[[1]], 0)
+  expect_equal(h5_read(file, "grp/vec")[[1]], vec[[1]])
+  
+  # Partial reads and value-dependent types are read right away
+  expect_equal(h5_read(file, "grp/vec", start = 2, count = 3, lazy = TRUE), vec[2:4])
+  expect_identical(h5_read(file, "grp/big", as = "double", lazy = TRUE), as.double(big))
+
+  # Values out of integer range become NA, with one warning per vector
+  h5_write(c(1, 3e9, -3e9), file, "far")
+  f <- h5_read(file, "far", as = "integer", lazy = TRUE)
+  expect_warning(y <- f[[2]], "integer range")
+  expect_identical(y, NA_integer_)
+  expect_silent(y <- f[[3]])
+  expect_identical(y, NA_integer_)
+  
+  expect_error(h5_read(file, "grp", lazy = "yes"))
+  
+  unlink(file)
+})
@@ -0,0 +1,56 @@
+local({
+  #test_that("h5_profile counts the stages of a call", {
+  file <- tempfile(fileext = ".h5")
+  on.exit(unlink(file))
+  
+  m   <- matrix(rnorm(6000), nrow = 200, dimnames = list(paste0("r", 1:200), NULL))
+  rec <- h5_profile(h5_write(m, file, "m"))
+  
+  expect_inherits(rec, "data.frame")
+  expect_identical(
+    rec$stage, 
+    c("open", "metadata", "read", "write", "transpose", "coerce", "strings", "dimscales") )
+  expect_identical(names(rec), c("stage", "calls", "seconds", "bytes", "elements"))
+  expect_true(rec$calls[rec$stage == "open"] >= 1)
+  expect_true(rec$elements[rec$stage == "write"] >= 6000)
+  
+  p <- h5_profile(h5_read(file, "m"))
+  expect_equal(attr(p, "value"), m)
+  
+  stage <- function (x, s) as.list(x[x$stage == s, ])
+  expect_equal(stage(p, "read")$bytes, 6000 * 8 + 200 * 8, tolerance = 0.5)
+  expect_true(stage(p, "transpose")$elements == 6000)
+  expect_true(stage(p, "strings")$elements == 200)
+  expect_true(stage(p, "dimscales")$calls == 1)
+  expect_true(all(p$seconds >= 0))
+  
+  p <- h5_profile(h5_read(file, "m", as = "integer"))
+  expect_true(stage(p, "coerce")$elements == 6000)
+})
+
+local({
+  #test_that("h5lite.profile accumulates counters until reset", {
+  file <- tempfile(fileext = ".h5")
+  old  <- options(h5lite.profile = NULL)
+  on.exit({ options(old); unlink(file) })
+  
+  h5_write(1:10, file, "x")
+  one <- h5_profile(h5_read(file, "x"))
+  h5_profile(reset = TRUE)
+  
+  # Off: nothing is counted
+  x <- h5_read(file, "x")
+  expect_true(all(h5_profile()$calls == 0))
+  
+  options(h5lite.profile = TRUE)
+  x <- h5_read(file, "x")
+  x <- h5_read(file, "x")
+  options(h5lite.profile = NULL)
+  
+  rec <- h5_profile(reset = TRUE)
+  expect_equal(rec$calls, 2 * one$calls)
+  expect_equal(rec$elements[rec$stage == "read"], 20)
+  expect_true(all(h5_profile()$calls == 0))
+  
+  expect_error(h5_profile(reset = NA))
+})